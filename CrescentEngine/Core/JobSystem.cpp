@@ -0,0 +1,443 @@
+#include "CrescentPCH.h"
+#include "JobSystem.h"
+#include "WorkStealingDeque.h"
+#include <algorithm>
+
+namespace Crescent
+{
+	static constexpr unsigned int g_InvalidWorkerIndex = ~0u;
+	//Upper bound on the chunks a single ParallelFor queues, keeping it well within our job pool.
+	static constexpr uint32_t g_MaximumParallelForChunks = JobSystem::g_JobPoolCapacity / 4;
+
+	//Index of the worker running on this thread. The main thread is worker 0 once the system is initialized.
+	static thread_local unsigned int s_WorkerIndex = g_InvalidWorkerIndex;
+
+	struct JobSystem::WorkerContext
+	{
+		WorkStealingDeque m_Deque;
+		std::vector<Job> m_JobPool = std::vector<Job>(g_JobPoolCapacity);
+		uint32_t m_NextJobIndex = 0;
+	};
+
+	unsigned int JobSystem::m_WorkerCount = 0;
+	std::vector<std::unique_ptr<JobSystem::WorkerContext>> JobSystem::m_WorkerContexts;
+	std::vector<std::thread> JobSystem::m_WorkerThreads;
+	std::atomic<bool> JobSystem::m_Running = { false };
+	std::atomic<int> JobSystem::m_QueuedJobCount = { 0 };
+	std::mutex JobSystem::m_WakeMutex;
+	std::condition_variable JobSystem::m_WakeCondition;
+	std::mutex JobSystem::m_MainThreadJobMutex;
+	std::vector<Job*> JobSystem::m_MainThreadJobs;
+	std::mutex JobSystem::m_BackgroundJobMutex;
+	std::deque<Job*> JobSystem::m_BackgroundJobs;
+
+	void JobSystem::Initialize(unsigned int workerCount)
+	{
+		if (m_Running)
+		{
+			return;
+		}
+
+		if (workerCount == 0)
+		{
+			workerCount = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+		m_WorkerCount = workerCount;
+
+		for (unsigned int i = 0; i < m_WorkerCount; i++)
+		{
+			m_WorkerContexts.push_back(std::make_unique<WorkerContext>());
+		}
+
+		m_Running = true;
+		s_WorkerIndex = 0;
+		for (unsigned int i = 1; i < m_WorkerCount; i++)
+		{
+			m_WorkerThreads.emplace_back(&JobSystem::WorkerLoop, i);
+		}
+
+		CrescentInfo("Job system started with " + std::to_string(m_WorkerCount) + " workers.");
+	}
+
+	void JobSystem::Shutdown()
+	{
+		if (!m_Running)
+		{
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> wakeLock(m_WakeMutex);
+			m_Running = false;
+		}
+		m_WakeCondition.notify_all();
+
+		for (std::thread& workerThread : m_WorkerThreads)
+		{
+			workerThread.join();
+		}
+
+		//Anything still queued, on either lane or in any worker's deque, runs now on this thread (standing in as the main thread). Otherwise its counter would
+		//never reach zero, and a job allocated on the heap would leak. Finishing a job can queue its continuations, so we keep going until nothing is left.
+		s_WorkerIndex = 0;
+		while (true)
+		{
+			if (ExecuteNextJob())
+			{
+				continue;
+			}
+
+			//ExecuteNextJob leaves the background lane to the other workers, which are gone by now.
+			Job* backgroundJob = nullptr;
+			{
+				std::lock_guard<std::mutex> backgroundLock(m_BackgroundJobMutex);
+				if (!m_BackgroundJobs.empty())
+				{
+					backgroundJob = m_BackgroundJobs.front();
+					m_BackgroundJobs.pop_front();
+				}
+			}
+
+			if (!backgroundJob)
+			{
+				break;
+			}
+			m_QueuedJobCount.fetch_sub(1, std::memory_order_relaxed);
+			ExecuteJob(backgroundJob);
+		}
+
+		m_WorkerThreads.clear();
+		m_WorkerContexts.clear();
+		m_WorkerCount = 0;
+		s_WorkerIndex = g_InvalidWorkerIndex;
+	}
+
+	void JobSystem::Run(std::function<void()> task, JobCounter* counter, JobCounter* dependency)
+	{
+		//Not set up, or called from a thread that isn't ours. Nothing to hand the job to, so run it right away.
+		if (!m_Running || s_WorkerIndex == g_InvalidWorkerIndex)
+		{
+			if (dependency)
+			{
+				Wait(dependency);
+			}
+			task();
+			return;
+		}
+
+		QueueJob(AllocateJob(std::move(task), counter, JobLane_Any), dependency);
+	}
+
+	void JobSystem::RunOnMainThread(std::function<void()> task, JobCounter* counter, JobCounter* dependency)
+	{
+		if (!m_Running || s_WorkerIndex == g_InvalidWorkerIndex)
+		{
+			if (dependency)
+			{
+				Wait(dependency);
+			}
+			task();
+			return;
+		}
+
+		QueueJob(AllocateJob(std::move(task), counter, JobLane_MainThread), dependency);
+	}
+
+	void JobSystem::RunInBackground(std::function<void()> task, JobCounter* counter, JobCounter* dependency)
+	{
+		if (!m_Running || s_WorkerIndex == g_InvalidWorkerIndex || m_WorkerCount <= 1)
+		{
+			if (dependency)
+			{
+				Wait(dependency);
+			}
+			task();
+			return;
+		}
+
+		QueueJob(AllocateJob(std::move(task), counter, JobLane_Background), dependency);
+	}
+
+	void JobSystem::ParallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)>& function)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+
+		grainSize = std::max(grainSize, (count + g_MaximumParallelForChunks - 1) / g_MaximumParallelForChunks);
+		grainSize = std::max(grainSize, 1u);
+		uint32_t chunkCount = (count + grainSize - 1) / grainSize;
+
+		if (chunkCount == 1 || m_WorkerCount <= 1 || !m_Running || s_WorkerIndex == g_InvalidWorkerIndex)
+		{
+			function(0, count);
+			return;
+		}
+
+		//Queue every chunk but the first, which we process ourselves while the others get stolen.
+		JobCounter parallelForCounter;
+		for (uint32_t chunkIndex = 1; chunkIndex < chunkCount; chunkIndex++)
+		{
+			uint32_t begin = chunkIndex * grainSize;
+			uint32_t end = std::min(begin + grainSize, count);
+			SubmitJob(AllocateJob([&function, begin, end]() { function(begin, end); }, &parallelForCounter, JobLane_Any), false);
+		}
+		WakeWorkers(true);
+
+		function(0, std::min(grainSize, count));
+		Wait(&parallelForCounter);
+	}
+
+	void JobSystem::Wait(JobCounter* counter)
+	{
+		while (!counter->IsComplete())
+		{
+			if (!ExecuteNextJob())
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void JobSystem::ExecuteMainThreadJobs()
+	{
+		std::vector<Job*> mainThreadJobs;
+		{
+			std::lock_guard<std::mutex> mainThreadLock(m_MainThreadJobMutex);
+			mainThreadJobs.swap(m_MainThreadJobs);
+		}
+
+		for (Job* job : mainThreadJobs)
+		{
+			ExecuteJob(job);
+		}
+	}
+
+	unsigned int JobSystem::RetrieveCurrentWorkerIndex()
+	{
+		return s_WorkerIndex;
+	}
+
+	bool JobSystem::IsMainThread()
+	{
+		return s_WorkerIndex == 0;
+	}
+
+	Job* JobSystem::AllocateJob(std::function<void()>&& task, JobCounter* counter, JobLane jobLane)
+	{
+		//Slots are recycled in order. One whose job hasn't run yet (say, a continuation still waiting on its dependency) is skipped for a heap allocation.
+		WorkerContext* workerContext = m_WorkerContexts[s_WorkerIndex].get();
+		Job* job = &workerContext->m_JobPool[workerContext->m_NextJobIndex & (g_JobPoolCapacity - 1)];
+		if (job->m_InUse.load(std::memory_order_acquire))
+		{
+			job = new Job();
+			job->m_HeapAllocated = true;
+		}
+		else
+		{
+			workerContext->m_NextJobIndex++;
+		}
+		job->m_InUse.store(true, std::memory_order_relaxed);
+		job->m_Task = std::move(task);
+		job->m_Counter = counter;
+		job->m_Lane = jobLane;
+
+		if (counter)
+		{
+			counter->m_Value.fetch_add(1, std::memory_order_relaxed);
+			counter->m_Complete.store(false, std::memory_order_relaxed);
+		}
+		return job;
+	}
+
+	void JobSystem::QueueJob(Job* job, JobCounter* dependency)
+	{
+		if (dependency)
+		{
+			while (dependency->m_ContinuationLock.test_and_set(std::memory_order_acquire))
+			{
+				std::this_thread::yield();
+			}
+
+			//If the dependency is still running, whoever brings it to zero will queue us. Checked under the lock so we can't miss that moment.
+			if (dependency->m_Value.load(std::memory_order_acquire) != 0)
+			{
+				dependency->m_Continuations.push_back(job);
+				dependency->m_ContinuationLock.clear(std::memory_order_release);
+				return;
+			}
+			dependency->m_ContinuationLock.clear(std::memory_order_release);
+		}
+
+		SubmitJob(job, true);
+	}
+
+	void JobSystem::SubmitJob(Job* job, bool wakeWorkers)
+	{
+		if (job->m_Lane == JobLane_MainThread)
+		{
+			std::lock_guard<std::mutex> mainThreadLock(m_MainThreadJobMutex);
+			m_MainThreadJobs.push_back(job);
+			return;
+		}
+
+		if (job->m_Lane == JobLane_Background)
+		{
+			{
+				std::lock_guard<std::mutex> backgroundLock(m_BackgroundJobMutex);
+				m_BackgroundJobs.push_back(job);
+			}
+			m_QueuedJobCount.fetch_add(1, std::memory_order_release);
+			WakeWorkers(false);
+			return;
+		}
+
+		if (!m_WorkerContexts[s_WorkerIndex]->m_Deque.Push(job))
+		{
+			//Our deque is full. Running the job here is always safe, if less parallel.
+			ExecuteJob(job);
+			return;
+		}
+
+		m_QueuedJobCount.fetch_add(1, std::memory_order_release);
+		if (wakeWorkers)
+		{
+			WakeWorkers(false);
+		}
+	}
+
+	void JobSystem::WakeWorkers(bool wakeAll)
+	{
+		//Taking the lock orders us against a worker that has just checked for work but not yet gone to sleep, which would otherwise miss this wake up.
+		{
+			std::lock_guard<std::mutex> wakeLock(m_WakeMutex);
+		}
+
+		if (wakeAll)
+		{
+			m_WakeCondition.notify_all();
+		}
+		else
+		{
+			m_WakeCondition.notify_one();
+		}
+	}
+
+	bool JobSystem::ExecuteNextJob()
+	{
+		if (s_WorkerIndex == g_InvalidWorkerIndex || m_WorkerContexts.empty())
+		{
+			return false;
+		}
+
+		if (s_WorkerIndex == 0)
+		{
+			//The main thread lane has priority, as other threads may be blocked on it.
+			Job* mainThreadJob = nullptr;
+			{
+				std::lock_guard<std::mutex> mainThreadLock(m_MainThreadJobMutex);
+				if (!m_MainThreadJobs.empty())
+				{
+					mainThreadJob = m_MainThreadJobs.back();
+					m_MainThreadJobs.pop_back();
+				}
+			}
+
+			if (mainThreadJob)
+			{
+				ExecuteJob(mainThreadJob);
+				return true;
+			}
+		}
+
+		Job* job = m_WorkerContexts[s_WorkerIndex]->m_Deque.Pop();
+		for (unsigned int i = 1; !job && i < m_WorkerCount; i++)
+		{
+			job = m_WorkerContexts[(s_WorkerIndex + i) % m_WorkerCount]->m_Deque.Steal();
+		}
+
+		//Background work only once there is nothing else, and never on the main thread.
+		if (!job && s_WorkerIndex != 0)
+		{
+			std::lock_guard<std::mutex> backgroundLock(m_BackgroundJobMutex);
+			if (!m_BackgroundJobs.empty())
+			{
+				job = m_BackgroundJobs.front();
+				m_BackgroundJobs.pop_front();
+			}
+		}
+
+		if (!job)
+		{
+			return false;
+		}
+
+		m_QueuedJobCount.fetch_sub(1, std::memory_order_relaxed);
+		ExecuteJob(job);
+		return true;
+	}
+
+	void JobSystem::ExecuteJob(Job* job)
+	{
+		//Take what we need and hand the slot back before running, as nothing reads the job past this point.
+		std::function<void()> task = std::move(job->m_Task);
+		JobCounter* counter = job->m_Counter;
+		if (job->m_HeapAllocated)
+		{
+			delete job;
+		}
+		else
+		{
+			job->m_Task = nullptr;
+			job->m_InUse.store(false, std::memory_order_release);
+		}
+
+		task();
+
+		if (counter)
+		{
+			DecrementCounter(counter);
+		}
+	}
+
+	void JobSystem::DecrementCounter(JobCounter* counter)
+	{
+		if (counter->m_Value.fetch_sub(1, std::memory_order_acq_rel) != 1)
+		{
+			return;
+		}
+
+		//We brought the counter to zero, so everything waiting on it can now be queued. Its owner may destroy it as soon as it is flagged complete,
+		//so the continuations are taken first and the flag is the last thing we touch.
+		std::vector<Job*> continuations;
+		while (counter->m_ContinuationLock.test_and_set(std::memory_order_acquire))
+		{
+			std::this_thread::yield();
+		}
+		continuations.swap(counter->m_Continuations);
+		counter->m_ContinuationLock.clear(std::memory_order_release);
+		counter->m_Complete.store(true, std::memory_order_release);
+
+		for (Job* continuation : continuations)
+		{
+			SubmitJob(continuation, true);
+		}
+	}
+
+	void JobSystem::WorkerLoop(unsigned int workerIndex)
+	{
+		s_WorkerIndex = workerIndex;
+
+		while (m_Running)
+		{
+			if (ExecuteNextJob())
+			{
+				continue;
+			}
+
+			std::unique_lock<std::mutex> wakeLock(m_WakeMutex);
+			m_WakeCondition.wait(wakeLock, []() { return m_QueuedJobCount.load(std::memory_order_acquire) > 0 || !m_Running; });
+		}
+	}
+}
\ No newline at end of file
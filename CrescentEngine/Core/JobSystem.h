@@ -0,0 +1,135 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <memory>
+#include <deque>
+#include <cstdint>
+
+namespace Crescent
+{
+	class JobCounter;
+	class WorkStealingDeque;
+
+	enum JobLane : uint8_t
+	{
+		JobLane_Any,
+		JobLane_MainThread,
+		JobLane_Background
+	};
+
+	struct Job
+	{
+		std::function<void()> m_Task;
+		JobCounter* m_Counter = nullptr; //Decremented once the task has run.
+		JobLane m_Lane = JobLane_Any;
+
+		std::atomic<bool> m_InUse = { false }; //Set while the job sits in the pool waiting to run, so that its slot isn't handed out again.
+		bool m_HeapAllocated = false; //Allocated because our pool slot was still in use. Deleted once run.
+	};
+
+	/*
+		Tracks a group of jobs. Incremented for every job run against it and decremented as each completes, so a value of zero means the whole group is done.
+		Jobs may also be made to wait on a counter, in which case they are only queued once it reaches zero.
+
+		Completion is published through its own flag rather than the value itself. Whoever brings the value to zero still has to take the continuation list, and
+		the counter may be destroyed the moment it is seen as complete (it often lives on the waiting thread's stack), so the flag is its very last access to it.
+	*/
+	class JobCounter
+	{
+	public:
+		JobCounter() { }
+		JobCounter(const JobCounter&) = delete;
+		JobCounter& operator=(const JobCounter&) = delete;
+
+		bool IsComplete() const { return m_Complete.load(std::memory_order_acquire); }
+
+	private:
+		friend class JobSystem;
+
+		std::atomic<int> m_Value = { 0 };
+		std::atomic<bool> m_Complete = { true }; //Set once m_Value has reached zero and we are done with the continuations.
+		std::atomic_flag m_ContinuationLock = ATOMIC_FLAG_INIT; //Guards the list below. Held only long enough to push or swap it.
+		std::vector<Job*> m_Continuations; //Jobs waiting for us to reach zero.
+	};
+
+	/*
+		Work stealing job scheduler. Every worker thread, including the main thread (worker 0), owns a lock-free deque it pushes its own jobs to and pops
+		them from. Workers that run out of work steal from the others, and sleep once there is nothing left anywhere. Jobs that must run on the main thread,
+		such as anything touching OpenGL, go through a separate lane that only the main thread drains.
+
+		Long running work, such as reading and importing files, goes through a background lane instead, which only the other workers drain and only once
+		they have nothing else to do. Otherwise the main thread could pick it up while helping out in Wait, and stall the frame for as long as it takes.
+
+		Before Initialize (or with a single worker), every job simply runs inline, so code can fan out work unconditionally.
+		Job storage comes from a per-worker ring of g_JobPoolCapacity jobs. A slot is only reused once its job has been taken to run, and should the next one
+		still be waiting, the job is allocated on the heap instead.
+	*/
+
+	class JobSystem
+	{
+	public:
+		static constexpr uint32_t g_JobPoolCapacity = 4096; //Per worker. Must be a power of 2.
+
+		static void Initialize(unsigned int workerCount = 0); //0 uses one worker per hardware thread.
+		static void Shutdown(); //Joins the workers, then runs whatever they left queued on the calling thread.
+
+		//Queues a task, optionally counted against a counter and held back until another counter reaches zero.
+		static void Run(std::function<void()> task, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+		//As above, but the task will only ever be executed by the main thread, within Wait or ExecuteMainThreadJobs.
+		static void RunOnMainThread(std::function<void()> task, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+		//As above, but the task will never be executed by the main thread. Runs inline if there are no other workers to hand it to.
+		static void RunInBackground(std::function<void()> task, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+
+		//Splits [0, count) into chunks of grainSize and processes them across all workers, returning once every chunk is done. The caller takes part.
+		static void ParallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)>& function);
+
+		//Executes other jobs until the counter reaches zero.
+		static void Wait(JobCounter* counter);
+		//Runs everything queued on the main thread lane. Called once per frame.
+		static void ExecuteMainThreadJobs();
+
+		static unsigned int RetrieveWorkerCount() { return m_WorkerCount; }
+		static unsigned int RetrieveCurrentWorkerIndex();
+		static bool IsMainThread();
+
+	private:
+		//Disallow creation of any JobSystem object. This is a static object.
+		JobSystem();
+
+		struct WorkerContext;
+
+		static Job* AllocateJob(std::function<void()>&& task, JobCounter* counter, JobLane jobLane);
+		static void SubmitJob(Job* job, bool wakeWorkers);
+		static void QueueJob(Job* job, JobCounter* dependency);
+		static void WakeWorkers(bool wakeAll);
+
+		static bool ExecuteNextJob();
+		static void ExecuteJob(Job* job);
+		static void DecrementCounter(JobCounter* counter);
+
+		static void WorkerLoop(unsigned int workerIndex);
+
+	private:
+		static unsigned int m_WorkerCount;
+		static std::vector<std::unique_ptr<WorkerContext>> m_WorkerContexts;
+		static std::vector<std::thread> m_WorkerThreads;
+		static std::atomic<bool> m_Running;
+
+		//Sleeping
+		static std::atomic<int> m_QueuedJobCount; //Jobs sitting in any deque or the background lane, so idle workers know whether to look for more.
+		static std::mutex m_WakeMutex;
+		static std::condition_variable m_WakeCondition;
+
+		//Main Thread Lane
+		static std::mutex m_MainThreadJobMutex;
+		static std::vector<Job*> m_MainThreadJobs;
+
+		//Background Lane - First in, first out, as these tend to be streaming requests ordered by priority.
+		static std::mutex m_BackgroundJobMutex;
+		static std::deque<Job*> m_BackgroundJobs;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <array>
+#include <cstdint>
+
+namespace Crescent
+{
+	struct Job;
+
+	/*
+		Fixed capacity Chase-Lev work stealing deque (as formalized for C11 atomics by Le et al.). Its owning worker pushes and pops jobs at the bottom
+		without any locking, while other workers steal from the top whenever they run dry. Only a pop racing a steal for the very last job needs a CAS.
+	*/
+
+	class WorkStealingDeque
+	{
+	public:
+		static constexpr int64_t g_DequeCapacity = 4096; //Must be a power of 2.
+
+		//Owner only. Returns false if the deque is full, in which case the caller should run the job itself.
+		bool Push(Job* job)
+		{
+			int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+			int64_t top = m_Top.load(std::memory_order_acquire);
+			if (bottom - top >= g_DequeCapacity)
+			{
+				return false;
+			}
+
+			m_Jobs[bottom & (g_DequeCapacity - 1)].store(job, std::memory_order_relaxed);
+			m_Bottom.store(bottom + 1, std::memory_order_release);
+			return true;
+		}
+
+		//Owner only. Takes the most recently pushed job, which is the most likely to still be in cache.
+		Job* Pop()
+		{
+			int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+			m_Bottom.store(bottom, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t top = m_Top.load(std::memory_order_relaxed);
+
+			if (top > bottom)
+			{
+				//Empty.
+				m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			Job* job = m_Jobs[bottom & (g_DequeCapacity - 1)].load(std::memory_order_relaxed);
+			if (top == bottom)
+			{
+				//Last job, so we race any thieves for it.
+				if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				{
+					job = nullptr;
+				}
+				m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+			}
+			return job;
+		}
+
+		//Any thread. Takes the oldest job. Returns nullptr if empty or if another thread won the race for it.
+		Job* Steal()
+		{
+			int64_t top = m_Top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+
+			if (top >= bottom)
+			{
+				return nullptr;
+			}
+
+			Job* job = m_Jobs[top & (g_DequeCapacity - 1)].load(std::memory_order_relaxed);
+			if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				return nullptr;
+			}
+			return job;
+		}
+
+	private:
+		//Top and bottom sit on their own cache lines, as thieves hammer the former while the owner works on the latter.
+		alignas(64) std::atomic<int64_t> m_Top = { 0 };
+		alignas(64) std::atomic<int64_t> m_Bottom = { 0 };
+		alignas(64) std::array<std::atomic<Job*>, g_DequeCapacity> m_Jobs = {};
+	};
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "CrescentPCH.h"
 #include "Window.h"
 #include "Editor.h"
+#include "JobSystem.h"
 #include "Shading/Texture.h"
 #include "Utilities/Timestep.h"
 #include "../Utilities/FlyCamera.h"
@@ -10,6 +11,8 @@
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEntity.h"
 #include "../Scene/SceneHierarchyPanel.h"
+#include "../Scene/SceneSerializer.h"
+#include "../Scene/WorldPartition.h"
 #include "../Scene/Entities/Skybox.h"
 #include "Shading/Material.h"
 #include "Rendering/GLStateCache.h"
@@ -52,7 +55,7 @@ glm::vec3 pointLightPosition = glm::vec3(1.2f, 0.0f, 0.0f);
 float lodLevel = 2.5f;
 
 //Input Callbacks
-void RenderEditor(Crescent::SceneHierarchyPanel* sceneHierarchyPanel, Crescent::RendererSettingsPanel* rendererPanel);
+void RenderEditor(Crescent::Scene* scene, Crescent::SceneHierarchyPanel* sceneHierarchyPanel, Crescent::RendererSettingsPanel* rendererPanel, Crescent::WorldPartition* worldPartition);
 void ProcessKeyboardEvents(GLFWwindow* window);
 void FramebufferResizeCallback(GLFWwindow* window, int windowWidth, int windowHeight);
 void CameraAllowEulerCallback(GLFWwindow* window, int button, int action, int mods);
@@ -77,6 +80,9 @@ int main(int argc, int argv[])
 	g_CoreSystems.m_Window.SetMouseButtonCallback(CameraAllowEulerCallback);
 	g_CoreSystems.m_Window.SetMouseScrollCallback(CameraZoomCallback);
 
+	//Starts our worker threads. The main thread (and with it, our OpenGL context) becomes worker 0.
+	Crescent::JobSystem::Initialize();
+
 	//Initializes OpenGL.
 	g_CoreSystems.m_Renderer = new Crescent::Renderer();
 	g_CoreSystems.m_Renderer->InitializeRenderer(1280.0f, 720.0f, &g_CoreSystems.m_Camera);
@@ -89,6 +95,8 @@ int main(int argc, int argv[])
 	Crescent::Scene* demoScene = new Crescent::Scene();
 	Crescent::SceneHierarchyPanel* sceneHierarchy = new Crescent::SceneHierarchyPanel(demoScene, &g_CoreSystems.m_Window);
 	Crescent::RendererSettingsPanel* rendererSettingsPanel = new Crescent::RendererSettingsPanel(g_CoreSystems.m_Renderer);
+	g_CoreSystems.m_Renderer->SetSpatialTree(&demoScene->RetrieveSpatialTree());
+	Crescent::WorldPartition* worldPartition = new Crescent::WorldPartition(demoScene, g_CoreSystems.m_Renderer);
 
 	//===========================================
 	/// Create Default Material Here
@@ -97,11 +105,10 @@ int main(int argc, int argv[])
 	Crescent::Cube* cube = new Crescent::Cube();
 	//Crescent::Sphere* sphere = new Crescent::Sphere(16, 16);
 
-	Crescent::SceneEntity* sceneCube = demoScene->ConstructNewEntity(cube, defaultMaterial);
 	//Crescent::SceneEntity* sceneCube2 = demoScene->ConstructNewEntity(cube, defaultMaterial);
 	//Crescent::SceneEntity* sceneSphere = demoScene->ConstructNewEntity(sphere, defaultMaterial);
 
-	Crescent::SceneEntity* sponza = Crescent::Resources::LoadMesh(g_CoreSystems.m_Renderer, demoScene, "Sponza", "Resources/Models/Sponza/sponza.obj");
+	Crescent::SceneEntity* sponza = Crescent::Resources::LoadMesh(g_CoreSystems.m_Renderer, demoScene, "Sponza", "Resources/Models/Sponza/sponza.obj", true);
 	Crescent::SceneEntity* backpack = Crescent::Resources::LoadMesh(g_CoreSystems.m_Renderer, demoScene, "Backpack", "Resources/Models/Stormtrooper/source/silly_dancing.fbx");
 	Crescent::SceneEntity* pokeball = Crescent::Resources::LoadMesh(g_CoreSystems.m_Renderer, demoScene, "Pokeball", "Resources/Models/Eyeball/Wyvern.fbx");
 
@@ -120,7 +127,6 @@ int main(int argc, int argv[])
 	//sceneCube2->SetEntityScale(glm::vec3(4.50f, 0.30f, 5.60f));
 	//sceneSphere->SetEntityPosition(glm::vec3(0.0f, 2.4f, 0.0f));
 
-	/// To Do: Convert directional light into a screen entity so it may be used in the scene hierarchy.
 	Crescent::DirectionalLight directionalLight;
 	directionalLight.m_LightColor = glm::vec3(1.0f, 0.89f, 0.7f);
 
@@ -130,8 +136,8 @@ int main(int argc, int argv[])
 	pointLight.m_LightIntensity = 50.0f;
 	pointLight.m_RenderMesh = true;
 
-	g_CoreSystems.m_Renderer->AddLightSource(&pointLight);
-	g_CoreSystems.m_Renderer->AddLightSource(&directionalLight);
+	Crescent::SceneEntity* pointLightEntity = demoScene->ConstructNewEntity(&pointLight);
+	demoScene->ConstructNewEntity(&directionalLight);
 	//===========================================
 
 	while (!g_CoreSystems.m_Window.RetrieveWindowCloseStatus())
@@ -156,6 +162,9 @@ int main(int argc, int argv[])
 		g_CoreSystems.m_Window.PollEvents();
 		ProcessKeyboardEvents(g_CoreSystems.m_Window.RetrieveWindow());
 
+		//Anything worker threads have handed back to us, such as GL uploads.
+		Crescent::JobSystem::ExecuteMainThreadJobs();
+
 		g_CoreSystems.m_Camera.Update(g_CoreSystems.m_Timestep.GetDeltaTimeInSeconds());
 
 		//Randomize
@@ -163,33 +172,34 @@ int main(int argc, int argv[])
 		pointLight.m_LightIntensity = 25.0f + 5.0 * std::cos(std::sin(glfwGetTime() * 0.67 + 0 * 2.31) * 2.31 * 0);
 
 		//Rendering
-		pointLight.m_LightPosition = pointLightPosition;
+		pointLightEntity->SetEntityPosition(pointLightPosition);
 		directionalLight.m_LightDirection = lightDirection;
 		directionalLight.m_LightIntensity = lightDirectionIntensity;
 		sceneSkybox->m_Material->SetShaderFloat("lodLevel", lodLevel);
 
-		//g_CoreSystems.m_Renderer->PushToRenderQueue(sceneCube);
-		//g_CoreSystems.m_Renderer->PushToRenderQueue(sceneCube2);
-		//g_CoreSystems.m_Renderer->PushToRenderQueue(sceneSphere);
-		g_CoreSystems.m_Renderer->PushToRenderQueue(sceneSkybox);
-		g_CoreSystems.m_Renderer->PushToRenderQueue(sponza);
-		g_CoreSystems.m_Renderer->PushToRenderQueue(backpack);
-		g_CoreSystems.m_Renderer->PushToRenderQueue(pokeball);
+		worldPartition->UpdateStreaming(g_CoreSystems.m_Camera.m_CameraPosition);
+		demoScene->UpdateScene(g_CoreSystems.m_Timestep.GetDeltaTimeInSeconds());
+
+		//Our skybox is drawn around the camera regardless of its transform, so it is never culled.
+		g_CoreSystems.m_Renderer->PushToRenderQueue(sceneSkybox->m_Mesh, sceneSkybox->m_Material, sceneSkybox->RetrieveEntityTransform(), false);
+		g_CoreSystems.m_Renderer->PushMeshRenderers();
 
 		g_CoreSystems.m_Renderer->RenderAllQueueItems();
 
 		//We reset the framebuffer back to normal here for our Editor.
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		RenderEditor(sceneHierarchy, rendererSettingsPanel);
+		RenderEditor(demoScene, sceneHierarchy, rendererSettingsPanel, worldPartition);
 
 		g_CoreSystems.m_Window.SwapBuffers();
 	}
 
+	delete worldPartition; //Waits on its jobs, so goes before our workers.
+	Crescent::JobSystem::Shutdown();
 	g_CoreSystems.m_Window.TerminateWindow();
 	return 0;
 }
 
-void RenderEditor(Crescent::SceneHierarchyPanel* sceneHierarchyPanel, Crescent::RendererSettingsPanel* rendererPanel)
+void RenderEditor(Crescent::Scene* scene, Crescent::SceneHierarchyPanel* sceneHierarchyPanel, Crescent::RendererSettingsPanel* rendererPanel, Crescent::WorldPartition* worldPartition)
 {
 	g_CoreSystems.m_Editor.BeginEditorRenderLoop();
 	g_CoreSystems.m_Editor.RenderDockingContext(); //This contains a Begin().
@@ -199,6 +209,26 @@ void RenderEditor(Crescent::SceneHierarchyPanel* sceneHierarchyPanel, Crescent::
 	ImGui::DragFloat3("Light Direction", glm::value_ptr(lightDirection), 0.10f);
 	ImGui::DragFloat("Light Intensity", &lightDirectionIntensity);
 	ImGui::DragFloat("Sample Level", &lodLevel, 0.1f);
+	if (ImGui::Button("Save Scene"))
+	{
+		Crescent::SceneSerializer::SaveScene(scene, "Resources/Demo.cscene");
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Load Scene"))
+	{
+		Crescent::SceneSerializer::LoadScene(scene, g_CoreSystems.m_Renderer, "Resources/Demo.cscene");
+	}
+	if (ImGui::Button("Build World"))
+	{
+		Crescent::WorldPartition::BuildPartition(scene, "Resources/Demo.cworld", 32.0f);
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Stream World"))
+	{
+		worldPartition->OpenPartition("Resources/Demo.cworld");
+	}
+	ImGui::Text("World Cells: %u Resident, %u Loading of %u (%.1f / %.1f MB)", worldPartition->RetrieveResidentCellCount(), worldPartition->RetrieveLoadingCellCount(), worldPartition->RetrieveCellCount(),
+		worldPartition->RetrieveResidentMemory() / (1024.0f * 1024.0f), worldPartition->RetrieveMemoryBudget() / (1024.0f * 1024.0f));
 	ImGui::End();
 
 	sceneHierarchyPanel->RenderSceneEditorUI();
@@ -217,9 +247,8 @@ void RenderEditor(Crescent::SceneHierarchyPanel* sceneHierarchyPanel, Crescent::
 		}
 	}
 
-	ImGui::Text("Shadow Map #1");
-	unsigned int shadowDepthAttachment = g_CoreSystems.m_Renderer->RetrieveShadowRenderTarget(0)->RetrieveDepthAndStencilAttachment()->RetrieveTextureID();
-	ImGui::Image((void*)shadowDepthAttachment, { 350.0f, 350.0f }, ImVec2{ 0, 1 }, ImVec2{ 1, 0 });
+	ImGui::Text("Shadow Atlas");
+	ImGui::Image((void*)g_CoreSystems.m_Renderer->RetrieveShadowAtlas()->RetrieveAtlasTextureID(), { 350.0f, 350.0f }, ImVec2{ 0, 1 }, ImVec2{ 1, 0 });
 
 	ImGui::Text("Custom Render Target Color Buffer");
 	ImGui::Image((void*)g_CoreSystems.m_Renderer->RetrieveCustomRenderTarget()->RetrieveColorAttachment(0)->RetrieveTextureID(), { 350.0f, 350.0f }, ImVec2{ 0, 1 }, ImVec2{ 1, 0 });
@@ -234,6 +263,22 @@ void RenderEditor(Crescent::SceneHierarchyPanel* sceneHierarchyPanel, Crescent::
 
 	unsigned int colorAttachment = g_CoreSystems.m_Renderer->RetrieveMainRenderTarget()->RetrieveColorAttachment(0)->RetrieveTextureID();
 	ImGui::Image((void*)colorAttachment, { (float)g_CoreSystems.m_Editor.RetrieveViewportWidth(), (float)g_CoreSystems.m_Editor.RetrieveViewportHeight() }, ImVec2{ 0, 1 }, ImVec2{ 1, 0 });
+	if (ImGui::IsItemClicked())
+	{
+		//Unprojects the clicked point on the near and far planes into a world space ray, then selects the closest entity along it.
+		const ImVec2 imageMinimum = ImGui::GetItemRectMin();
+		const ImVec2 imageSize = ImGui::GetItemRectSize();
+		const ImVec2 mousePosition = ImGui::GetMousePos();
+		const glm::vec2 mouseNDC = glm::vec2((mousePosition.x - imageMinimum.x) / imageSize.x, 1.0f - (mousePosition.y - imageMinimum.y) / imageSize.y) * 2.0f - 1.0f;
+
+		const glm::mat4 inverseViewProjection = glm::inverse(g_CoreSystems.m_Camera.m_ProjectionMatrix * g_CoreSystems.m_Camera.m_ViewMatrix);
+		glm::vec4 nearPoint = inverseViewProjection * glm::vec4(mouseNDC, -1.0f, 1.0f);
+		glm::vec4 farPoint = inverseViewProjection * glm::vec4(mouseNDC, 1.0f, 1.0f);
+		nearPoint /= nearPoint.w;
+		farPoint /= farPoint.w;
+
+		sceneHierarchyPanel->SetSelectedEntity(scene->PickEntity(glm::vec3(nearPoint), glm::normalize(glm::vec3(farPoint - nearPoint))));
+	}
 
 	ImGui::End();
 	ImGui::PopStyleVar(); //Pops the pushed style so other windows beyond this won't have the style's properties.
@@ -3,11 +3,11 @@
 
 namespace Crescent
 {
-	class RenderTarget;
+	class ShadowCascades;
 
 	/*
-		Light container object for any 3D directional light source. Directional light types support shadow casting, holding a reference to the RenderTarget and the
-		relevant Light Space View Projection Matrix used for its shadow map generation.
+		Light container object for any 3D directional light source. Directional light types support shadow casting, holding a reference to the cascaded shadow
+		map the renderer fitted to its camera for them this frame.
 	*/
 
 	class DirectionalLight
@@ -18,7 +18,6 @@ namespace Crescent
 		float m_LightIntensity = 1.0f;
 
 		bool m_ShadowCastingEnabled = true;
-		RenderTarget* m_ShadowMapRenderTarget = nullptr;
-		glm::mat4 m_LightSpaceViewProjectionMatrix = glm::mat4(1.0f);
+		ShadowCascades* m_ShadowCascades = nullptr; //Null while the light casts no shadows.
 	};
 }
\ No newline at end of file
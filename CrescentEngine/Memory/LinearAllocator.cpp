@@ -0,0 +1,87 @@
+#include "CrescentPCH.h"
+#include "LinearAllocator.h"
+
+namespace Crescent
+{
+	LinearAllocator::LinearAllocator(size_t initialCapacity)
+	{
+		m_MemoryBlocks.reserve(8);
+		AllocateBlock(initialCapacity);
+		m_HeapAllocationCount = 0;
+	}
+
+	LinearAllocator::~LinearAllocator()
+	{
+		for (MemoryBlock& memoryBlock : m_MemoryBlocks)
+		{
+			delete[] memoryBlock.m_Memory;
+		}
+		m_MemoryBlocks.clear();
+	}
+
+	void* LinearAllocator::Allocate(size_t size, size_t alignment)
+	{
+		MemoryBlock* memoryBlock = &m_MemoryBlocks.back();
+		size_t alignedOffset = (m_CurrentOffset + alignment - 1) & ~(alignment - 1);
+
+		//Out of space in our current block. Chain on a new one, at least twice as large, and continue from there.
+		if (alignedOffset + size > memoryBlock->m_Capacity)
+		{
+			size_t blockCapacity = memoryBlock->m_Capacity * 2;
+			while (blockCapacity < size + alignment)
+			{
+				blockCapacity *= 2;
+			}
+
+			AllocateBlock(blockCapacity);
+			memoryBlock = &m_MemoryBlocks.back();
+			alignedOffset = (reinterpret_cast<uintptr_t>(memoryBlock->m_Memory) + alignment - 1) & ~(alignment - 1);
+			alignedOffset -= reinterpret_cast<uintptr_t>(memoryBlock->m_Memory);
+		}
+
+		m_UsedMemory += (alignedOffset - m_CurrentOffset) + size;
+		m_CurrentOffset = alignedOffset + size;
+		return memoryBlock->m_Memory + alignedOffset;
+	}
+
+	void LinearAllocator::Reset()
+	{
+		//If last frame needed more than one block, replace them all with a single block that fits everything.
+		if (m_MemoryBlocks.size() > 1)
+		{
+			size_t totalCapacity = RetrieveCapacity();
+			for (MemoryBlock& memoryBlock : m_MemoryBlocks)
+			{
+				delete[] memoryBlock.m_Memory;
+			}
+			m_MemoryBlocks.clear();
+			AllocateBlock(totalCapacity);
+		}
+
+		//Counted from here, so the coalesced block above belongs to last frame's allocations rather than the next one's.
+		m_HeapAllocationCount = 0;
+		m_CurrentOffset = 0;
+		m_UsedMemory = 0;
+	}
+
+	size_t LinearAllocator::RetrieveCapacity() const
+	{
+		size_t totalCapacity = 0;
+		for (const MemoryBlock& memoryBlock : m_MemoryBlocks)
+		{
+			totalCapacity += memoryBlock.m_Capacity;
+		}
+		return totalCapacity;
+	}
+
+	void LinearAllocator::AllocateBlock(size_t capacity)
+	{
+		MemoryBlock memoryBlock;
+		memoryBlock.m_Memory = new uint8_t[capacity];
+		memoryBlock.m_Capacity = capacity;
+		m_MemoryBlocks.push_back(memoryBlock);
+
+		m_CurrentOffset = 0;
+		m_HeapAllocationCount++;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace Crescent
+{
+	/*
+		Bump allocator for memory that lives for a single frame. Allocations simply advance an offset and are released together in Reset().
+		Should a frame outgrow the current block, a new block is chained on. On the next Reset(), chained blocks are coalesced into a single block large enough
+		for the whole frame, so once the working set has been seen, the allocator stops touching the heap entirely.
+	*/
+
+	class LinearAllocator
+	{
+	public:
+		LinearAllocator(size_t initialCapacity);
+		~LinearAllocator();
+
+		LinearAllocator(const LinearAllocator&) = delete;
+		LinearAllocator& operator=(const LinearAllocator&) = delete;
+
+		void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+		//Memory is uninitialized. Callers construct their objects in place.
+		template<typename T>
+		T* AllocateArray(size_t count)
+		{
+			return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+		}
+
+		//Releases every allocation made since the last reset.
+		void Reset();
+
+		//Number of heap allocations made since the last reset. Expected to be 0 in steady state.
+		unsigned int RetrieveHeapAllocationCount() const { return m_HeapAllocationCount; }
+		size_t RetrieveUsedMemory() const { return m_UsedMemory; }
+		size_t RetrieveCapacity() const;
+
+	private:
+		void AllocateBlock(size_t capacity);
+
+	private:
+		struct MemoryBlock
+		{
+			uint8_t* m_Memory = nullptr;
+			size_t m_Capacity = 0;
+		};
+
+		std::vector<MemoryBlock> m_MemoryBlocks;
+		size_t m_CurrentOffset = 0;
+		size_t m_UsedMemory = 0;
+		unsigned int m_HeapAllocationCount = 0;
+	};
+}
\ No newline at end of file
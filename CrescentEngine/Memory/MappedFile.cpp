@@ -0,0 +1,68 @@
+#include "CrescentPCH.h"
+#include "MappedFile.h"
+
+namespace Crescent
+{
+	MappedFile::~MappedFile()
+	{
+		CloseFile();
+	}
+
+	bool MappedFile::OpenFile(const std::string& filePath)
+	{
+		CloseFile();
+
+		HANDLE fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (fileHandle == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		m_FileHandle = fileHandle;
+
+		//Empty files can't be mapped.
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+		{
+			CloseFile();
+			return false;
+		}
+
+		m_MappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!m_MappingHandle)
+		{
+			CloseFile();
+			return false;
+		}
+
+		m_Data = static_cast<const uint8_t*>(MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0));
+		if (!m_Data)
+		{
+			CloseFile();
+			return false;
+		}
+
+		m_Size = (size_t)fileSize.QuadPart;
+		return true;
+	}
+
+	void MappedFile::CloseFile()
+	{
+		if (m_Data)
+		{
+			UnmapViewOfFile(m_Data);
+		}
+		if (m_MappingHandle)
+		{
+			CloseHandle(m_MappingHandle);
+		}
+		if (m_FileHandle)
+		{
+			CloseHandle(m_FileHandle);
+		}
+
+		m_Data = nullptr;
+		m_MappingHandle = nullptr;
+		m_FileHandle = nullptr;
+		m_Size = 0;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace Crescent
+{
+	/*
+		Read-only view of a whole file mapped into our address space. Pages are only read from disk as they are first touched, so opening even a large file
+		is near instant, and data is used in place rather than copied into our own buffers.
+	*/
+
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		//Returns false if the file doesn't exist, is empty or can't be mapped.
+		bool OpenFile(const std::string& filePath);
+		void CloseFile();
+
+		const uint8_t* RetrieveData() const { return m_Data; }
+		size_t RetrieveSize() const { return m_Size; }
+
+	private:
+		void* m_FileHandle = nullptr;
+		void* m_MappingHandle = nullptr;
+		const uint8_t* m_Data = nullptr;
+		size_t m_Size = 0;
+	};
+}
\ No newline at end of file
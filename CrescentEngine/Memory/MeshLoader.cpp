@@ -1,6 +1,8 @@
 #include "CrescentPCH.h"
 #include "MeshLoader.h"
 #include "../Scene/SceneEntity.h"
+#include "../Scene/EntityPool.h"
+#include "../Scene/Components.h"
 #include "../Models/Mesh.h"
 #include "../Rendering/Resources.h"
 #include "../Shading/Material.h"
@@ -8,6 +10,7 @@
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include "../Rendering/Renderer.h"
+#include <algorithm>
 
 namespace Crescent
 {
@@ -21,58 +24,79 @@ namespace Crescent
         }
     }
     // --------------------------------------------------------------------------------------------
-    SceneEntity* MeshLoader::LoadMesh(Renderer* rendererContext, const std::string& filePath, bool setDefaultMaterial)
+    void MeshLoader::ReleaseMesh(Mesh* mesh)
+    {
+        MeshLoader::m_MeshStore.erase(std::remove(MeshLoader::m_MeshStore.begin(), MeshLoader::m_MeshStore.end(), mesh), MeshLoader::m_MeshStore.end());
+        mesh->ReleaseGeometry();
+        delete mesh;
+    }
+    // --------------------------------------------------------------------------------------------
+    SceneEntity* MeshLoader::LoadMesh(Renderer* rendererContext, const std::string& filePath, bool setDefaultMaterial, bool poolGeometry)
     {
         CrescentLoad("Loading mesh: " + filePath + ".");
         Assimp::Importer importer;
-        const aiScene* scene = importer.ReadFile(filePath, aiProcess_Triangulate | aiProcess_CalcTangentSpace);
+        const aiScene* scene = MeshLoader::ImportMesh(importer, filePath);
+        if (!scene)
+        {
+            CrescentError("Assimp failed to load model at path: " + filePath);
+            return nullptr;
+        }
 
+        return MeshLoader::LoadMesh(rendererContext, scene, filePath, setDefaultMaterial, poolGeometry);
+    }
+
+    const aiScene* MeshLoader::ImportMesh(Assimp::Importer& importer, const std::string& filePath)
+    {
+        //No logging here, as we may be on a worker thread.
+        const aiScene* scene = importer.ReadFile(filePath, aiProcess_Triangulate | aiProcess_CalcTangentSpace);
         if (!scene || scene->mFlags == AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
         {
-            CrescentError("Assimp failed to load model at path: " + filePath);
             return nullptr;
         }
+        return scene;
+    }
 
+    SceneEntity* MeshLoader::LoadMesh(Renderer* rendererContext, const aiScene* scene, const std::string& filePath, bool setDefaultMaterial, bool poolGeometry)
+    {
         std::string directory = filePath.substr(0, filePath.find_last_of("/"));
 
         CrescentLoad("Succesfully loaded: " + filePath + ".");
 
-        return MeshLoader::ProcessNode(rendererContext, scene->mRootNode, scene, directory, setDefaultMaterial);
+        //Skinned meshes are kept in their own buffers.
+        GeometryPool* geometryPool = (poolGeometry && !scene->HasAnimations()) ? rendererContext->RetrieveGeometryPool() : nullptr;
+
+        return MeshLoader::ProcessNode(rendererContext, scene->mRootNode, scene, directory, setDefaultMaterial, geometryPool);
     }
 
-    SceneEntity* MeshLoader::ProcessNode(Renderer* rendererContext, aiNode* aiNode, const aiScene* aiScene, const std::string& fileDirectory, bool setDefaultMaterial)
+    SceneEntity* MeshLoader::ProcessNode(Renderer* rendererContext, aiNode* aiNode, const aiScene* aiScene, const std::string& fileDirectory, bool setDefaultMaterial, GeometryPool* geometryPool)
     {
         //Note that we allocate memory ourselves and pass memory responsibility to calling resource manager. 
         //The resource manager is responsible for holding the scene entity pointer and deleting where appropriate.
-        SceneEntity* node = new SceneEntity(aiNode->mName.C_Str(), 0);
+        SceneEntity* node = EntityPool::ConstructEntity(aiNode->mName.C_Str());
 
         for (unsigned int i = 0; i < aiNode->mNumMeshes; ++i)
         {
             aiMesh* assimpMesh = aiScene->mMeshes[aiNode->mMeshes[i]];
             aiMaterial* assimpMat = aiScene->mMaterials[assimpMesh->mMaterialIndex];
-            Mesh* mesh = MeshLoader::ParseMesh(assimpMesh, aiScene);
+            Mesh* mesh = MeshLoader::ParseMesh(assimpMesh, aiScene, geometryPool);
             Material* material = nullptr;
             if (setDefaultMaterial)
             {
                 material = MeshLoader::ParseMaterial(rendererContext, assimpMat, aiScene, fileDirectory);
             }
 
+            //Loaded hierarchies are flattened into prefabs by the resource manager and then destroyed, so their own renderers are disabled and never draw.
             //If we only have one mesh, this entity itself contains the mesh/material.
             if (aiNode->mNumMeshes == 1)
             {
-                node->m_Mesh = mesh;
-                if (setDefaultMaterial)
-                {
-                    node->m_Material = material;
-                }
+                ComponentStorage::AttachMeshRenderer(node, mesh, material).m_Enabled = false;
             }
 
             //Otherwise, the meshes are considered on equal depth of its children
             else
             {
-                SceneEntity* child = new SceneEntity(aiScene->mMeshes[i]->mName.C_Str(), 0);
-                child->m_Mesh = mesh;
-                child->m_Material = material;
+                SceneEntity* child = EntityPool::ConstructEntity(aiScene->mMeshes[i]->mName.C_Str());
+                ComponentStorage::AttachMeshRenderer(child, mesh, material).m_Enabled = false;
                 node->AddChildEntity(child);
             }
         }
@@ -80,13 +104,13 @@ namespace Crescent
         //Also recursively parse this node's children 
         for (unsigned int i = 0; i < aiNode->mNumChildren; ++i)
         {
-            node->AddChildEntity(MeshLoader::ProcessNode(rendererContext, aiNode->mChildren[i], aiScene, fileDirectory, setDefaultMaterial));
+            node->AddChildEntity(MeshLoader::ProcessNode(rendererContext, aiNode->mChildren[i], aiScene, fileDirectory, setDefaultMaterial, geometryPool));
         }
 
         return node;
     }
     
-    Mesh* MeshLoader::ParseMesh(aiMesh* aiMesh, const aiScene* aiScene)
+    Mesh* MeshLoader::ParseMesh(aiMesh* aiMesh, const aiScene* aiScene, GeometryPool* geometryPool)
     {
         std::vector<glm::vec3> positions;
         std::vector<glm::vec2> uv;
@@ -138,7 +162,14 @@ namespace Crescent
         mesh->m_Bitangents = bitangents;
         mesh->m_Indices = indices;
         mesh->m_Topology = Triangles;
-        mesh->FinalizeMesh(true);
+        if (geometryPool)
+        {
+            mesh->FinalizePooledMesh(geometryPool);
+        }
+        else
+        {
+            mesh->FinalizeMesh(true);
+        }
 
         if (aiScene->HasAnimations())
         {
@@ -8,12 +8,18 @@ struct aiMesh;
 struct aiMaterial;
 struct aiString;
 
+namespace Assimp
+{
+	class Importer;
+}
+
 namespace Crescent
 {
 	class Renderer;
 	class SceneEntity;
 	class Mesh;
 	class Material;
+	class GeometryPool;
 
 	/*
 		Mesh load functionality.
@@ -22,13 +28,21 @@ namespace Crescent
 	class MeshLoader
 	{
 	public:
-		static SceneEntity* LoadMesh(Renderer* rendererContext, const std::string& filePath, bool setDefaultMaterial = true);
+		//Pooled geometry is uploaded into the renderer's geometry pool. Ignored for animated models.
+		static SceneEntity* LoadMesh(Renderer* rendererContext, const std::string& filePath, bool setDefaultMaterial = true, bool poolGeometry = false);
 		static void ClearMeshStore();
 
+		//The two halves of the above. Importing only parses the file into the importer's scene, so it is safe to call from any thread with an importer of its own.
+		//Loading creates our meshes, materials and GPU resources from an imported scene, and must happen on the main thread. Returns nullptr if the import failed.
+		static const aiScene* ImportMesh(Assimp::Importer& importer, const std::string& filePath);
+		static SceneEntity* LoadMesh(Renderer* rendererContext, const aiScene* importedScene, const std::string& filePath, bool setDefaultMaterial = true, bool poolGeometry = false);
+		//Frees a mesh we loaded, along with its GPU resources. Anything drawing it must be gone.
+		static void ReleaseMesh(Mesh* mesh);
+
 	private:
-		static SceneEntity* ProcessNode(Renderer* rendererContext, aiNode* aiNode, const aiScene* aiScene, const std::string& fileDirectory, bool setDefaultMaterial = true);
+		static SceneEntity* ProcessNode(Renderer* rendererContext, aiNode* aiNode, const aiScene* aiScene, const std::string& fileDirectory, bool setDefaultMaterial = true, GeometryPool* geometryPool = nullptr);
 		static void ProcessMeshAnimations(const aiScene* aiScene, aiMesh* aiMesh, Mesh* mesh);
-		static Mesh* ParseMesh(aiMesh* aiMesh, const aiScene* aiScene);
+		static Mesh* ParseMesh(aiMesh* aiMesh, const aiScene* aiScene, GeometryPool* geometryPool = nullptr);
 		static Material* ParseMaterial(Renderer* rendererContext, aiMaterial* aiMaterial, const aiScene* aiScene, const std::string& fileDirectory);
 		static std::string ProcessPath(aiString* filePath, std::string fileDirectory);
 
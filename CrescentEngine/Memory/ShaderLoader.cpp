@@ -33,6 +33,27 @@ namespace Crescent
 		return shader;
 	}
 
+	Shader ShaderLoader::LoadComputeShader(const std::string& shaderName, std::string computeShaderPath)
+	{
+		std::ifstream computeShaderFile;
+		computeShaderFile.open(computeShaderPath);
+
+		if (!computeShaderFile.is_open())
+		{
+			CrescentError("Compute shader failed to load at path: " + computeShaderPath);
+			return Shader();
+		}
+
+		std::string computeSource = ReadShader(computeShaderFile, shaderName, computeShaderPath);
+
+		Shader shader;
+		shader.LoadComputeShader(shaderName, computeSource);
+
+		computeShaderFile.close();
+
+		return shader;
+	}
+
 	std::string ShaderLoader::ReadShader(std::ifstream& file, const std::string& shaderName, std::string& filePath)
 	{
 		std::string directory = filePath.substr(0, filePath.find_last_of("/\\"));
@@ -14,6 +14,7 @@ namespace Crescent
 	{
 	public:
 		static Shader LoadShader(const std::string& shaderName, std::string vertexShaderPath, std::string fragmentShaderPath);
+		static Shader LoadComputeShader(const std::string& shaderName, std::string computeShaderPath);
 
 	private:
 		static std::string ReadShader(std::ifstream& file, const std::string& shaderName, std::string& filePath);
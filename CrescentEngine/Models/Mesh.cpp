@@ -1,11 +1,14 @@
 #include "CrescentPCH.h"
 #include "Mesh.h"
+#include "../Rendering/GeometryPool.h"
 #include "GL/glew.h"
 #include <glm/gtc/type_ptr.hpp>
 #include <algorithm>
 
 namespace Crescent
 {
+	unsigned int Mesh::m_MeshCounterID = 0;
+
 	Mesh::Mesh()
 	{
 
@@ -42,8 +45,69 @@ namespace Crescent
 		m_Indices = indices;
 	}
 
+	void Mesh::CalculateBoundingBox()
+	{
+		if (m_Positions.empty())
+		{
+			m_BoundingBoxMinimum = glm::vec3(0.0f);
+			m_BoundingBoxMaximum = glm::vec3(0.0f);
+			return;
+		}
+
+		m_BoundingBoxMinimum = m_Positions[0];
+		m_BoundingBoxMaximum = m_Positions[0];
+		for (const glm::vec3& position : m_Positions)
+		{
+			m_BoundingBoxMinimum = glm::min(m_BoundingBoxMinimum, position);
+			m_BoundingBoxMaximum = glm::max(m_BoundingBoxMaximum, position);
+		}
+	}
+
+	void Mesh::ReleaseGeometry()
+	{
+		if (!m_GeometryPooled && m_VertexArrayID)
+		{
+			glDeleteVertexArrays(1, &m_VertexArrayID);
+			glDeleteBuffers(1, &m_VertexBufferID);
+			glDeleteBuffers(1, &m_IndexBufferID);
+		}
+		m_VertexArrayID = 0;
+		m_VertexBufferID = 0;
+		m_IndexBufferID = 0;
+		m_GeometryPooled = false;
+
+		//Swapped out rather than cleared, so their memory is actually returned.
+		std::vector<glm::vec3>().swap(m_Positions);
+		std::vector<glm::vec2>().swap(m_UV);
+		std::vector<glm::vec3>().swap(m_Normals);
+		std::vector<glm::vec3>().swap(m_Tangents);
+		std::vector<glm::vec3>().swap(m_Bitangents);
+		std::vector<unsigned int>().swap(m_Indices);
+	}
+
+	void Mesh::FinalizePooledMesh(GeometryPool* geometryPool)
+	{
+		//Pool pages are drawn with indexed triangles only.
+		if (!geometryPool || m_Indices.empty() || m_Topology != Triangles || m_VertexArrayID)
+		{
+			FinalizeMesh(true);
+			return;
+		}
+
+		CalculateBoundingBox();
+
+		GeometryAllocation geometryAllocation = geometryPool->AllocateMesh(this);
+		m_VertexArrayID = geometryAllocation.m_VertexArrayID;
+		m_GeometryPageIndex = geometryAllocation.m_GeometryPageIndex;
+		m_PooledFirstIndex = geometryAllocation.m_FirstIndex;
+		m_PooledBaseVertex = geometryAllocation.m_BaseVertex;
+		m_GeometryPooled = true;
+	}
+
 	void Mesh::FinalizeMesh(bool interleaved)
 	{
+		CalculateBoundingBox();
+
 		//Initialize IDs if not configured before.
 		if (!m_VertexArrayID)
 		{
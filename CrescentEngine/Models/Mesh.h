@@ -11,6 +11,8 @@
 
 namespace Crescent
 {
+	class GeometryPool;
+
 	struct Vertex  //Defined for each vertice on a mesh.
 	{
 		glm::vec3 Position;
@@ -72,9 +74,19 @@ namespace Crescent
 		Mesh(std::vector<glm::vec3> positions, std::vector<glm::vec2> uv, std::vector<glm::vec3> normals, std::vector<glm::vec3> tangents, std::vector<glm::vec3> bitangents, std::vector<unsigned int> indices);
 
 		void FinalizeMesh(bool interleaved = true); //Preprocess buffer data as interleaved or seperate when specified. 
+		void FinalizePooledMesh(GeometryPool* geometryPool); //Uploads into the renderer's shared geometry pool instead of our own buffers. Falls back to FinalizeMesh() for non-indexed meshes.
+		void CalculateBoundingBox(); //Local space AABB of our positions. Called by FinalizeMesh, so only needed if positions change afterwards.
+		void ReleaseGeometry(); //Frees our buffers and CPU side geometry. Pooled geometry stays behind in its page, as pool allocations are never freed.
 
 		//Retrieves
 		unsigned int RetrieveVertexArrayID() const { return m_VertexArrayID; }
+		unsigned int RetrieveMeshID() const { return m_MeshID; }
+
+		//Geometry Pool
+		bool IsGeometryPooled() const { return m_GeometryPooled; }
+		unsigned int RetrieveGeometryPageIndex() const { return m_GeometryPageIndex; }
+		uint32_t RetrievePooledFirstIndex() const { return m_PooledFirstIndex; }
+		int32_t RetrievePooledBaseVertex() const { return m_PooledBaseVertex; }
 
 		//Skeletal Animations
 		void RecursivelyUpdateBoneMatrices(int animation_id, aiNode* node, glm::mat4 transform, double ticks);
@@ -117,6 +129,10 @@ namespace Crescent
 
 		std::vector<unsigned int> m_Indices;
 
+		//Local space axis-aligned bounding box, used for culling.
+		glm::vec3 m_BoundingBoxMinimum = glm::vec3(0.0f);
+		glm::vec3 m_BoundingBoxMaximum = glm::vec3(0.0f);
+
 		//Skeletal Animations
 		std::vector<glm::mat4> m_BoneMatrices, m_BoneOffsets;
 		int m_CurrentlyPlayingAnimationIndex;
@@ -125,10 +141,19 @@ namespace Crescent
 		BoneMapper m_BoneMapper;
 
 	private:
+		static unsigned int m_MeshCounterID;
+		unsigned int m_MeshID = m_MeshCounterID++; //Stable across the mesh's lifetime, unlike its vertex array which may be shared with other pooled meshes.
+
 		unsigned int m_VertexArrayID = 0;
 		unsigned int m_VertexBufferID = 0;
 		unsigned int m_IndexBufferID = 0;
 
+		//When pooled, the vertex array above belongs to the geometry pool page and we own no buffers.
+		bool m_GeometryPooled = false;
+		unsigned int m_GeometryPageIndex = 0;
+		uint32_t m_PooledFirstIndex = 0;
+		int32_t m_PooledBaseVertex = 0;
+
 	public:
 		//Defunct
 		Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<MeshTexture> textures);
@@ -0,0 +1,198 @@
+#include "CrescentPCH.h"
+#include "Frustum.h"
+#include "RenderCommand.h"
+#include <immintrin.h>
+
+namespace Crescent
+{
+	Frustum::Frustum(const glm::mat4& viewProjectionMatrix)
+	{
+		ExtractPlanes(viewProjectionMatrix);
+	}
+
+	void Frustum::ExtractPlanes(const glm::mat4& viewProjectionMatrix)
+	{
+		//Gribb/Hartmann plane extraction. GLM matrices are column-major, so we build the rows ourselves.
+		glm::vec4 rows[4];
+		for (int i = 0; i < 4; i++)
+		{
+			rows[i] = glm::vec4(viewProjectionMatrix[0][i], viewProjectionMatrix[1][i], viewProjectionMatrix[2][i], viewProjectionMatrix[3][i]);
+		}
+
+		m_Planes[FrustumPlane_Left] = rows[3] + rows[0];
+		m_Planes[FrustumPlane_Right] = rows[3] - rows[0];
+		m_Planes[FrustumPlane_Bottom] = rows[3] + rows[1];
+		m_Planes[FrustumPlane_Top] = rows[3] - rows[1];
+		m_Planes[FrustumPlane_Near] = rows[3] + rows[2];
+		m_Planes[FrustumPlane_Far] = rows[3] - rows[2];
+
+		//Normalize so that plane distances are in world units, which our sphere tests rely on.
+		for (int i = 0; i < FrustumPlane_Count; i++)
+		{
+			float planeLength = glm::length(glm::vec3(m_Planes[i]));
+			if (planeLength > 0.0f)
+			{
+				m_Planes[i] /= planeLength;
+			}
+		}
+	}
+
+	bool Frustum::IsSphereVisible(const glm::vec3& sphereCenter, float sphereRadius) const
+	{
+		for (int i = 0; i < FrustumPlane_Count; i++)
+		{
+			if (glm::dot(glm::vec3(m_Planes[i]), sphereCenter) + m_Planes[i].w < -sphereRadius)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool Frustum::IsBoxVisible(const glm::vec3& boxCenter, const glm::vec3& boxExtents) const
+	{
+		//A box is outside a plane if even its most positive vertex (relative to the plane normal) is behind it.
+		for (int i = 0; i < FrustumPlane_Count; i++)
+		{
+			glm::vec3 planeNormal = glm::vec3(m_Planes[i]);
+			float projectedRadius = glm::dot(glm::abs(planeNormal), boxExtents);
+			if (glm::dot(planeNormal, boxCenter) + m_Planes[i].w + projectedRadius < 0.0f)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	uint32_t Frustum::CullRenderCommands(const RenderCommandList& renderCommands, RenderCommand** visibleCommands) const
+	{
+		const uint32_t commandCount = renderCommands.size();
+		uint32_t visibleCount = 0;
+		uint32_t commandIndex = 0;
+
+#if defined(__AVX2__)
+		//8 boxes at a time. Each plane is broadcast across all lanes, and boxes are transposed into SoA registers.
+		__m256 planeNormalsX[FrustumPlane_Count], planeNormalsY[FrustumPlane_Count], planeNormalsZ[FrustumPlane_Count], planeDistances[FrustumPlane_Count];
+		__m256 absoluteNormalsX[FrustumPlane_Count], absoluteNormalsY[FrustumPlane_Count], absoluteNormalsZ[FrustumPlane_Count];
+		for (int i = 0; i < FrustumPlane_Count; i++)
+		{
+			planeNormalsX[i] = _mm256_set1_ps(m_Planes[i].x);
+			planeNormalsY[i] = _mm256_set1_ps(m_Planes[i].y);
+			planeNormalsZ[i] = _mm256_set1_ps(m_Planes[i].z);
+			planeDistances[i] = _mm256_set1_ps(m_Planes[i].w);
+			absoluteNormalsX[i] = _mm256_set1_ps(std::abs(m_Planes[i].x));
+			absoluteNormalsY[i] = _mm256_set1_ps(std::abs(m_Planes[i].y));
+			absoluteNormalsZ[i] = _mm256_set1_ps(std::abs(m_Planes[i].z));
+		}
+
+		const __m256 zero = _mm256_setzero_ps();
+		for (; commandIndex + 8 <= commandCount; commandIndex += 8)
+		{
+			alignas(32) float centersX[8], centersY[8], centersZ[8], extentsX[8], extentsY[8], extentsZ[8];
+			int cullingDisabledMask = 0;
+			for (int lane = 0; lane < 8; lane++)
+			{
+				const RenderCommand& renderCommand = renderCommands[commandIndex + lane];
+				centersX[lane] = renderCommand.m_BoundingBoxCenter.x;
+				centersY[lane] = renderCommand.m_BoundingBoxCenter.y;
+				centersZ[lane] = renderCommand.m_BoundingBoxCenter.z;
+				extentsX[lane] = renderCommand.m_BoundingBoxExtents.x;
+				extentsY[lane] = renderCommand.m_BoundingBoxExtents.y;
+				extentsZ[lane] = renderCommand.m_BoundingBoxExtents.z;
+				cullingDisabledMask |= renderCommand.m_FrustumCullingEnabled ? 0 : (1 << lane);
+			}
+
+			__m256 centerX = _mm256_load_ps(centersX), centerY = _mm256_load_ps(centersY), centerZ = _mm256_load_ps(centersZ);
+			__m256 extentX = _mm256_load_ps(extentsX), extentY = _mm256_load_ps(extentsY), extentZ = _mm256_load_ps(extentsZ);
+
+			__m256 outsideMask = _mm256_setzero_ps();
+			for (int i = 0; i < FrustumPlane_Count; i++)
+			{
+				__m256 distance = _mm256_add_ps(_mm256_mul_ps(centerX, planeNormalsX[i]), planeDistances[i]);
+				distance = _mm256_add_ps(distance, _mm256_mul_ps(centerY, planeNormalsY[i]));
+				distance = _mm256_add_ps(distance, _mm256_mul_ps(centerZ, planeNormalsZ[i]));
+				distance = _mm256_add_ps(distance, _mm256_mul_ps(extentX, absoluteNormalsX[i]));
+				distance = _mm256_add_ps(distance, _mm256_mul_ps(extentY, absoluteNormalsY[i]));
+				distance = _mm256_add_ps(distance, _mm256_mul_ps(extentZ, absoluteNormalsZ[i]));
+				outsideMask = _mm256_or_ps(outsideMask, _mm256_cmp_ps(distance, zero, _CMP_LT_OQ));
+			}
+
+			int visibleMask = (~_mm256_movemask_ps(outsideMask) | cullingDisabledMask) & 0xFF;
+			for (int lane = 0; lane < 8; lane++)
+			{
+				if (visibleMask & (1 << lane))
+				{
+					visibleCommands[visibleCount++] = &renderCommands[commandIndex + lane];
+				}
+			}
+		}
+#else
+		//4 boxes at a time. Each plane is broadcast across all lanes, and boxes are transposed into SoA registers.
+		__m128 planeNormalsX[FrustumPlane_Count], planeNormalsY[FrustumPlane_Count], planeNormalsZ[FrustumPlane_Count], planeDistances[FrustumPlane_Count];
+		__m128 absoluteNormalsX[FrustumPlane_Count], absoluteNormalsY[FrustumPlane_Count], absoluteNormalsZ[FrustumPlane_Count];
+		for (int i = 0; i < FrustumPlane_Count; i++)
+		{
+			planeNormalsX[i] = _mm_set1_ps(m_Planes[i].x);
+			planeNormalsY[i] = _mm_set1_ps(m_Planes[i].y);
+			planeNormalsZ[i] = _mm_set1_ps(m_Planes[i].z);
+			planeDistances[i] = _mm_set1_ps(m_Planes[i].w);
+			absoluteNormalsX[i] = _mm_set1_ps(std::abs(m_Planes[i].x));
+			absoluteNormalsY[i] = _mm_set1_ps(std::abs(m_Planes[i].y));
+			absoluteNormalsZ[i] = _mm_set1_ps(std::abs(m_Planes[i].z));
+		}
+
+		const __m128 zero = _mm_setzero_ps();
+		for (; commandIndex + 4 <= commandCount; commandIndex += 4)
+		{
+			const RenderCommand& command0 = renderCommands[commandIndex + 0];
+			const RenderCommand& command1 = renderCommands[commandIndex + 1];
+			const RenderCommand& command2 = renderCommands[commandIndex + 2];
+			const RenderCommand& command3 = renderCommands[commandIndex + 3];
+
+			//_mm_set_ps takes its lanes from highest to lowest.
+			__m128 centerX = _mm_set_ps(command3.m_BoundingBoxCenter.x, command2.m_BoundingBoxCenter.x, command1.m_BoundingBoxCenter.x, command0.m_BoundingBoxCenter.x);
+			__m128 centerY = _mm_set_ps(command3.m_BoundingBoxCenter.y, command2.m_BoundingBoxCenter.y, command1.m_BoundingBoxCenter.y, command0.m_BoundingBoxCenter.y);
+			__m128 centerZ = _mm_set_ps(command3.m_BoundingBoxCenter.z, command2.m_BoundingBoxCenter.z, command1.m_BoundingBoxCenter.z, command0.m_BoundingBoxCenter.z);
+			__m128 extentX = _mm_set_ps(command3.m_BoundingBoxExtents.x, command2.m_BoundingBoxExtents.x, command1.m_BoundingBoxExtents.x, command0.m_BoundingBoxExtents.x);
+			__m128 extentY = _mm_set_ps(command3.m_BoundingBoxExtents.y, command2.m_BoundingBoxExtents.y, command1.m_BoundingBoxExtents.y, command0.m_BoundingBoxExtents.y);
+			__m128 extentZ = _mm_set_ps(command3.m_BoundingBoxExtents.z, command2.m_BoundingBoxExtents.z, command1.m_BoundingBoxExtents.z, command0.m_BoundingBoxExtents.z);
+
+			int cullingDisabledMask = (command0.m_FrustumCullingEnabled ? 0 : 1) | (command1.m_FrustumCullingEnabled ? 0 : 2) |
+				(command2.m_FrustumCullingEnabled ? 0 : 4) | (command3.m_FrustumCullingEnabled ? 0 : 8);
+
+			__m128 outsideMask = _mm_setzero_ps();
+			for (int i = 0; i < FrustumPlane_Count; i++)
+			{
+				__m128 distance = _mm_add_ps(_mm_mul_ps(centerX, planeNormalsX[i]), planeDistances[i]);
+				distance = _mm_add_ps(distance, _mm_mul_ps(centerY, planeNormalsY[i]));
+				distance = _mm_add_ps(distance, _mm_mul_ps(centerZ, planeNormalsZ[i]));
+				distance = _mm_add_ps(distance, _mm_mul_ps(extentX, absoluteNormalsX[i]));
+				distance = _mm_add_ps(distance, _mm_mul_ps(extentY, absoluteNormalsY[i]));
+				distance = _mm_add_ps(distance, _mm_mul_ps(extentZ, absoluteNormalsZ[i]));
+				outsideMask = _mm_or_ps(outsideMask, _mm_cmplt_ps(distance, zero));
+			}
+
+			int visibleMask = (~_mm_movemask_ps(outsideMask) | cullingDisabledMask) & 0xF;
+			for (int lane = 0; lane < 4; lane++)
+			{
+				if (visibleMask & (1 << lane))
+				{
+					visibleCommands[visibleCount++] = &renderCommands[commandIndex + lane];
+				}
+			}
+		}
+#endif
+
+		//Remaining commands that didn't fill a full batch.
+		for (; commandIndex < commandCount; commandIndex++)
+		{
+			RenderCommand& renderCommand = renderCommands[commandIndex];
+			if (!renderCommand.m_FrustumCullingEnabled || IsBoxVisible(renderCommand.m_BoundingBoxCenter, renderCommand.m_BoundingBoxExtents))
+			{
+				visibleCommands[visibleCount++] = &renderCommand;
+			}
+		}
+
+		return visibleCount;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+
+namespace Crescent
+{
+	struct RenderCommand;
+	class RenderCommandList;
+
+	/*
+		View frustum as 6 inward facing planes (ax + by + cz + d >= 0 is inside), extracted from a view projection matrix. Works with both perspective (camera) and
+		orthographic (directional light) projections. Render commands are tested in batches with SSE, or AVX2 when the build targets it.
+	*/
+
+	enum FrustumPlane
+	{
+		FrustumPlane_Left = 0,
+		FrustumPlane_Right,
+		FrustumPlane_Bottom,
+		FrustumPlane_Top,
+		FrustumPlane_Near,
+		FrustumPlane_Far,
+		FrustumPlane_Count
+	};
+
+	class Frustum
+	{
+	public:
+		Frustum() = default;
+		Frustum(const glm::mat4& viewProjectionMatrix);
+
+		void ExtractPlanes(const glm::mat4& viewProjectionMatrix);
+
+		bool IsSphereVisible(const glm::vec3& sphereCenter, float sphereRadius) const;
+		bool IsBoxVisible(const glm::vec3& boxCenter, const glm::vec3& boxExtents) const;
+
+		//Tests every command's world bounding box against the frustum and writes references to the visible ones, in order, into visibleCommands. Returns the visible count.
+		uint32_t CullRenderCommands(const RenderCommandList& renderCommands, RenderCommand** visibleCommands) const;
+
+	public:
+		glm::vec4 m_Planes[FrustumPlane_Count];
+	};
+}
\ No newline at end of file
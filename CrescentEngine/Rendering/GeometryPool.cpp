@@ -0,0 +1,137 @@
+#include "CrescentPCH.h"
+#include "GeometryPool.h"
+#include "../Models/Mesh.h"
+
+namespace Crescent
+{
+	//Position (3), UV (2), Normal (3), Tangent (3), Bitangent (3).
+	static constexpr uint32_t g_PooledVertexFloatCount = 14;
+	static constexpr uint32_t g_PooledVertexStride = g_PooledVertexFloatCount * sizeof(float);
+
+	//Default page size. About 28MB of vertices and 8MB of indices, which fits a model like Sponza in a single page.
+	static constexpr uint32_t g_DefaultPageVertexCapacity = 512 * 1024;
+	static constexpr uint32_t g_DefaultPageIndexCapacity = 2 * 1024 * 1024;
+
+	GeometryPool::GeometryPool()
+	{
+	}
+
+	GeometryPool::~GeometryPool()
+	{
+		for (GeometryPage& geometryPage : m_GeometryPages)
+		{
+			glDeleteVertexArrays(1, &geometryPage.m_VertexArrayID);
+			glDeleteBuffers(1, &geometryPage.m_VertexBufferID);
+			glDeleteBuffers(1, &geometryPage.m_IndexBufferID);
+		}
+	}
+
+	GeometryAllocation GeometryPool::AllocateMesh(const Mesh* mesh)
+	{
+		uint32_t vertexCount = (uint32_t)mesh->m_Positions.size();
+		uint32_t indexCount = (uint32_t)mesh->m_Indices.size();
+
+		//Find the first page with room for this mesh. Meshes larger than a default page get a page of their own.
+		unsigned int pageIndex = 0;
+		for (; pageIndex < m_GeometryPages.size(); pageIndex++)
+		{
+			const GeometryPage& geometryPage = m_GeometryPages[pageIndex];
+			if (geometryPage.m_VertexCount + vertexCount <= geometryPage.m_VertexCapacity && geometryPage.m_IndexCount + indexCount <= geometryPage.m_IndexCapacity)
+			{
+				break;
+			}
+		}
+
+		if (pageIndex == m_GeometryPages.size())
+		{
+			pageIndex = CreateGeometryPage(std::max(vertexCount, g_DefaultPageVertexCapacity), std::max(indexCount, g_DefaultPageIndexCapacity));
+		}
+		GeometryPage& geometryPage = m_GeometryPages[pageIndex];
+
+		//Interleave into our fixed vertex format. Missing attributes are zero filled.
+		std::vector<float> vertexData(vertexCount * g_PooledVertexFloatCount, 0.0f);
+		for (uint32_t i = 0; i < vertexCount; i++)
+		{
+			float* vertex = &vertexData[i * g_PooledVertexFloatCount];
+			vertex[0] = mesh->m_Positions[i].x;
+			vertex[1] = mesh->m_Positions[i].y;
+			vertex[2] = mesh->m_Positions[i].z;
+			if (i < mesh->m_UV.size())
+			{
+				vertex[3] = mesh->m_UV[i].x;
+				vertex[4] = mesh->m_UV[i].y;
+			}
+			if (i < mesh->m_Normals.size())
+			{
+				vertex[5] = mesh->m_Normals[i].x;
+				vertex[6] = mesh->m_Normals[i].y;
+				vertex[7] = mesh->m_Normals[i].z;
+			}
+			if (i < mesh->m_Tangents.size())
+			{
+				vertex[8] = mesh->m_Tangents[i].x;
+				vertex[9] = mesh->m_Tangents[i].y;
+				vertex[10] = mesh->m_Tangents[i].z;
+			}
+			if (i < mesh->m_Bitangents.size())
+			{
+				vertex[11] = mesh->m_Bitangents[i].x;
+				vertex[12] = mesh->m_Bitangents[i].y;
+				vertex[13] = mesh->m_Bitangents[i].z;
+			}
+		}
+
+		glBindBuffer(GL_ARRAY_BUFFER, geometryPage.m_VertexBufferID);
+		glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)geometryPage.m_VertexCount * g_PooledVertexStride, vertexData.size() * sizeof(float), vertexData.data());
+
+		//Indices stay relative to the mesh. The draw's base vertex offsets them into the page.
+		glBindBuffer(GL_COPY_WRITE_BUFFER, geometryPage.m_IndexBufferID);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)geometryPage.m_IndexCount * sizeof(unsigned int), indexCount * sizeof(unsigned int), mesh->m_Indices.data());
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		GeometryAllocation geometryAllocation;
+		geometryAllocation.m_GeometryPageIndex = pageIndex;
+		geometryAllocation.m_VertexArrayID = geometryPage.m_VertexArrayID;
+		geometryAllocation.m_FirstIndex = geometryPage.m_IndexCount;
+		geometryAllocation.m_BaseVertex = (int32_t)geometryPage.m_VertexCount;
+
+		geometryPage.m_VertexCount += vertexCount;
+		geometryPage.m_IndexCount += indexCount;
+		m_PooledMeshCount++;
+
+		return geometryAllocation;
+	}
+
+	unsigned int GeometryPool::CreateGeometryPage(uint32_t vertexCapacity, uint32_t indexCapacity)
+	{
+		GeometryPage geometryPage;
+		geometryPage.m_VertexCapacity = vertexCapacity;
+		geometryPage.m_IndexCapacity = indexCapacity;
+
+		glGenVertexArrays(1, &geometryPage.m_VertexArrayID);
+		glGenBuffers(1, &geometryPage.m_VertexBufferID);
+		glGenBuffers(1, &geometryPage.m_IndexBufferID);
+
+		glBindVertexArray(geometryPage.m_VertexArrayID);
+		glBindBuffer(GL_ARRAY_BUFFER, geometryPage.m_VertexBufferID);
+		glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vertexCapacity * g_PooledVertexStride, nullptr, GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, geometryPage.m_IndexBufferID);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)indexCapacity * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+
+		//Same attribute locations as our per-mesh VAOs, so every mesh shader works with pooled geometry.
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, g_PooledVertexStride, (GLvoid*)0);
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, g_PooledVertexStride, (GLvoid*)(3 * sizeof(float)));
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, g_PooledVertexStride, (GLvoid*)(5 * sizeof(float)));
+		glEnableVertexAttribArray(3);
+		glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, g_PooledVertexStride, (GLvoid*)(8 * sizeof(float)));
+		glEnableVertexAttribArray(4);
+		glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, g_PooledVertexStride, (GLvoid*)(11 * sizeof(float)));
+		glBindVertexArray(0);
+
+		m_GeometryPages.push_back(geometryPage);
+		return (unsigned int)m_GeometryPages.size() - 1;
+	}
+}
\ No newline at end of file
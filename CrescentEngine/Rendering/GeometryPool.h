@@ -0,0 +1,67 @@
+#pragma once
+#include <GL/glew.h>
+#include <vector>
+#include <cstdint>
+
+namespace Crescent
+{
+	class Mesh;
+
+	/*
+		Opt-in shared storage for static mesh geometry. Meshes are sub-allocated into a few large vertex/index buffer pages sharing one interleaved vertex format
+		(position, uv, normal, tangent, bitangent - the same attribute locations as Mesh::FinalizeMesh), so that many meshes can be drawn from a single VAO
+		with one glMultiDrawElementsIndirect call. Allocations are never freed individually; the pool only grows by adding pages.
+	*/
+
+	//Matches the layout expected by glMultiDrawElementsIndirect.
+	struct DrawElementsIndirectCommand
+	{
+		uint32_t m_IndexCount;
+		uint32_t m_InstanceCount;
+		uint32_t m_FirstIndex;
+		int32_t m_BaseVertex;
+		uint32_t m_BaseInstance;
+	};
+
+	//Where a pooled mesh's geometry lives. Indices are stored relative to the mesh, so draws offset them by the base vertex.
+	struct GeometryAllocation
+	{
+		unsigned int m_GeometryPageIndex = 0;
+		unsigned int m_VertexArrayID = 0;
+		uint32_t m_FirstIndex = 0;
+		int32_t m_BaseVertex = 0;
+	};
+
+	struct GeometryPage
+	{
+		unsigned int m_VertexArrayID = 0;
+		unsigned int m_VertexBufferID = 0;
+		unsigned int m_IndexBufferID = 0;
+
+		uint32_t m_VertexCapacity = 0;
+		uint32_t m_VertexCount = 0;
+		uint32_t m_IndexCapacity = 0;
+		uint32_t m_IndexCount = 0;
+	};
+
+	class GeometryPool
+	{
+	public:
+		GeometryPool();
+		~GeometryPool();
+
+		//Uploads the mesh's geometry into a page with enough space. Use Mesh::FinalizePooledMesh() rather than calling this directly.
+		GeometryAllocation AllocateMesh(const Mesh* mesh);
+
+		const GeometryPage& RetrieveGeometryPage(unsigned int pageIndex) const { return m_GeometryPages[pageIndex]; }
+		unsigned int RetrieveGeometryPageCount() const { return (unsigned int)m_GeometryPages.size(); }
+		size_t RetrievePooledMeshCount() const { return m_PooledMeshCount; }
+
+	private:
+		unsigned int CreateGeometryPage(uint32_t vertexCapacity, uint32_t indexCapacity);
+
+	private:
+		std::vector<GeometryPage> m_GeometryPages;
+		size_t m_PooledMeshCount = 0;
+	};
+}
\ No newline at end of file
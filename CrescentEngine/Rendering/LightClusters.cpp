@@ -0,0 +1,222 @@
+#include "CrescentPCH.h"
+#include "LightClusters.h"
+#include "UniformBlocks.h"
+#include "../Shading/Shader.h"
+#include "../Core/JobSystem.h"
+#include <immintrin.h>
+#include <cmath>
+#include <cfloat>
+
+namespace Crescent
+{
+	static constexpr UniformHandle g_ClusterViewUniform = "clusterView";
+	static constexpr UniformHandle g_LightCountUniform = "lightCount";
+	static constexpr UniformHandle g_ClusterTileSizeUniform = "clusterTileSize";
+	static constexpr UniformHandle g_ClusterDepthScaleBiasUniform = "clusterDepthScaleBias";
+
+	//Clip planes of an OpenGL perspective projection.
+	static glm::vec2 RetrieveClipPlanes(const glm::mat4& projectionMatrix)
+	{
+		return glm::vec2(projectionMatrix[3][2] / (projectionMatrix[2][2] - 1.0f), projectionMatrix[3][2] / (projectionMatrix[2][2] + 1.0f));
+	}
+
+	LightClusters::LightClusters()
+	{
+		glGenBuffers(1, &m_ClusterBoundsBufferID);
+		glGenBuffers(1, &m_ClusterLightCountBufferID);
+		glGenBuffers(1, &m_ClusterLightIndexBufferID);
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_ClusterBoundsBufferID);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, g_ClusterCount * sizeof(ClusterBounds), nullptr, GL_STATIC_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_ClusterLightCountBufferID);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, g_ClusterCount * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_ClusterLightIndexBufferID);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, (size_t)g_ClusterCount * g_MaximumLightsPerCluster * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+		m_ClusterBounds.resize(g_ClusterCount);
+	}
+
+	LightClusters::~LightClusters()
+	{
+		glDeleteBuffers(1, &m_ClusterBoundsBufferID);
+		glDeleteBuffers(1, &m_ClusterLightCountBufferID);
+		glDeleteBuffers(1, &m_ClusterLightIndexBufferID);
+	}
+
+	void LightClusters::UpdateClusterGrid(const glm::mat4& projectionMatrix, const glm::vec2& renderTargetSize)
+	{
+		if (projectionMatrix == m_GridProjection && renderTargetSize == m_GridTargetSize)
+		{
+			return;
+		}
+
+		m_GridProjection = projectionMatrix;
+		m_GridTargetSize = renderTargetSize;
+
+		//Slice k starts at near * (far / near)^(k / Z), so the slice of a depth is Z * log(depth / near) / log(far / near).
+		const glm::vec2 clipPlanes = RetrieveClipPlanes(projectionMatrix);
+		const float logDepthRange = std::log(clipPlanes.y / clipPlanes.x);
+		m_DepthScaleBias = glm::vec2((float)g_ClusterCountZ / logDepthRange, -(float)g_ClusterCountZ * std::log(clipPlanes.x) / logDepthRange);
+
+		BuildClusterBounds(projectionMatrix, m_ClusterBounds.data());
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_ClusterBoundsBufferID);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, g_ClusterCount * sizeof(ClusterBounds), m_ClusterBounds.data());
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+
+	void LightClusters::BinLightsGPU(Shader* binningShader, const glm::mat4& viewMatrix, const PointLightBuffer& pointLightBuffer)
+	{
+		binningShader->UseShader();
+		binningShader->SetUniformMat4(g_ClusterViewUniform, viewMatrix);
+		binningShader->SetUniformInteger(g_LightCountUniform, (int)pointLightBuffer.RetrieveLightCount());
+		BindStorageBuffers();
+
+		glDispatchCompute((g_ClusterCount + g_ClusterBinningGroupSize - 1) / g_ClusterBinningGroupSize, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+	}
+
+	void LightClusters::BinLightsCPU(const glm::mat4& viewMatrix, const PointLightBuffer& pointLightBuffer)
+	{
+		const std::vector<PointLightStorageEntry>& pointLightEntries = pointLightBuffer.RetrievePointLightEntries();
+		const uint32_t lightCount = (uint32_t)pointLightEntries.size();
+		m_ViewSpaceLights.resize(lightCount);
+		for (uint32_t i = 0; i < lightCount; i++)
+		{
+			const glm::vec4& positionRadius = pointLightEntries[i].m_PositionRadius;
+			m_ViewSpaceLights[i] = glm::vec4(glm::vec3(viewMatrix * glm::vec4(glm::vec3(positionRadius), 1.0f)), positionRadius.w);
+		}
+
+		m_ClusterLightCounts.resize(g_ClusterCount);
+		m_ClusterLightIndices.resize((size_t)g_ClusterCount * g_MaximumLightsPerCluster);
+
+		//A depth slice per job at most.
+		JobSystem::ParallelFor(g_ClusterCount, g_ClusterCountX * g_ClusterCountY, [&](uint32_t clusterBegin, uint32_t clusterEnd)
+		{
+			BinLights(m_ClusterBounds.data(), clusterBegin, clusterEnd, m_ViewSpaceLights.data(), lightCount, m_ClusterLightCounts.data(), m_ClusterLightIndices.data());
+		});
+
+		//Entries past each cluster's count are never read, but the lists are uploaded whole rather than cluster by cluster.
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_ClusterLightCountBufferID);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, g_ClusterCount * sizeof(uint32_t), m_ClusterLightCounts.data());
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_ClusterLightIndexBufferID);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_ClusterLightIndices.size() * sizeof(uint32_t), m_ClusterLightIndices.data());
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+
+	void LightClusters::BindClusters(Shader* shadingShader)
+	{
+		BindStorageBuffers();
+		shadingShader->SetUniformVector2(g_ClusterTileSizeUniform, m_GridTargetSize / glm::vec2((float)g_ClusterCountX, (float)g_ClusterCountY));
+		shadingShader->SetUniformVector2(g_ClusterDepthScaleBiasUniform, m_DepthScaleBias);
+	}
+
+	void LightClusters::BindStorageBuffers()
+	{
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, StorageBlock_ClusterBounds, m_ClusterBoundsBufferID);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, StorageBlock_ClusterLightCounts, m_ClusterLightCountBufferID);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, StorageBlock_ClusterLightIndices, m_ClusterLightIndexBufferID);
+	}
+
+	void LightClusters::BuildClusterBounds(const glm::mat4& projectionMatrix, ClusterBounds* clusterBounds)
+	{
+		const glm::vec2 clipPlanes = RetrieveClipPlanes(projectionMatrix);
+		const glm::mat4 inverseProjection = glm::inverse(projectionMatrix);
+
+		//View space rays through the corners of every tile, scaled to a depth of 1 so that a point at depth d along one is just the ray times d.
+		std::vector<glm::vec3> cornerRays((g_ClusterCountX + 1) * (g_ClusterCountY + 1));
+		for (uint32_t y = 0; y <= g_ClusterCountY; y++)
+		{
+			for (uint32_t x = 0; x <= g_ClusterCountX; x++)
+			{
+				const glm::vec2 deviceCoordinates = glm::vec2((float)x / g_ClusterCountX, (float)y / g_ClusterCountY) * 2.0f - 1.0f;
+				const glm::vec4 nearPoint = inverseProjection * glm::vec4(deviceCoordinates, -1.0f, 1.0f);
+				cornerRays[x + y * (g_ClusterCountX + 1)] = glm::vec3(nearPoint) / -nearPoint.z;
+			}
+		}
+
+		for (uint32_t z = 0; z < g_ClusterCountZ; z++)
+		{
+			const float sliceNear = clipPlanes.x * std::pow(clipPlanes.y / clipPlanes.x, (float)z / g_ClusterCountZ);
+			const float sliceFar = clipPlanes.x * std::pow(clipPlanes.y / clipPlanes.x, (float)(z + 1) / g_ClusterCountZ);
+
+			for (uint32_t y = 0; y < g_ClusterCountY; y++)
+			{
+				for (uint32_t x = 0; x < g_ClusterCountX; x++)
+				{
+					glm::vec3 boundsMinimum = glm::vec3(FLT_MAX);
+					glm::vec3 boundsMaximum = glm::vec3(-FLT_MAX);
+					for (uint32_t corner = 0; corner < 4; corner++)
+					{
+						const glm::vec3& cornerRay = cornerRays[(x + (corner & 1)) + (y + (corner >> 1)) * (g_ClusterCountX + 1)];
+						boundsMinimum = glm::min(boundsMinimum, glm::min(cornerRay * sliceNear, cornerRay * sliceFar));
+						boundsMaximum = glm::max(boundsMaximum, glm::max(cornerRay * sliceNear, cornerRay * sliceFar));
+					}
+
+					ClusterBounds& bounds = clusterBounds[x + y * g_ClusterCountX + z * g_ClusterCountX * g_ClusterCountY];
+					bounds.m_Minimum = glm::vec4(boundsMinimum, 0.0f);
+					bounds.m_Maximum = glm::vec4(boundsMaximum, 0.0f);
+				}
+			}
+		}
+	}
+
+	void LightClusters::BinLights(const ClusterBounds* clusterBounds, uint32_t clusterBegin, uint32_t clusterEnd, const glm::vec4* viewSpaceLights, uint32_t lightCount, uint32_t* clusterLightCounts, uint32_t* clusterLightIndices)
+	{
+		const uint32_t batchedLightCount = lightCount & ~3u;
+		const __m128 zero = _mm_setzero_ps();
+
+		for (uint32_t clusterIndex = clusterBegin; clusterIndex < clusterEnd; clusterIndex++)
+		{
+			const ClusterBounds& bounds = clusterBounds[clusterIndex];
+			uint32_t* lightIndices = clusterLightIndices + (size_t)clusterIndex * g_MaximumLightsPerCluster;
+			uint32_t visibleCount = 0;
+
+			const __m128 minimumX = _mm_set1_ps(bounds.m_Minimum.x);
+			const __m128 minimumY = _mm_set1_ps(bounds.m_Minimum.y);
+			const __m128 minimumZ = _mm_set1_ps(bounds.m_Minimum.z);
+			const __m128 maximumX = _mm_set1_ps(bounds.m_Maximum.x);
+			const __m128 maximumY = _mm_set1_ps(bounds.m_Maximum.y);
+			const __m128 maximumZ = _mm_set1_ps(bounds.m_Maximum.z);
+
+			uint32_t lightIndex = 0;
+			for (; lightIndex < batchedLightCount && visibleCount < g_MaximumLightsPerCluster; lightIndex += 4)
+			{
+				//Lights are stored as xyzr, so 4 of them transpose into a register per component.
+				__m128 lightX = _mm_loadu_ps(&viewSpaceLights[lightIndex].x);
+				__m128 lightY = _mm_loadu_ps(&viewSpaceLights[lightIndex + 1].x);
+				__m128 lightZ = _mm_loadu_ps(&viewSpaceLights[lightIndex + 2].x);
+				__m128 lightRadius = _mm_loadu_ps(&viewSpaceLights[lightIndex + 3].x);
+				_MM_TRANSPOSE4_PS(lightX, lightY, lightZ, lightRadius);
+
+				//Distance from each center to the box along each axis, zero within the box's extent.
+				const __m128 offsetX = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minimumX, lightX), _mm_sub_ps(lightX, maximumX)), zero);
+				const __m128 offsetY = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minimumY, lightY), _mm_sub_ps(lightY, maximumY)), zero);
+				const __m128 offsetZ = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minimumZ, lightZ), _mm_sub_ps(lightZ, maximumZ)), zero);
+				const __m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(offsetX, offsetX), _mm_mul_ps(offsetY, offsetY)), _mm_mul_ps(offsetZ, offsetZ));
+				const int overlapMask = _mm_movemask_ps(_mm_cmple_ps(distanceSquared, _mm_mul_ps(lightRadius, lightRadius)));
+
+				for (uint32_t lane = 0; lane < 4 && overlapMask; lane++)
+				{
+					if ((overlapMask & (1 << lane)) && visibleCount < g_MaximumLightsPerCluster)
+					{
+						lightIndices[visibleCount++] = lightIndex + lane;
+					}
+				}
+			}
+
+			for (; lightIndex < lightCount && visibleCount < g_MaximumLightsPerCluster; lightIndex++)
+			{
+				const glm::vec4& viewSpaceLight = viewSpaceLights[lightIndex];
+				const glm::vec3 lightCenter = glm::vec3(viewSpaceLight);
+				const glm::vec3 offset = glm::max(glm::max(glm::vec3(bounds.m_Minimum) - lightCenter, lightCenter - glm::vec3(bounds.m_Maximum)), glm::vec3(0.0f));
+				if (glm::dot(offset, offset) <= viewSpaceLight.w * viewSpaceLight.w)
+				{
+					lightIndices[visibleCount++] = lightIndex;
+				}
+			}
+
+			clusterLightCounts[clusterIndex] = visibleCount;
+		}
+	}
+}
\ No newline at end of file
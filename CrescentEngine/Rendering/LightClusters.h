@@ -0,0 +1,80 @@
+#pragma once
+#include "PointLightBuffer.h"
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+
+namespace Crescent
+{
+	class Shader;
+
+	/*
+		Clustered point lighting. The view frustum is split into a grid of froxels: screen space tiles, sliced exponentially in depth so that slices stay roughly
+		cubic. Each frame, the visible point lights are streamed into a PointLightBuffer and a compute pass bins them into a fixed size list per cluster. A single
+		full screen pass then shades every pixel against its cluster's list only (see Deferred/ClusteredLightFragment.shader), so the G-buffer is read once no
+		matter how many lights there are, and each light costs a buffer entry rather than a draw.
+
+		BinLights is the CPU reference of the compute pass, testing 4 lights at a time with SSE. Both run the same sphere against box test and append lights in
+		index order, so the renderer can bin on either side for comparison. Their lists agree, but for lights that only graze a cluster: the GPU's float math
+		may round the distance differently, so such a light can be in one side's list and not the other's (see CrescentTests/LightClusterTests.cpp).
+	*/
+
+	//Must match Resources/Shaders/Constants/Clusters.shader.
+	static constexpr uint32_t g_ClusterCountX = 16;
+	static constexpr uint32_t g_ClusterCountY = 9;
+	static constexpr uint32_t g_ClusterCountZ = 24;
+	static constexpr uint32_t g_ClusterCount = g_ClusterCountX * g_ClusterCountY * g_ClusterCountZ;
+	static constexpr uint32_t g_MaximumLightsPerCluster = 256; //Further lights touching a cluster are dropped from it.
+	static constexpr uint32_t g_ClusterBinningGroupSize = 128; //Local size of the binning compute shader.
+
+	//View space bounds of one cluster. Must match ClusterBounds in Resources/Shaders/Constants/Clusters.shader.
+	struct ClusterBounds
+	{
+		glm::vec4 m_Minimum;
+		glm::vec4 m_Maximum;
+	};
+
+	static_assert(sizeof(ClusterBounds) == 32, "ClusterBounds no longer matches its std430 layout.");
+
+	class LightClusters
+	{
+	public:
+		LightClusters();
+		~LightClusters();
+
+		//Rebuilds our clusters' bounds should the projection or target size have changed since the last call. Perspective projections only.
+		void UpdateClusterGrid(const glm::mat4& projectionMatrix, const glm::vec2& renderTargetSize);
+		//Fills the cluster lists with the lights last uploaded to the light buffer, seen through the given view matrix. The CPU path bins with BinLights and
+		//uploads the result. The lists hold indices into the light buffer, so it must not be refilled before the lights are shaded.
+		void BinLightsGPU(Shader* binningShader, const glm::mat4& viewMatrix, const PointLightBuffer& pointLightBuffer);
+		void BinLightsCPU(const glm::mat4& viewMatrix, const PointLightBuffer& pointLightBuffer);
+
+		//Binds our storage buffers and sets the cluster lookup uniforms of the shading shader.
+		void BindClusters(Shader* shadingShader);
+
+		//Reference - Independent of OpenGL. Bounds are built for the projection's whole grid, and lights (view space centers, radius in w) are binned into clusters
+		//[clusterBegin, clusterEnd), at most g_MaximumLightsPerCluster each, into clusterLightIndices at g_MaximumLightsPerCluster entries per cluster.
+		static void BuildClusterBounds(const glm::mat4& projectionMatrix, ClusterBounds* clusterBounds);
+		static void BinLights(const ClusterBounds* clusterBounds, uint32_t clusterBegin, uint32_t clusterEnd, const glm::vec4* viewSpaceLights, uint32_t lightCount, uint32_t* clusterLightCounts, uint32_t* clusterLightIndices);
+
+	private:
+		void BindStorageBuffers();
+
+	private:
+		unsigned int m_ClusterBoundsBufferID = 0;
+		unsigned int m_ClusterLightCountBufferID = 0;
+		unsigned int m_ClusterLightIndexBufferID = 0;
+
+		//Grid - Rebuilt only when the projection or target changes.
+		glm::mat4 m_GridProjection = glm::mat4(0.0f);
+		glm::vec2 m_GridTargetSize = glm::vec2(0.0f);
+		glm::vec2 m_DepthScaleBias = glm::vec2(0.0f); //Maps the log of a view depth onto our depth slices.
+		std::vector<ClusterBounds> m_ClusterBounds;
+
+		//Staging memory, kept between frames.
+		std::vector<glm::vec4> m_ViewSpaceLights;
+		std::vector<uint32_t> m_ClusterLightCounts;
+		std::vector<uint32_t> m_ClusterLightIndices;
+	};
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "../Shading/Material.h"
 #include "Resources.h"
 #include "../Utilities/StringID.h"
+#include <algorithm>
 
 namespace Crescent
 {
@@ -24,10 +25,46 @@ namespace Crescent
 			delete m_Materials[i];
 		}
 
-		//delete m_DebugLightMaterial;
 		//delete m_DefaultBlitMaterial;
 	}
 
+	bool MaterialLibrary::DestroyMaterial(Material* material)
+	{
+		auto iterator = std::find(m_Materials.begin(), m_Materials.end(), material);
+		if (iterator == m_Materials.end())
+		{
+			return false;
+		}
+
+		m_Materials.erase(iterator);
+		delete material;
+		return true;
+	}
+
+	bool MaterialLibrary::IsTextureReferenced(const Texture* texture) const
+	{
+		auto samplesTexture = [texture](Material* material)
+		{
+			for (const auto& samplerUniform : *material->GetSamplerUniforms())
+			{
+				if (samplerUniform.second.m_UniformType != Shader_Type_SamplerCube && samplerUniform.second.m_Texture == texture)
+				{
+					return true;
+				}
+			}
+			return false;
+		};
+
+		for (auto iterator = m_DefaultMaterials.begin(); iterator != m_DefaultMaterials.end(); ++iterator)
+		{
+			if (samplesTexture(iterator->second))
+			{
+				return true;
+			}
+		}
+		return std::any_of(m_Materials.begin(), m_Materials.end(), samplesTexture);
+	}
+
 	Material* MaterialLibrary::CreateMaterial(std::string& base) //Default material.
 	{
 		auto foundMaterial = m_DefaultMaterials.find(SID(base));
@@ -50,6 +87,8 @@ namespace Crescent
 		//Default render material (deferred path).
 		Shader* defaultShader = Resources::LoadShader("Default", "Resources/Shaders/Deferred/GBufferVertex.shader", "Resources/Shaders/Deferred/GBufferFragment.shader");
 		Material* defaultMaterial = new Material(defaultShader);
+		//Set before our textures, so that their sampler units are assigned to both variants.
+		defaultMaterial->SetInstancedShader(Resources::LoadShader("Default Instanced", "Resources/Shaders/Deferred/GBufferInstancedVertex.shader", "Resources/Shaders/Deferred/GBufferFragment.shader"));
 
 		defaultMaterial->m_MaterialType = Material_Default;
 		defaultMaterial->SetShaderTexture("TexAlbedo", Resources::LoadTexture("Default Albedo", "Resources/Textures/Checkerboard.png", GL_TEXTURE_2D, GL_RGB), 3);
@@ -65,6 +104,8 @@ namespace Crescent
 		//Deferred
 		m_DeferredDirectionalLightShader = Resources::LoadShader("Deferred Directional Light", "Resources/Shaders/Deferred/ScreenDirectionalVertex.shader", "Resources/Shaders/Deferred/DirectionalFragment.shader");
 		m_DeferredPointLightShader = Resources::LoadShader("Deferred Point Light", "Resources/Shaders/Deferred/PointLightVertex.shader", "Resources/Shaders/Deferred/PointLightFragment.shader");
+		m_DeferredClusteredLightShader = Resources::LoadShader("Deferred Clustered Light", "Resources/Shaders/Deferred/ScreenDirectionalVertex.shader", "Resources/Shaders/Deferred/ClusteredLightFragment.shader");
+		m_ClusterBinningShader = Resources::LoadComputeShader("Cluster Binning", "Resources/Shaders/Deferred/ClusterBinningCompute.shader");
 		m_DeferredAmbientLightShader = Resources::LoadShader("Deferred Ambient Light", "Resources/Shaders/Deferred/ScreenAmbienceVertex.shader", "Resources/Shaders/Deferred/AmbienceLightFragment.shader");
 
 		//Ambience
@@ -90,12 +131,18 @@ namespace Crescent
 		m_DeferredPointLightShader->SetUniformInteger("gNormalRoughness", 1);
 		m_DeferredPointLightShader->SetUniformInteger("gAlbedoAO", 2);
 
+		//Clustered Point Lights
+		m_DeferredClusteredLightShader->UseShader();
+		m_DeferredClusteredLightShader->SetUniformInteger("gPositionMetallic", 0);
+		m_DeferredClusteredLightShader->SetUniformInteger("gNormalRoughness", 1);
+		m_DeferredClusteredLightShader->SetUniformInteger("gAlbedoAO", 2);
+
 		//Shadows
 		m_DirectionalShadowShader = Resources::LoadShader("Directional Shadow", "Resources/Shaders/ShadowCastVertex.shader", "Resources/Shaders/ShadowCastFragment.shader");
+		m_DirectionalShadowInstancedShader = Resources::LoadShader("Directional Shadow Instanced", "Resources/Shaders/ShadowCastInstancedVertex.shader", "Resources/Shaders/ShadowCastFragment.shader");
 
 		//Debug
-		Shader* debugLightShader = Resources::LoadShader("Debug Light", "Resources/Shaders/LightDebugVertex.shader", "Resources/Shaders/LightDebugFragment.shader");
-		m_DebugLightMaterial = new Material(debugLightShader);
+		m_DebugLightShader = Resources::LoadShader("Debug Light", "Resources/Shaders/LightDebugVertex.shader", "Resources/Shaders/LightDebugFragment.shader");
 	}
 /*
 	Material* MaterialLibrary::CreateCustomMaterial(Shader* shader) //Player created.
@@ -25,6 +25,10 @@ namespace Crescent
 		Material* CreateMaterial(std::string& base);				//These don't have the custom flag set (a default material has default state and uses checkboard textures as albedo (and black metallic, half roughness, purple normal, white AO).
 		//Material* CreateCustomMaterial(Shader* shader);				//These have the custom flag set (will be rnedered in the forward pass).
 		//Material* CreatePostProcessingMaterial(Shader* shader);		//These have the post-processing flags set (will be rendered after deferred/forward pass).
+		bool DestroyMaterial(Material* material); //Materials made by CreateMaterial only. Returns false, leaving the material alone, for any other.
+
+		//Whether any material we hold samples the texture. Used to decide whether unloaded models' textures can be freed with them.
+		bool IsTextureReferenced(const Texture* texture) const;
 
 		Material* m_DefaultBlitMaterial;
 
@@ -42,11 +46,14 @@ namespace Crescent
 		//Shader* m_DeferredAmbientLightShader;
 		Shader* m_DeferredDirectionalLightShader;
 		Shader* m_DeferredPointLightShader;
+		Shader* m_DeferredClusteredLightShader;
+		Shader* m_ClusterBinningShader;
 		Shader* m_DeferredAmbientLightShader;
 
 		Shader* m_DirectionalShadowShader;
+		Shader* m_DirectionalShadowInstancedShader;
 
-		Material* m_DebugLightMaterial;
+		Shader* m_DebugLightShader;
 
 		//Holds a list of default material templates that other materials can derive from.
 		std::map<unsigned int, Material*> m_DefaultMaterials;
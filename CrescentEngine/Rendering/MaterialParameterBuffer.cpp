@@ -0,0 +1,83 @@
+#include "CrescentPCH.h"
+#include "MaterialParameterBuffer.h"
+
+namespace Crescent
+{
+	MaterialParameterBuffer::MaterialParameterBuffer(unsigned int initialSlotCount) : m_SlotCapacity(initialSlotCount)
+	{
+		GLint offsetAlignment = 0;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+		if (offsetAlignment > 0)
+		{
+			m_SlotSize = (m_SlotSize + offsetAlignment - 1) / offsetAlignment * offsetAlignment;
+		}
+
+		glGenBuffers(1, &m_BufferID);
+		glBindBuffer(GL_UNIFORM_BUFFER, m_BufferID);
+		glBufferData(GL_UNIFORM_BUFFER, m_SlotSize * m_SlotCapacity, nullptr, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+
+	MaterialParameterBuffer::~MaterialParameterBuffer()
+	{
+		glDeleteBuffers(1, &m_BufferID);
+	}
+
+	int MaterialParameterBuffer::AllocateSlot()
+	{
+		//Slots of destroyed materials go first, so the buffer only grows with the number of live materials.
+		if (!m_FreeSlots.empty())
+		{
+			const int slot = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+			return slot;
+		}
+
+		if (m_HandedOutSlotCount == m_SlotCapacity)
+		{
+			GrowBuffer();
+		}
+		return (int)m_HandedOutSlotCount++;
+	}
+
+	void MaterialParameterBuffer::ReleaseSlot(int slot)
+	{
+		//Draws still in flight may read the old contents, but the slot's next upload goes through glBufferSubData, which the driver orders after them.
+		m_FreeSlots.push_back(slot);
+	}
+
+	void MaterialParameterBuffer::UploadSlot(int slot, const void* data, size_t dataSize)
+	{
+		if (dataSize > m_SlotSize)
+		{
+			CrescentError("Material parameter block of " + std::to_string(dataSize) + " bytes exceeds the material buffer's slot size.");
+		}
+
+		//Only happens when a material is rebaked, which is rare enough that letting the driver handle any in-flight reads is fine.
+		glBindBuffer(GL_UNIFORM_BUFFER, m_BufferID);
+		glBufferSubData(GL_UNIFORM_BUFFER, slot * m_SlotSize, dataSize, data);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+
+	void MaterialParameterBuffer::BindSlot(int slot, unsigned int bindingPoint)
+	{
+		glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, m_BufferID, slot * m_SlotSize, m_SlotSize);
+	}
+
+	void MaterialParameterBuffer::GrowBuffer()
+	{
+		unsigned int newBufferID = 0;
+		glGenBuffers(1, &newBufferID);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, newBufferID);
+		glBufferData(GL_COPY_WRITE_BUFFER, m_SlotSize * m_SlotCapacity * 2, nullptr, GL_DYNAMIC_DRAW);
+
+		glBindBuffer(GL_COPY_READ_BUFFER, m_BufferID);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, m_SlotSize * m_SlotCapacity);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		glDeleteBuffers(1, &m_BufferID);
+		m_BufferID = newBufferID;
+		m_SlotCapacity *= 2;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstddef>
+#include <vector>
+
+namespace Crescent
+{
+	/*
+		Holds every material's baked parameter block in one uniform buffer, split into fixed size slots. A material only uploads into its slot when it is
+		rebaked, so binding its parameters for a draw is a single glBindBufferRange. Slots of destroyed materials are handed back and reused first, and only once
+		every slot is taken does the buffer double in size, keeping its contents.
+	*/
+
+	class MaterialParameterBuffer
+	{
+	public:
+		MaterialParameterBuffer(unsigned int initialSlotCount = 256);
+		~MaterialParameterBuffer();
+
+		int AllocateSlot();
+		void ReleaseSlot(int slot); //Called when the slot's material is destroyed.
+		void UploadSlot(int slot, const void* data, size_t dataSize);
+		void BindSlot(int slot, unsigned int bindingPoint);
+
+		size_t RetrieveSlotSize() const { return m_SlotSize; }
+		unsigned int RetrieveAllocatedSlotCount() const { return m_HandedOutSlotCount - (unsigned int)m_FreeSlots.size(); }
+
+	private:
+		void GrowBuffer();
+
+	private:
+		unsigned int m_BufferID = 0;
+		size_t m_SlotSize = 256; //Largest parameter block we hold, rounded up to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT.
+		unsigned int m_SlotCapacity = 0;
+		unsigned int m_HandedOutSlotCount = 0; //Slots below this have been handed out at some point. Those since released are in m_FreeSlots.
+		std::vector<int> m_FreeSlots;
+	};
+}
\ No newline at end of file
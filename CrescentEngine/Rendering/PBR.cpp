@@ -7,7 +7,6 @@
 #include "../Shading/Texture.h"
 #include "../Shading/TextureCube.h"
 #include "../Models/DefaultPrimitives.h"
-#include "../Scene/SceneEntity.h"
 #include "../Shading/Material.h"
 #include "../Shading/Shader.h"
 
@@ -37,9 +36,6 @@ namespace Crescent
 		m_PBRPrefilterCaptureMaterial->m_FaceCullingEnabled = false;
 
 		m_PBRCaptureCube = new Cube();
-		m_SceneEnvironmentCube = new SceneEntity("Scene Environment Cube", 0);
-		m_SceneEnvironmentCube->m_Mesh = m_PBRCaptureCube;
-		m_SceneEnvironmentCube->m_Material = m_PBRHDRToCubemapMaterial;
 
 		//BRDF Integration
 		m_RendererContext->Blit(nullptr, m_RenderTargetBRDFLUT, m_PBRIntegrateBRDFMaterial);
@@ -48,7 +44,6 @@ namespace Crescent
 	PBR::~PBR()
 	{
 		delete m_PBRCaptureCube;
-		delete m_SceneEnvironmentCube;
 		delete m_RenderTargetBRDFLUT;
 		delete m_PBRHDRToCubemapMaterial;
 		delete m_PBRIrradianceCaptureMaterial;
@@ -60,12 +55,11 @@ namespace Crescent
 	EnvironmentalPBR* PBR::ProcessEquirectangularMap(Texture* environmentalMap)
 	{
 		//Convert HDR Radiance Image to HDR Environment Cubemap
-		m_SceneEnvironmentCube->m_Material = m_PBRHDRToCubemapMaterial;
 		m_PBRHDRToCubemapMaterial->SetShaderTexture("environment", environmentalMap, 0);
 
 		TextureCube hdrEnvironmentalMap;
 		hdrEnvironmentalMap.DefaultInitialize(128, 128, GL_RGB, GL_FLOAT);
-		m_RendererContext->RenderCubemap(m_SceneEnvironmentCube, &hdrEnvironmentalMap);
+		m_RendererContext->RenderCubemap(m_PBRCaptureCube, m_PBRHDRToCubemapMaterial, &hdrEnvironmentalMap);
 
 		return ProcessCubeMap(&hdrEnvironmentalMap);
 	}
@@ -78,8 +72,7 @@ namespace Crescent
 		environmentProbe->m_IrradianceTextureCube = new TextureCube();
 		environmentProbe->m_IrradianceTextureCube->DefaultInitialize(32, 32, GL_RGB, GL_FLOAT);
 		m_PBRIrradianceCaptureMaterial->SetShaderTextureCube("environment", environmentCapture, 0);
-		m_SceneEnvironmentCube->m_Material = m_PBRIrradianceCaptureMaterial;
-		m_RendererContext->RenderCubemap(m_SceneEnvironmentCube, environmentProbe->m_IrradianceTextureCube, glm::vec3(0.0f), 0);
+		m_RendererContext->RenderCubemap(m_PBRCaptureCube, m_PBRIrradianceCaptureMaterial, environmentProbe->m_IrradianceTextureCube, glm::vec3(0.0f), 0);
 
 		//Prefilter
 		if (prefilter)
@@ -88,14 +81,13 @@ namespace Crescent
 			environmentProbe->m_PrefilteredTextureCube->m_TextureCubeMinificationFilter = GL_LINEAR_MIPMAP_LINEAR;
 			environmentProbe->m_PrefilteredTextureCube->DefaultInitialize(128, 128, GL_RGB, GL_FLOAT, true);
 			m_PBRPrefilterCaptureMaterial->SetShaderTextureCube("environment", environmentCapture, 0);
-			m_SceneEnvironmentCube->m_Material = m_PBRPrefilterCaptureMaterial;
 
 			//Calculate prefilter for multiple roughness levels.
 			unsigned int maxMipmappingLevels = 5;
 			for (unsigned int i = 0; i < maxMipmappingLevels; i++)
 			{
 				m_PBRPrefilterCaptureMaterial->SetShaderFloat("roughness", (float)i / (float)(maxMipmappingLevels - 1));
-				m_RendererContext->RenderCubemap(m_SceneEnvironmentCube, environmentProbe->m_PrefilteredTextureCube, glm::vec3(0.0f), i);
+				m_RendererContext->RenderCubemap(m_PBRCaptureCube, m_PBRPrefilterCaptureMaterial, environmentProbe->m_PrefilteredTextureCube, glm::vec3(0.0f), i);
 			}
 		}
 
@@ -9,7 +9,6 @@ namespace Crescent
 	class RenderTarget;
 	class Material;
 	class Mesh;
-	class SceneEntity;
 
 	/*
 		Manages and mains all render data and functionality related to the (main) deferred PBR pipeline.
@@ -47,7 +46,6 @@ namespace Crescent
 		Material* m_PBRIntegrateBRDFMaterial;
 
 		Mesh* m_PBRCaptureCube;
-		SceneEntity* m_SceneEnvironmentCube;
 
 		Renderer* m_RendererContext;
 	};
@@ -0,0 +1,51 @@
+#include "CrescentPCH.h"
+#include "PointLightBuffer.h"
+#include "UniformBlocks.h"
+#include "../Lighting/PointLight.h"
+#include <algorithm>
+
+namespace Crescent
+{
+	//Lights the storage buffer starts out with, so that small scenes never grow it.
+	static constexpr size_t g_MinimumPointLightCapacity = 256;
+
+	PointLightBuffer::PointLightBuffer()
+	{
+		m_StorageCapacity = g_MinimumPointLightCapacity;
+		glGenBuffers(1, &m_StorageBufferID);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_StorageBufferID);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, m_StorageCapacity * sizeof(PointLightStorageEntry), nullptr, GL_STREAM_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+
+	PointLightBuffer::~PointLightBuffer()
+	{
+		glDeleteBuffers(1, &m_StorageBufferID);
+	}
+
+	void PointLightBuffer::UploadPointLights(const std::vector<PointLight*>& pointLights)
+	{
+		m_PointLightEntries.resize(pointLights.size());
+		for (size_t i = 0; i < pointLights.size(); i++)
+		{
+			const PointLight* pointLight = pointLights[i];
+			m_PointLightEntries[i].m_PositionRadius = glm::vec4(pointLight->m_LightPosition, pointLight->m_LightRadius);
+			m_PointLightEntries[i].m_ColorIntensity = glm::vec4(glm::normalize(pointLight->m_LightColor), pointLight->m_LightIntensity);
+		}
+
+		if (m_PointLightEntries.size() > m_StorageCapacity)
+		{
+			m_StorageCapacity = std::max(m_PointLightEntries.size(), m_StorageCapacity * 2);
+		}
+
+		//Respecified on every upload to orphan the storage that earlier passes may still be reading.
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_StorageBufferID);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, m_StorageCapacity * sizeof(PointLightStorageEntry), nullptr, GL_STREAM_DRAW);
+		if (!m_PointLightEntries.empty())
+		{
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_PointLightEntries.size() * sizeof(PointLightStorageEntry), m_PointLightEntries.data());
+		}
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, StorageBlock_PointLights, m_StorageBufferID);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+
+namespace Crescent
+{
+	class PointLight;
+
+	/*
+		Point lights streamed into a shader storage buffer (see Constants/Lights.shader), so that passes over many lights read them by index rather than
+		taking a draw with its own uniforms per light. The clustered pass indexes it through its cluster lists, and the light volume and debug passes by
+		instance, drawing every light with a single instanced call.
+
+		The buffer is respecified on every upload, so it may be refilled with a different set of lights between passes of the same frame.
+	*/
+
+	//Must match PointLightEntry in Resources/Shaders/Constants/Lights.shader, laid out as std430.
+	struct PointLightStorageEntry
+	{
+		glm::vec4 m_PositionRadius; //World space position, with the light's radius in w.
+		glm::vec4 m_ColorIntensity; //Normalized color, with the light's intensity in w.
+	};
+
+	static_assert(sizeof(PointLightStorageEntry) == 32, "PointLightStorageEntry no longer matches its std430 layout.");
+
+	class PointLightBuffer
+	{
+	public:
+		PointLightBuffer();
+		~PointLightBuffer();
+
+		//Streams the lights into our buffer, in order, and binds it for our shaders. Their indices there are what instances and cluster lists refer to.
+		void UploadPointLights(const std::vector<PointLight*>& pointLights);
+
+		const std::vector<PointLightStorageEntry>& RetrievePointLightEntries() const { return m_PointLightEntries; } //As of the last upload.
+		uint32_t RetrieveLightCount() const { return (uint32_t)m_PointLightEntries.size(); }
+
+	private:
+		unsigned int m_StorageBufferID = 0;
+		size_t m_StorageCapacity = 0; //In lights.
+		std::vector<PointLightStorageEntry> m_PointLightEntries;
+	};
+}
\ No newline at end of file
@@ -1,15 +1,60 @@
 #pragma once
 #include <glm/glm.hpp>
+#include <cstdint>
 
 namespace Crescent
 {
 	class Mesh;
 	class Material;
 
+	static constexpr uint32_t g_NullTransformSlot = ~0u;
+
 	struct RenderCommand
 	{
 		glm::mat4 m_Transform = glm::mat4(1.0f);
 		Mesh* m_Mesh;
 		Material* m_Material;
+
+		//Packed pass/state/depth key used to order commands before submission. See RenderSortKey.h.
+		uint64_t m_SortKey = 0;
+
+		//World space bounding box, used for frustum culling.
+		glm::vec3 m_BoundingBoxCenter = glm::vec3(0.0f);
+		glm::vec3 m_BoundingBoxExtents = glm::vec3(0.0f);
+		bool m_FrustumCullingEnabled = true;
+
+		//Slot of the command's world matrix in the render world, for commands drawn from a render proxy. Immediate commands have none.
+		uint32_t m_TransformSlot = g_NullTransformSlot;
+
+		//Dynamic casters are redrawn into the shadow maps every frame, static ones only when a cascade's cache is invalidated. Immediate commands are always dynamic.
+		bool m_DynamicShadowCaster = true;
+	};
+
+	/*
+		Non-owning view over render commands stored in the render queue's frame memory. It either points at a contiguous run of commands,
+		or at a list of references into other runs (such as the shadow caster list), so retrieving commands never copies them. Only valid until the queue is cleared.
+	*/
+
+	class RenderCommandList
+	{
+	public:
+		RenderCommandList() = default;
+		RenderCommandList(RenderCommand* renderCommands, uint32_t commandCount) : m_RenderCommands(renderCommands), m_CommandCount(commandCount) { }
+		RenderCommandList(RenderCommand* const* commandReferences, uint32_t commandCount) : m_CommandReferences(commandReferences), m_CommandCount(commandCount) { }
+
+		uint32_t size() const { return m_CommandCount; }
+		bool empty() const { return m_CommandCount == 0; }
+		RenderCommand& operator[](uint32_t index) const { return m_CommandReferences ? *m_CommandReferences[index] : m_RenderCommands[index]; }
+
+		//View over commandCount commands starting at firstIndex, such as one chunk of a list being processed in parallel.
+		RenderCommandList RetrieveSubList(uint32_t firstIndex, uint32_t commandCount) const
+		{
+			return m_CommandReferences ? RenderCommandList(m_CommandReferences + firstIndex, commandCount) : RenderCommandList(m_RenderCommands + firstIndex, commandCount);
+		}
+
+	private:
+		RenderCommand* m_RenderCommands = nullptr;
+		RenderCommand* const* m_CommandReferences = nullptr;
+		uint32_t m_CommandCount = 0;
 	};
 }
\ No newline at end of file
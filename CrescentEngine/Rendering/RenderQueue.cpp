@@ -1,11 +1,24 @@
 #include "CrescentPCH.h"
 #include "RenderQueue.h"
 #include "RenderCommand.h"
+#include "RenderSortKey.h"
+#include "Renderer.h"
 #include "../Shading/Material.h"
+#include "../Shading/Shader.h"
+#include "../Models/Mesh.h"
+#include "../Utilities/Camera.h"
+#include "../Core/JobSystem.h"
+#include <cstring>
 
 namespace Crescent
 {
-	RenderQueue::RenderQueue(Renderer* renderer)
+	//Per-frame memory for our commands. Grows on demand and settles at the frame's working set.
+	static constexpr size_t g_InitialFrameMemory = 256 * 1024;
+	static constexpr uint32_t g_MinimumBucketCapacity = 64;
+	//Commands per culling job. Smaller lists are culled inline, as the SIMD test gets through this many faster than a job can be scheduled.
+	static constexpr uint32_t g_CullingChunkSize = 2048;
+
+	RenderQueue::RenderQueue(Renderer* renderer) : m_FrameAllocator(g_InitialFrameMemory)
 	{
 		m_Renderer = renderer;
 	}
@@ -15,89 +28,389 @@ namespace Crescent
 		ClearQueuedCommands();
 	}
 
-	void RenderQueue::PushToRenderQueue(Mesh* mesh, Material* material, glm::mat4 transform, RenderTarget* renderTarget)
+	void RenderQueue::PushToRenderQueue(Mesh* mesh, Material* material, glm::mat4 transform, RenderTarget* renderTarget, bool frustumCullingEnabled)
+	{
+		SubmitRenderCommand(BuildRenderCommand(mesh, material, transform, frustumCullingEnabled), renderTarget);
+	}
+
+	RenderCommand RenderQueue::BuildRenderCommand(Mesh* mesh, Material* material, const glm::mat4& transform, bool frustumCullingEnabled, bool depthSorted) const
 	{
 		RenderCommand renderCommand = {};
 
 		renderCommand.m_Mesh = mesh;
 		renderCommand.m_Material = material;
 		renderCommand.m_Transform = transform;
+		renderCommand.m_FrustumCullingEnabled = frustumCullingEnabled;
+
+		FitCommandBounds(renderCommand);
+		renderCommand.m_SortKey = GenerateSortKey(renderCommand, depthSorted);
+		return renderCommand;
+	}
+
+	void RenderQueue::FitCommandBounds(RenderCommand& renderCommand)
+	{
+		//Transform the mesh's local bounding box into a world space box that encloses it. The extents are projected onto each world axis by the absolute rotation/scale.
+		const Mesh* mesh = renderCommand.m_Mesh;
+		const glm::mat4& transform = renderCommand.m_Transform;
+		glm::vec3 localCenter = (mesh->m_BoundingBoxMinimum + mesh->m_BoundingBoxMaximum) * 0.5f;
+		glm::vec3 localExtents = (mesh->m_BoundingBoxMaximum - mesh->m_BoundingBoxMinimum) * 0.5f;
+		renderCommand.m_BoundingBoxCenter = glm::vec3(transform * glm::vec4(localCenter, 1.0f));
+		for (int axis = 0; axis < 3; axis++)
+		{
+			renderCommand.m_BoundingBoxExtents[axis] = std::abs(transform[0][axis]) * localExtents.x + std::abs(transform[1][axis]) * localExtents.y + std::abs(transform[2][axis]) * localExtents.z;
+		}
+	}
+
+	uint64_t RenderQueue::GenerateSortKey(const RenderCommand& renderCommand, bool depthSorted) const
+	{
+		//Quantize the command's view depth for front-to-back/back-to-front ordering within its state bucket.
+		uint64_t quantizedDepth = 0;
+		Camera* camera = depthSorted ? m_Renderer->RetrieveSceneCamera() : nullptr;
+		if (camera)
+		{
+			glm::vec4 viewPosition = camera->m_ViewMatrix * glm::vec4(glm::vec3(renderCommand.m_Transform[3]), 1.0f);
+			quantizedDepth = RenderSortKey::QuantizeDepth(-viewPosition.z, camera->m_FarClip);
+		}
+
+		const Material* material = renderCommand.m_Material;
+		unsigned int shaderID = material->RetrieveMaterialShader() ? material->RetrieveMaterialShader()->GetShaderID() : 0;
+		unsigned int meshID = renderCommand.m_Mesh->RetrieveMeshID();
+
+		if (material->m_BlendingEnabled)
+		{
+			return RenderSortKey::GenerateTransparentKey(shaderID, material->RetrieveMaterialID(), meshID, quantizedDepth);
+		}
+		return RenderSortKey::GenerateOpaqueKey(shaderID, material->RetrieveMaterialID(), meshID, quantizedDepth);
+	}
+
+	void RenderQueue::SubmitRenderCommand(const RenderCommand& renderCommand, RenderTarget* renderTarget)
+	{
+		Material* material = renderCommand.m_Material;
 
 		//Here, we will have different queue types for different rendering styles. We can filter with material types.
 		if (material->m_BlendingEnabled)
 		{
-			//Add to blending command queue.
+			PushToBucket(m_AlphaRenderCommands, renderCommand);
 		}
 		else
 		{
 			//We check the type of material we have and process differently where necessary.
 			if (material->m_MaterialType == Material_Default)
 			{
-				m_DeferredRenderingCommands.push_back(renderCommand);
+				PushToBucket(m_DeferredRenderingCommands, renderCommand);
 			}
 			else if (material->m_MaterialType == Material_Custom)
 			{
-				//Check if this render target has been pushed before. If so, we add to its vector.
-				//Otherwise, we create a new vector with this render target. 
-				if (m_CustomRenderCommands.find(renderTarget) != m_CustomRenderCommands.end())
-				{
-					m_CustomRenderCommands[renderTarget].push_back(renderCommand);
-				}
-				else
+				//Check if this render target has been pushed before. If so, we add to its bucket. Otherwise, we create a new bucket for this render target.
+				RenderCommandBucket* customBucket = RetrieveCustomBucket(renderTarget);
+				if (!customBucket)
 				{
-					m_CustomRenderCommands[renderTarget] = std::vector<RenderCommand>();
-					m_CustomRenderCommands[renderTarget].push_back(renderCommand);
+					m_CustomRenderCommands.emplace_back();
+					m_CustomRenderCommands.back().m_RenderTarget = renderTarget;
+					customBucket = &m_CustomRenderCommands.back().m_Bucket;
 				}
+				PushToBucket(*customBucket, renderCommand);
+			}
+			//One more check if its a post-processing material.
+		}
+	}
+
+	void RenderQueue::PushToBucket(RenderCommandBucket& bucket, const RenderCommand& renderCommand)
+	{
+		if (bucket.m_CommandCount == bucket.m_CommandCapacity)
+		{
+			//Relocate the bucket into a larger run of frame memory. The old run is simply abandoned until the allocator resets.
+			uint32_t newCapacity = bucket.m_CommandCapacity * 2;
+			if (newCapacity < bucket.m_PreviousCommandCount)
+			{
+				newCapacity = bucket.m_PreviousCommandCount;
+			}
+			if (newCapacity < g_MinimumBucketCapacity)
+			{
+				newCapacity = g_MinimumBucketCapacity;
 			}
-			//One more check if its a post-processing material. 
+
+			RenderCommand* renderCommands = m_FrameAllocator.AllocateArray<RenderCommand>(newCapacity);
+			std::uninitialized_copy(bucket.m_RenderCommands, bucket.m_RenderCommands + bucket.m_CommandCount, renderCommands);
+			bucket.m_RenderCommands = renderCommands;
+			bucket.m_CommandCapacity = newCapacity;
 		}
+
+		new (&bucket.m_RenderCommands[bucket.m_CommandCount++]) RenderCommand(renderCommand);
 	}
 
-	std::vector<RenderCommand> RenderQueue::RetrieveDeferredRenderingCommands()
+	void RenderQueue::ClearBucket(RenderCommandBucket& bucket)
 	{
-		//Add cull check here.
-		return m_DeferredRenderingCommands;
+		bucket.m_PreviousCommandCount = bucket.m_CommandCount;
+		bucket.m_RenderCommands = nullptr;
+		bucket.m_CommandCount = 0;
+		bucket.m_CommandCapacity = 0;
 	}
 
-	std::vector<RenderCommand> RenderQueue::RetrieveShadowCastingRenderCommands()
+	RenderQueue::RenderCommandBucket* RenderQueue::RetrieveCustomBucket(RenderTarget* renderTarget)
 	{
-		std::vector<RenderCommand> renderCommands;
-		for (auto iterator = m_DeferredRenderingCommands.begin(); iterator != m_DeferredRenderingCommands.end(); iterator++)
+		for (CustomRenderCommandBucket& customBucket : m_CustomRenderCommands)
 		{
-			if (iterator->m_Material->m_ShadowCasting)
+			if (customBucket.m_RenderTarget == renderTarget)
 			{
-				renderCommands.push_back(*iterator);
+				return &customBucket.m_Bucket;
 			}
 		}
+		return nullptr;
+	}
 
-		for (auto iterator = m_CustomRenderCommands[nullptr].begin(); iterator != m_CustomRenderCommands[nullptr].end(); iterator++)
+	void RenderQueue::SubmitRetainedCommands(const RenderCommandList& deferredCommands, const RenderCommandList& forwardCommands)
+	{
+		m_RetainedDeferredCommands = deferredCommands;
+		m_RetainedForwardCommands = forwardCommands;
+	}
+
+	RenderCommandList RenderQueue::RetrieveDeferredRenderingCommands(bool cullingEnabled)
+	{
+		if (cullingEnabled)
 		{
-			if (iterator->m_Material->m_ShadowCasting)
+			return CullRenderCommands(m_DeferredCommandList, RetrieveCameraFrustum());
+		}
+		return m_DeferredCommandList;
+	}
+
+	RenderCommandList RenderQueue::RetrieveShadowCastingRenderCommands(ShadowCasterFilter casterFilter)
+	{
+		//Built on demand as sorting moves our commands around. References live in frame memory, so this doesn't allocate either.
+		uint32_t maximumCasterCount = m_DeferredCommandList.size() + m_ForwardCommandList.size();
+		if (maximumCasterCount == 0)
+		{
+			return RenderCommandList();
+		}
+
+		RenderCommand** shadowCasters = m_FrameAllocator.AllocateArray<RenderCommand*>(maximumCasterCount);
+		uint32_t casterCount = 0;
+		for (const RenderCommandList* renderCommands : { &m_DeferredCommandList, &m_ForwardCommandList })
+		{
+			for (uint32_t i = 0; i < renderCommands->size(); i++)
 			{
-				renderCommands.push_back(*iterator);
+				const RenderCommand& renderCommand = (*renderCommands)[i];
+				if (renderCommand.m_Material->m_ShadowCasting && (casterFilter == ShadowCaster_All || renderCommand.m_DynamicShadowCaster == (casterFilter == ShadowCaster_Dynamic)))
+				{
+					shadowCasters[casterCount++] = &(*renderCommands)[i];
+				}
 			}
 		}
 
-		return renderCommands;
+		return RenderCommandList(shadowCasters, casterCount);
 	}
 
-	std::vector<RenderCommand> RenderQueue::RetrieveCustomRenderCommands(RenderTarget* renderTarget, bool cullingEnabled)
+	RenderCommandList RenderQueue::RetrieveCustomRenderCommands(RenderTarget* renderTarget, bool cullingEnabled)
 	{
-		//Only do culling when on our main/null render target. Culling code here.
+		//Only do culling when on our main/null render target, as other targets may be rendered with their own views. Retained commands only ever go to the main target.
+		if (renderTarget == nullptr)
+		{
+			return cullingEnabled ? CullRenderCommands(m_ForwardCommandList, RetrieveCameraFrustum()) : m_ForwardCommandList;
+		}
 
-		return m_CustomRenderCommands[renderTarget]; //Return render commands belonging to the passed in render target.
+		RenderCommandBucket* customBucket = RetrieveCustomBucket(renderTarget);
+		if (!customBucket)
+		{
+			return RenderCommandList();
+		}
+		return RenderCommandList(customBucket->m_RenderCommands, customBucket->m_CommandCount); //Return render commands belonging to the passed in render target.
 	}
 
-	std::vector<RenderCommand> RenderQueue::RetrievePostProcessingRenderCommands()
+	RenderCommandList RenderQueue::RetrieveAlphaRenderCommands()
 	{
-		return m_PostProcessingRenderCommands;
+		return RenderCommandList(m_AlphaRenderCommands.m_RenderCommands, m_AlphaRenderCommands.m_CommandCount);
+	}
+
+	RenderCommandList RenderQueue::RetrievePostProcessingRenderCommands()
+	{
+		return RenderCommandList(m_PostProcessingRenderCommands.m_RenderCommands, m_PostProcessingRenderCommands.m_CommandCount);
+	}
+
+	RenderCommandList RenderQueue::CullRenderCommands(const RenderCommandList& renderCommands, const Frustum& frustum)
+	{
+		if (renderCommands.empty())
+		{
+			return renderCommands;
+		}
+
+		RenderCommand** visibleCommands = m_FrameAllocator.AllocateArray<RenderCommand*>(renderCommands.size());
+		const uint32_t chunkCount = (renderCommands.size() + g_CullingChunkSize - 1) / g_CullingChunkSize;
+		if (chunkCount == 1)
+		{
+			uint32_t visibleCount = frustum.CullRenderCommands(renderCommands, visibleCommands);
+			return RenderCommandList(visibleCommands, visibleCount);
+		}
+
+		//Each chunk writes its visible commands to the start of its own range of the output, which we then close the gaps between to keep the original order.
+		uint32_t* chunkVisibleCounts = m_FrameAllocator.AllocateArray<uint32_t>(chunkCount);
+		JobSystem::ParallelFor(chunkCount, 1, [&](uint32_t beginChunk, uint32_t endChunk)
+		{
+			for (uint32_t chunkIndex = beginChunk; chunkIndex < endChunk; chunkIndex++)
+			{
+				uint32_t firstCommand = chunkIndex * g_CullingChunkSize;
+				uint32_t commandCount = std::min(g_CullingChunkSize, renderCommands.size() - firstCommand);
+				chunkVisibleCounts[chunkIndex] = frustum.CullRenderCommands(renderCommands.RetrieveSubList(firstCommand, commandCount), visibleCommands + firstCommand);
+			}
+		});
+
+		uint32_t visibleCount = chunkVisibleCounts[0];
+		for (uint32_t chunkIndex = 1; chunkIndex < chunkCount; chunkIndex++)
+		{
+			memmove(visibleCommands + visibleCount, visibleCommands + chunkIndex * g_CullingChunkSize, chunkVisibleCounts[chunkIndex] * sizeof(RenderCommand*));
+			visibleCount += chunkVisibleCounts[chunkIndex];
+		}
+		return RenderCommandList(visibleCommands, visibleCount);
+	}
+
+	Frustum RenderQueue::RetrieveCameraFrustum() const
+	{
+		Camera* camera = m_Renderer->RetrieveSceneCamera();
+		return Frustum(camera->m_ProjectionMatrix * camera->m_ViewMatrix);
+	}
+
+	void RenderQueue::SortRenderCommands()
+	{
+		RadixSortRenderCommands(m_DeferredRenderingCommands);
+		RadixSortRenderCommands(m_AlphaRenderCommands);
+
+		for (CustomRenderCommandBucket& customBucket : m_CustomRenderCommands)
+		{
+			RadixSortRenderCommands(customBucket.m_Bucket);
+		}
+
+		m_DeferredCommandList = MergeRetainedCommands(&m_DeferredRenderingCommands, m_RetainedDeferredCommands);
+		m_ForwardCommandList = MergeRetainedCommands(RetrieveCustomBucket(nullptr), m_RetainedForwardCommands);
+	}
+
+	RenderCommandList RenderQueue::MergeRetainedCommands(const RenderCommandBucket* bucket, const RenderCommandList& retainedCommands)
+	{
+		const uint32_t immediateCount = bucket ? bucket->m_CommandCount : 0;
+		if (retainedCommands.empty())
+		{
+			return RenderCommandList(bucket ? bucket->m_RenderCommands : nullptr, immediateCount);
+		}
+		if (immediateCount == 0)
+		{
+			return retainedCommands;
+		}
+
+		RenderCommand** mergedCommands = m_FrameAllocator.AllocateArray<RenderCommand*>(immediateCount + retainedCommands.size());
+		uint32_t immediateIndex = 0, retainedIndex = 0, mergedCount = 0;
+		while (immediateIndex < immediateCount && retainedIndex < retainedCommands.size())
+		{
+			RenderCommand* immediateCommand = &bucket->m_RenderCommands[immediateIndex];
+			RenderCommand* retainedCommand = &retainedCommands[retainedIndex];
+			if (retainedCommand->m_SortKey < immediateCommand->m_SortKey)
+			{
+				mergedCommands[mergedCount++] = retainedCommand;
+				retainedIndex++;
+			}
+			else
+			{
+				mergedCommands[mergedCount++] = immediateCommand;
+				immediateIndex++;
+			}
+		}
+		while (immediateIndex < immediateCount)
+		{
+			mergedCommands[mergedCount++] = &bucket->m_RenderCommands[immediateIndex++];
+		}
+		while (retainedIndex < retainedCommands.size())
+		{
+			mergedCommands[mergedCount++] = &retainedCommands[retainedIndex++];
+		}
+		return RenderCommandList(mergedCommands, mergedCount);
+	}
+
+	void RenderQueue::RadixSortRenderCommands(RenderCommandBucket& bucket)
+	{
+		const uint32_t commandCount = bucket.m_CommandCount;
+		if (commandCount < 2)
+		{
+			return;
+		}
+
+		struct SortEntry
+		{
+			uint64_t m_SortKey;
+			uint32_t m_CommandIndex;
+		};
+
+		//We sort small key/index pairs instead of the commands themselves, and only move each command once at the very end. Scratch memory comes from the frame allocator.
+		SortEntry* sortEntries = m_FrameAllocator.AllocateArray<SortEntry>(commandCount);
+		SortEntry* scratchEntries = m_FrameAllocator.AllocateArray<SortEntry>(commandCount);
+
+		//Build the histograms of all 8 byte-sized digits in a single pass over the keys.
+		uint32_t histograms[8][256] = {};
+		for (uint32_t i = 0; i < commandCount; i++)
+		{
+			uint64_t sortKey = bucket.m_RenderCommands[i].m_SortKey;
+			sortEntries[i].m_SortKey = sortKey;
+			sortEntries[i].m_CommandIndex = i;
+
+			for (unsigned int digit = 0; digit < 8; digit++)
+			{
+				histograms[digit][(sortKey >> (digit * 8)) & 0xFF]++;
+			}
+		}
+
+		SortEntry* source = sortEntries;
+		SortEntry* destination = scratchEntries;
+		for (unsigned int digit = 0; digit < 8; digit++)
+		{
+			uint32_t* histogram = histograms[digit];
+			const unsigned int shift = digit * 8;
+
+			//If every key shares the same value for this digit, this pass wouldn't change the order. Most of our keys have sparse high bits, so this skips a lot of work.
+			if (histogram[(source[0].m_SortKey >> shift) & 0xFF] == commandCount)
+			{
+				continue;
+			}
+
+			//Exclusive prefix sum turns the counts into output offsets.
+			uint32_t offset = 0;
+			for (unsigned int histogramBucket = 0; histogramBucket < 256; histogramBucket++)
+			{
+				uint32_t count = histogram[histogramBucket];
+				histogram[histogramBucket] = offset;
+				offset += count;
+			}
+
+			for (uint32_t i = 0; i < commandCount; i++)
+			{
+				destination[histogram[(source[i].m_SortKey >> shift) & 0xFF]++] = source[i];
+			}
+
+			std::swap(source, destination);
+		}
+
+		//Finally, gather the commands in their sorted order into a fresh run, which becomes the bucket's storage.
+		RenderCommand* sortedCommands = m_FrameAllocator.AllocateArray<RenderCommand>(commandCount);
+		for (uint32_t i = 0; i < commandCount; i++)
+		{
+			new (&sortedCommands[i]) RenderCommand(bucket.m_RenderCommands[source[i].m_CommandIndex]);
+		}
+		bucket.m_RenderCommands = sortedCommands;
+		bucket.m_CommandCapacity = commandCount;
 	}
 
 	void RenderQueue::ClearQueuedCommands()
 	{
-		m_DeferredRenderingCommands.clear();
-		m_PostProcessingRenderCommands.clear();
-		m_CustomRenderCommands.clear();
+		ClearBucket(m_DeferredRenderingCommands);
+		ClearBucket(m_AlphaRenderCommands);
+		ClearBucket(m_PostProcessingRenderCommands);
+		for (CustomRenderCommandBucket& customBucket : m_CustomRenderCommands)
+		{
+			ClearBucket(customBucket.m_Bucket);
+		}
+
+		m_RetainedDeferredCommands = RenderCommandList();
+		m_RetainedForwardCommands = RenderCommandList();
+		m_DeferredCommandList = RenderCommandList();
+		m_ForwardCommandList = RenderCommandList();
+
+		//RenderCommand is trivially destructible, so releasing the memory is all that's needed.
+		m_FrameAllocator.Reset();
 	}
 }
 
@@ -1,7 +1,8 @@
 #pragma once
 #include "RenderCommand.h"
-#include <deque>
-#include <map>
+#include "Frustum.h"
+#include "../Memory/LinearAllocator.h"
+#include <vector>
 
 namespace Crescent
 {
@@ -10,28 +11,123 @@ namespace Crescent
 	class Material;
 	class RenderTarget;
 
+	enum ShadowCasterFilter
+	{
+		ShadowCaster_All,
+		ShadowCaster_Static, //Kept in cached shadow maps. See RenderCommand::m_DynamicShadowCaster.
+		ShadowCaster_Dynamic
+	};
+
+	/*
+		All commands live in a per-frame linear allocator that is reset in ClearQueuedCommands(). Each queue is a contiguous run inside it that is relocated (and doubled)
+		when it fills up, sized from last frame's count so that this rarely happens. Retrieval hands out RenderCommandList views, so neither building nor draining the queue
+		touches the heap once the allocator has grown to the frame's working set.
+	*/
+
 	class RenderQueue
 	{
 	public:
 		RenderQueue(Renderer* renderer);
 		~RenderQueue();
 
-		void PushToRenderQueue(Mesh* model, Material* material, glm::mat4 transform, RenderTarget* renderTarget = nullptr);
-		std::vector<RenderCommand> RetrieveDeferredRenderingCommands();
+		void PushToRenderQueue(Mesh* model, Material* material, glm::mat4 transform, RenderTarget* renderTarget = nullptr, bool frustumCullingEnabled = true);
+
+		//The two halves of the above. Building resolves the command's bounds and sort key without touching the queue, so it is safe to call from any thread.
+		//Submitting files the command into its queue, and must only happen on the thread that owns the queue.
+		//Commands kept across frames leave the view depth out of their sort keys (depthSorted = false), as it goes stale as soon as the camera moves.
+		RenderCommand BuildRenderCommand(Mesh* mesh, Material* material, const glm::mat4& transform, bool frustumCullingEnabled = true, bool depthSorted = true) const;
+		void SubmitRenderCommand(const RenderCommand& renderCommand, RenderTarget* renderTarget = nullptr);
+		uint64_t GenerateSortKey(const RenderCommand& renderCommand, bool depthSorted = true) const;
+		//Refits the command's world space bounding box to its transform.
+		static void FitCommandBounds(RenderCommand& renderCommand);
 
-		//Returns the list of all render commands with mesh shadow casting.
-		std::vector<RenderCommand> RetrieveShadowCastingRenderCommands();
+		//Commands owned by the render world for this frame only, already culled and sorted. Each list is merged with the immediate commands of its queue (deferred,
+		//and custom without a render target) once those are sorted, so they are never copied or sorted again here.
+		void SubmitRetainedCommands(const RenderCommandList& deferredCommands, const RenderCommandList& forwardCommands);
 
-		std::vector<RenderCommand> RetrievePostProcessingRenderCommands();
+		//When culling is enabled, only commands within the scene camera's frustum are returned. Retained commands are only included once the queue is sorted.
+		RenderCommandList RetrieveDeferredRenderingCommands(bool cullingEnabled = false);
+
+		//Returns the list of render commands with mesh shadow casting, limited to static or dynamic casters if asked. These are references to the deferred/custom commands, not copies.
+		RenderCommandList RetrieveShadowCastingRenderCommands(ShadowCasterFilter casterFilter = ShadowCaster_All);
+
+		RenderCommandList RetrievePostProcessingRenderCommands();
 		//Returns a list of custom render commands for a specific render target.
-		std::vector<RenderCommand> RetrieveCustomRenderCommands(RenderTarget* renderTarget, bool cullingEnabled = false);
+		RenderCommandList RetrieveCustomRenderCommands(RenderTarget* renderTarget, bool cullingEnabled = false);
+		//Returns the list of all blended render commands, ordered back-to-front.
+		RenderCommandList RetrieveAlphaRenderCommands();
+
+		//Returns references to the commands whose bounding boxes intersect the given frustum, in their original order. Large lists are culled in parallel chunks.
+		RenderCommandList CullRenderCommands(const RenderCommandList& renderCommands, const Frustum& frustum);
+
+		//Orders every queue by its commands' sort keys. Done once per frame before any pass retrieves its commands.
+		void SortRenderCommands();
+
+		//Calls function(RenderCommand&) for every command submitted to a drawn queue, which excludes retained and post-processing commands.
+		template<typename Function>
+		void ForEachQueuedCommand(Function function)
+		{
+			auto visitBucket = [&function](RenderCommandBucket& bucket)
+			{
+				for (uint32_t i = 0; i < bucket.m_CommandCount; i++)
+				{
+					function(bucket.m_RenderCommands[i]);
+				}
+			};
+
+			visitBucket(m_DeferredRenderingCommands);
+			visitBucket(m_AlphaRenderCommands);
+			for (CustomRenderCommandBucket& customBucket : m_CustomRenderCommands)
+			{
+				visitBucket(customBucket.m_Bucket);
+			}
+		}
+
+		//Heap allocations made by the queue since it was last cleared. Expected to stay at 0 in steady state.
+		unsigned int RetrieveHeapAllocationCount() const { return m_FrameAllocator.RetrieveHeapAllocationCount(); }
+		size_t RetrieveFrameMemoryUsage() const { return m_FrameAllocator.RetrieveUsedMemory(); }
 
 		void ClearQueuedCommands();
 
 	private:
-		std::vector<RenderCommand> m_DeferredRenderingCommands;
-		std::vector<RenderCommand> m_PostProcessingRenderCommands;
-		std::map<RenderTarget*, std::vector<RenderCommand>> m_CustomRenderCommands;
+		struct RenderCommandBucket
+		{
+			RenderCommand* m_RenderCommands = nullptr;
+			uint32_t m_CommandCount = 0;
+			uint32_t m_CommandCapacity = 0;
+			uint32_t m_PreviousCommandCount = 0; //Used to size the bucket's first allocation each frame.
+		};
+
+		struct CustomRenderCommandBucket
+		{
+			RenderTarget* m_RenderTarget = nullptr;
+			RenderCommandBucket m_Bucket;
+		};
+
+		void PushToBucket(RenderCommandBucket& bucket, const RenderCommand& renderCommand);
+		void ClearBucket(RenderCommandBucket& bucket);
+		RenderCommandBucket* RetrieveCustomBucket(RenderTarget* renderTarget);
+		Frustum RetrieveCameraFrustum() const;
+
+		//Least significant digit radix sort over the 64-bit sort keys. Stable, so commands with equal keys keep their submission order.
+		void RadixSortRenderCommands(RenderCommandBucket& bucket);
+		//Merges a sorted bucket with sorted retained commands into one list of references, by key. Immediate commands go first among equal keys.
+		RenderCommandList MergeRetainedCommands(const RenderCommandBucket* bucket, const RenderCommandList& retainedCommands);
+
+	private:
+		LinearAllocator m_FrameAllocator;
+
+		RenderCommandBucket m_DeferredRenderingCommands;
+		RenderCommandBucket m_AlphaRenderCommands;
+		RenderCommandBucket m_PostProcessingRenderCommands;
+		//Few render targets are ever used, so a flat list beats a map here. Entries are kept across frames; only their contents are cleared.
+		std::vector<CustomRenderCommandBucket> m_CustomRenderCommands;
+
+		//Retained commands submitted this frame, and the lists our passes retrieve once they're merged in.
+		RenderCommandList m_RetainedDeferredCommands;
+		RenderCommandList m_RetainedForwardCommands;
+		RenderCommandList m_DeferredCommandList;
+		RenderCommandList m_ForwardCommandList;
 		Renderer* m_Renderer;
 	};
 }
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <glm/glm.hpp>
+
+namespace Crescent
+{
+	/*
+		Every render command carries a packed 64-bit sort key. Sorting the queue by this key once per frame groups commands by the GL state they need,
+		so consecutive draws share as many shader, material and vertex array binds as possible.
+
+		Opaque:      | Pass (2) | Shader (10) | Material (16) | Mesh (16) | Depth (20) |  - Front-to-back within each state bucket.
+		Transparent: | Pass (2) | Inverted Depth (20) | Shader (10) | Material (16) | Mesh (16) |  - Strictly back-to-front.
+	*/
+
+	enum RenderPass
+	{
+		RenderPass_Opaque = 0,
+		RenderPass_Transparent = 1
+	};
+
+	namespace RenderSortKey
+	{
+		constexpr uint64_t PassBits = 2;
+		constexpr uint64_t ShaderBits = 10;
+		constexpr uint64_t MaterialBits = 16;
+		constexpr uint64_t MeshBits = 16;
+		constexpr uint64_t DepthBits = 20;
+
+		constexpr uint64_t PassMask = (1ull << PassBits) - 1;
+		constexpr uint64_t ShaderMask = (1ull << ShaderBits) - 1;
+		constexpr uint64_t MaterialMask = (1ull << MaterialBits) - 1;
+		constexpr uint64_t MeshMask = (1ull << MeshBits) - 1;
+		constexpr uint64_t DepthMask = (1ull << DepthBits) - 1;
+
+		//Quantizes a view-space depth into the depth field of the key. Anything beyond the far plane is clamped into the last bucket.
+		inline uint64_t QuantizeDepth(float viewDepth, float farClip)
+		{
+			float normalizedDepth = farClip > 0.0f ? glm::clamp(viewDepth / farClip, 0.0f, 1.0f) : 0.0f;
+			return (uint64_t)(normalizedDepth * (float)DepthMask) & DepthMask;
+		}
+
+		inline uint64_t GenerateOpaqueKey(unsigned int shaderID, unsigned int materialID, unsigned int meshID, uint64_t quantizedDepth)
+		{
+			uint64_t sortKey = 0;
+			sortKey |= ((uint64_t)RenderPass_Opaque & PassMask) << (ShaderBits + MaterialBits + MeshBits + DepthBits);
+			sortKey |= ((uint64_t)shaderID & ShaderMask) << (MaterialBits + MeshBits + DepthBits);
+			sortKey |= ((uint64_t)materialID & MaterialMask) << (MeshBits + DepthBits);
+			sortKey |= ((uint64_t)meshID & MeshMask) << DepthBits;
+			sortKey |= quantizedDepth & DepthMask;
+			return sortKey;
+		}
+
+		inline uint64_t GenerateTransparentKey(unsigned int shaderID, unsigned int materialID, unsigned int meshID, uint64_t quantizedDepth)
+		{
+			//Inverting the depth makes the farthest commands sort first, which is what we want for correct blending.
+			uint64_t invertedDepth = DepthMask - (quantizedDepth & DepthMask);
+
+			uint64_t sortKey = 0;
+			sortKey |= ((uint64_t)RenderPass_Transparent & PassMask) << (DepthBits + ShaderBits + MaterialBits + MeshBits);
+			sortKey |= invertedDepth << (ShaderBits + MaterialBits + MeshBits);
+			sortKey |= ((uint64_t)shaderID & ShaderMask) << (MaterialBits + MeshBits);
+			sortKey |= ((uint64_t)materialID & MaterialMask) << MeshBits;
+			sortKey |= (uint64_t)meshID & MeshMask;
+			return sortKey;
+		}
+	}
+}
@@ -0,0 +1,344 @@
+#include "CrescentPCH.h"
+#include "RenderWorld.h"
+#include "RenderQueue.h"
+#include "../Scene/SceneEntity.h"
+#include "../Scene/EntityPool.h"
+#include "../Scene/Components.h"
+#include "../Scene/TransformSystem.h"
+#include "../Scene/DynamicAABBTree.h"
+#include "../Scene/Prefab.h"
+#include "../Shading/Material.h"
+#include "../Models/Mesh.h"
+#include <algorithm>
+
+namespace Crescent
+{
+	//How many synchronizations a moved proxy has to go without moving before it is a static shadow caster again.
+	static constexpr uint32_t g_ShadowCasterSettleFrames = 30;
+
+	RenderWorld::RenderWorld(RenderQueue* renderQueue) : m_RenderQueue(renderQueue)
+	{
+	}
+
+	void RenderWorld::SynchronizeProxies()
+	{
+		m_RebuiltProxyCount = 0;
+		m_MovedProxyCount = 0;
+		m_SynchronizationIndex++;
+
+		//Both lists may name an entity several times, so each is de-duplicated by handle first.
+		auto forEachUniqueEntity = [this](const std::vector<EntityHandle>& entityHandles, auto function)
+		{
+			m_ChangedEntities.clear();
+			for (EntityHandle entityHandle : entityHandles)
+			{
+				m_ChangedEntities.push_back(entityHandle.m_Value);
+			}
+			std::sort(m_ChangedEntities.begin(), m_ChangedEntities.end());
+			m_ChangedEntities.erase(std::unique(m_ChangedEntities.begin(), m_ChangedEntities.end()), m_ChangedEntities.end());
+
+			for (uint32_t handleValue : m_ChangedEntities)
+			{
+				function(EntityHandle(handleValue));
+			}
+		};
+
+		forEachUniqueEntity(ComponentStorage::RetrieveChangedRenderables(), [this](EntityHandle entityHandle) { RebuildEntityProxies(entityHandle); });
+		forEachUniqueEntity(ComponentStorage::RetrieveMovedRenderables(), [this](EntityHandle entityHandle) { MoveEntityProxies(entityHandle); });
+		ComponentStorage::ClearRenderableChanges();
+		SettleMovingProxies();
+		std::sort(m_DirtyTransformSlots.begin(), m_DirtyTransformSlots.end());
+
+		//Only added or removed proxies change a list's order. Moving never does, as our keys leave the depth out.
+		for (unsigned int i = 0; i < DrawList_Count; i++)
+		{
+			if (m_DrawLists[i].m_SortInvalidated)
+			{
+				SortDrawList((DrawListType)i);
+			}
+		}
+	}
+
+	void RenderWorld::ClearDirtyTransformSlots()
+	{
+		for (uint32_t transformSlot : m_DirtyTransformSlots)
+		{
+			m_Proxies[transformSlot].m_TransformDirty = false;
+		}
+		m_DirtyTransformSlots.clear();
+	}
+
+	void RenderWorld::SubmitVisibleProxies(const DynamicAABBTree* spatialTree, const std::vector<uint32_t>* visibleTreeProxies)
+	{
+		const bool cullByEntity = spatialTree && visibleTreeProxies;
+		if (cullByEntity)
+		{
+			m_FrameIndex++;
+			if (m_VisibleFrames.size() < m_EntityProxies.size())
+			{
+				m_VisibleFrames.resize(m_EntityProxies.size(), 0);
+			}
+
+			for (uint32_t treeProxy : *visibleTreeProxies)
+			{
+				const uint32_t entitySlot = EntityHandle(spatialTree->RetrieveUserData(treeProxy)).RetrieveSlotIndex();
+				if (entitySlot < m_VisibleFrames.size())
+				{
+					m_VisibleFrames[entitySlot] = m_FrameIndex;
+				}
+			}
+		}
+
+		//Walking a sorted list and skipping invisible entries keeps the visible subset sorted, so nothing is sorted per frame.
+		auto retrieveVisibleCommands = [this, cullByEntity](DrawList& drawList)
+		{
+			if (!cullByEntity)
+			{
+				return RenderCommandList(drawList.m_SortedCommands.data(), (uint32_t)drawList.m_SortedCommands.size());
+			}
+
+			drawList.m_VisibleCommands.clear();
+			for (size_t i = 0; i < drawList.m_SortedCommands.size(); i++)
+			{
+				if (m_VisibleFrames[drawList.m_EntitySlots[i]] == m_FrameIndex)
+				{
+					drawList.m_VisibleCommands.push_back(drawList.m_SortedCommands[i]);
+				}
+			}
+			return RenderCommandList(drawList.m_VisibleCommands.data(), (uint32_t)drawList.m_VisibleCommands.size());
+		};
+
+		m_RenderQueue->SubmitRetainedCommands(retrieveVisibleCommands(m_DrawLists[DrawList_Deferred]), retrieveVisibleCommands(m_DrawLists[DrawList_Forward]));
+
+		//Blending needs a strict back-to-front order, which changes with the camera. These are copied into the queue with a fresh depth in their keys.
+		const RenderCommandList transparentCommands = retrieveVisibleCommands(m_DrawLists[DrawList_Transparent]);
+		for (uint32_t i = 0; i < transparentCommands.size(); i++)
+		{
+			RenderCommand renderCommand = transparentCommands[i];
+			renderCommand.m_SortKey = m_RenderQueue->GenerateSortKey(renderCommand);
+			m_RenderQueue->SubmitRenderCommand(renderCommand);
+		}
+	}
+
+	void RenderWorld::RebuildEntityProxies(EntityHandle entityHandle)
+	{
+		const uint32_t entitySlot = entityHandle.RetrieveSlotIndex();
+		SceneEntity* sceneEntity = EntityPool::RetrieveEntity(entityHandle);
+
+		//A live entity in the slot also means any proxies left by a previous occupant are stale.
+		if (entitySlot < m_EntityProxies.size() && (m_EntityProxies[entitySlot].m_EntityHandle == entityHandle || sceneEntity))
+		{
+			DestroyEntityProxies(entitySlot);
+		}
+
+		if (!sceneEntity)
+		{
+			return;
+		}
+
+		const glm::mat4& worldMatrix = TransformSystem::RetrieveWorldMatrix(sceneEntity->RetrieveTransformIndex());
+		const MeshRendererComponent* meshRenderer = ComponentStorage::RetrieveMeshRenderers().RetrieveComponent(entityHandle);
+		if (meshRenderer && meshRenderer->m_Enabled)
+		{
+			CreateProxy(entityHandle, meshRenderer->m_Mesh, meshRenderer->m_Material, glm::mat4(1.0f), worldMatrix);
+		}
+
+		const PrefabInstanceComponent* prefabInstance = ComponentStorage::RetrievePrefabInstances().RetrieveComponent(entityHandle);
+		if (prefabInstance && prefabInstance->m_Enabled)
+		{
+			const std::vector<PrefabNode>& prefabNodes = prefabInstance->m_Prefab->RetrieveNodes();
+			for (uint32_t nodeIndex : prefabInstance->m_Prefab->RetrieveRenderableNodes())
+			{
+				const PrefabNode& prefabNode = prefabNodes[nodeIndex];
+				CreateProxy(entityHandle, prefabNode.m_Mesh, prefabInstance->RetrieveNodeMaterial(nodeIndex, prefabNode.m_Material), prefabNode.m_PrefabTransform, worldMatrix);
+			}
+		}
+	}
+
+	void RenderWorld::MoveEntityProxies(EntityHandle entityHandle)
+	{
+		const uint32_t entitySlot = entityHandle.RetrieveSlotIndex();
+		SceneEntity* sceneEntity = EntityPool::RetrieveEntity(entityHandle);
+		if (!sceneEntity || entitySlot >= m_EntityProxies.size() || m_EntityProxies[entitySlot].m_EntityHandle != entityHandle)
+		{
+			return;
+		}
+
+		const glm::mat4& worldMatrix = TransformSystem::RetrieveWorldMatrix(sceneEntity->RetrieveTransformIndex());
+		for (uint32_t proxyIndex = m_EntityProxies[entitySlot].m_FirstProxyIndex; proxyIndex != g_NullTransformSlot; proxyIndex = m_Proxies[proxyIndex].m_NextProxyIndex)
+		{
+			RenderProxy& renderProxy = m_Proxies[proxyIndex];
+			if (!renderProxy.m_RenderCommand.m_DynamicShadowCaster)
+			{
+				//Its old position is baked into the cached shadow maps, so they are redrawn once without it.
+				InvalidateStaticShadowCaster(renderProxy);
+				renderProxy.m_RenderCommand.m_DynamicShadowCaster = true;
+				renderProxy.m_Settling = true;
+				m_MovingProxies.push_back(proxyIndex);
+			}
+			renderProxy.m_LastMovedFrame = m_SynchronizationIndex;
+			renderProxy.m_RenderCommand.m_Transform = worldMatrix * renderProxy.m_NodeTransform;
+			RenderQueue::FitCommandBounds(renderProxy.m_RenderCommand);
+			MarkTransformDirty(proxyIndex);
+			m_MovedProxyCount++;
+		}
+	}
+
+	void RenderWorld::DestroyEntityProxies(uint32_t entitySlot)
+	{
+		uint32_t proxyIndex = m_EntityProxies[entitySlot].m_FirstProxyIndex;
+		while (proxyIndex != g_NullTransformSlot)
+		{
+			RenderProxy& renderProxy = m_Proxies[proxyIndex];
+			const uint32_t nextProxyIndex = renderProxy.m_NextProxyIndex;
+
+			InvalidateStaticShadowCaster(renderProxy);
+			m_DrawLists[renderProxy.m_DrawListType].m_SortInvalidated = true;
+			renderProxy.m_Allocated = false;
+			renderProxy.m_Settling = false;
+			renderProxy.m_NextProxyIndex = m_FreeProxyIndex;
+			m_FreeProxyIndex = proxyIndex;
+			m_ProxyCount--;
+
+			proxyIndex = nextProxyIndex;
+		}
+		m_EntityProxies[entitySlot] = EntityProxies();
+	}
+
+	void RenderWorld::CreateProxy(EntityHandle entityHandle, Mesh* mesh, Material* material, const glm::mat4& nodeTransform, const glm::mat4& worldMatrix)
+	{
+		//The same split the render queue makes for immediate commands. Post-processing materials aren't drawn per object.
+		DrawListType drawListType;
+		if (material->m_BlendingEnabled)
+		{
+			drawListType = DrawList_Transparent;
+		}
+		else if (material->m_MaterialType == Material_Default)
+		{
+			drawListType = DrawList_Deferred;
+		}
+		else if (material->m_MaterialType == Material_Custom)
+		{
+			drawListType = DrawList_Forward;
+		}
+		else
+		{
+			return;
+		}
+
+		uint32_t proxyIndex = m_FreeProxyIndex;
+		if (proxyIndex != g_NullTransformSlot)
+		{
+			m_FreeProxyIndex = m_Proxies[proxyIndex].m_NextProxyIndex;
+		}
+		else
+		{
+			//Growing moves every proxy, and with them the commands our draw lists point at.
+			if (m_Proxies.size() == m_Proxies.capacity())
+			{
+				for (DrawList& drawList : m_DrawLists)
+				{
+					drawList.m_SortInvalidated = true;
+				}
+			}
+			proxyIndex = (uint32_t)m_Proxies.size();
+			m_Proxies.emplace_back();
+		}
+
+		const uint32_t entitySlot = entityHandle.RetrieveSlotIndex();
+		if (entitySlot >= m_EntityProxies.size())
+		{
+			m_EntityProxies.resize(entitySlot + 1);
+		}
+		EntityProxies& entityProxies = m_EntityProxies[entitySlot];
+		entityProxies.m_EntityHandle = entityHandle;
+
+		RenderProxy& renderProxy = m_Proxies[proxyIndex];
+		renderProxy.m_RenderCommand = m_RenderQueue->BuildRenderCommand(mesh, material, worldMatrix * nodeTransform, true, false);
+		renderProxy.m_RenderCommand.m_TransformSlot = proxyIndex;
+		renderProxy.m_RenderCommand.m_DynamicShadowCaster = !mesh->m_Animations.empty(); //Skinned meshes change shape without ever moving.
+		renderProxy.m_NodeTransform = nodeTransform;
+		renderProxy.m_OwnerEntity = entityHandle;
+		renderProxy.m_DrawListType = drawListType;
+		renderProxy.m_Allocated = true;
+		renderProxy.m_NextProxyIndex = entityProxies.m_FirstProxyIndex;
+		entityProxies.m_FirstProxyIndex = proxyIndex;
+
+		MarkTransformDirty(proxyIndex);
+		InvalidateStaticShadowCaster(renderProxy);
+
+		m_DrawLists[drawListType].m_SortInvalidated = true;
+		m_ProxyCount++;
+		m_RebuiltProxyCount++;
+	}
+
+	void RenderWorld::MarkTransformDirty(uint32_t proxyIndex)
+	{
+		if (!m_Proxies[proxyIndex].m_TransformDirty)
+		{
+			m_Proxies[proxyIndex].m_TransformDirty = true;
+			m_DirtyTransformSlots.push_back(proxyIndex);
+		}
+	}
+
+	void RenderWorld::SettleMovingProxies()
+	{
+		for (size_t i = 0; i < m_MovingProxies.size();)
+		{
+			RenderProxy& renderProxy = m_Proxies[m_MovingProxies[i]];
+			if (renderProxy.m_Settling && m_SynchronizationIndex - renderProxy.m_LastMovedFrame < g_ShadowCasterSettleFrames)
+			{
+				i++;
+				continue;
+			}
+
+			//Entries of proxies destroyed since (or listed twice, after their slot was reused) are dropped without settling anything.
+			if (renderProxy.m_Settling)
+			{
+				renderProxy.m_Settling = false;
+				renderProxy.m_RenderCommand.m_DynamicShadowCaster = false;
+				InvalidateStaticShadowCaster(renderProxy);
+			}
+			m_MovingProxies[i] = m_MovingProxies.back();
+			m_MovingProxies.pop_back();
+		}
+	}
+
+	void RenderWorld::InvalidateStaticShadowCaster(const RenderProxy& renderProxy)
+	{
+		if (!renderProxy.m_RenderCommand.m_DynamicShadowCaster && renderProxy.m_RenderCommand.m_Material->m_ShadowCasting)
+		{
+			m_StaticGeometryVersion++;
+		}
+	}
+
+	void RenderWorld::SortDrawList(DrawListType drawListType)
+	{
+		std::vector<uint32_t> proxyIndices;
+		for (uint32_t i = 0; i < (uint32_t)m_Proxies.size(); i++)
+		{
+			if (m_Proxies[i].m_Allocated && m_Proxies[i].m_DrawListType == drawListType)
+			{
+				proxyIndices.push_back(i);
+			}
+		}
+
+		//Ties are broken by proxy index, so the order (and with it our instancing runs) is stable across re-sorts.
+		std::sort(proxyIndices.begin(), proxyIndices.end(), [this](uint32_t indexA, uint32_t indexB)
+		{
+			const uint64_t sortKeyA = m_Proxies[indexA].m_RenderCommand.m_SortKey;
+			const uint64_t sortKeyB = m_Proxies[indexB].m_RenderCommand.m_SortKey;
+			return sortKeyA != sortKeyB ? sortKeyA < sortKeyB : indexA < indexB;
+		});
+
+		DrawList& drawList = m_DrawLists[drawListType];
+		drawList.m_SortedCommands.clear();
+		drawList.m_EntitySlots.clear();
+		for (uint32_t proxyIndex : proxyIndices)
+		{
+			drawList.m_SortedCommands.push_back(&m_Proxies[proxyIndex].m_RenderCommand);
+			drawList.m_EntitySlots.push_back(m_Proxies[proxyIndex].m_OwnerEntity.RetrieveSlotIndex());
+		}
+		drawList.m_SortInvalidated = false;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,124 @@
+#pragma once
+#include "RenderCommand.h"
+#include "../Scene/EntityHandle.h"
+#include <vector>
+
+namespace Crescent
+{
+	class RenderQueue;
+	class DynamicAABBTree;
+	class Mesh;
+	class Material;
+
+	/*
+		Retained render state for every renderable in the component pools. Each node a mesh renderer or prefab instance draws owns a persistent proxy holding its
+		render command, with its bounds, transform slot and depth-free sort key resolved once. Proxies are rebuilt only for renderables the component storage lists
+		as changed, and merely moved for those the scene lists as moved, so a static scene does no per-object work at all between frames.
+
+		Opaque proxies are kept in draw lists sorted by their sort keys, re-sorted only when proxies are added or removed. Each frame, the lists are filtered down to
+		the entities our spatial tree found visible and handed to the render queue as-is. Transparent proxies are still depth sorted by the queue every frame.
+
+		Proxies start out as static shadow casters, which the renderer keeps in cached shadow maps, unless their mesh is animated. Moving a proxy makes it dynamic
+		until it has stayed put for a while, so that something being dragged around doesn't invalidate those caches every frame.
+	*/
+
+	class RenderWorld
+	{
+	public:
+		RenderWorld(RenderQueue* renderQueue);
+
+		//Rebuilds the proxies of changed renderables and moves those of moved ones, then clears both lists. Transforms must have been propagated and the
+		//scene's bounds refit (see Scene::UpdateScene) beforehand. Main thread only.
+		void SynchronizeProxies();
+
+		//Submits the proxies of every visible entity to the render queue: given a spatial tree, the entities owning visibleTreeProxies, and every proxy otherwise.
+		void SubmitVisibleProxies(const DynamicAABBTree* spatialTree, const std::vector<uint32_t>* visibleTreeProxies);
+
+		uint32_t RetrieveProxyCount() const { return m_ProxyCount; }
+		//Work done by the last SynchronizeProxies.
+		uint32_t RetrieveRebuiltProxyCount() const { return m_RebuiltProxyCount; }
+		uint32_t RetrieveMovedProxyCount() const { return m_MovedProxyCount; }
+		//Changes whenever a static shadow caster is added, removed, moved or settles. Shadow maps cached at another version are stale.
+		uint64_t RetrieveStaticGeometryVersion() const { return m_StaticGeometryVersion; }
+
+		//Every proxy's slot indexes this array. Released slots keep their last matrix until reused.
+		uint32_t RetrieveTransformSlotCount() const { return (uint32_t)m_Proxies.size(); }
+		const glm::mat4& RetrieveSlotTransform(uint32_t transformSlot) const { return m_Proxies[transformSlot].m_RenderCommand.m_Transform; }
+		//Slots whose matrix was written since the last ClearDirtyTransformSlots, in ascending order so that neighbouring slots can be uploaded together.
+		const std::vector<uint32_t>& RetrieveDirtyTransformSlots() const { return m_DirtyTransformSlots; }
+		void ClearDirtyTransformSlots();
+
+	private:
+		enum DrawListType
+		{
+			DrawList_Deferred,
+			DrawList_Forward, //Custom materials, drawn to the main render target.
+			DrawList_Transparent,
+			DrawList_Count
+		};
+
+		//Proxies double as transform slots: a proxy's index is its slot, and freed proxies are reused before the array grows.
+		struct RenderProxy
+		{
+			RenderCommand m_RenderCommand;
+			glm::mat4 m_NodeTransform = glm::mat4(1.0f); //Relative to the owning entity. Identity for mesh renderers.
+			EntityHandle m_OwnerEntity;
+			uint32_t m_NextProxyIndex = g_NullTransformSlot; //Next proxy of the same entity, or next free proxy.
+			DrawListType m_DrawListType = DrawList_Deferred;
+			bool m_Allocated = false;
+			bool m_TransformDirty = false; //Set while the slot is listed in m_DirtyTransformSlots.
+			bool m_Settling = false; //Made dynamic by moving, and listed in m_MovingProxies until it has stopped.
+			uint32_t m_LastMovedFrame = 0;
+		};
+
+		struct DrawList
+		{
+			std::vector<RenderCommand*> m_SortedCommands;
+			std::vector<uint32_t> m_EntitySlots; //Slot of the entity owning each sorted command.
+			std::vector<RenderCommand*> m_VisibleCommands; //This frame's visible subset, still in order.
+			bool m_SortInvalidated = false;
+		};
+
+		//The proxies of one entity slot, chained through m_NextProxyIndex.
+		struct EntityProxies
+		{
+			EntityHandle m_EntityHandle;
+			uint32_t m_FirstProxyIndex = g_NullTransformSlot;
+		};
+
+		void RebuildEntityProxies(EntityHandle entityHandle);
+		void MoveEntityProxies(EntityHandle entityHandle);
+		void DestroyEntityProxies(uint32_t entitySlot);
+		void CreateProxy(EntityHandle entityHandle, Mesh* mesh, Material* material, const glm::mat4& nodeTransform, const glm::mat4& worldMatrix);
+		void MarkTransformDirty(uint32_t proxyIndex);
+		//Returns proxies that haven't moved for a while to being static shadow casters.
+		void SettleMovingProxies();
+		//Bumps our static geometry version should the proxy be in the cached shadow maps.
+		void InvalidateStaticShadowCaster(const RenderProxy& renderProxy);
+		//Re-gathers and sorts the list's commands from our proxies.
+		void SortDrawList(DrawListType drawListType);
+
+	private:
+		RenderQueue* m_RenderQueue = nullptr;
+
+		std::vector<RenderProxy> m_Proxies;
+		uint32_t m_FreeProxyIndex = g_NullTransformSlot;
+		uint32_t m_ProxyCount = 0;
+		std::vector<EntityProxies> m_EntityProxies; //Indexed by entity slot.
+		DrawList m_DrawLists[DrawList_Count];
+
+		//Visibility - An entity is visible this frame if its slot holds the current frame's stamp.
+		std::vector<uint32_t> m_VisibleFrames;
+		uint32_t m_FrameIndex = 0;
+
+		std::vector<uint32_t> m_DirtyTransformSlots;
+		std::vector<uint32_t> m_ChangedEntities; //Scratch memory for de-duplicating our change lists.
+		uint32_t m_RebuiltProxyCount = 0;
+		uint32_t m_MovedProxyCount = 0;
+
+		//Shadow Caching
+		std::vector<uint32_t> m_MovingProxies;
+		uint32_t m_SynchronizationIndex = 0;
+		uint64_t m_StaticGeometryVersion = 0;
+	};
+}
\ No newline at end of file
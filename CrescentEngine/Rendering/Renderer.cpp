@@ -2,11 +2,14 @@
 #include "CrescentPCH.h";
 #include "Renderer.h";
 #include "RenderQueue.h"
+#include "RenderWorld.h"
 #include "GLStateCache.h"
 #include "MaterialLibrary.h"
 #include "../Models/DefaultPrimitives.h"
 #include "../Utilities/FlyCamera.h"
 #include "../Scene/SceneEntity.h"
+#include "../Scene/Components.h"
+#include "../Scene/DynamicAABBTree.h"
 #include "../Models/Model.h"
 #include "../Shading/Shader.h"
 #include "../Shading/Material.h"
@@ -15,32 +18,81 @@
 #include "../Rendering/Resources.h"
 #include "../Shading/TextureCube.h"
 #include "PostProcessor.h"
+#include "Frustum.h"
+#include "UniformBlocks.h"
+#include "UniformRingBuffer.h"
+#include "TransformBuffer.h"
+#include "PointLightBuffer.h"
+#include "LightClusters.h"
+#include "MaterialParameterBuffer.h"
 #include <glm/gtc/type_ptr.hpp>
-#include <stack>
+#include <algorithm>
 
 //As of now, our renderer only supports Forward Pass Rendering.
 
 namespace Crescent
 {
+	//Size of each of the draw uniform ring's segments. Fits 2048 draws at the common 256 byte offset alignment before we move to the next one.
+	static constexpr size_t g_DrawUniformSegmentSize = 512 * 1024;
+	//Size of each of the transform buffer's staging segments. Fits 4096 slot uploads before we move to the next one.
+	static constexpr size_t g_TransformStagingSegmentSize = 512 * 1024;
+
+	//Shadow casters share tiles of an atlas of up to this size, which holds four 2048 cascades at most.
+	static constexpr uint32_t g_MaximumShadowAtlasResolution = 4096;
+	static constexpr uint32_t g_MaximumShadowTileSize = 2048;
+	static_assert(g_MaximumShadowCasters * g_MaximumShadowCascades * g_MinimumShadowTileSize * g_MinimumShadowTileSize <= g_MaximumShadowAtlasResolution * g_MaximumShadowAtlasResolution,
+		"Every shadow caster's cascades must fit the atlas at the minimum tile size.");
+	//Dimmer shadow casters get proportionally smaller tiles than the brightest one, down to this fraction of its resolution.
+	static constexpr float g_MinimumShadowImportance = 0.25f;
+
+	//Uniforms we set every frame, hashed at compile time.
+	static constexpr UniformHandle g_LightSpaceProjectionUniform = "lightSpaceProjection";
+	static constexpr UniformHandle g_LightSpaceViewUniform = "lightSpaceView";
+	static constexpr UniformHandle g_LightDirectionUniform = "lightDirection";
+	static constexpr UniformHandle g_LightColorUniform = "lightColor";
+	static constexpr UniformHandle g_LightCascadeViewProjectionsUniform = "lightCascadeViewProjections";
+	static constexpr UniformHandle g_LightCascadeSplitsUniform = "lightCascadeSplits";
+	static constexpr UniformHandle g_LightCascadeBiasesUniform = "lightCascadeBiases";
+	static constexpr UniformHandle g_LightCascadeAtlasBoundsUniform = "lightCascadeAtlasBounds";
+	static constexpr UniformHandle g_LightCascadeCountUniform = "lightCascadeCount";
+	static constexpr UniformHandle g_LightCascadeBlendFractionUniform = "lightCascadeBlendFraction";
+	static constexpr UniformHandle g_LightMeshScaleUniform = "lightMeshScale";
+	static constexpr UniformHandle g_LightIntensityScaleUniform = "lightIntensityScale";
+	static constexpr UniformHandle g_SSAOUniform = "SSAO";
+	static constexpr UniformHandle g_GreyscaleEnabledUniform = "GreyscaleEnabled";
+	static constexpr UniformHandle g_InverseEnabledUniform = "InverseEnabled";
+
 	Renderer::Renderer()
 	{
 	}
 
 	Renderer::~Renderer()
 	{
+		delete m_RenderWorld;
 		delete m_RenderQueue;
 		delete m_NDCQuad;
 		delete m_MaterialLibrary;
 		delete m_GBuffer;
 		delete m_CustomRenderTarget;
 
-		for (int i = 0; i < m_ShadowRenderTargets.size(); i++)
+		//Cascades release their tiles into the atlas.
+		for (int i = 0; i < m_ShadowCascades.size(); i++)
 		{
-			delete m_ShadowRenderTargets[i];
+			delete m_ShadowCascades[i];
 		}
+		delete m_ShadowAtlas;
 
 		delete m_DebugLightMesh;
 		delete m_PostProcessRenderTarget;
+		glDeleteBuffers(1, &m_InstanceBufferID);
+		glDeleteBuffers(1, &m_IndirectBufferID);
+		glDeleteBuffers(1, &m_GlobalUniformBufferID);
+		delete m_DrawUniformBuffer;
+		delete m_TransformBuffer;
+		delete m_PointLightBuffer;
+		delete m_LightClusters;
+		delete m_MaterialParameterBuffer;
+		delete m_GeometryPool;
 		delete m_PostProcessor;
 		delete m_PBR;
 	}
@@ -77,6 +129,8 @@ namespace Crescent
 
 		//Core Systems
 		m_RenderQueue = new RenderQueue(this);
+		m_RenderWorld = new RenderWorld(m_RenderQueue);
+		m_GeometryPool = new GeometryPool();
 		m_MaterialLibrary = new MaterialLibrary(m_GBuffer);
 
 		//Render Targets
@@ -87,24 +141,32 @@ namespace Crescent
 		m_PostProcessor = new PostProcessor(this);
 
 		//Shadows
-		for (int i = 0; i < 4; i++) //Allow for up to a total of 4 directional/spot shadow casters.
+		m_ShadowAtlas = new ShadowAtlas(g_MaximumShadowAtlasResolution, g_MinimumShadowTileSize, g_MaximumShadowTileSize);
+		for (int i = 0; i < g_MaximumShadowCasters; i++) //Allow for up to a total of 4 directional shadow casters.
 		{
-			RenderTarget* renderTarget = new RenderTarget(2048, 2048, GL_UNSIGNED_BYTE, 1, true);
-			renderTarget->m_DepthAndStencilAttachment.BindTexture();
-
-			renderTarget->m_DepthAndStencilAttachment.SetMinificationFilter(GL_NEAREST);
-			renderTarget->m_DepthAndStencilAttachment.SetMagnificationFilter(GL_NEAREST);
-			renderTarget->m_DepthAndStencilAttachment.SetWrappingMode(GL_CLAMP_TO_BORDER);
-
-			float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
-			glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
-			m_ShadowRenderTargets.push_back(renderTarget);
+			m_ShadowCascades.push_back(new ShadowCascades(m_ShadowAtlas));
 		}
 
+		//Instancing
+		glGenBuffers(1, &m_InstanceBufferID);
+		glGenBuffers(1, &m_IndirectBufferID);
+
 		//Cubemap
 		glGenFramebuffers(1, &m_CubemapFramebufferID);
 		glGenRenderbuffers(1, &m_CubemapDepthRenderbufferID);
 
+		//Global Uniform Buffer Object - Needed before any command is rendered, including our PBR pre-computes below.
+		glGenBuffers(1, &m_GlobalUniformBufferID);
+		glBindBuffer(GL_UNIFORM_BUFFER, m_GlobalUniformBufferID);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniformBlock), nullptr, GL_DYNAMIC_DRAW);
+		glBindBufferBase(GL_UNIFORM_BUFFER, UniformBlock_Frame, m_GlobalUniformBufferID);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		m_DrawUniformBuffer = new UniformRingBuffer(g_DrawUniformSegmentSize);
+		m_TransformBuffer = new TransformBuffer(g_TransformStagingSegmentSize);
+		m_MaterialParameterBuffer = new MaterialParameterBuffer();
+		m_PointLightBuffer = new PointLightBuffer();
+		m_LightClusters = new LightClusters();
+
 		m_PBR = new PBR(this);
 
 		//Default PBR Pre-Compute (Get a more default oriented HDR map for this).
@@ -112,49 +174,96 @@ namespace Crescent
 		Texture* milkyWayMap = Resources::LoadHDRTexture("Sky Environment", "Resources/Skybox/AlleyWay/Alley.hdr");
 		EnvironmentalPBR* environmentalCapture = m_PBR->ProcessEquirectangularMap(milkyWayMap);
 		SetSkyCapture(environmentalCapture);
-
-		//Global Uniform Buffer Object
-		//glGenBuffers(1, &m_GlobalUniformBufferID);
-		//glBindBuffer(GL_UNIFORM_BUFFER, m_GlobalUniformBufferID);
-		//glBufferData(GL_UNIFORM_BUFFER, 720, nullptr, GL_STREAM_DRAW);
-		//glBindBufferBase(GL_UNIFORM_BUFFER, 0, m_GlobalUniformBufferID);
 	}
 
-	void Renderer::PushToRenderQueue(SceneEntity* sceneEntity)
+	void Renderer::PushMeshRenderers()
 	{
-		//Update transform before pushing node to render command buffer.
-		sceneEntity->UpdateEntityTransform(true);
+		//Only renderables changed or moved since last frame touch their proxies. Everything else is submitted exactly as it was.
+		m_RenderWorld->SynchronizeProxies();
 
-		std::stack<SceneEntity*> nodeStack;
-		nodeStack.push(sceneEntity);
-		for (unsigned int i = 0; i < sceneEntity->RetrieveChildCount(); i++)
+		//Our proxies' matrices stay on the GPU, so only the slots they created or moved are uploaded.
+		m_TransformBuffer->ReserveSlots(m_RenderWorld->RetrieveTransformSlotCount());
+		for (uint32_t transformSlot : m_RenderWorld->RetrieveDirtyTransformSlots())
 		{
-			nodeStack.push(sceneEntity->RetrieveChildByIndex(i));
+			m_TransformBuffer->WriteSlot(transformSlot, m_RenderWorld->RetrieveSlotTransform(transformSlot));
 		}
+		m_RenderWorld->ClearDirtyTransformSlots();
 
-		while (!nodeStack.empty())
+		if (m_SpatialTree && m_FrustumCullingEnabled)
 		{
-			SceneEntity* node = nodeStack.top();
-			nodeStack.pop();
-			if (node->m_Mesh)
-			{
-				m_RenderQueue->PushToRenderQueue(node->m_Mesh, node->m_Material, node->RetrieveEntityTransform());
-			}
+			//Only entities the tree finds in a frustum we render are submitted at all. The passes still cull these per command against their own frustum.
+			CollectVisibleProxies();
+			m_RenderWorld->SubmitVisibleProxies(m_SpatialTree, &m_VisibleProxies);
+		}
+		else
+		{
+			m_RenderWorld->SubmitVisibleProxies(nullptr, nullptr);
+		}
+	}
+
+	void Renderer::CollectVisibleProxies()
+	{
+		m_VisibleProxies.clear();
+		auto addProxy = [this](uint32_t proxyIndex) { m_VisibleProxies.push_back(proxyIndex); };
 
-			for (unsigned int i = 0; i < node->RetrieveChildCount(); i++)
+		m_SpatialTree->QueryFrustum(Frustum(m_Camera->m_ProjectionMatrix * m_Camera->m_ViewMatrix), addProxy);
+
+		//Casters outside of our view can still throw shadows into it, so each shadow casting light's frustum is gathered as well.
+		if (m_ShadowsEnabled)
+		{
+			for (const LightComponent& lightComponent : ComponentStorage::RetrieveLights().RetrieveComponents())
 			{
-				nodeStack.push(node->RetrieveChildByIndex(i));
+				if (lightComponent.m_DirectionalLight && lightComponent.m_DirectionalLight->m_ShadowCastingEnabled)
+				{
+					//The same fit the shadow pass makes, as cascades only depend on the camera and the light's direction.
+					ShadowCascade shadowCascades[g_MaximumShadowCascades];
+					const uint32_t cascadeCount = ShadowCascades::FitCascades(*m_Camera, lightComponent.m_DirectionalLight->m_LightDirection, m_ShadowCascadeSettings, shadowCascades);
+					for (uint32_t i = 0; i < cascadeCount; i++)
+					{
+						m_SpatialTree->QueryFrustum(Frustum(shadowCascades[i].m_ViewProjection), addProxy);
+					}
+				}
 			}
 		}
+
+		//Entities within several frustums were found once per frustum.
+		std::sort(m_VisibleProxies.begin(), m_VisibleProxies.end());
+		m_VisibleProxies.erase(std::unique(m_VisibleProxies.begin(), m_VisibleProxies.end()), m_VisibleProxies.end());
+	}
+
+	void Renderer::PushToRenderQueue(Mesh* mesh, Material* material, const glm::mat4& transform, bool frustumCullingEnabled)
+	{
+		m_RenderQueue->SubmitRenderCommand(m_RenderQueue->BuildRenderCommand(mesh, material, transform, frustumCullingEnabled));
 	}
 
 	//Attach shader to material.
 	void Renderer::RenderAllQueueItems()
 	{
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		m_RenderStatistics = RenderStatistics();
+		m_RenderStatistics.m_RenderProxies = m_RenderWorld->RetrieveProxyCount();
+		m_RenderStatistics.m_RebuiltProxies = m_RenderWorld->RetrieveRebuiltProxyCount();
+		m_RenderStatistics.m_MovedProxies = m_RenderWorld->RetrieveMovedProxyCount();
+		ResetBoundDrawState();
+		CollectLightSources();
+
+		//Sort all queued commands by their sort keys, grouping them by shader, material and mesh.
+		double sortStartTime = glfwGetTime();
+		m_RenderQueue->SortRenderCommands();
+		m_RenderStatistics.m_SortTime = (float)((glfwGetTime() - sortStartTime) * 1000.0);
+
+		//Commands pushed straight to the queue have no proxy, so they borrow a slot for this frame. From here on, every queued command draws from the transform buffer.
+		m_RenderQueue->ForEachQueuedCommand([this](RenderCommand& renderCommand)
+		{
+			if (renderCommand.m_TransformSlot == g_NullTransformSlot)
+			{
+				renderCommand.m_TransformSlot = m_TransformBuffer->WriteTransientSlot(renderCommand.m_Transform);
+			}
+		});
+		m_TransformBuffer->FlushUploads();
 
 		//Update Global Uniform Buffer Object
-		UpdateGlobalUniformBufferObjects();
+		UpdateGlobalUniformBufferObjects(m_Camera);
 
 		//Set default OpenGL state.
 		m_GLStateCache->ToggleBlending(false);
@@ -164,7 +273,9 @@ namespace Crescent
 		m_GLStateCache->SetDepthFunction(GL_LESS);
 		
 		//1) Geometry Buffer
-		std::vector<RenderCommand> deferredRenderCommands = m_RenderQueue->RetrieveDeferredRenderingCommands();
+		RenderCommandList deferredRenderCommands = m_RenderQueue->RetrieveDeferredRenderingCommands(m_FrustumCullingEnabled);
+		m_RenderStatistics.m_GeometryPassCulling.m_VisibleCount = deferredRenderCommands.size();
+		m_RenderStatistics.m_GeometryPassCulling.m_CulledCount = m_RenderQueue->RetrieveDeferredRenderingCommands().size() - deferredRenderCommands.size();
 		glViewport(0, 0, m_RenderWindowSize.x, m_RenderWindowSize.y);
 		glBindFramebuffer(GL_FRAMEBUFFER, m_GBuffer->m_FramebufferID);
 		unsigned int attachments[4] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3 };
@@ -172,11 +283,28 @@ namespace Crescent
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 		m_GLStateCache->SetPolygonMode(m_WireframesEnabled ? GL_LINE : GL_FILL);
 
-		for (int i = 0; i < deferredRenderCommands.size(); i++)
+		BuildGeometryBatches(deferredRenderCommands, true);
+		for (const GeometryBatch& geometryBatch : m_GeometryBatches)
 		{
-			RenderCustomCommand(&deferredRenderCommands[i], nullptr, false);
+			RenderCommand* renderCommand = &deferredRenderCommands[geometryBatch.m_CommandIndex];
+			switch (geometryBatch.m_BatchType)
+			{
+			case GeometryBatch_MultiDraw:
+				RenderMultiDrawCommand(renderCommand, geometryBatch);
+				break;
+			case GeometryBatch_Instanced:
+				RenderInstancedCommand(renderCommand, geometryBatch.m_CommandCount, geometryBatch.m_InstanceOffset);
+				break;
+			default:
+				for (uint32_t j = 0; j < geometryBatch.m_CommandCount; j++)
+				{
+					RenderCustomCommand(&renderCommand[j], nullptr, false);
+				}
+				break;
+			}
 		}
 		m_GLStateCache->SetPolygonMode(GL_FILL);
+		ResetBoundDrawState();
 
 		//Disable for next pass (shadow map generation).
 		attachments[1] = GL_NONE;
@@ -185,39 +313,106 @@ namespace Crescent
 		glDrawBuffers(4, attachments);
 
 		//2) Render All Shadow Casters to Light Shadow Buffers
+		for (DirectionalLight* directionalLight : m_DirectionalLights)
+		{
+			directionalLight->m_ShadowCascades = nullptr;
+		}
+
 		if (m_ShadowsEnabled)
 		{
 			m_GLStateCache->SetCulledFace(GL_FRONT);
-			std::vector<RenderCommand> shadowRenderCommands = m_RenderQueue->RetrieveShadowCastingRenderCommands();
+			RenderCommandList shadowRenderCommands;
+			RenderCommandList staticShadowCommands;
+			RenderCommandList dynamicShadowCommands;
+			if (m_ShadowCachingEnabled)
+			{
+				staticShadowCommands = m_RenderQueue->RetrieveShadowCastingRenderCommands(ShadowCaster_Static);
+				dynamicShadowCommands = m_RenderQueue->RetrieveShadowCastingRenderCommands(ShadowCaster_Dynamic);
+			}
+			else
+			{
+				shadowRenderCommands = m_RenderQueue->RetrieveShadowCastingRenderCommands();
+			}
+			const uint64_t staticGeometryVersion = m_RenderWorld->RetrieveStaticGeometryVersion();
 
-			unsigned int shadowRenderTargetIndex = 0;
+			float brightestShadowCaster = 0.0f;
+			for (DirectionalLight* directionalLight : m_DirectionalLights)
+			{
+				if (directionalLight->m_ShadowCastingEnabled)
+				{
+					brightestShadowCaster = std::max(brightestShadowCaster, directionalLight->m_LightIntensity);
+				}
+			}
+
+			//Every caster's cascades are fitted first, so that the atlas can size and place all of their tiles at once.
+			unsigned int shadowCasterCount = 0;
+			m_ShadowTileRequests.clear();
 			for (int i = 0; i < m_DirectionalLights.size(); i++) //We usually have 1 directional light source.
 			{
 				DirectionalLight* directionalLight = m_DirectionalLights[i];
-				if (directionalLight->m_ShadowCastingEnabled)
+				if (!directionalLight->m_ShadowCastingEnabled || shadowCasterCount == m_ShadowCascades.size())
 				{
-					m_MaterialLibrary->m_DirectionalShadowShader->UseShader();
+					continue;
+				}
+
+				ShadowCascades* shadowCascades = m_ShadowCascades[shadowCasterCount++];
+				shadowCascades->UpdateCascades(*m_Camera, directionalLight->m_LightDirection, m_ShadowCascadeSettings);
+				directionalLight->m_ShadowCascades = shadowCascades;
+
+				const float lightImportance = brightestShadowCaster > 0.0f ? std::sqrt(directionalLight->m_LightIntensity / brightestShadowCaster) : 1.0f;
+				const float resolutionScale = m_ShadowCascadeSettings.m_ResolutionScale * std::max(lightImportance, g_MinimumShadowImportance);
+				shadowCascades->RequestTiles(*m_Camera, m_RenderWindowSize.y, resolutionScale, m_ShadowTileRequests);
+			}
+			for (unsigned int i = shadowCasterCount; i < m_ShadowCascades.size(); i++)
+			{
+				m_ShadowCascades[i]->ReleaseTiles();
+			}
+			m_ShadowAtlas->UpdateTiles(m_ShadowTileRequests);
 
-					glBindFramebuffer(GL_FRAMEBUFFER, m_ShadowRenderTargets[shadowRenderTargetIndex]->m_FramebufferID);
-					glViewport(0, 0, m_ShadowRenderTargets[shadowRenderTargetIndex]->m_FramebufferWidth, m_ShadowRenderTargets[shadowRenderTargetIndex]->m_FramebufferHeight);
-					glClear(GL_DEPTH_BUFFER_BIT);
+			for (unsigned int shadowCasterIndex = 0; shadowCasterIndex < shadowCasterCount; shadowCasterIndex++)
+			{
+				ShadowCascades* shadowCascades = m_ShadowCascades[shadowCasterIndex];
+				shadowCascades->ApplyTiles();
 
-					glm::mat4 lightProjectionMatrix = glm::ortho(-20.0f, 20.0f, -20.0f, 20.0f, -15.0f, 20.0f);
-					glm::mat4 lightViewMatrix = glm::lookAt(-directionalLight->m_LightDirection * 10.0f, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+				for (uint32_t cascadeIndex = 0; cascadeIndex < shadowCascades->RetrieveCascadeCount(); cascadeIndex++)
+				{
+					const ShadowCascade& shadowCascade = shadowCascades->RetrieveCascade(cascadeIndex);
+					if (!m_ShadowCachingEnabled)
+					{
+						shadowCascades->BindCascadeTarget(cascadeIndex);
+						RenderShadowCasters(shadowRenderCommands, shadowCascade);
+						continue;
+					}
 
-					m_DirectionalLights[i]->m_LightSpaceViewProjectionMatrix = lightProjectionMatrix * lightViewMatrix;
-					m_DirectionalLights[i]->m_ShadowMapRenderTarget = m_ShadowRenderTargets[shadowRenderTargetIndex];
+					//Static casters are only drawn when the light, the cascade's fit or the static geometry has changed since they were cached.
+					if (shadowCascades->IsStaticCacheCurrent(cascadeIndex, staticGeometryVersion))
+					{
+						m_RenderStatistics.m_CachedShadowCascades++;
+					}
+					else
+					{
+						shadowCascades->BindStaticCacheTarget(cascadeIndex, staticGeometryVersion);
+						RenderShadowCasters(staticShadowCommands, shadowCascade);
+						m_RenderStatistics.m_RedrawnShadowCascades++;
+					}
 
-					//This varies based on the amount of objects in our scene that can cast shadows on objects. This filtered whenever we submit commands into the render queue.
-					//By default, all physical objects in the scene can cast and receive shadows.
-					for (int j = 0; j < shadowRenderCommands.size(); j++) 
+					//Dynamic casters are drawn over a fresh copy of the cache. Without any, a tile still holding last frame's copy is left as it is.
+					if (dynamicShadowCommands.empty() && shadowCascades->IsStaticCacheRestored(cascadeIndex))
+					{
+						continue;
+					}
+					shadowCascades->RestoreStaticCache(cascadeIndex);
+					if (!dynamicShadowCommands.empty())
 					{
-						RenderShadowCastCommand(&shadowRenderCommands[j], lightProjectionMatrix, lightViewMatrix);
+						shadowCascades->BindCascadeTarget(cascadeIndex, false);
+						RenderShadowCasters(dynamicShadowCommands, shadowCascade);
 					}
-					shadowRenderTargetIndex++;
 				}
 			}
 			m_GLStateCache->SetCulledFace(GL_BACK);
+
+			//Later passes sample the shadow maps we just rendered.
+			UpdateGlobalUniformBufferObjects(m_Camera);
 		}
 		attachments[0] = GL_COLOR_ATTACHMENT0;
 		glDrawBuffers(4, attachments);
@@ -250,14 +445,32 @@ namespace Crescent
 				RenderDeferredDirectionalLight(*iterator);
 			}
 			
-			//Point Lights
-			m_GLStateCache->SetCulledFace(GL_FRONT);
+			//Point Lights - Lights whose volumes are entirely outside of our view can't contribute to any visible pixel.
+			Frustum cameraFrustum(m_Camera->m_ProjectionMatrix * m_Camera->m_ViewMatrix);
+			m_VisiblePointLights.clear();
 			for (auto iterator = m_PointLights.begin(); iterator != m_PointLights.end(); iterator++) //Remember that our objects are stored as pointers, thus the dereference.
 			{
-				///Frustrum Check.
-				RenderDeferredPointLight(*iterator);
+				//Lights touching no geometry at all have nothing to shade.
+				if (m_FrustumCullingEnabled && (!cameraFrustum.IsSphereVisible((*iterator)->m_LightPosition, (*iterator)->m_LightRadius) ||
+					(m_SpatialTree && !m_SpatialTree->OverlapsSphere((*iterator)->m_LightPosition, (*iterator)->m_LightRadius))))
+				{
+					m_RenderStatistics.m_PointLightCulling.m_CulledCount++;
+					continue;
+				}
+
+				m_RenderStatistics.m_PointLightCulling.m_VisibleCount++;
+				m_VisiblePointLights.push_back(*iterator);
+			}
+
+			//Our clusters slice depth exponentially, which an orthographic projection has no use for.
+			if (m_ClusteredShadingEnabled && m_Camera->m_IsPerspectiveCamera)
+			{
+				RenderClusteredPointLights();
+			}
+			else
+			{
+				RenderDeferredPointLights();
 			}
-			m_GLStateCache->SetCulledFace(GL_BACK);
 		}
 
 		m_GLStateCache->ToggleDepthTesting(true);
@@ -295,9 +508,15 @@ namespace Crescent
 				glBindFramebuffer(GL_FRAMEBUFFER, m_CustomRenderTarget->m_FramebufferID);
 				m_Camera->SetPerspectiveMatrix(m_Camera->m_FieldOfView, m_RenderWindowSize.x / m_RenderWindowSize.y, 0.1f, 100.0f);
 			}
+			ResetBoundDrawState(); //Our camera's projection may have changed.
 
 			///Render custom commands here. (Things with custom material). By default, we will have 1 for the sky.
-			std::vector<RenderCommand> renderCommands = m_RenderQueue->RetrieveCustomRenderCommands(renderTarget);
+			RenderCommandList renderCommands = m_RenderQueue->RetrieveCustomRenderCommands(renderTarget, m_FrustumCullingEnabled);
+			if (!renderTarget)
+			{
+				m_RenderStatistics.m_ForwardPassCulling.m_VisibleCount += renderCommands.size();
+				m_RenderStatistics.m_ForwardPassCulling.m_CulledCount += m_RenderQueue->RetrieveCustomRenderCommands(renderTarget).size() - renderCommands.size();
+			}
 
 			//Iterate over all render commands and execute.
 			m_GLStateCache->SetPolygonMode(m_WireframesEnabled ? GL_LINE : GL_FILL);
@@ -308,61 +527,54 @@ namespace Crescent
 			m_GLStateCache->SetPolygonMode(GL_FILL);
 		}
 
-		//7) Alpha Material Pass
-		//glViewport(0, 0, m_RenderWindowSize.x, m_RenderWindowSize.y);
-		//glBindFramebuffer(GL_FRAMEBUFFER, m_CustomRenderTarget->m_FramebufferID);
-		///Alpha Render Commands Here.
+		//7) Alpha Material Pass - Sorted back-to-front by their sort keys.
+		glViewport(0, 0, m_RenderWindowSize.x, m_RenderWindowSize.y);
+		glBindFramebuffer(GL_FRAMEBUFFER, m_CustomRenderTarget->m_FramebufferID);
+		ResetBoundDrawState();
+
+		RenderCommandList alphaRenderCommands = m_RenderQueue->RetrieveAlphaRenderCommands();
+		for (unsigned int i = 0; i < alphaRenderCommands.size(); i++)
+		{
+			RenderCustomCommand(&alphaRenderCommands[i], nullptr);
+		}
 
 		//Render Light Mesh (as visual cue), if requested.
+		m_DebugPointLights.clear();
 		for (auto iterator = m_PointLights.begin(); iterator != m_PointLights.end(); iterator++)
 		{
 			if ((*iterator)->m_RenderMesh)
 			{
-				m_MaterialLibrary->m_DebugLightMaterial->SetShaderVector3("lightColor", (*iterator)->m_LightColor * (*iterator)->m_LightIntensity * 0.25f);
-			
-				RenderCommand renderCommand;
-				renderCommand.m_Material = m_MaterialLibrary->m_DebugLightMaterial;
-				renderCommand.m_Mesh = m_DebugLightMesh;
-
-				glm::mat4 lightModelMatrix = glm::mat4(1.0f); //Not the light space matrix. Just our model matrix for the light itself.
-				lightModelMatrix = glm::translate(lightModelMatrix, (*iterator)->m_LightPosition);
-				lightModelMatrix = glm::scale(lightModelMatrix, glm::vec3(0.25f));
-				renderCommand.m_Transform = lightModelMatrix;
-
-				RenderCustomCommand(&renderCommand, nullptr);
+				m_DebugPointLights.push_back(*iterator);
 			}
 		}
 
+		if (!m_DebugPointLights.empty())
+		{
+			m_GLStateCache->ToggleBlending(false);
+			m_GLStateCache->ToggleDepthTesting(true);
+			m_GLStateCache->SetDepthFunction(GL_LESS);
+			m_GLStateCache->ToggleFaceCulling(true);
+			m_GLStateCache->SetCulledFace(GL_BACK);
+			RenderDebugPointLights(m_DebugPointLights, 0.25f, 0.25f);
+		}
+
 		//8) Pody-Processing Stage after all lighting calculations.
 
 		//9) Render Debug Visuals
 		glViewport(0, 0, m_RenderWindowSize.x, m_RenderWindowSize.y);
 		glBindFramebuffer(GL_FRAMEBUFFER, m_CustomRenderTarget->m_FramebufferID);
+		ResetBoundDrawState();
 		if (m_ShowDebugLightVolumes)
 		{
 			m_GLStateCache->SetPolygonMode(GL_LINE);
 			m_GLStateCache->SetCulledFace(GL_FRONT);
-			for (auto iterator = m_PointLights.begin(); iterator != m_PointLights.end(); iterator++)
-			{
-				m_MaterialLibrary->m_DebugLightMaterial->SetShaderVector3("lightColor", (*iterator)->m_LightColor);
-
-				RenderCommand renderCommand;
-				renderCommand.m_Material = m_MaterialLibrary->m_DebugLightMaterial;
-				renderCommand.m_Mesh = m_DebugLightMesh;
-
-				glm::mat4 lightDebugModelMatrix = glm::mat4(1.0f); //Not the light space matrix. Just our model matrix for the light debug mesh itself.
-				lightDebugModelMatrix = glm::translate(lightDebugModelMatrix, (*iterator)->m_LightPosition);
-				lightDebugModelMatrix = glm::scale(lightDebugModelMatrix, glm::vec3((*iterator)->m_LightRadius));
-				renderCommand.m_Transform = lightDebugModelMatrix;
-
-				RenderCustomCommand(&renderCommand, nullptr);
-			}
+			RenderDebugPointLights(m_PointLights, 0.0f, 0.0f); //Scaled to each light's volume, in its bare color.
 			m_GLStateCache->SetPolygonMode(GL_FILL);
 			m_GLStateCache->SetCulledFace(GL_BACK);
 		}
 
 		//10) Custom Post Processing Pass
-		std::vector<RenderCommand> postProcessingCommands = m_RenderQueue->RetrievePostProcessingRenderCommands();
+		RenderCommandList postProcessingCommands = m_RenderQueue->RetrievePostProcessingRenderCommands();
 		for (unsigned int i = 0; i < postProcessingCommands.size(); i++)
 		{
 			//Ping Pong
@@ -374,7 +586,12 @@ namespace Crescent
 		//11) Finally, Blit everything to our framebuffer for rendering.
 		BlitToMainFramebuffer(postProcessingCommands.size() % 2 == 0 ? m_CustomRenderTarget->RetrieveColorAttachment(0) : m_PostProcessRenderTarget->RetrieveColorAttachment(0));
 
+		m_RenderStatistics.m_QueueHeapAllocations = m_RenderQueue->RetrieveHeapAllocationCount();
+		m_RenderStatistics.m_QueueFrameMemory = m_RenderQueue->RetrieveFrameMemoryUsage();
 		m_RenderQueue->ClearQueuedCommands();
+		m_RenderStatistics.m_TransformUploads = m_TransformBuffer->RetrieveUploadedSlotCount();
+		m_DrawUniformBuffer->EndFrame();
+		m_TransformBuffer->EndFrame();
 		m_RenderTargetsCustom.clear();
 
 		glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -392,9 +609,9 @@ namespace Crescent
 		m_GBuffer->RetrieveColorAttachment(3)->BindTexture(5);
 
 		m_PostProcessor->m_PostProcessingShader->UseShader();
-		m_PostProcessor->m_PostProcessingShader->SetUniformBool("SSAO", true);
-		m_PostProcessor->m_PostProcessingShader->SetUniformBool("GreyscaleEnabled", m_PostProcessor->m_GreyscaleEnabled);
-		m_PostProcessor->m_PostProcessingShader->SetUniformBool("InverseEnabled", m_PostProcessor->m_InversionEnabled);
+		m_PostProcessor->m_PostProcessingShader->SetUniformBool(g_SSAOUniform, true);
+		m_PostProcessor->m_PostProcessingShader->SetUniformBool(g_GreyscaleEnabledUniform, m_PostProcessor->m_GreyscaleEnabled);
+		m_PostProcessor->m_PostProcessingShader->SetUniformBool(g_InverseEnabledUniform, m_PostProcessor->m_InversionEnabled);
 
 		RenderMesh(m_NDCQuad);
 	}
@@ -432,24 +649,25 @@ namespace Crescent
 		{
 			material->SetShaderTexture(textureUniformName, textureSource, 0);
 		}
-		//Render screen-space material to Quad which will be displayed in the destination's buffers.
+		//Render screen-space material to Quad which will be displayed in the destination's buffers. Its input textures may have been bound over since our last draw.
+		ResetBoundDrawState();
 		RenderCommand renderCommand;
 		renderCommand.m_Material = material;
 		renderCommand.m_Mesh = m_NDCQuad;
 		RenderCustomCommand(&renderCommand, nullptr);
 	}
 
-	void Renderer::RenderCubemap(SceneEntity* sceneEntity, TextureCube* cubemapTarget, glm::vec3 position, unsigned int mipmappingLevel)
+	void Renderer::RenderCubemap(Mesh* mesh, Material* material, TextureCube* cubemapTarget, glm::vec3 position, unsigned int mipmappingLevel)
 	{
-		//We create a render queue just for this operation as to not conflict with our main command buffer. Rendering a cubemap in PBR is after all a chain of commands in itself.
-		RenderQueue renderQueue(this);
-		renderQueue.PushToRenderQueue(sceneEntity->m_Mesh, sceneEntity->m_Material, sceneEntity->RetrieveEntityTransform());
+		//We build the command locally as to not conflict with our main command buffer. Rendering a cubemap in PBR is after all a chain of commands in itself.
+		RenderCommand renderCommand;
+		renderCommand.m_Mesh = mesh;
+		renderCommand.m_Material = material;
 
-		std::vector<RenderCommand> renderCommands = renderQueue.RetrieveCustomRenderCommands(nullptr);
-		RenderCubemap(renderCommands, cubemapTarget, position, mipmappingLevel);
+		RenderCubemap(RenderCommandList(&renderCommand, 1), cubemapTarget, position, mipmappingLevel);
 	}
 
-	void Renderer::RenderCubemap(std::vector<RenderCommand>& renderCommands, TextureCube* cubeTarget, glm::vec3 position, unsigned int mipmappingLevel)
+	void Renderer::RenderCubemap(const RenderCommandList& renderCommands, TextureCube* cubeTarget, glm::vec3 position, unsigned int mipmappingLevel)
 	{
 		//Define 6 camera directions/lookup vectors.
 		Camera faceCameras[6] =
@@ -481,6 +699,7 @@ namespace Crescent
 			camera->m_ProjectionMatrix = glm::perspective(glm::radians(90.0f), width / height, 0.1f, 100.0f);
 			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, cubeTarget->m_TextureCubeID, mipmappingLevel);
 			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			ResetBoundDrawState();
 
 			for (unsigned int i = 0; i < renderCommands.size(); i++)
 			{
@@ -494,35 +713,109 @@ namespace Crescent
 		}
 	}
 
+	//Sets the light's matrices on both of our shadow casting shaders, so individual commands only have to stream their transform slot.
+	void Renderer::BindShadowCastLightState(const glm::mat4& lightSpaceProjectionMatrix, const glm::mat4& lightSpaceViewMatrix)
+	{
+		Shader* shadowShaders[2] = { m_MaterialLibrary->m_DirectionalShadowShader, m_MaterialLibrary->m_DirectionalShadowInstancedShader };
+		for (Shader* shadowShader : shadowShaders)
+		{
+			shadowShader->UseShader();
+			shadowShader->SetUniformMat4(g_LightSpaceProjectionUniform, lightSpaceProjectionMatrix);
+			shadowShader->SetUniformMat4(g_LightSpaceViewUniform, lightSpaceViewMatrix);
+		}
+	}
+
 	//Renders from the light's point of view. 
-	void Renderer::RenderShadowCastCommand(RenderCommand* renderCommand, const glm::mat4& lightSpaceProjectionMatrix, const glm::mat4& lightSpaceViewMatrix)
+	void Renderer::RenderShadowCasters(const RenderCommandList& shadowRenderCommands, const ShadowCascade& shadowCascade)
 	{
-		Shader* shadowShader = m_MaterialLibrary->m_DirectionalShadowShader;
+		BindShadowCastLightState(shadowCascade.m_Projection, shadowCascade.m_View);
+
+		//This varies based on the amount of objects in our scene that can cast shadows on objects. This filtered whenever we submit commands into the render queue.
+		//By default, all physical objects in the scene can cast and receive shadows. Casters outside of the cascade's bounds can't land in its layer.
+		RenderCommandList visibleShadowCommands = shadowRenderCommands;
+		if (m_FrustumCullingEnabled)
+		{
+			visibleShadowCommands = m_RenderQueue->CullRenderCommands(shadowRenderCommands, Frustum(shadowCascade.m_ViewProjection));
+		}
+		m_RenderStatistics.m_ShadowPassCulling.m_VisibleCount += visibleShadowCommands.size();
+		m_RenderStatistics.m_ShadowPassCulling.m_CulledCount += shadowRenderCommands.size() - visibleShadowCommands.size();
+
+		//Only the mesh matters for depth, so shadow casters are batched regardless of their material.
+		BuildGeometryBatches(visibleShadowCommands, false);
+		for (const GeometryBatch& geometryBatch : m_GeometryBatches)
+		{
+			RenderCommand* renderCommand = &visibleShadowCommands[geometryBatch.m_CommandIndex];
+			switch (geometryBatch.m_BatchType)
+			{
+			case GeometryBatch_MultiDraw:
+				RenderShadowCastMultiDrawCommand(geometryBatch);
+				break;
+			case GeometryBatch_Instanced:
+				RenderShadowCastInstancedCommand(renderCommand, geometryBatch.m_CommandCount, geometryBatch.m_InstanceOffset);
+				break;
+			default:
+				for (uint32_t k = 0; k < geometryBatch.m_CommandCount; k++)
+				{
+					RenderShadowCastCommand(&renderCommand[k]);
+				}
+				break;
+			}
+		}
+	}
 
-		shadowShader->UseShader();
-		shadowShader->SetUniformMat4("lightSpaceProjection", lightSpaceProjectionMatrix);
-		shadowShader->SetUniformMat4("lightSpaceView", lightSpaceViewMatrix);
-		shadowShader->SetUniformMat4("model", renderCommand->m_Transform);
+	void Renderer::RenderShadowCastCommand(RenderCommand* renderCommand)
+	{
+		m_MaterialLibrary->m_DirectionalShadowShader->UseShader();
+		BindDrawUniforms(renderCommand->m_Transform, renderCommand->m_TransformSlot);
 
 		RenderMesh(renderCommand->m_Mesh);
 	}
 
+	void Renderer::RenderShadowCastInstancedCommand(RenderCommand* renderCommand, uint32_t instanceCount, uint32_t instanceOffset)
+	{
+		m_MaterialLibrary->m_DirectionalShadowInstancedShader->UseShader();
+		RenderMeshInstanced(renderCommand->m_Mesh, instanceCount, instanceOffset);
+	}
+
+	void Renderer::RenderShadowCastMultiDrawCommand(const GeometryBatch& geometryBatch)
+	{
+		m_MaterialLibrary->m_DirectionalShadowInstancedShader->UseShader();
+		RenderGeometryPageIndirect(geometryBatch);
+	}
+
 	void Renderer::RenderDeferredDirectionalLight(DirectionalLight* directionalLight)
 	{
-		//We also have to update the global uniform buffer for this.
+		//The camera and shadow toggle come from the global uniform buffer.
 		Shader* directionalShader = m_MaterialLibrary->m_DeferredDirectionalLightShader;
 
 		directionalShader->UseShader();
-		directionalShader->SetUniformVector3("cameraPosition", m_Camera->m_CameraPosition);
-		directionalShader->SetUniformVector3("lightDirection", directionalLight->m_LightDirection);
-		directionalShader->SetUniformVector3("lightColor", glm::normalize(directionalLight->m_LightColor) * directionalLight->m_LightIntensity);
-		directionalShader->SetUniformBool("ShadowsEnabled", m_ShadowsEnabled);
+		directionalShader->SetUniformVector3(g_LightDirectionUniform, directionalLight->m_LightDirection);
+		directionalShader->SetUniformVector3(g_LightColorUniform, glm::normalize(directionalLight->m_LightColor) * directionalLight->m_LightIntensity);
 
-		if (directionalLight->m_ShadowMapRenderTarget)
+		const ShadowCascades* shadowCascades = directionalLight->m_ShadowCascades;
+		if (shadowCascades)
 		{
-			directionalShader->SetUniformMat4("lightShadowViewProjection", directionalLight->m_LightSpaceViewProjectionMatrix);
-			directionalLight->m_ShadowMapRenderTarget->RetrieveDepthAndStencilAttachment()->BindTexture(3); //In our material library, we set the shadow map sampler to be in texture slot 3.
+			//Cascades are sampled through their atlas tiles.
+			glm::mat4 cascadeViewProjections[g_MaximumShadowCascades];
+			glm::vec4 cascadeAtlasBounds[g_MaximumShadowCascades];
+			glm::vec4 cascadeSplits = glm::vec4(0.0f);
+			glm::vec4 cascadeBiases = glm::vec4(0.0f);
+			for (uint32_t i = 0; i < shadowCascades->RetrieveCascadeCount(); i++)
+			{
+				cascadeViewProjections[i] = shadowCascades->RetrieveCascade(i).m_AtlasViewProjection;
+				cascadeAtlasBounds[i] = shadowCascades->RetrieveCascade(i).m_AtlasBounds;
+				cascadeSplits[i] = shadowCascades->RetrieveCascade(i).m_SplitDepth;
+				cascadeBiases[i] = shadowCascades->RetrieveCascade(i).m_DepthBias;
+			}
+
+			directionalShader->SetUniformMat4Array(g_LightCascadeViewProjectionsUniform, cascadeViewProjections, (int)shadowCascades->RetrieveCascadeCount());
+			directionalShader->SetUniformVector4Array(g_LightCascadeAtlasBoundsUniform, cascadeAtlasBounds, (int)shadowCascades->RetrieveCascadeCount());
+			directionalShader->SetUniformVector4(g_LightCascadeSplitsUniform, cascadeSplits);
+			directionalShader->SetUniformVector4(g_LightCascadeBiasesUniform, cascadeBiases);
+			directionalShader->SetUniformFloat(g_LightCascadeBlendFractionUniform, m_ShadowCascadeSettings.m_BlendFraction);
+			shadowCascades->BindShadowMap(3); //In our material library, we set the shadow map sampler to be in texture slot 3.
 		}
+		directionalShader->SetUniformInteger(g_LightCascadeCountUniform, shadowCascades ? (int)shadowCascades->RetrieveCascadeCount() : 0);
 
 		RenderMesh(m_NDCQuad);
 	}
@@ -541,31 +834,79 @@ namespace Crescent
 			
 			Shader* ambientShader = m_MaterialLibrary->m_DeferredAmbientLightShader;
 			ambientShader->UseShader();
-			ambientShader->SetUniformVector3("camPos", m_Camera->m_CameraPosition);
-			ambientShader->SetUniformInteger("SSAO", true);
+			ambientShader->SetUniformInteger(g_SSAOUniform, true);
 			RenderMesh(m_NDCQuad);
 		}
 	}
 
-	void Renderer::RenderDeferredPointLight(PointLight* pointLight)
+	void Renderer::RenderDeferredPointLights()
 	{
-		Shader* pointLightShader = m_MaterialLibrary->m_DeferredPointLightShader;
+		if (m_VisiblePointLights.empty())
+		{
+			return;
+		}
+
+		//Back faces, so that volumes containing the camera still shade.
+		m_PointLightBuffer->UploadPointLights(m_VisiblePointLights);
+		m_MaterialLibrary->m_DeferredPointLightShader->UseShader();
+		m_GLStateCache->SetCulledFace(GL_FRONT);
+		RenderMeshPerPointLight(m_DeferredPointLightMesh, m_PointLightBuffer->RetrieveLightCount());
+		m_GLStateCache->SetCulledFace(GL_BACK);
+	}
 
-		pointLightShader->UseShader();
-		pointLightShader->SetUniformVector3("cameraPosition", m_Camera->m_CameraPosition);
-		pointLightShader->SetUniformVector3("lightPosition", pointLight->m_LightPosition);
-		pointLightShader->SetUniformFloat("lightRadius", pointLight->m_LightRadius);
-		pointLightShader->SetUniformVector3("lightColor", glm::normalize(pointLight->m_LightColor) * pointLight->m_LightIntensity);
+	void Renderer::RenderDebugPointLights(const std::vector<PointLight*>& pointLights, float meshScale, float intensityScale)
+	{
+		if (pointLights.empty())
+		{
+			return;
+		}
 
-		glm::mat4 pointLightModelMatrix = glm::mat4(1.0f);
-		pointLightModelMatrix = glm::translate(pointLightModelMatrix, pointLight->m_LightPosition);
-		pointLightModelMatrix = glm::scale(pointLightModelMatrix, glm::vec3(pointLight->m_LightRadius));
+		Shader* debugLightShader = m_MaterialLibrary->m_DebugLightShader;
+		m_PointLightBuffer->UploadPointLights(pointLights);
+		BindShaderState(debugLightShader, m_Camera);
+		debugLightShader->SetUniformFloat(g_LightMeshScaleUniform, meshScale);
+		debugLightShader->SetUniformFloat(g_LightIntensityScaleUniform, intensityScale);
+		RenderMeshPerPointLight(m_DebugLightMesh, m_PointLightBuffer->RetrieveLightCount());
+	}
 
-		pointLightShader->SetUniformMat4("projection", m_Camera->m_ProjectionMatrix);
-		pointLightShader->SetUniformMat4("view", m_Camera->m_ViewMatrix);
-		pointLightShader->SetUniformMat4("model", pointLightModelMatrix);
+	void Renderer::RenderMeshPerPointLight(Mesh* mesh, uint32_t lightCount)
+	{
+		m_RenderStatistics.m_DrawCalls++;
+		glBindVertexArray(mesh->RetrieveVertexArrayID());
 
-		RenderMesh(m_DeferredPointLightMesh);
+		const GLenum topology = mesh->m_Topology == TriangleStrips ? GL_TRIANGLE_STRIP : GL_TRIANGLES;
+		if (mesh->m_Indices.size() > 0)
+		{
+			glDrawElementsInstanced(topology, mesh->m_Indices.size(), GL_UNSIGNED_INT, 0, lightCount);
+		}
+		else
+		{
+			glDrawArraysInstanced(topology, 0, mesh->m_Positions.size(), lightCount);
+		}
+	}
+
+	void Renderer::RenderClusteredPointLights()
+	{
+		if (m_VisiblePointLights.empty())
+		{
+			return;
+		}
+
+		m_LightClusters->UpdateClusterGrid(m_Camera->m_ProjectionMatrix, glm::vec2(m_CustomRenderTarget->m_FramebufferWidth, m_CustomRenderTarget->m_FramebufferHeight));
+		m_PointLightBuffer->UploadPointLights(m_VisiblePointLights);
+		if (m_GPULightBinningEnabled)
+		{
+			m_LightClusters->BinLightsGPU(m_MaterialLibrary->m_ClusterBinningShader, m_Camera->m_ViewMatrix, *m_PointLightBuffer);
+		}
+		else
+		{
+			m_LightClusters->BinLightsCPU(m_Camera->m_ViewMatrix, *m_PointLightBuffer);
+		}
+
+		Shader* clusteredLightShader = m_MaterialLibrary->m_DeferredClusteredLightShader;
+		clusteredLightShader->UseShader();
+		m_LightClusters->BindClusters(clusteredLightShader);
+		RenderMesh(m_NDCQuad);
 	}
 
 	void Renderer::RenderCustomCommand(RenderCommand* renderCommand, Camera* customRenderCamera, bool updateGLStates)
@@ -588,97 +929,133 @@ namespace Crescent
 			m_GLStateCache->SetCulledFace(material->m_CulledFace);
 		}
 
-		//Default uniforms that are always configured regardless of shader configuration. See these as a set of default shader variables that are always there.
-		///To implement with Uniform Buffer Objects.
-		material->RetrieveMaterialShader()->UseShader();
-		material->RetrieveMaterialShader()->SetUniformMat4("projection", m_Camera->m_ProjectionMatrix);
-		material->RetrieveMaterialShader()->SetUniformMat4("view", m_Camera->m_ViewMatrix);
-		material->RetrieveMaterialShader()->SetUniformVector3("cameraPosition", m_Camera->m_CameraPosition);
+		Shader* shader = material->RetrieveMaterialShader();
+		Camera* renderCamera = customRenderCamera ? customRenderCamera : m_Camera; //If a custom camera is defined, we will update our shader uniforms with its information as needed.
+
+		bool shaderChanged = BindShaderState(shader, renderCamera);
+		BindDrawUniforms(renderCommand->m_Transform, renderCommand->m_TransformSlot);
+		BindMaterialState(material, shader, shaderChanged);
+
+		RenderMesh(renderCommand->m_Mesh);
+	}
+
+	bool Renderer::BindShaderState(Shader* shader, Camera* renderCamera)
+	{
+		//Shader::UseShader already skips redundant program binds, so this is cheap and keeps us correct if anything else bound a program in between.
+		shader->UseShader();
+
+		//Per-view values live in the global uniform buffer, shared by every shader. They only need uploading when the camera changes.
+		if (renderCamera != m_GlobalUniformCamera)
+		{
+			UpdateGlobalUniformBufferObjects(renderCamera);
+		}
+
+		if (shader == m_BoundShader)
+		{
+			return false;
+		}
+
+		m_BoundShader = shader;
+		m_RenderStatistics.m_ShaderSwitches++;
+		return true;
+	}
+
+	void Renderer::BindDrawUniforms(const glm::mat4& modelMatrix, uint32_t transformSlot)
+	{
+		//The model matrix is still streamed for shaders that don't read the transform buffer.
+		DrawUniformBlock drawUniforms = {};
+		drawUniforms.m_Model = modelMatrix;
+		drawUniforms.m_TransformSlot = transformSlot;
+		m_DrawUniformBuffer->BindUniformData(UniformBlock_Draw, &drawUniforms, sizeof(DrawUniformBlock));
+	}
 
-		if (customRenderCamera) //If a custom camera is defined, we will update our shader uniforms with its information as needed.
+	void Renderer::BindMaterialState(Material* material, Shader* shader, bool forceRebind)
+	{
+		//Material state is only bound again when the material (or any of its values) has changed since our last command.
+		if (!forceRebind && material == m_BoundMaterial && material->RetrieveMaterialVersion() == m_BoundMaterialVersion)
 		{
-			material->RetrieveMaterialShader()->SetUniformMat4("projection", customRenderCamera->m_ProjectionMatrix);
-			material->RetrieveMaterialShader()->SetUniformMat4("view", customRenderCamera->m_ViewMatrix);
-			material->RetrieveMaterialShader()->SetUniformVector3("cameraPosition", customRenderCamera->m_CameraPosition);
+			return;
 		}
 
-		//==============================================
-		material->RetrieveMaterialShader()->SetUniformMat4("model", renderCommand->m_Transform);
+		m_BoundMaterial = material;
+		m_BoundMaterialVersion = material->RetrieveMaterialVersion();
+		m_RenderStatistics.m_MaterialSwitches++;
 
 		///Shadow Related Stuff. Create Shaders for relevant stuff in Material Library.
-		material->RetrieveMaterialShader()->SetUniformBool("ShadowsEnabled", m_ShadowsEnabled); //If global shadows are enabled.
 		if (m_ShadowsEnabled && material->m_MaterialType == Material_Custom && material->m_ShadowReceiving) //If the mesh in question should receive shadows...
 		{
-			for (int i = 0; i < m_DirectionalLights.size(); i++)
+			//The matching cascade matrices and splits are in the global uniform buffer.
+			if (const ShadowCascades* shadowCascades = RetrievePrimaryShadowCascades())
 			{
-				if (m_DirectionalLights[i]->m_ShadowMapRenderTarget != nullptr)
-				{
-					material->RetrieveMaterialShader()->SetUniformMat4("lightShadowViewProjection" + std::to_string(i + 1), m_DirectionalLights[i]->m_LightSpaceViewProjectionMatrix);
-					m_DirectionalLights[i]->m_ShadowMapRenderTarget->RetrieveDepthAndStencilAttachment()->BindTexture(10 + i);
-				}
+				shadowCascades->BindShadowMap(10);
 			}
 		}
 
-		//Bind and set active uniform sampler/texture objects.
-		auto* samplers = material->GetSamplerUniforms(); //Returns a map of a string (uniform name) and its corresponding uniform information.
-		for (auto iterator = samplers->begin(); iterator != samplers->end(); iterator++)
+		if (material->IsParameterBlockDirty())
 		{
-			if (iterator->second.m_UniformType == Shader_Type_SamplerCube)
+			material->BakeParameterBlock();
+			const std::vector<uint8_t>& parameterBlock = material->RetrieveParameterBlock();
+			if (!parameterBlock.empty())
 			{
-				iterator->second.m_TextureCube->BindTextureCube(iterator->second.m_TextureUnit);
-			}
-			else
-			{
-				iterator->second.m_Texture->BindTexture(iterator->second.m_TextureUnit);
+				if (material->RetrieveParameterBlockSlot() < 0)
+				{
+					material->SetParameterBlockSlot(m_MaterialParameterBuffer->AllocateSlot());
+				}
+				m_MaterialParameterBuffer->UploadSlot(material->RetrieveParameterBlockSlot(), parameterBlock.data(), parameterBlock.size());
 			}
 		}
 
-		//Set uniform states of material.
-		auto* uniforms = material->GetUniforms(); //Returns a map of a string (uniform name) and its corresponding uniform information.
-		for (auto iterator = uniforms->begin(); iterator != uniforms->end(); iterator++)
+		if (!material->RetrieveParameterBlock().empty())
+		{
+			m_MaterialParameterBuffer->BindSlot(material->RetrieveParameterBlockSlot(), UniformBlock_Material);
+		}
+
+		for (const MaterialTextureBinding& textureBinding : material->RetrieveTextureBindings())
+		{
+			glActiveTexture(GL_TEXTURE0 + textureBinding.m_TextureUnit);
+			glBindTexture(textureBinding.m_TextureTarget, textureBinding.m_TextureID);
+		}
+
+		//Uniforms the shader doesn't declare within its MaterialUniforms block.
+		for (const MaterialLooseUniform& looseUniform : material->RetrieveLooseUniforms())
 		{
-			switch (iterator->second.m_UniformType)
+			switch (looseUniform.m_Value.m_UniformType)
 			{
 			case Shader_Type_Boolean:
-				material->RetrieveMaterialShader()->SetUniformBool(iterator->first, iterator->second.m_BoolValue);
+				shader->SetUniformBool(looseUniform.m_Uniform, looseUniform.m_Value.m_BoolValue);
 				break;
 			case Shader_Type_Integer:
-				material->RetrieveMaterialShader()->SetUniformInteger(iterator->first, iterator->second.m_IntValue);
+				shader->SetUniformInteger(looseUniform.m_Uniform, looseUniform.m_Value.m_IntValue);
 				break;
 			case Shader_Type_Float:
-				material->RetrieveMaterialShader()->SetUniformFloat(iterator->first, iterator->second.m_FloatValue);
+				shader->SetUniformFloat(looseUniform.m_Uniform, looseUniform.m_Value.m_FloatValue);
+				break;
+			case Shader_Type_Vector2:
+				shader->SetUniformVector2(looseUniform.m_Uniform, looseUniform.m_Value.m_Vector2Value);
 				break;
-			//case Shader_Type_Vec2:
-				//material->RetrieveMaterialShader()->SetUniformVector2(it->first, it->second.Vec2);
-				//break;
 			case Shader_Type_Vector3:
-				material->RetrieveMaterialShader()->SetUniformVector3(iterator->first, iterator->second.m_Vector3Value);
+				shader->SetUniformVector3(looseUniform.m_Uniform, looseUniform.m_Value.m_Vector3Value);
 				break;
-			//case Shader_Type_Vec4:
-				//material->RetrieveMaterialShader()->SetVector(it->first, it->second.Vec4);
-				//break;
-			//case Shader_Type_Mat2:
-				//material->RetrieveMaterialShader()->SetMatrix(it->first, it->second.Mat2);
-				//break;
-			//case Shader_Type_Mat3:
-				//material->RetrieveMaterialShader()->SetMatrix(it->first, it->second.Mat3);
-				//break;
 			case Shader_Type_Matrix4:
-				material->RetrieveMaterialShader()->SetUniformMat4(iterator->first, iterator->second.m_Mat4Value);
+				shader->SetUniformMat4(looseUniform.m_Uniform, looseUniform.m_Value.m_Mat4Value);
 				break;
 			default:
 				CrescentError("You tried to set an unidentified uniform data type and value. Please check."); //Include which shader.
 				break;
 			}
 		}
-
-		RenderMesh(renderCommand->m_Mesh);
 	}
 
 	void Renderer::RenderMesh(Mesh* mesh)
 	{
+		m_RenderStatistics.m_DrawCalls++;
 		glBindVertexArray(mesh->RetrieveVertexArrayID()); //Binding will automatically fill the vertex array with the attributes allocated during its time. 
-		if (mesh->m_Indices.size() > 0)
+		if (mesh->IsGeometryPooled())
+		{
+			//Our vertex array is the pool page's, so we offset into its shared buffers.
+			glDrawElementsBaseVertex(GL_TRIANGLES, mesh->m_Indices.size(), GL_UNSIGNED_INT, (GLvoid*)(mesh->RetrievePooledFirstIndex() * sizeof(unsigned int)), mesh->RetrievePooledBaseVertex());
+		}
+		else if (mesh->m_Indices.size() > 0)
 		{
 			glDrawElements(mesh->m_Topology == TriangleStrips ? GL_TRIANGLE_STRIP : GL_TRIANGLES, mesh->m_Indices.size(), GL_UNSIGNED_INT, 0);
 		}
@@ -688,6 +1065,208 @@ namespace Crescent
 		}
 	}
 
+	uint32_t Renderer::RetrieveInstanceRunLength(const RenderCommandList& renderCommands, uint32_t startIndex, bool matchMaterial) const
+	{
+		const RenderCommand& firstCommand = renderCommands[startIndex];
+		if (matchMaterial && !firstCommand.m_Material->RetrieveInstancedShader())
+		{
+			return 1;
+		}
+
+		//Instances are drawn from the transform buffer, so commands without a slot are drawn one by one.
+		if (firstCommand.m_TransformSlot == g_NullTransformSlot)
+		{
+			return 1;
+		}
+
+		//Sorting places commands sharing a material and mesh next to each other, so we only need to look ahead.
+		uint32_t runEnd = startIndex + 1;
+		while (runEnd < renderCommands.size())
+		{
+			const RenderCommand& renderCommand = renderCommands[runEnd];
+			if (renderCommand.m_Mesh != firstCommand.m_Mesh || (matchMaterial && renderCommand.m_Material != firstCommand.m_Material) || renderCommand.m_TransformSlot == g_NullTransformSlot)
+			{
+				break;
+			}
+			runEnd++;
+		}
+		return runEnd - startIndex;
+	}
+
+	void Renderer::BuildGeometryBatches(const RenderCommandList& renderCommands, bool matchMaterial)
+	{
+		m_GeometryBatches.clear();
+		m_InstanceSlots.clear();
+		m_IndirectCommands.clear();
+
+		for (uint32_t i = 0; i < renderCommands.size();)
+		{
+			const RenderCommand& renderCommand = renderCommands[i];
+			Mesh* mesh = renderCommand.m_Mesh;
+			uint32_t runLength = m_InstancingEnabled ? RetrieveInstanceRunLength(renderCommands, i, matchMaterial) : 1;
+
+			//Pooled meshes draw through the instanced shaders, so their materials must provide one in the geometry pass, and their commands a transform slot.
+			bool instanceDrawable = renderCommand.m_TransformSlot != g_NullTransformSlot && (!matchMaterial || renderCommand.m_Material->RetrieveInstancedShader());
+			bool multiDrawable = m_MultiDrawIndirectEnabled && mesh->IsGeometryPooled() && instanceDrawable;
+			if (multiDrawable)
+			{
+				//Keep appending runs to the previous multi-draw batch while they share its page (and material, as all of a batch's draws share its material state).
+				GeometryBatch* geometryBatch = m_GeometryBatches.empty() ? nullptr : &m_GeometryBatches.back();
+				if (!geometryBatch || geometryBatch->m_BatchType != GeometryBatch_MultiDraw || geometryBatch->m_GeometryPageIndex != mesh->RetrieveGeometryPageIndex() ||
+					(matchMaterial && renderCommands[geometryBatch->m_CommandIndex].m_Material != renderCommand.m_Material))
+				{
+					GeometryBatch newBatch;
+					newBatch.m_BatchType = GeometryBatch_MultiDraw;
+					newBatch.m_CommandIndex = i;
+					newBatch.m_InstanceOffset = (uint32_t)m_InstanceSlots.size();
+					newBatch.m_IndirectOffset = (uint32_t)m_IndirectCommands.size();
+					newBatch.m_GeometryPageIndex = mesh->RetrieveGeometryPageIndex();
+					m_GeometryBatches.push_back(newBatch);
+					geometryBatch = &m_GeometryBatches.back();
+				}
+
+				//Each run becomes one indirect draw. Its base instance points the instanced attribute at the run's transform slots.
+				DrawElementsIndirectCommand indirectCommand;
+				indirectCommand.m_IndexCount = (uint32_t)mesh->m_Indices.size();
+				indirectCommand.m_InstanceCount = runLength;
+				indirectCommand.m_FirstIndex = mesh->RetrievePooledFirstIndex();
+				indirectCommand.m_BaseVertex = mesh->RetrievePooledBaseVertex();
+				indirectCommand.m_BaseInstance = (uint32_t)m_InstanceSlots.size();
+				m_IndirectCommands.push_back(indirectCommand);
+
+				geometryBatch->m_CommandCount += runLength;
+				geometryBatch->m_DrawCount++;
+			}
+			else
+			{
+				GeometryBatch geometryBatch;
+				//An instance only costs us its 4 byte slot, which undercuts the draw uniform block a single command streams. Even runs of one are instanced.
+				geometryBatch.m_BatchType = m_InstancingEnabled && instanceDrawable ? GeometryBatch_Instanced : GeometryBatch_Single;
+				geometryBatch.m_CommandIndex = i;
+				geometryBatch.m_CommandCount = runLength;
+				geometryBatch.m_InstanceOffset = (uint32_t)m_InstanceSlots.size();
+				m_GeometryBatches.push_back(geometryBatch);
+
+				if (geometryBatch.m_BatchType == GeometryBatch_Single)
+				{
+					i += runLength;
+					continue;
+				}
+			}
+
+			for (uint32_t j = 0; j < runLength; j++)
+			{
+				m_InstanceSlots.push_back(renderCommands[i + j].m_TransformSlot);
+			}
+			i += runLength;
+		}
+
+		UploadGeometryBatchData();
+	}
+
+	void Renderer::UploadGeometryBatchData()
+	{
+		//Orphan the previous contents so we don't stall on draws still reading from them, growing the buffers if needed.
+		if (!m_InstanceSlots.empty())
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, m_InstanceBufferID);
+			if (m_InstanceSlots.size() > m_InstanceBufferCapacity)
+			{
+				m_InstanceBufferCapacity = std::max(m_InstanceSlots.size(), m_InstanceBufferCapacity * 2);
+			}
+			glBufferData(GL_ARRAY_BUFFER, m_InstanceBufferCapacity * sizeof(uint32_t), nullptr, GL_STREAM_DRAW);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, m_InstanceSlots.size() * sizeof(uint32_t), m_InstanceSlots.data());
+		}
+
+		if (!m_IndirectCommands.empty())
+		{
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_IndirectBufferID);
+			if (m_IndirectCommands.size() > m_IndirectBufferCapacity)
+			{
+				m_IndirectBufferCapacity = std::max(m_IndirectCommands.size(), m_IndirectBufferCapacity * 2);
+			}
+			glBufferData(GL_DRAW_INDIRECT_BUFFER, m_IndirectBufferCapacity * sizeof(DrawElementsIndirectCommand), nullptr, GL_STREAM_DRAW);
+			glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, m_IndirectCommands.size() * sizeof(DrawElementsIndirectCommand), m_IndirectCommands.data());
+		}
+	}
+
+	void Renderer::RenderInstancedCommand(RenderCommand* renderCommand, uint32_t instanceCount, uint32_t instanceOffset)
+	{
+		Material* material = renderCommand->m_Material;
+		Shader* shader = material->RetrieveInstancedShader();
+
+		bool shaderChanged = BindShaderState(shader, m_Camera);
+		BindMaterialState(material, shader, shaderChanged);
+
+		RenderMeshInstanced(renderCommand->m_Mesh, instanceCount, instanceOffset);
+	}
+
+	void Renderer::RenderMeshInstanced(Mesh* mesh, uint32_t instanceCount, uint32_t instanceOffset)
+	{
+		m_RenderStatistics.m_DrawCalls++;
+		m_RenderStatistics.m_InstancedBatches++;
+		m_RenderStatistics.m_InstancedCommands += instanceCount;
+
+		glBindVertexArray(mesh->RetrieveVertexArrayID());
+
+		//Point the per-instance transform slot at this run's slots. Shaders fetch the matrices themselves from the transform buffer.
+		glBindBuffer(GL_ARRAY_BUFFER, m_InstanceBufferID);
+		glEnableVertexAttribArray(5);
+		glVertexAttribIPointer(5, 1, GL_UNSIGNED_INT, sizeof(uint32_t), (GLvoid*)(instanceOffset * sizeof(uint32_t)));
+		glVertexAttribDivisor(5, 1);
+
+		if (mesh->IsGeometryPooled())
+		{
+			glDrawElementsInstancedBaseVertex(GL_TRIANGLES, mesh->m_Indices.size(), GL_UNSIGNED_INT, (GLvoid*)(mesh->RetrievePooledFirstIndex() * sizeof(unsigned int)), instanceCount, mesh->RetrievePooledBaseVertex());
+		}
+		else if (mesh->m_Indices.size() > 0)
+		{
+			glDrawElementsInstanced(mesh->m_Topology == TriangleStrips ? GL_TRIANGLE_STRIP : GL_TRIANGLES, mesh->m_Indices.size(), GL_UNSIGNED_INT, 0, instanceCount);
+		}
+		else
+		{
+			glDrawArraysInstanced(mesh->m_Topology == TriangleStrips ? GL_TRIANGLE_STRIP : GL_TRIANGLES, 0, mesh->m_Positions.size(), instanceCount);
+		}
+	}
+
+	void Renderer::RenderMultiDrawCommand(RenderCommand* renderCommand, const GeometryBatch& geometryBatch)
+	{
+		//Every draw in the batch shares this command's material.
+		Material* material = renderCommand->m_Material;
+		Shader* shader = material->RetrieveInstancedShader();
+
+		bool shaderChanged = BindShaderState(shader, m_Camera);
+		BindMaterialState(material, shader, shaderChanged);
+
+		RenderGeometryPageIndirect(geometryBatch);
+	}
+
+	void Renderer::RenderGeometryPageIndirect(const GeometryBatch& geometryBatch)
+	{
+		m_RenderStatistics.m_DrawCalls++;
+		m_RenderStatistics.m_MultiDrawBatches++;
+		m_RenderStatistics.m_MultiDrawCommands += geometryBatch.m_CommandCount;
+
+		glBindVertexArray(m_GeometryPool->RetrieveGeometryPage(geometryBatch.m_GeometryPageIndex).m_VertexArrayID);
+
+		//Each indirect draw's base instance offsets into the instance buffer, so the attributes start at its beginning.
+		glBindBuffer(GL_ARRAY_BUFFER, m_InstanceBufferID);
+		glEnableVertexAttribArray(5);
+		glVertexAttribIPointer(5, 1, GL_UNSIGNED_INT, sizeof(uint32_t), (GLvoid*)0);
+		glVertexAttribDivisor(5, 1);
+
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_IndirectBufferID);
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (GLvoid*)(geometryBatch.m_IndirectOffset * sizeof(DrawElementsIndirectCommand)), geometryBatch.m_DrawCount, 0);
+	}
+
+	void Renderer::ResetBoundDrawState()
+	{
+		m_BoundShader = nullptr;
+		m_GlobalUniformCamera = nullptr; //The camera's matrices may have changed, even if it's the same camera.
+		m_BoundMaterial = nullptr;
+		m_BoundMaterialVersion = 0;
+	}
+
 	void Renderer::SetRenderingWindowSize(int newWidth, int newHeight)
 	{
 		m_RenderWindowSize = glm::vec2(newWidth, newHeight);
@@ -709,9 +1288,21 @@ namespace Crescent
 		return m_GBuffer;
 	}
 
-	RenderTarget* Renderer::RetrieveShadowRenderTarget(int index)
+	ShadowCascades* Renderer::RetrieveShadowCascades(int index)
 	{
-		return m_ShadowRenderTargets[index];
+		return m_ShadowCascades[index];
+	}
+
+	const ShadowCascades* Renderer::RetrievePrimaryShadowCascades() const
+	{
+		for (const DirectionalLight* directionalLight : m_DirectionalLights)
+		{
+			if (directionalLight->m_ShadowCascades)
+			{
+				return directionalLight->m_ShadowCascades;
+			}
+		}
+		return nullptr;
 	}
 
 	RenderTarget* Renderer::RetrieveCustomRenderTarget()
@@ -734,14 +1325,43 @@ namespace Crescent
 		return m_MaterialLibrary->CreateMaterial(shaderName);
 	}
 
-	void Renderer::AddLightSource(DirectionalLight* directionalLight)
+	void Renderer::DestroyMaterial(Material* material)
+	{
+		//Our bound draw state only compares pointers, which a new material could reuse.
+		if (material == m_BoundMaterial)
+		{
+			m_BoundMaterial = nullptr;
+		}
+
+		//Streamed cells destroy their materials every time they unload, so the parameter block slot has to go back for the next material to use.
+		const int parameterBlockSlot = material->RetrieveParameterBlockSlot();
+		if (m_MaterialLibrary->DestroyMaterial(material) && parameterBlockSlot >= 0)
+		{
+			m_MaterialParameterBuffer->ReleaseSlot(parameterBlockSlot);
+		}
+	}
+
+	bool Renderer::IsTextureReferenced(const Texture* texture) const
 	{
-		m_DirectionalLights.push_back(directionalLight);
+		return m_MaterialLibrary->IsTextureReferenced(texture);
 	}
 
-	void Renderer::AddLightSource(PointLight* pointLight)
+	void Renderer::CollectLightSources()
 	{
-		m_PointLights.push_back(pointLight);
+		m_DirectionalLights.clear();
+		m_PointLights.clear();
+
+		for (const LightComponent& lightComponent : ComponentStorage::RetrieveLights().RetrieveComponents())
+		{
+			if (lightComponent.m_DirectionalLight)
+			{
+				m_DirectionalLights.push_back(lightComponent.m_DirectionalLight);
+			}
+			if (lightComponent.m_PointLight)
+			{
+				m_PointLights.push_back(lightComponent.m_PointLight);
+			}
+		}
 	}
 
 	EnvironmentalPBR* Renderer::RetrieveSkyCapture()
@@ -754,11 +1374,29 @@ namespace Crescent
 		m_PBR->SetSkyCapture(capturedEnvironment);
 	}
 
-	void Renderer::UpdateGlobalUniformBufferObjects()
+	void Renderer::UpdateGlobalUniformBufferObjects(Camera* renderCamera)
 	{
-		//glBindBuffer(GL_UNIFORM_BUFFER, m_GlobalUniformBufferID);
-		//For now, we will update the global uniforms here. 
-		//glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(m_Camera->m_ProjectionMatrix);
-		//glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(m_Camera->GetViewMatrix()));
+		FrameUniformBlock frameUniforms = {};
+		frameUniforms.m_Projection = renderCamera->m_ProjectionMatrix;
+		frameUniforms.m_View = renderCamera->m_ViewMatrix;
+		frameUniforms.m_CameraPosition = glm::vec4(renderCamera->m_CameraPosition, 1.0f);
+		frameUniforms.m_ShadowsEnabled = m_ShadowsEnabled;
+
+		//The cascades shadow receiving materials have bound.
+		if (const ShadowCascades* shadowCascades = RetrievePrimaryShadowCascades())
+		{
+			frameUniforms.m_ShadowCascadeCount = (int32_t)shadowCascades->RetrieveCascadeCount();
+			for (int i = 0; i < frameUniforms.m_ShadowCascadeCount; i++)
+			{
+				frameUniforms.m_ShadowCascadeViewProjections[i] = shadowCascades->RetrieveCascade(i).m_AtlasViewProjection;
+				frameUniforms.m_ShadowCascadeSplits[i] = shadowCascades->RetrieveCascade(i).m_SplitDepth;
+			}
+		}
+
+		glBindBuffer(GL_UNIFORM_BUFFER, m_GlobalUniformBufferID);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniformBlock), &frameUniforms);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+		m_GlobalUniformCamera = renderCamera;
 	}
 }
\ No newline at end of file
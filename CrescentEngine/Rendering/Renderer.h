@@ -2,12 +2,13 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include "RenderCommand.h"
+#include "GeometryPool.h"
 #include "EnvironmentalPBR.h"
 #include "PBR.h"
+#include "ShadowCascades.h"
 
 namespace Crescent
 {
-	class SceneEntity;
 	class RenderQueue;
 	class Shader;
 	class GLStateCache;
@@ -24,6 +25,45 @@ namespace Crescent
 	class EnvironmentalPBR;
 	class PBR;
 	class PostProcessor;
+	class UniformRingBuffer;
+	class TransformBuffer;
+	class PointLightBuffer;
+	class LightClusters;
+	class MaterialParameterBuffer;
+	class DynamicAABBTree;
+	class RenderWorld;
+
+	struct CullingStatistics
+	{
+		unsigned int m_VisibleCount = 0;
+		unsigned int m_CulledCount = 0;
+	};
+
+	//Per-frame counters, reset at the start of every RenderAllQueueItems call.
+	struct RenderStatistics
+	{
+		unsigned int m_DrawCalls = 0;
+		unsigned int m_ShaderSwitches = 0;
+		unsigned int m_MaterialSwitches = 0;
+		float m_SortTime = 0.0f; //In milliseconds.
+		unsigned int m_InstancedBatches = 0; //Instanced draw calls, each replacing a run of identical commands.
+		unsigned int m_InstancedCommands = 0; //Commands drawn through those batches.
+		unsigned int m_MultiDrawBatches = 0; //Multi-draw indirect calls over pooled geometry.
+		unsigned int m_MultiDrawCommands = 0; //Commands drawn through those calls.
+		unsigned int m_QueueHeapAllocations = 0; //Heap allocations made while building and draining the render queue. Should be 0 in steady state.
+		size_t m_QueueFrameMemory = 0; //In bytes.
+		unsigned int m_RenderProxies = 0; //Retained by the render world.
+		unsigned int m_RebuiltProxies = 0; //Proxies created for changed renderables this frame.
+		unsigned int m_MovedProxies = 0; //Proxies of moved renderables refit this frame.
+		unsigned int m_TransformUploads = 0; //Transform slots copied to the GPU this frame. Should be 0 for a static scene.
+		unsigned int m_CachedShadowCascades = 0; //Cascades whose static casters came from their cache.
+		unsigned int m_RedrawnShadowCascades = 0; //Cascades whose cache had to be redrawn.
+
+		CullingStatistics m_GeometryPassCulling;
+		CullingStatistics m_ShadowPassCulling; //Summed over all shadow casting lights.
+		CullingStatistics m_ForwardPassCulling;
+		CullingStatistics m_PointLightCulling;
+	};
 
 	class Renderer
 	{
@@ -36,7 +76,8 @@ namespace Crescent
 		void InitializeRenderer(const int& renderWindowWidth, const int& renderWindowHeight, Camera* sceneCamera);
 
 		//Rendering Items
-		void PushToRenderQueue(SceneEntity* sceneEntity);
+		void PushMeshRenderers(); //Brings our render world in line with changed MeshRenderer and PrefabInstance components, then queues its visible proxies. Run after Scene::UpdateScene.
+		void PushToRenderQueue(Mesh* mesh, Material* material, const glm::mat4& transform, bool frustumCullingEnabled = true); //Meshes living outside the scene's components, such as our skybox.
 		void RenderAllQueueItems();
 		void RenderMesh(Mesh* mesh);
 
@@ -50,18 +91,21 @@ namespace Crescent
 		void SetSceneCamera(Camera* sceneCamera);
 		Camera* RetrieveSceneCamera();
 
+		//Spatial Index - When set, PushMeshRenderers only submits the proxies of entities the tree finds in our camera's or shadow casters' frustums.
+		void SetSpatialTree(const DynamicAABBTree* spatialTree) { m_SpatialTree = spatialTree; }
+
 		//Creation
 		Material* CreateMaterial(std::string shaderName = "Default"); //Default materials. These materials have default state and uses checkboard texture as its albedo/diffuse (and black metalliic, half roughness purple normals and white AO).
-		void AddLightSource(DirectionalLight* directionalLight);
-		void AddLightSource(PointLight* pointLight);
+		void DestroyMaterial(Material* material);
+		bool IsTextureReferenced(const Texture* texture) const; //By any material, including the renderer's own.
 
 		//Retrieve
 		EnvironmentalPBR* RetrieveSkyCapture();
 		void SetSkyCapture(EnvironmentalPBR* capturedEnvironment);
 
 		//Cubemap
-		void RenderCubemap(SceneEntity* sceneEntity, TextureCube* cubemapTarget, glm::vec3 position = glm::vec3(0.0f), unsigned int mipmappingLevel = 0);
-		void RenderCubemap(std::vector<RenderCommand>& renderCommands, TextureCube* cubeTarget, glm::vec3 position = glm::vec3(0.0f), unsigned int mipmappingLevel = 0);
+		void RenderCubemap(Mesh* mesh, Material* material, TextureCube* cubemapTarget, glm::vec3 position = glm::vec3(0.0f), unsigned int mipmappingLevel = 0);
+		void RenderCubemap(const RenderCommandList& renderCommands, TextureCube* cubeTarget, glm::vec3 position = glm::vec3(0.0f), unsigned int mipmappingLevel = 0);
 
 		const char* RetrieveDeviceRendererInformation() const { return m_DeviceRendererInformation; }
 		const char* RetrieveDeviceVendorInformation() const { return m_DeviceVendorInformation; }
@@ -69,12 +113,16 @@ namespace Crescent
 		glm::vec2 RetrieveRenderWindowSize() const { return m_RenderWindowSize; }
 
 		GLStateCache* RetrieveGLStateCache() { return m_GLStateCache; }
+		GeometryPool* RetrieveGeometryPool() { return m_GeometryPool; }
 
 		RenderTarget* RetrieveMainRenderTarget();
 		RenderTarget* RetrieveGBuffer();
-		RenderTarget* RetrieveShadowRenderTarget(int index = 0);
+		ShadowCascades* RetrieveShadowCascades(int index = 0);
+		const ShadowAtlas* RetrieveShadowAtlas() const { return m_ShadowAtlas; }
 		RenderTarget* RetrieveCustomRenderTarget();
 
+		const RenderStatistics& RetrieveRenderStatistics() const { return m_RenderStatistics; }
+
 	public:
 		bool m_ShadowsEnabled = true;
 		bool m_LightsEnabled = true;
@@ -82,27 +130,92 @@ namespace Crescent
 		bool m_WireframesEnabled = false;
 		bool m_CubemapEnabled = true;
 		bool m_IBLAmbience = true;
+		bool m_FrustumCullingEnabled = true;
+		bool m_InstancingEnabled = true;
+		bool m_MultiDrawIndirectEnabled = true;
+		bool m_ClusteredShadingEnabled = true; //Shades point lights in a single full screen pass over light clusters, rather than a volume per light.
+		bool m_GPULightBinningEnabled = true; //Bins lights into clusters with a compute pass, rather than on our worker threads.
+		bool m_ShadowCachingEnabled = true; //Keeps static casters in a cache per cascade, so that only dynamic ones are drawn every frame.
+		ShadowCascadeSettings m_ShadowCascadeSettings;
 
 		Quad* m_NDCQuad = nullptr;
 
 		PostProcessor* m_PostProcessor = nullptr;
 
+	private:
+		enum GeometryBatchType
+		{
+			GeometryBatch_Single, //Commands drawn one by one.
+			GeometryBatch_Instanced, //A run of identical commands drawn with one instanced call.
+			GeometryBatch_MultiDraw //Consecutive runs of pooled meshes drawn with one indirect call.
+		};
+
+		struct GeometryBatch
+		{
+			GeometryBatchType m_BatchType = GeometryBatch_Single;
+			uint32_t m_CommandIndex = 0;
+			uint32_t m_CommandCount = 0;
+			uint32_t m_InstanceOffset = 0; //Into our instance buffer.
+			uint32_t m_IndirectOffset = 0; //Into our indirect buffer, in commands. Multi-draw batches only.
+			uint32_t m_DrawCount = 0; //Multi-draw batches only.
+			unsigned int m_GeometryPageIndex = 0; //Multi-draw batches only.
+		};
+
 	private:
 		//Renderer-specific logic for rendering a custom forward-pass command.
 		void RenderCustomCommand(RenderCommand* renderCommand, Camera* customRenderCamera, bool updateGLStates = true);
+		//Binds the shader, and the camera's frame uniforms if they differ from the last command's. Returns true if the shader changed.
+		bool BindShaderState(Shader* shader, Camera* renderCamera);
+		//Streams the command's model matrix and transform slot into the per-draw uniform block. Draws outside the render queue have no slot.
+		void BindDrawUniforms(const glm::mat4& modelMatrix, uint32_t transformSlot = g_NullTransformSlot);
+		//Binds the material's parameter block, textures and remaining uniforms onto the given shader if they differ from the last command's. Rebakes the material first if dirty.
+		void BindMaterialState(Material* material, Shader* shader, bool forceRebind);
+
+		//Instancing - Runs of consecutive commands sharing a mesh (and material, for the geometry pass) are drawn with a single instanced call.
+		uint32_t RetrieveInstanceRunLength(const RenderCommandList& renderCommands, uint32_t startIndex, bool matchMaterial) const;
+		//Splits a sorted pass into single, instanced and multi-draw batches, then streams their transform slots and indirect commands to the GPU.
+		void BuildGeometryBatches(const RenderCommandList& renderCommands, bool matchMaterial);
+		void UploadGeometryBatchData();
+		void RenderInstancedCommand(RenderCommand* renderCommand, uint32_t instanceCount, uint32_t instanceOffset);
+		void RenderMeshInstanced(Mesh* mesh, uint32_t instanceCount, uint32_t instanceOffset);
+
+		//Multi-Draw Indirect - Pooled meshes sharing a geometry page (and material, for the geometry pass) are drawn with a single indirect call.
+		void RenderMultiDrawCommand(RenderCommand* renderCommand, const GeometryBatch& geometryBatch);
+		void RenderGeometryPageIndirect(const GeometryBatch& geometryBatch);
+
+		//Forgets the shader/material state bound by previous commands. Called at pass boundaries, where state may have been changed behind our back.
+		void ResetBoundDrawState();
 
 		//Render Directional Light
 		void RenderDeferredDirectionalLight(DirectionalLight* directionalLight);
 		//Render Ambient Lighting (Including Indirect IBL)
 		void RenderDeferredAmbientLight();
-		//Render Point Light
-		void RenderDeferredPointLight(PointLight* pointLight);
+		//Render Visible Point Lights as volumes, drawn with one instanced call.
+		void RenderDeferredPointLights();
+		//Render Visible Point Lights through our light clusters. Perspective cameras only.
+		void RenderClusteredPointLights();
+		//Render Debug Meshes of the given lights, drawn with one instanced call. A zero scale draws each light's volume, or its bare color.
+		void RenderDebugPointLights(const std::vector<PointLight*>& pointLights, float meshScale, float intensityScale);
+		//Draws an instance of the mesh per light in our point light buffer, for shaders reading their light by instance.
+		void RenderMeshPerPointLight(Mesh* mesh, uint32_t lightCount);
 		
 		//Render Mesh for Shadow Buffer Generation
-		void RenderShadowCastCommand(RenderCommand* renderCommand, const glm::mat4& lightSpaceProjectionMatrix, const glm::mat4& lightSpaceViewMatrix);
-
-		//Update the global uniform buffer objects.
-		void UpdateGlobalUniformBufferObjects();
+		void BindShadowCastLightState(const glm::mat4& lightSpaceProjectionMatrix, const glm::mat4& lightSpaceViewMatrix); //Once per light, before any of the below.
+		//Culls the casters against the cascade's frustum and draws what remains into the bound target.
+		void RenderShadowCasters(const RenderCommandList& shadowRenderCommands, const ShadowCascade& shadowCascade);
+		void RenderShadowCastCommand(RenderCommand* renderCommand);
+		void RenderShadowCastInstancedCommand(RenderCommand* renderCommand, uint32_t instanceCount, uint32_t instanceOffset);
+		void RenderShadowCastMultiDrawCommand(const GeometryBatch& geometryBatch);
+
+		//Update the global uniform buffer objects with the given camera and our shadow casters' matrices.
+		void UpdateGlobalUniformBufferObjects(Camera* renderCamera);
+
+		//Rebuilds our light lists from the light components.
+		void CollectLightSources();
+		//Cascades of our first shadow casting directional light this frame, which shadow receiving materials sample. Null if there is none.
+		const ShadowCascades* RetrievePrimaryShadowCascades() const;
+		//Gathers the tree proxies within any frustum we render this frame, without duplicates.
+		void CollectVisibleProxies();
 
 		//Final
 		void BlitToMainFramebuffer(Texture* sourceRenderTarget);
@@ -112,12 +225,21 @@ namespace Crescent
 		PBR* m_PBR = nullptr;
 
 		//UBO
-		unsigned int m_GlobalUniformBufferID;
+		unsigned int m_GlobalUniformBufferID = 0;
+		Camera* m_GlobalUniformCamera = nullptr; //The camera the global uniform buffer currently holds.
+		UniformRingBuffer* m_DrawUniformBuffer = nullptr;
+		TransformBuffer* m_TransformBuffer = nullptr; //Every queued command's matrices, indexed by transform slot.
+		MaterialParameterBuffer* m_MaterialParameterBuffer = nullptr;
+		PointLightBuffer* m_PointLightBuffer = nullptr; //Refilled by each pass over point lights.
+		LightClusters* m_LightClusters = nullptr;
 
 		MaterialLibrary* m_MaterialLibrary = nullptr;
 		RenderQueue* m_RenderQueue = nullptr;
+		RenderWorld* m_RenderWorld = nullptr;
 		GLStateCache* m_GLStateCache = nullptr;
+		GeometryPool* m_GeometryPool = nullptr;
 		Camera* m_Camera = nullptr;
+		const DynamicAABBTree* m_SpatialTree = nullptr;
 
 		//Render Targets
 		RenderTarget* m_GBuffer = nullptr;
@@ -129,12 +251,16 @@ namespace Crescent
 
 		std::vector<RenderTarget*> m_RenderTargetsCustom;
 
-		//Shadow Target
-		std::vector<RenderTarget*> m_ShadowRenderTargets;;
+		//Shadow Targets - Handed out to shadow casting directional lights in order. Their cascades share tiles of a single atlas.
+		ShadowAtlas* m_ShadowAtlas = nullptr;
+		std::vector<ShadowCascades*> m_ShadowCascades;
+		std::vector<ShadowTileRequest> m_ShadowTileRequests;
 
-		//Lights
+		//Lights - Gathered from the light components at the start of every frame.
 		std::vector<DirectionalLight*> m_DirectionalLights;
 		std::vector<PointLight*> m_PointLights;
+		std::vector<PointLight*> m_VisiblePointLights; //Point lights surviving culling this frame.
+		std::vector<PointLight*> m_DebugPointLights; //Point lights with their mesh shown this frame.
 		Mesh* m_DeferredPointLightMesh = nullptr;
 
 		glm::vec2 m_RenderWindowSize = glm::vec2(0.0f);
@@ -147,5 +273,26 @@ namespace Crescent
 		//Debug
 		Mesh* m_DebugLightMesh = nullptr;
 
+		//Bound Draw State - Lets consecutive sorted commands skip redundant shader/material setup.
+		Shader* m_BoundShader = nullptr;
+		Material* m_BoundMaterial = nullptr;
+		unsigned int m_BoundMaterialVersion = 0;
+
+		RenderStatistics m_RenderStatistics;
+
+		//Visibility - Tree proxies found by CollectVisibleProxies, kept between frames so that steady state frames don't allocate.
+		std::vector<uint32_t> m_VisibleProxies;
+
+		//Instancing
+		unsigned int m_InstanceBufferID = 0;
+		size_t m_InstanceBufferCapacity = 0; //In transform slots.
+		std::vector<uint32_t> m_InstanceSlots; //Staging memory, kept between frames.
+
+		//Multi-Draw Indirect
+		unsigned int m_IndirectBufferID = 0;
+		size_t m_IndirectBufferCapacity = 0; //In commands.
+		std::vector<DrawElementsIndirectCommand> m_IndirectCommands;
+		std::vector<GeometryBatch> m_GeometryBatches; //The current pass' batches.
+
 	};
 }
@@ -20,6 +20,22 @@ namespace Crescent
 		ImGui::Checkbox("Enable Lighting", &m_RendererContext->m_LightsEnabled);
 		ImGui::Checkbox("Enable Shadows", &m_RendererContext->m_ShadowsEnabled);
 		ImGui::Checkbox("Enable Lighting Volumes", &m_RendererContext->m_ShowDebugLightVolumes);
+		ImGui::Checkbox("Enable Frustum Culling", &m_RendererContext->m_FrustumCullingEnabled);
+		ImGui::Checkbox("Enable Instancing", &m_RendererContext->m_InstancingEnabled);
+		ImGui::Checkbox("Enable Multi-Draw Indirect", &m_RendererContext->m_MultiDrawIndirectEnabled);
+		ImGui::Checkbox("Enable Clustered Shading", &m_RendererContext->m_ClusteredShadingEnabled);
+		ImGui::Checkbox("GPU Light Binning", &m_RendererContext->m_GPULightBinningEnabled);
+		ImGui::Checkbox("Enable Shadow Caching", &m_RendererContext->m_ShadowCachingEnabled);
+
+		ShadowCascadeSettings& shadowCascadeSettings = m_RendererContext->m_ShadowCascadeSettings;
+		int shadowCascadeCount = (int)shadowCascadeSettings.m_CascadeCount;
+		if (ImGui::SliderInt("Shadow Cascades", &shadowCascadeCount, 2, g_MaximumShadowCascades))
+		{
+			shadowCascadeSettings.m_CascadeCount = (uint32_t)shadowCascadeCount;
+		}
+		ImGui::DragFloat("Shadow Distance", &shadowCascadeSettings.m_ShadowDistance, 1.0f, 1.0f, 1000.0f);
+		ImGui::SliderFloat("Cascade Split Blend", &shadowCascadeSettings.m_SplitBlend, 0.0f, 1.0f);
+		ImGui::SliderFloat("Shadow Resolution Scale", &shadowCascadeSettings.m_ResolutionScale, 0.25f, 2.0f);
 
 		ImGui::End();
 
@@ -37,6 +53,29 @@ namespace Crescent
 		ImGui::NewLine();
 		ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
 
+		const RenderStatistics& renderStatistics = m_RendererContext->RetrieveRenderStatistics();
+		ImGui::NewLine();
+		ImGui::Text("Draw Calls: %u", renderStatistics.m_DrawCalls);
+		ImGui::Text("Shader Switches: %u", renderStatistics.m_ShaderSwitches);
+		ImGui::Text("Material Switches: %u", renderStatistics.m_MaterialSwitches);
+		ImGui::Text("Instanced Batches: %u (%u Commands)", renderStatistics.m_InstancedBatches, renderStatistics.m_InstancedCommands);
+		ImGui::Text("Multi-Draw Batches: %u (%u Commands)", renderStatistics.m_MultiDrawBatches, renderStatistics.m_MultiDrawCommands);
+		ImGui::Text("Command Sort: %.3f ms", renderStatistics.m_SortTime);
+		ImGui::Text("Queue Memory: %.1f KB (%u Heap Allocations)", renderStatistics.m_QueueFrameMemory / 1024.0f, renderStatistics.m_QueueHeapAllocations);
+		ImGui::Text("Render Proxies: %u (%u Rebuilt, %u Moved)", renderStatistics.m_RenderProxies, renderStatistics.m_RebuiltProxies, renderStatistics.m_MovedProxies);
+		ImGui::Text("Transform Uploads: %u", renderStatistics.m_TransformUploads);
+
+		ImGui::NewLine();
+		ImGui::Text("Geometry Pass: %u Visible, %u Culled", renderStatistics.m_GeometryPassCulling.m_VisibleCount, renderStatistics.m_GeometryPassCulling.m_CulledCount);
+		ImGui::Text("Shadow Pass: %u Visible, %u Culled", renderStatistics.m_ShadowPassCulling.m_VisibleCount, renderStatistics.m_ShadowPassCulling.m_CulledCount);
+		ImGui::Text("Shadow Cascades: %u Cached, %u Redrawn", renderStatistics.m_CachedShadowCascades, renderStatistics.m_RedrawnShadowCascades);
+		const ShadowAtlas* shadowAtlas = m_RendererContext->RetrieveShadowAtlas();
+		const float shadowAtlasArea = (float)shadowAtlas->RetrieveAtlasResolution() * shadowAtlas->RetrieveAtlasResolution();
+		ImGui::Text("Shadow Atlas: %u x %u, %.0f%% Allocated (%u Repacks)", shadowAtlas->RetrieveAtlasResolution(), shadowAtlas->RetrieveAtlasResolution(),
+			shadowAtlasArea > 0.0f ? shadowAtlas->RetrieveAllocatedArea() * 100.0f / shadowAtlasArea : 0.0f, shadowAtlas->RetrieveRepackCount());
+		ImGui::Text("Forward Pass: %u Visible, %u Culled", renderStatistics.m_ForwardPassCulling.m_VisibleCount, renderStatistics.m_ForwardPassCulling.m_CulledCount);
+		ImGui::Text("Point Lights: %u Visible, %u Culled", renderStatistics.m_PointLightCulling.m_VisibleCount, renderStatistics.m_PointLightCulling.m_CulledCount);
+
 		ImGui::End();
 	}
 }
\ No newline at end of file
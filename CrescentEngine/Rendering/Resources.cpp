@@ -3,18 +3,25 @@
 #include "../Memory/ShaderLoader.h"
 #include "../Memory/TextureLoader.h"
 #include "../Memory/MeshLoader.h"
+#include "../Memory/MappedFile.h"
 #include "../Shading/Texture.h"
 #include "../Shading/TextureCube.h"
 #include "../Utilities/StringID.h"
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEntity.h"
+#include "../Scene/EntityPool.h"
+#include "../Scene/Prefab.h"
+#include "../Shading/Material.h"
+#include "Renderer.h"
+#include <unordered_set>
+#include <algorithm>
 
 namespace Crescent
 {
 	std::map<unsigned int, Shader> Resources::m_Shaders = std::map<unsigned int, Shader>();
 	std::map<unsigned int, Texture> Resources::m_Textures = std::map<unsigned int, Texture>();
 	std::map<unsigned int, TextureCube> Resources::m_TextureCubes = std::map<unsigned int, TextureCube>();
-	std::map<unsigned int, SceneEntity*> Resources::m_SceneMeshes = std::map<unsigned int, SceneEntity*>();
+	std::map<unsigned int, Prefab*> Resources::m_Prefabs = std::map<unsigned int, Prefab*>();
 
 	void Resources::InitializeResourceManager()
 	{
@@ -23,10 +30,11 @@ namespace Crescent
 
 	void Resources::Clean()
 	{
-		for (auto iterator = m_SceneMeshes.begin(); iterator != m_SceneMeshes.end(); iterator++)
+		for (auto iterator = m_Prefabs.begin(); iterator != m_Prefabs.end(); iterator++)
 		{
 			delete iterator->second;
 		}
+		m_Prefabs.clear();
 	}
 
 	Shader* Resources::LoadShader(const std::string& name, const std::string& vertexShaderPath, const std::string& fragmentShaderPath)
@@ -46,6 +54,23 @@ namespace Crescent
 		return &Resources::m_Shaders[stringID];
 	}
 
+	Shader* Resources::LoadComputeShader(const std::string& name, const std::string& computeShaderPath)
+	{
+		unsigned int stringID = SID(name);
+
+		//Compute shaders share the name space of our other shaders.
+		if (Resources::m_Shaders.find(stringID) != Resources::m_Shaders.end())
+		{
+			return &Resources::m_Shaders[stringID];
+		}
+
+		CrescentInfo("Loading Compute Shader: " + name);
+		Shader shader = ShaderLoader::LoadComputeShader(name, computeShaderPath);
+		Resources::m_Shaders[stringID] = shader;
+		CrescentInfo("Successfully loaded Compute Shader: " + name);
+		return &Resources::m_Shaders[stringID];
+	}
+
 	Shader* Resources::RetrieveShader(const std::string& name)
 	{
 		unsigned int stringID = SID(name);
@@ -163,29 +188,129 @@ namespace Crescent
 		}
 	}
 
-	SceneEntity* Resources::LoadMesh(Renderer* rendererContext, Scene* sceneContext, const std::string& meshName, const std::string& filePath)
+	SceneEntity* Resources::LoadMesh(Renderer* rendererContext, Scene* sceneContext, const std::string& meshName, const std::string& filePath, bool poolGeometry)
+	{
+		const Prefab* prefab = LoadPrefab(rendererContext, meshName, filePath, poolGeometry);
+		return prefab ? sceneContext->ConstructNewEntity(prefab) : nullptr;
+	}
+
+	const Prefab* Resources::LoadPrefab(Renderer* rendererContext, const std::string& meshName, const std::string& filePath, bool poolGeometry)
 	{
 		unsigned int stringID = SID(meshName);
 
 		//Check if mesh exists.
-		if (Resources::m_SceneMeshes.find(stringID) != Resources::m_SceneMeshes.end())
+		if (Resources::m_Prefabs.find(stringID) != Resources::m_Prefabs.end())
+		{
+			return Resources::m_Prefabs[stringID];
+		}
+
+		//Scene files reference models by the hash of their contents, so they still resolve should the file be renamed or moved.
+		MappedFile sourceFile;
+		if (!sourceFile.OpenFile(filePath))
 		{
-			return sceneContext->ConstructNewEntity(Resources::m_SceneMeshes[stringID]);
+			CrescentLoad("Error loading model file at: " + filePath + ".");
+			return nullptr;
 		}
+		const uint64_t contentHash = Hash_FNV1a64(sourceFile.RetrieveData(), sourceFile.RetrieveSize());
+		sourceFile.CloseFile();
 
-		SceneEntity* sceneEntity = MeshLoader::LoadMesh(rendererContext, filePath);
-		Resources::m_SceneMeshes[stringID] = sceneEntity;
+		SceneEntity* loadedHierarchy = MeshLoader::LoadMesh(rendererContext, filePath, true, poolGeometry);
+		return loadedHierarchy ? AddPrefab(meshName, loadedHierarchy, filePath, contentHash, poolGeometry) : nullptr;
+	}
+
+	const Prefab* Resources::LoadPrefab(Renderer* rendererContext, const std::string& meshName, const std::string& filePath, uint64_t contentHash, const aiScene* importedScene, bool poolGeometry)
+	{
+		unsigned int stringID = SID(meshName);
+		if (Resources::m_Prefabs.find(stringID) != Resources::m_Prefabs.end())
+		{
+			return Resources::m_Prefabs[stringID];
+		}
 
-		return sceneContext->ConstructNewEntity(sceneEntity);
+		SceneEntity* loadedHierarchy = MeshLoader::LoadMesh(rendererContext, importedScene, filePath, true, poolGeometry);
+		return loadedHierarchy ? AddPrefab(meshName, loadedHierarchy, filePath, contentHash, poolGeometry) : nullptr;
+	}
+
+	const Prefab* Resources::AddPrefab(const std::string& meshName, SceneEntity* loadedHierarchy, const std::string& filePath, uint64_t contentHash, bool poolGeometry)
+	{
+		//The loaded hierarchy is only needed until it has been flattened. Its meshes and materials live on in the prefab.
+		Prefab* prefab = new Prefab(meshName, loadedHierarchy, filePath, contentHash, poolGeometry);
+		EntityPool::DestroyEntityHierarchy(loadedHierarchy);
+		Resources::m_Prefabs[SID(meshName)] = prefab;
+
+		return prefab;
+	}
+
+	void Resources::UnloadPrefab(Renderer* rendererContext, const Prefab* prefab)
+	{
+		auto prefabIterator = std::find_if(m_Prefabs.begin(), m_Prefabs.end(), [prefab](const std::pair<const unsigned int, Prefab*>& entry) { return entry.second == prefab; });
+		if (prefabIterator == m_Prefabs.end())
+		{
+			return;
+		}
+
+		//Every mesh and material was created for this prefab alone, while textures are shared by file name across all of them.
+		std::unordered_set<Material*> materials;
+		std::unordered_set<Texture*> textures;
+		for (const PrefabNode& prefabNode : prefab->RetrieveNodes())
+		{
+			if (prefabNode.m_Mesh)
+			{
+				MeshLoader::ReleaseMesh(prefabNode.m_Mesh);
+			}
+			if (prefabNode.m_Material && materials.insert(prefabNode.m_Material).second)
+			{
+				for (const auto& samplerUniform : *prefabNode.m_Material->GetSamplerUniforms())
+				{
+					if (samplerUniform.second.m_UniformType != Shader_Type_SamplerCube && samplerUniform.second.m_Texture)
+					{
+						textures.insert(samplerUniform.second.m_Texture);
+					}
+				}
+			}
+		}
+
+		for (Material* material : materials)
+		{
+			rendererContext->DestroyMaterial(material);
+		}
+
+		for (auto textureIterator = m_Textures.begin(); textureIterator != m_Textures.end();)
+		{
+			if (textures.count(&textureIterator->second) && !rendererContext->IsTextureReferenced(&textureIterator->second))
+			{
+				textureIterator->second.DeleteTexture();
+				textureIterator = m_Textures.erase(textureIterator);
+			}
+			else
+			{
+				textureIterator++;
+			}
+		}
+
+		CrescentInfo("Unloaded model: " + prefab->RetrieveSourcePath() + ".");
+		delete prefabIterator->second;
+		m_Prefabs.erase(prefabIterator);
+	}
+
+	const Prefab* Resources::RetrievePrefabByContentHash(uint64_t contentHash)
+	{
+		for (auto iterator = m_Prefabs.begin(); iterator != m_Prefabs.end(); iterator++)
+		{
+			if (iterator->second->RetrieveContentHash() == contentHash)
+			{
+				return iterator->second;
+			}
+		}
+		return nullptr;
 	}
 
-	SceneEntity* Resources::RetrieveMesh(const std::string& meshName)
+	const Prefab* Resources::RetrievePrefab(const std::string& meshName)
 	{
 		unsigned int stringID = SID(meshName);
 
-		if (Resources::m_SceneMeshes.find(stringID) != Resources::m_SceneMeshes.end())
+		if (Resources::m_Prefabs.find(stringID) != Resources::m_Prefabs.end())
 		{
-			//return Scene::ConstructNewEntity(Resources::m_SceneMeshes[stringID]);
+			return Resources::m_Prefabs[stringID];
 		}
 		else
 		{
@@ -2,6 +2,9 @@
 #include <GL/glew.h>
 #include <map>
 #include <vector>
+#include <cstdint>
+
+struct aiScene;
 
 namespace Crescent
 {
@@ -10,6 +13,7 @@ namespace Crescent
 	class Shader;
 	class Scene;
 	class SceneEntity;
+	class Prefab;
 	class Renderer;
 
 	/*
@@ -25,6 +29,7 @@ namespace Crescent
 
 		//Shader Resources
 		static Shader* LoadShader(const std::string& name, const std::string& vertexShaderPath, const std::string& fragmentShaderPath);
+		static Shader* LoadComputeShader(const std::string& name, const std::string& computeShaderPath);
 		static Shader* RetrieveShader(const std::string& name);
 
 		//Textures
@@ -38,19 +43,27 @@ namespace Crescent
 		static TextureCube* LoadTextureCube(const std::string& name, const std::string& folderPath);
 		static TextureCube* RetrieveTextureCube(const std::string& name);
 
-		//Meshes
-		static SceneEntity* LoadMesh(Renderer* rendererContext, Scene* sceneContext, const std::string& meshName, const std::string& filePath);
-		static SceneEntity* RetrieveMesh(const std::string& meshName);
+		//Meshes - Models are loaded once into a prefab, and every load places a new instance of it into the scene.
+		static SceneEntity* LoadMesh(Renderer* rendererContext, Scene* sceneContext, const std::string& meshName, const std::string& filePath, bool poolGeometry = false); //Pooled meshes can be batched into multi-draws. Best for large static models.
+		static const Prefab* LoadPrefab(Renderer* rendererContext, const std::string& meshName, const std::string& filePath, bool poolGeometry = false); //Without placing an instance.
+		static const Prefab* RetrievePrefab(const std::string& meshName);
+		static const Prefab* RetrievePrefabByContentHash(uint64_t contentHash); //nullptr if no loaded prefab was built from such a file.
+		//Finishes a model imported off the main thread (see MeshLoader::ImportMesh), whose file hashed to contentHash.
+		static const Prefab* LoadPrefab(Renderer* rendererContext, const std::string& meshName, const std::string& filePath, uint64_t contentHash, const aiScene* importedScene, bool poolGeometry);
+		//Frees the prefab along with its meshes, its materials and any of their textures no remaining material samples. Its instances must be gone, and out of the render world.
+		static void UnloadPrefab(Renderer* rendererContext, const Prefab* prefab);
 
 	private:
 		//Disallow creation of any Resources object. This is a static object.
 		Resources();
 
+		static const Prefab* AddPrefab(const std::string& meshName, SceneEntity* loadedHierarchy, const std::string& filePath, uint64_t contentHash, bool poolGeometry);
+
 	private:
 		//We index all resources with a hashed string ID.
 		static std::map<unsigned int, Shader> m_Shaders;
 		static std::map<unsigned int, Texture> m_Textures;
 		static std::map<unsigned int, TextureCube> m_TextureCubes;
-		static std::map<unsigned int, SceneEntity*> m_SceneMeshes;
+		static std::map<unsigned int, Prefab*> m_Prefabs;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,343 @@
+#include "CrescentPCH.h"
+#include "ShadowAtlas.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Crescent
+{
+	//How far past the geometric midpoint between two tile sizes a request has to move before its tile follows.
+	static constexpr float g_TileSizeHysteresis = 0.25f;
+
+	//Gathers every other bit of a Morton index, giving one of its two coordinates.
+	static uint32_t CompactMortonBits(uint32_t value)
+	{
+		value &= 0x55555555;
+		value = (value | (value >> 1)) & 0x33333333;
+		value = (value | (value >> 2)) & 0x0F0F0F0F;
+		value = (value | (value >> 4)) & 0x00FF00FF;
+		value = (value | (value >> 8)) & 0x0000FFFF;
+		return value;
+	}
+
+	ShadowAtlas::ShadowAtlas(uint32_t maximumAtlasResolution, uint32_t minimumTileSize, uint32_t maximumTileSize) : m_MaximumAtlasResolution(maximumAtlasResolution),
+		m_MinimumTileSize(minimumTileSize), m_MaximumTileSize(std::min(maximumTileSize, maximumAtlasResolution))
+	{
+		glGenFramebuffers(1, &m_FramebufferID);
+	}
+
+	ShadowAtlas::~ShadowAtlas()
+	{
+		glDeleteFramebuffers(1, &m_FramebufferID);
+		if (m_AtlasTextureID)
+		{
+			glDeleteTextures(1, &m_AtlasTextureID);
+		}
+		if (m_StaticCacheTextureID)
+		{
+			glDeleteTextures(1, &m_StaticCacheTextureID);
+		}
+	}
+
+	void ShadowAtlas::UpdateTiles(std::vector<ShadowTileRequest>& tileRequests)
+	{
+		m_TileSizes.resize(tileRequests.size());
+		uint64_t requestedArea = 0;
+		uint32_t largestTileSize = 0;
+		for (size_t i = 0; i < tileRequests.size(); i++)
+		{
+			m_TileSizes[i] = SelectTileSize(tileRequests[i].m_Tile->m_Size, tileRequests[i].m_DesiredSize);
+			requestedArea += (uint64_t)m_TileSizes[i] * m_TileSizes[i];
+			largestTileSize = std::max(largestTileSize, m_TileSizes[i]);
+		}
+
+		//Grow to the smallest atlas holding every requested tile, if we can. Everything moves into the new texture.
+		uint32_t requiredResolution = std::max(m_AtlasResolution, largestTileSize);
+		while (requiredResolution < m_MaximumAtlasResolution && (uint64_t)requiredResolution * requiredResolution < requestedArea)
+		{
+			requiredResolution *= 2;
+		}
+		if (requiredResolution > m_AtlasResolution)
+		{
+			ResizeAtlas(requiredResolution);
+			RepackTiles(tileRequests, m_TileSizes);
+			return;
+		}
+
+		//Shrinking tiles frees space for growing ones, so they go first. Larger tiles are placed before smaller ones, keeping the quadtree compact.
+		m_PendingRequests.clear();
+		for (uint32_t i = 0; i < (uint32_t)tileRequests.size(); i++)
+		{
+			if (m_TileSizes[i] != tileRequests[i].m_Tile->m_Size)
+			{
+				m_PendingRequests.push_back(i);
+			}
+		}
+		std::sort(m_PendingRequests.begin(), m_PendingRequests.end(), [this, &tileRequests](uint32_t requestA, uint32_t requestB)
+		{
+			const bool shrinkingA = m_TileSizes[requestA] < tileRequests[requestA].m_Tile->m_Size;
+			const bool shrinkingB = m_TileSizes[requestB] < tileRequests[requestB].m_Tile->m_Size;
+			return shrinkingA != shrinkingB ? shrinkingA : m_TileSizes[requestA] > m_TileSizes[requestB];
+		});
+
+		const bool requestsFitAtlas = requestedArea <= (uint64_t)m_AtlasResolution * m_AtlasResolution;
+		for (uint32_t requestIndex : m_PendingRequests)
+		{
+			ShadowAtlasTile& tile = *tileRequests[requestIndex].m_Tile;
+			if (tile.m_Size > m_TileSizes[requestIndex])
+			{
+				ReleaseTile(tile);
+				AllocateTile(m_TileSizes[requestIndex], tile); //Can't fail, as the node we just freed holds it.
+				continue;
+			}
+
+			//Grown tiles keep their old allocation until the new one succeeds.
+			ShadowAtlasTile allocatedTile;
+			if (AllocateTile(m_TileSizes[requestIndex], allocatedTile))
+			{
+				ReleaseTile(tile);
+				tile = allocatedTile;
+			}
+			else if (tile.m_Size == 0 || requestsFitAtlas)
+			{
+				//Either a new tile has nowhere to go, or free space is merely fragmented. Repacking places every tile, shrinking the largest should they not fit.
+				RepackTiles(tileRequests, m_TileSizes);
+				return;
+			}
+			//Otherwise the atlas is full, and the tile stays as it is until space frees up.
+		}
+	}
+
+	void ShadowAtlas::ReleaseTile(ShadowAtlasTile& tile)
+	{
+		if (tile.m_Size == 0)
+		{
+			return;
+		}
+
+		uint32_t nodeLevel = tile.m_NodeLevel;
+		uint32_t nodeIndex = tile.m_NodeIndex;
+		m_NodeLevels[nodeLevel][nodeIndex] = Node_Free;
+		m_AllocatedArea -= tile.m_Size * tile.m_Size;
+
+		//Four free siblings merge back into their parent.
+		while (nodeLevel > 0)
+		{
+			std::vector<NodeState>& levelNodes = m_NodeLevels[nodeLevel];
+			const uint32_t firstSibling = nodeIndex & ~3u;
+			if (levelNodes[firstSibling] != Node_Free || levelNodes[firstSibling + 1] != Node_Free || levelNodes[firstSibling + 2] != Node_Free || levelNodes[firstSibling + 3] != Node_Free)
+			{
+				break;
+			}
+
+			std::fill(levelNodes.begin() + firstSibling, levelNodes.begin() + firstSibling + 4, Node_Unused);
+			nodeIndex >>= 2;
+			nodeLevel--;
+			m_NodeLevels[nodeLevel][nodeIndex] = Node_Free;
+		}
+
+		tile = ShadowAtlasTile();
+	}
+
+	void ShadowAtlas::BindTileTarget(const ShadowAtlasTile& tile, bool clearDepth)
+	{
+		BindTileRegion(m_AtlasTextureID, tile, clearDepth);
+	}
+
+	void ShadowAtlas::BindStaticCacheTarget(const ShadowAtlasTile& tile)
+	{
+		if (!m_StaticCacheTextureID)
+		{
+			CreateStaticCacheTexture();
+		}
+		BindTileRegion(m_StaticCacheTextureID, tile, true);
+	}
+
+	void ShadowAtlas::RestoreStaticCache(const ShadowAtlasTile& tile)
+	{
+		glCopyImageSubData(m_StaticCacheTextureID, GL_TEXTURE_2D, 0, tile.m_X, tile.m_Y, 0, m_AtlasTextureID, GL_TEXTURE_2D, 0, tile.m_X, tile.m_Y, 0, tile.m_Size, tile.m_Size, 1);
+	}
+
+	void ShadowAtlas::BindShadowMap(unsigned int textureUnit) const
+	{
+		glActiveTexture(GL_TEXTURE0 + textureUnit);
+		glBindTexture(GL_TEXTURE_2D, m_AtlasTextureID);
+	}
+
+	uint32_t ShadowAtlas::SelectTileSize(uint32_t currentSize, float desiredSize) const
+	{
+		static const float squareRootOfTwo = std::sqrt(2.0f);
+		desiredSize = std::min(std::max(desiredSize, (float)m_MinimumTileSize), (float)m_MaximumTileSize);
+		if (currentSize != 0 && desiredSize <= currentSize * squareRootOfTwo * (1.0f + g_TileSizeHysteresis) && desiredSize >= currentSize / (squareRootOfTwo * (1.0f + g_TileSizeHysteresis)))
+		{
+			return currentSize;
+		}
+
+		//The nearest power of two, halfway points being geometric.
+		uint32_t tileSize = m_MinimumTileSize;
+		while (tileSize < m_MaximumTileSize && desiredSize > tileSize * squareRootOfTwo)
+		{
+			tileSize *= 2;
+		}
+		return tileSize;
+	}
+
+	bool ShadowAtlas::AllocateTile(uint32_t tileSize, ShadowAtlasTile& tile)
+	{
+		uint32_t targetLevel = 0;
+		while ((m_AtlasResolution >> targetLevel) > tileSize)
+		{
+			targetLevel++;
+		}
+		if (tileSize == 0 || targetLevel >= (uint32_t)m_NodeLevels.size() || (m_AtlasResolution >> targetLevel) != tileSize)
+		{
+			return false;
+		}
+
+		//The smallest free node holding the tile is split down to its size.
+		for (int nodeLevel = (int)targetLevel; nodeLevel >= 0; nodeLevel--)
+		{
+			std::vector<NodeState>& levelNodes = m_NodeLevels[nodeLevel];
+			const auto freeNode = std::find(levelNodes.begin(), levelNodes.end(), Node_Free);
+			if (freeNode == levelNodes.end())
+			{
+				continue;
+			}
+
+			uint32_t nodeIndex = (uint32_t)(freeNode - levelNodes.begin());
+			for (uint32_t splitLevel = (uint32_t)nodeLevel; splitLevel < targetLevel; splitLevel++)
+			{
+				m_NodeLevels[splitLevel][nodeIndex] = Node_Split;
+				nodeIndex *= 4;
+				std::fill(m_NodeLevels[splitLevel + 1].begin() + nodeIndex, m_NodeLevels[splitLevel + 1].begin() + nodeIndex + 4, Node_Free);
+			}
+			m_NodeLevels[targetLevel][nodeIndex] = Node_Allocated;
+
+			tile.m_X = CompactMortonBits(nodeIndex) * tileSize;
+			tile.m_Y = CompactMortonBits(nodeIndex >> 1) * tileSize;
+			tile.m_Size = tileSize;
+			tile.m_AllocationIndex = ++m_AllocationCounter;
+			tile.m_NodeLevel = targetLevel;
+			tile.m_NodeIndex = nodeIndex;
+			m_AllocatedArea += tileSize * tileSize;
+			return true;
+		}
+		return false;
+	}
+
+	void ShadowAtlas::RepackTiles(std::vector<ShadowTileRequest>& tileRequests, std::vector<uint32_t>& tileSizes)
+	{
+		m_RepackCount++;
+		for (std::vector<NodeState>& levelNodes : m_NodeLevels)
+		{
+			std::fill(levelNodes.begin(), levelNodes.end(), Node_Unused);
+		}
+		m_NodeLevels[0][0] = Node_Free;
+		m_AllocatedArea = 0;
+
+		//Halve the largest tiles until they fit. The minimum tile size is small enough for every shadow caster to fit, which the renderer asserts.
+		uint64_t requestedArea = 0;
+		for (uint32_t tileSize : tileSizes)
+		{
+			requestedArea += (uint64_t)tileSize * tileSize;
+		}
+		while (requestedArea > (uint64_t)m_AtlasResolution * m_AtlasResolution)
+		{
+			uint32_t& largestTileSize = *std::max_element(tileSizes.begin(), tileSizes.end());
+			if (largestTileSize <= m_MinimumTileSize)
+			{
+				break;
+			}
+			requestedArea -= (uint64_t)largestTileSize * largestTileSize * 3 / 4;
+			largestTileSize /= 2;
+		}
+
+		m_PendingRequests.resize(tileRequests.size());
+		for (uint32_t i = 0; i < (uint32_t)tileRequests.size(); i++)
+		{
+			m_PendingRequests[i] = i;
+			*tileRequests[i].m_Tile = ShadowAtlasTile();
+		}
+		std::stable_sort(m_PendingRequests.begin(), m_PendingRequests.end(), [&tileSizes](uint32_t requestA, uint32_t requestB) { return tileSizes[requestA] > tileSizes[requestB]; });
+
+		for (uint32_t requestIndex : m_PendingRequests)
+		{
+			AllocateTile(tileSizes[requestIndex], *tileRequests[requestIndex].m_Tile);
+		}
+	}
+
+	void ShadowAtlas::ResizeAtlas(uint32_t atlasResolution)
+	{
+		m_AtlasResolution = atlasResolution;
+
+		m_NodeLevels.clear();
+		for (uint32_t nodeCount = 1; (atlasResolution >> (m_NodeLevels.size())) >= m_MinimumTileSize; nodeCount *= 4)
+		{
+			m_NodeLevels.emplace_back(nodeCount, Node_Unused);
+		}
+
+		if (m_AtlasTextureID)
+		{
+			glDeleteTextures(1, &m_AtlasTextureID);
+		}
+		if (m_StaticCacheTextureID)
+		{
+			glDeleteTextures(1, &m_StaticCacheTextureID);
+			m_StaticCacheTextureID = 0;
+		}
+		m_AttachedTextureID = 0;
+
+		//Immutable storage, as the atlas is only ever recreated whole.
+		glGenTextures(1, &m_AtlasTextureID);
+		glBindTexture(GL_TEXTURE_2D, m_AtlasTextureID);
+		glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT24, atlasResolution, atlasResolution);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+
+		float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		//Depth only. Whichever texture is being rendered into is attached whenever a tile is bound.
+		glBindFramebuffer(GL_FRAMEBUFFER, m_FramebufferID);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_AtlasTextureID, 0);
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		{
+			CrescentError("Shadow atlas framebuffer is incomplete.");
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		m_AttachedTextureID = m_AtlasTextureID;
+	}
+
+	void ShadowAtlas::CreateStaticCacheTexture()
+	{
+		//Only ever copied from, never sampled.
+		glGenTextures(1, &m_StaticCacheTextureID);
+		glBindTexture(GL_TEXTURE_2D, m_StaticCacheTextureID);
+		glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT24, m_AtlasResolution, m_AtlasResolution);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	void ShadowAtlas::BindTileRegion(unsigned int textureID, const ShadowAtlasTile& tile, bool clearDepth)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, m_FramebufferID);
+		if (textureID != m_AttachedTextureID)
+		{
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, textureID, 0);
+			m_AttachedTextureID = textureID;
+		}
+		glViewport(tile.m_X, tile.m_Y, tile.m_Size, tile.m_Size);
+
+		//Only the tile's own region, as the rest of the atlas belongs to other tiles.
+		if (clearDepth)
+		{
+			glEnable(GL_SCISSOR_TEST);
+			glScissor(tile.m_X, tile.m_Y, tile.m_Size, tile.m_Size);
+			glClear(GL_DEPTH_BUFFER_BIT);
+			glDisable(GL_SCISSOR_TEST);
+		}
+	}
+}
\ No newline at end of file
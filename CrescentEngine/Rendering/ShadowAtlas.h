@@ -0,0 +1,110 @@
+#pragma once
+#include <GL/glew.h>
+#include <vector>
+#include <cstdint>
+
+namespace Crescent
+{
+	/*
+		A single large depth texture that every shadow casting light renders into. Square, power of two tiles are handed out by a quadtree: each node is either
+		unused (an ancestor isn't split), free, split into four children or allocated, so that freeing a tile merges it back with its free siblings. Allocation
+		takes the smallest free node that can hold the tile, splitting it down as needed, which keeps large nodes whole for large requests.
+
+		Tile sizes are requested each frame from how large the area a tile covers appears on screen (see ShadowCascades::RequestTiles). A tile only changes size
+		once its request has moved well past the boundary between two sizes, so that requests hovering around one don't reallocate it every frame. Tiles are
+		resized in place where space allows. When a new tile doesn't fit, or free space is too fragmented for a grown one, every tile is repacked from scratch,
+		largest first, shrinking the largest ones until they fit. Packing power of two squares in descending order never fragments a quadtree, so this always succeeds.
+
+		The atlas starts out with no texture at all, and grows (by powers of two, up to its maximum) whenever the requested tiles no longer fit its area, repacking
+		everything into the larger texture. Video memory thus follows what the visible shadow casters need. It is never shrunk again, as that would reallocate
+		every tile for the sake of memory the engine is evidently willing to spend.
+	*/
+
+	struct ShadowAtlasTile
+	{
+		uint32_t m_X = 0;
+		uint32_t m_Y = 0;
+		uint32_t m_Size = 0; //0 while the tile isn't allocated.
+		uint32_t m_AllocationIndex = 0; //Unique to each allocation, so that anything cached in a tile can tell it was reallocated, even at the same place.
+
+		//Quadtree node, for freeing.
+		uint32_t m_NodeLevel = 0;
+		uint32_t m_NodeIndex = 0;
+	};
+
+	struct ShadowTileRequest
+	{
+		ShadowAtlasTile* m_Tile = nullptr;
+		float m_DesiredSize = 0.0f; //In texels, before being rounded to a power of two.
+	};
+
+	class ShadowAtlas
+	{
+	public:
+		ShadowAtlas(uint32_t maximumAtlasResolution, uint32_t minimumTileSize, uint32_t maximumTileSize);
+		~ShadowAtlas();
+
+		ShadowAtlas(const ShadowAtlas&) = delete;
+		ShadowAtlas& operator=(const ShadowAtlas&) = delete;
+
+		//Resizes, allocates or repacks the requested tiles. Every allocated tile must be requested, or have been released beforehand.
+		void UpdateTiles(std::vector<ShadowTileRequest>& tileRequests);
+		void ReleaseTile(ShadowAtlasTile& tile);
+
+		//Binds the tile's region for rendering casters into, clearing it if asked.
+		void BindTileTarget(const ShadowAtlasTile& tile, bool clearDepth);
+		//Binds and clears the tile's region of the static cache.
+		void BindStaticCacheTarget(const ShadowAtlasTile& tile);
+		//Copies the tile's region of the static cache into the atlas.
+		void RestoreStaticCache(const ShadowAtlasTile& tile);
+		void BindShadowMap(unsigned int textureUnit) const;
+
+		uint32_t RetrieveAtlasResolution() const { return m_AtlasResolution; } //0 until the first tile is allocated.
+		unsigned int RetrieveAtlasTextureID() const { return m_AtlasTextureID; }
+		uint32_t RetrieveAllocatedArea() const { return m_AllocatedArea; } //In texels.
+		uint32_t RetrieveRepackCount() const { return m_RepackCount; } //Since the atlas was created.
+
+		//Reference - Independent of OpenGL. Rounds the desired size to a power of two within our tile sizes, keeping the current size while the desired one is
+		//within the hysteresis band around it.
+		uint32_t SelectTileSize(uint32_t currentSize, float desiredSize) const;
+
+	private:
+		enum NodeState : uint8_t
+		{
+			Node_Unused,
+			Node_Free,
+			Node_Split,
+			Node_Allocated
+		};
+
+		//Allocation - Independent of OpenGL.
+		bool AllocateTile(uint32_t tileSize, ShadowAtlasTile& tile);
+		void RepackTiles(std::vector<ShadowTileRequest>& tileRequests, std::vector<uint32_t>& tileSizes);
+
+		//Recreates the atlas at the given size. Tiles must be repacked afterwards, and the static cache is recreated on its next use.
+		void ResizeAtlas(uint32_t atlasResolution);
+		void CreateStaticCacheTexture();
+		void BindTileRegion(unsigned int textureID, const ShadowAtlasTile& tile, bool clearDepth);
+
+	private:
+		uint32_t m_AtlasResolution = 0;
+		uint32_t m_MaximumAtlasResolution = 0;
+		uint32_t m_MinimumTileSize = 0;
+		uint32_t m_MaximumTileSize = 0;
+
+		unsigned int m_FramebufferID = 0;
+		unsigned int m_AtlasTextureID = 0;
+		unsigned int m_StaticCacheTextureID = 0;
+		unsigned int m_AttachedTextureID = 0;
+
+		//Quadtree - Level L holds 4^L nodes of m_AtlasResolution >> L texels, indexed in Morton order so that a node's children are 4i to 4i + 3.
+		std::vector<std::vector<NodeState>> m_NodeLevels;
+		uint32_t m_AllocationCounter = 0;
+		uint32_t m_AllocatedArea = 0;
+		uint32_t m_RepackCount = 0;
+
+		//Scratch memory, kept between frames.
+		std::vector<uint32_t> m_TileSizes;
+		std::vector<uint32_t> m_PendingRequests;
+	};
+}
\ No newline at end of file
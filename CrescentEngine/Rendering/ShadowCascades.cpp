@@ -0,0 +1,188 @@
+#include "CrescentPCH.h"
+#include "ShadowCascades.h"
+#include "../Utilities/Camera.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace Crescent
+{
+	//Cascade radii are rounded up to this, so that floating point noise in the fitted sphere doesn't resize (and thus shimmer) the cascade.
+	static constexpr float g_CascadeRadiusGranularity = 1.0f / 16.0f;
+
+	ShadowCascades::ShadowCascades(ShadowAtlas* shadowAtlas) : m_ShadowAtlas(shadowAtlas)
+	{
+	}
+
+	ShadowCascades::~ShadowCascades()
+	{
+		ReleaseTiles();
+	}
+
+	void ShadowCascades::UpdateCascades(const Camera& camera, const glm::vec3& lightDirection, const ShadowCascadeSettings& cascadeSettings)
+	{
+		m_CascadeCount = FitCascades(camera, lightDirection, cascadeSettings, m_Cascades);
+	}
+
+	void ShadowCascades::RequestTiles(const Camera& camera, float viewportHeight, float resolutionScale, std::vector<ShadowTileRequest>& tileRequests)
+	{
+		//A pixel spans 2 / (projection[1][1] * viewportHeight) world units, times the view depth for perspective projections.
+		const float pixelsPerWorldUnit = camera.m_ProjectionMatrix[1][1] * viewportHeight * 0.5f;
+
+		float splitNear = camera.m_NearClip;
+		for (uint32_t cascadeIndex = 0; cascadeIndex < m_CascadeCount; cascadeIndex++)
+		{
+			//Depths in a cascade are weighted geometrically, as its pixels shrink towards the near end much faster than they grow towards the far one.
+			const ShadowCascade& cascade = m_Cascades[cascadeIndex];
+			const float cascadeDepth = camera.m_IsPerspectiveCamera ? std::sqrt(std::max(splitNear, camera.m_NearClip) * cascade.m_SplitDepth) : 1.0f;
+			const float cascadePixels = cascade.m_HalfExtent * 2.0f * pixelsPerWorldUnit / cascadeDepth;
+			tileRequests.push_back({ &m_CascadeTiles[cascadeIndex], cascadePixels * resolutionScale });
+			splitNear = cascade.m_SplitDepth;
+		}
+
+		for (uint32_t cascadeIndex = m_CascadeCount; cascadeIndex < g_MaximumShadowCascades; cascadeIndex++)
+		{
+			m_ShadowAtlas->ReleaseTile(m_CascadeTiles[cascadeIndex]);
+		}
+	}
+
+	void ShadowCascades::ApplyTiles()
+	{
+		const float atlasResolution = (float)m_ShadowAtlas->RetrieveAtlasResolution();
+		for (uint32_t cascadeIndex = 0; cascadeIndex < m_CascadeCount; cascadeIndex++)
+		{
+			const ShadowAtlasTile& cascadeTile = m_CascadeTiles[cascadeIndex];
+			ShadowCascade& cascade = m_Cascades[cascadeIndex];
+
+			//Scales the cascade's clip space down onto the tile's part of the atlas' clip space.
+			const float tileScale = cascadeTile.m_Size / atlasResolution;
+			const glm::vec2 tileOffset = glm::vec2(cascadeTile.m_X, cascadeTile.m_Y) / atlasResolution;
+			const glm::mat4 tileMatrix = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(tileOffset * 2.0f + tileScale - 1.0f, 0.0f)), glm::vec3(tileScale, tileScale, 1.0f));
+
+			cascade.m_AtlasViewProjection = tileMatrix * cascade.m_ViewProjection;
+			cascade.m_AtlasBounds = glm::vec4(tileOffset, tileOffset + tileScale);
+			cascade.m_DepthBias = cascadeTile.m_Size ? (cascade.m_HalfExtent * 2.0f / cascadeTile.m_Size) / cascade.m_DepthRange : 0.0f;
+		}
+	}
+
+	void ShadowCascades::ReleaseTiles()
+	{
+		for (ShadowAtlasTile& cascadeTile : m_CascadeTiles)
+		{
+			m_ShadowAtlas->ReleaseTile(cascadeTile);
+		}
+	}
+
+	void ShadowCascades::BindCascadeTarget(uint32_t cascadeIndex, bool clearDepth)
+	{
+		m_ShadowAtlas->BindTileTarget(m_CascadeTiles[cascadeIndex], clearDepth);
+		m_StaticCacheEntries[cascadeIndex].m_Restored = false;
+	}
+
+	void ShadowCascades::BindShadowMap(unsigned int textureUnit) const
+	{
+		m_ShadowAtlas->BindShadowMap(textureUnit);
+	}
+
+	bool ShadowCascades::IsStaticCacheCurrent(uint32_t cascadeIndex, uint64_t staticGeometryVersion) const
+	{
+		//Fitted matrices are snapped, so they come out bit for bit the same for as long as neither the camera nor the light has moved by a whole step.
+		const StaticCacheEntry& cacheEntry = m_StaticCacheEntries[cascadeIndex];
+		return cacheEntry.m_Valid && cacheEntry.m_GeometryVersion == staticGeometryVersion && cacheEntry.m_TileAllocationIndex == m_CascadeTiles[cascadeIndex].m_AllocationIndex &&
+			cacheEntry.m_ViewProjection == m_Cascades[cascadeIndex].m_ViewProjection;
+	}
+
+	void ShadowCascades::BindStaticCacheTarget(uint32_t cascadeIndex, uint64_t staticGeometryVersion)
+	{
+		m_ShadowAtlas->BindStaticCacheTarget(m_CascadeTiles[cascadeIndex]);
+
+		StaticCacheEntry& cacheEntry = m_StaticCacheEntries[cascadeIndex];
+		cacheEntry.m_ViewProjection = m_Cascades[cascadeIndex].m_ViewProjection;
+		cacheEntry.m_TileAllocationIndex = m_CascadeTiles[cascadeIndex].m_AllocationIndex;
+		cacheEntry.m_GeometryVersion = staticGeometryVersion;
+		cacheEntry.m_Valid = true;
+		cacheEntry.m_Restored = false;
+	}
+
+	void ShadowCascades::RestoreStaticCache(uint32_t cascadeIndex)
+	{
+		m_ShadowAtlas->RestoreStaticCache(m_CascadeTiles[cascadeIndex]);
+		m_StaticCacheEntries[cascadeIndex].m_Restored = true;
+	}
+
+	uint32_t ShadowCascades::FitCascades(const Camera& camera, const glm::vec3& lightDirection, const ShadowCascadeSettings& cascadeSettings, ShadowCascade* cascades)
+	{
+		const uint32_t cascadeCount = std::min(std::max(cascadeSettings.m_CascadeCount, 1u), g_MaximumShadowCascades);
+		const float nearClip = camera.m_NearClip;
+		const float farClip = std::max(std::min(camera.m_FarClip, cascadeSettings.m_ShadowDistance), nearClip * 2.0f);
+
+		//The corners of the camera's frustum, on its near and far clip planes. Points along each edge between them move linearly in view depth.
+		const glm::mat4 inverseViewProjection = glm::inverse(camera.m_ProjectionMatrix * camera.m_ViewMatrix);
+		glm::vec3 nearCorners[4];
+		glm::vec3 farCorners[4];
+		for (uint32_t corner = 0; corner < 4; corner++)
+		{
+			const glm::vec2 deviceCoordinates = glm::vec2((corner & 1) ? 1.0f : -1.0f, (corner & 2) ? 1.0f : -1.0f);
+			const glm::vec4 nearCorner = inverseViewProjection * glm::vec4(deviceCoordinates, -1.0f, 1.0f);
+			const glm::vec4 farCorner = inverseViewProjection * glm::vec4(deviceCoordinates, 1.0f, 1.0f);
+			nearCorners[corner] = glm::vec3(nearCorner) / nearCorner.w;
+			farCorners[corner] = glm::vec3(farCorner) / farCorner.w;
+		}
+
+		//Rotation only, so that snapping to texels in light space is independent of where the cascade lies.
+		glm::vec3 direction = glm::length(lightDirection) > 0.0f ? glm::normalize(lightDirection) : glm::vec3(0.0f, -1.0f, 0.0f);
+		const glm::vec3 upDirection = std::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+		const glm::mat4 lightRotation = glm::lookAt(glm::vec3(0.0f), direction, upDirection);
+
+		const float cameraDepthRange = camera.m_FarClip - camera.m_NearClip;
+		float splitNear = nearClip;
+		for (uint32_t cascadeIndex = 0; cascadeIndex < cascadeCount; cascadeIndex++)
+		{
+			const float splitFraction = (float)(cascadeIndex + 1) / cascadeCount;
+			const float logarithmicSplit = nearClip * std::pow(farClip / nearClip, splitFraction);
+			const float uniformSplit = nearClip + (farClip - nearClip) * splitFraction;
+			const float splitFar = cascadeSettings.m_SplitBlend * logarithmicSplit + (1.0f - cascadeSettings.m_SplitBlend) * uniformSplit;
+
+			glm::vec3 subFrustumCorners[8];
+			glm::vec3 subFrustumCenter = glm::vec3(0.0f);
+			for (uint32_t corner = 0; corner < 4; corner++)
+			{
+				subFrustumCorners[corner] = glm::mix(nearCorners[corner], farCorners[corner], (splitNear - camera.m_NearClip) / cameraDepthRange);
+				subFrustumCorners[corner + 4] = glm::mix(nearCorners[corner], farCorners[corner], (splitFar - camera.m_NearClip) / cameraDepthRange);
+				subFrustumCenter += subFrustumCorners[corner] + subFrustumCorners[corner + 4];
+			}
+			subFrustumCenter /= 8.0f;
+
+			float cascadeRadius = 0.0f;
+			for (const glm::vec3& subFrustumCorner : subFrustumCorners)
+			{
+				cascadeRadius = std::max(cascadeRadius, glm::length(subFrustumCorner - subFrustumCenter));
+			}
+			cascadeRadius = std::ceil(cascadeRadius / g_CascadeRadiusGranularity) * g_CascadeRadiusGranularity;
+
+			//Moving the cascade by whole texels only keeps each caster's rasterization the same from one frame to the next. Snapping moves the cascade by up to
+			//one step off the sphere's center, so the cascade is widened by exactly that step, which is 2/g_MinimumShadowTileSize of its width.
+			const float halfExtent = cascadeRadius * g_MinimumShadowTileSize / (g_MinimumShadowTileSize - 2.0f);
+			const float snapSize = halfExtent * 2.0f / g_MinimumShadowTileSize;
+			glm::vec3 lightSpaceCenter = glm::vec3(lightRotation * glm::vec4(subFrustumCenter, 1.0f));
+			lightSpaceCenter.x = std::floor(lightSpaceCenter.x / snapSize) * snapSize;
+			lightSpaceCenter.y = std::floor(lightSpaceCenter.y / snapSize) * snapSize;
+
+			//Light space looks down -Z, so depths are negated Z values.
+			const float depthNear = -lightSpaceCenter.z - cascadeRadius - cascadeSettings.m_CasterPullback;
+			const float depthFar = -lightSpaceCenter.z + cascadeRadius;
+
+			ShadowCascade& cascade = cascades[cascadeIndex];
+			cascade.m_View = lightRotation;
+			cascade.m_Projection = glm::ortho(lightSpaceCenter.x - halfExtent, lightSpaceCenter.x + halfExtent, lightSpaceCenter.y - halfExtent, lightSpaceCenter.y + halfExtent, depthNear, depthFar);
+			cascade.m_ViewProjection = cascade.m_Projection * cascade.m_View;
+			cascade.m_SplitDepth = splitFar;
+			cascade.m_HalfExtent = halfExtent;
+			cascade.m_DepthRange = depthFar - depthNear;
+
+			splitNear = splitFar;
+		}
+
+		return cascadeCount;
+	}
+}
\ No newline at end of file
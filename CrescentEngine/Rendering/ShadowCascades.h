@@ -0,0 +1,107 @@
+#pragma once
+#include "UniformBlocks.h"
+#include "ShadowAtlas.h"
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+
+namespace Crescent
+{
+	class Camera;
+
+	/*
+		Cascaded shadow map of a directional light. The camera's view frustum, up to our shadow distance, is split into sub-frustums with the practical split
+		scheme: a blend of logarithmic splits, which keep texel density proportional to depth, and uniform ones, which keep the nearest cascade from becoming
+		needlessly thin. Each cascade gets an orthographic projection fitted around the bounding sphere of its sub-frustum, so that its size doesn't change as
+		the camera turns, and is snapped to whole texels in light space, so that shadow edges don't shimmer as the camera moves.
+
+		Each cascade renders into its own tile of the renderer's shadow atlas, sized by how many screen pixels a texel of it covers (see RequestTiles). As tiles
+		change size independently, cascades are snapped to 1/g_MinimumShadowTileSize of their width, which is a whole number of texels at every tile size. The
+		cascades are then selected (and blended across their borders) by view depth in Deferred/DirectionalFragment.shader.
+
+		Static casters can be kept in the atlas' static cache, in the same tile, valid for as long as the cascade's matrix, its tile and the static geometry it was
+		drawn with stay the same. Each frame, the cache is copied into the cascade's tile and only dynamic casters are drawn on top. Tiles left with nothing drawn
+		over their copy need no copy at all until something dynamic enters them.
+	*/
+
+	//Smallest tile the atlas hands out, and the fraction of their width cascades are snapped to.
+	static constexpr uint32_t g_MinimumShadowTileSize = 256;
+
+	struct ShadowCascadeSettings
+	{
+		uint32_t m_CascadeCount = 4; //Clamped to [1, g_MaximumShadowCascades].
+		float m_SplitBlend = 0.75f; //0 splits the shadowed range uniformly, 1 logarithmically.
+		float m_ShadowDistance = 100.0f; //Beyond which nothing receives shadows, should the camera see further.
+		float m_CasterPullback = 50.0f; //How far behind each cascade's bounds casters are still rendered, towards the light.
+		float m_BlendFraction = 0.1f; //Fraction of each cascade's depth range over which it fades into the next one.
+		float m_ResolutionScale = 1.0f; //Shadow texels per screen pixel each cascade's tile aims for, in the middle of its depth range.
+	};
+
+	struct ShadowCascade
+	{
+		glm::mat4 m_Projection = glm::mat4(1.0f);
+		glm::mat4 m_View = glm::mat4(1.0f);
+		glm::mat4 m_ViewProjection = glm::mat4(1.0f);
+		glm::mat4 m_AtlasViewProjection = glm::mat4(1.0f); //Into the atlas' clip space rather than the cascade's, for sampling its tile.
+		glm::vec4 m_AtlasBounds = glm::vec4(0.0f); //Texture coordinates of the tile's corners, minimum in xy and maximum in zw.
+		float m_SplitDepth = 0.0f; //View depth at which the cascade ends.
+		float m_HalfExtent = 0.0f; //Half of the cascade's width in world units.
+		float m_DepthRange = 0.0f; //In world units.
+		float m_DepthBias = 0.0f; //One texel's world size, in the cascade's [0, 1] depth range.
+	};
+
+	class ShadowCascades
+	{
+	public:
+		ShadowCascades(ShadowAtlas* shadowAtlas);
+		~ShadowCascades();
+
+		ShadowCascades(const ShadowCascades&) = delete;
+		ShadowCascades& operator=(const ShadowCascades&) = delete;
+
+		void UpdateCascades(const Camera& camera, const glm::vec3& lightDirection, const ShadowCascadeSettings& cascadeSettings);
+		//Appends a tile request per cascade, sized so that one texel covers 1/resolutionScale of a pixel as seen by the camera, and releases the tiles of any
+		//cascades no longer used. Once the atlas has updated the tiles, ApplyTiles maps our cascades into them.
+		void RequestTiles(const Camera& camera, float viewportHeight, float resolutionScale, std::vector<ShadowTileRequest>& tileRequests);
+		void ApplyTiles();
+		void ReleaseTiles();
+
+		//Binds the cascade's tile for rendering casters into, clearing it unless they are drawn over a restored cache.
+		void BindCascadeTarget(uint32_t cascadeIndex, bool clearDepth = true);
+		void BindShadowMap(unsigned int textureUnit) const;
+
+		//Static Cache - Keyed on the cascade's current matrix and tile, and the given version of the static geometry.
+		bool IsStaticCacheCurrent(uint32_t cascadeIndex, uint64_t staticGeometryVersion) const;
+		//Binds and clears the cascade's cached tile for rendering static casters into, keying it to our current matrix and tile.
+		void BindStaticCacheTarget(uint32_t cascadeIndex, uint64_t staticGeometryVersion);
+		//Copies the cached tile into the cascade's tile.
+		void RestoreStaticCache(uint32_t cascadeIndex);
+		//Whether the cascade's tile holds exactly its cache, with nothing bound for rendering over it since.
+		bool IsStaticCacheRestored(uint32_t cascadeIndex) const { return m_StaticCacheEntries[cascadeIndex].m_Restored; }
+
+		uint32_t RetrieveCascadeCount() const { return m_CascadeCount; }
+		const ShadowCascade& RetrieveCascade(uint32_t cascadeIndex) const { return m_Cascades[cascadeIndex]; }
+		const ShadowAtlasTile& RetrieveCascadeTile(uint32_t cascadeIndex) const { return m_CascadeTiles[cascadeIndex]; }
+
+		//Reference - Independent of OpenGL. Fills cascades with the camera's, returning how many there are. Atlas mappings and depth biases are left to ApplyTiles.
+		static uint32_t FitCascades(const Camera& camera, const glm::vec3& lightDirection, const ShadowCascadeSettings& cascadeSettings, ShadowCascade* cascades);
+
+	private:
+		struct StaticCacheEntry
+		{
+			glm::mat4 m_ViewProjection = glm::mat4(0.0f);
+			uint32_t m_TileAllocationIndex = 0;
+			uint64_t m_GeometryVersion = 0;
+			bool m_Valid = false;
+			bool m_Restored = false;
+		};
+
+	private:
+		ShadowAtlas* m_ShadowAtlas = nullptr;
+		ShadowAtlasTile m_CascadeTiles[g_MaximumShadowCascades];
+		StaticCacheEntry m_StaticCacheEntries[g_MaximumShadowCascades];
+
+		ShadowCascade m_Cascades[g_MaximumShadowCascades];
+		uint32_t m_CascadeCount = 0;
+	};
+}
\ No newline at end of file
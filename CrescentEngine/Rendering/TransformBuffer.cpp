@@ -0,0 +1,206 @@
+#include "CrescentPCH.h"
+#include "TransformBuffer.h"
+#include "UniformBlocks.h"
+#include <algorithm>
+
+namespace Crescent
+{
+	//Slots the storage buffer starts out with, so that small scenes never grow it.
+	static constexpr uint32_t g_MinimumStorageCapacity = 1024;
+
+	TransformBuffer::TransformBuffer(size_t stagingSegmentSize, unsigned int segmentCount)
+	{
+		m_SegmentSize = std::max(stagingSegmentSize / sizeof(TransformStorageEntry), (size_t)1) * sizeof(TransformStorageEntry);
+		m_SegmentFences.resize(segmentCount, nullptr);
+
+		//As with our uniform ring, persistent mapping depends on the extension in our 4.3 context.
+		if (GLEW_ARB_buffer_storage)
+		{
+			GLbitfield storageFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glGenBuffers(1, &m_StagingBufferID);
+			glBindBuffer(GL_COPY_READ_BUFFER, m_StagingBufferID);
+			glBufferStorage(GL_COPY_READ_BUFFER, m_SegmentSize * segmentCount, nullptr, storageFlags);
+			m_MappedMemory = (uint8_t*)glMapBufferRange(GL_COPY_READ_BUFFER, 0, m_SegmentSize * segmentCount, storageFlags);
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		}
+		else
+		{
+			m_SystemMemory.resize(m_SegmentSize * segmentCount);
+		}
+
+		EnsureStorageCapacity(g_MinimumStorageCapacity);
+	}
+
+	TransformBuffer::~TransformBuffer()
+	{
+		for (GLsync& segmentFence : m_SegmentFences)
+		{
+			if (segmentFence)
+			{
+				glDeleteSync(segmentFence);
+			}
+		}
+
+		if (m_MappedMemory)
+		{
+			glBindBuffer(GL_COPY_READ_BUFFER, m_StagingBufferID);
+			glUnmapBuffer(GL_COPY_READ_BUFFER);
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+			glDeleteBuffers(1, &m_StagingBufferID);
+		}
+		glDeleteBuffers(1, &m_StorageBufferID);
+	}
+
+	void TransformBuffer::ReserveSlots(uint32_t persistentSlotCount)
+	{
+		if (persistentSlotCount > m_PersistentSlotCount)
+		{
+			//Grown geometrically, as every growth copies the whole buffer.
+			m_PersistentSlotCount = std::max(persistentSlotCount, m_PersistentSlotCount * 2);
+			EnsureStorageCapacity(m_PersistentSlotCount);
+		}
+	}
+
+	void TransformBuffer::WriteSlot(uint32_t transformSlot, const glm::mat4& modelMatrix)
+	{
+		TransformStorageEntry* storageEntry = AllocateStagingEntry(transformSlot);
+		storageEntry->m_Model = modelMatrix;
+		storageEntry->m_NormalMatrix = glm::mat4(glm::transpose(glm::inverse(glm::mat3(modelMatrix))));
+	}
+
+	uint32_t TransformBuffer::WriteTransientSlot(const glm::mat4& modelMatrix)
+	{
+		uint32_t transformSlot = m_PersistentSlotCount + m_TransientSlotCount++;
+		WriteSlot(transformSlot, modelMatrix);
+		return transformSlot;
+	}
+
+	TransformStorageEntry* TransformBuffer::AllocateStagingEntry(uint32_t transformSlot)
+	{
+		//A full segment is copied out before we move on, as the next one may be reused before this frame's flush.
+		if (m_SegmentOffset + sizeof(TransformStorageEntry) > m_SegmentSize)
+		{
+			FlushUploads();
+			AdvanceSegment();
+		}
+
+		size_t stagingOffset = m_CurrentSegment * m_SegmentSize + m_SegmentOffset;
+		m_SegmentOffset += sizeof(TransformStorageEntry);
+		m_UploadedSlotCount++;
+
+		//Slots arrive mostly in ascending order, so neighbouring slots extend the last region rather than adding a copy of their own.
+		CopyRegion* lastRegion = m_CopyRegions.empty() ? nullptr : &m_CopyRegions.back();
+		if (lastRegion && lastRegion->m_FirstSlot + lastRegion->m_SlotCount == transformSlot && lastRegion->m_StagingOffset + lastRegion->m_SlotCount * sizeof(TransformStorageEntry) == stagingOffset)
+		{
+			lastRegion->m_SlotCount++;
+		}
+		else
+		{
+			CopyRegion copyRegion;
+			copyRegion.m_StagingOffset = stagingOffset;
+			copyRegion.m_FirstSlot = transformSlot;
+			copyRegion.m_SlotCount = 1;
+			m_CopyRegions.push_back(copyRegion);
+		}
+
+		uint8_t* stagingMemory = m_MappedMemory ? m_MappedMemory : m_SystemMemory.data();
+		return (TransformStorageEntry*)(stagingMemory + stagingOffset);
+	}
+
+	void TransformBuffer::FlushUploads()
+	{
+		EnsureStorageCapacity(m_PersistentSlotCount + m_TransientSlotCount);
+
+		if (!m_CopyRegions.empty())
+		{
+			if (m_MappedMemory)
+			{
+				glBindBuffer(GL_COPY_READ_BUFFER, m_StagingBufferID);
+				glBindBuffer(GL_COPY_WRITE_BUFFER, m_StorageBufferID);
+				for (const CopyRegion& copyRegion : m_CopyRegions)
+				{
+					glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, copyRegion.m_StagingOffset, copyRegion.m_FirstSlot * sizeof(TransformStorageEntry), copyRegion.m_SlotCount * sizeof(TransformStorageEntry));
+				}
+				glBindBuffer(GL_COPY_READ_BUFFER, 0);
+				glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+			}
+			else
+			{
+				glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_StorageBufferID);
+				for (const CopyRegion& copyRegion : m_CopyRegions)
+				{
+					glBufferSubData(GL_SHADER_STORAGE_BUFFER, copyRegion.m_FirstSlot * sizeof(TransformStorageEntry), copyRegion.m_SlotCount * sizeof(TransformStorageEntry), m_SystemMemory.data() + copyRegion.m_StagingOffset);
+				}
+				glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+			}
+			m_CopyRegions.clear();
+		}
+
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, StorageBlock_Transforms, m_StorageBufferID);
+	}
+
+	void TransformBuffer::EndFrame()
+	{
+		if (m_SegmentOffset > 0)
+		{
+			FlushUploads();
+			AdvanceSegment();
+		}
+
+		m_TransientSlotCount = 0;
+		m_UploadedSlotCount = 0;
+	}
+
+	void TransformBuffer::EnsureStorageCapacity(uint32_t slotCount)
+	{
+		if (slotCount <= m_StorageCapacity)
+		{
+			return;
+		}
+
+		//Slots already uploaded are carried over on the GPU, so growing never re-uploads matrices.
+		uint32_t newCapacity = std::max(slotCount, m_StorageCapacity * 2);
+		unsigned int newBufferID = 0;
+		glGenBuffers(1, &newBufferID);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, newBufferID);
+		glBufferData(GL_COPY_WRITE_BUFFER, newCapacity * sizeof(TransformStorageEntry), nullptr, GL_DYNAMIC_DRAW);
+
+		if (m_StorageBufferID)
+		{
+			glBindBuffer(GL_COPY_READ_BUFFER, m_StorageBufferID);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, m_StorageCapacity * sizeof(TransformStorageEntry));
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+			glDeleteBuffers(1, &m_StorageBufferID);
+		}
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		m_StorageBufferID = newBufferID;
+		m_StorageCapacity = newCapacity;
+	}
+
+	void TransformBuffer::AdvanceSegment()
+	{
+		m_CurrentSegment = (m_CurrentSegment + 1) % m_SegmentFences.size();
+		m_SegmentOffset = 0;
+
+		//System memory is consumed by glBufferSubData right away, and needs no fencing.
+		if (!m_MappedMemory)
+		{
+			return;
+		}
+
+		//Fence the copies out of the segment we just filled, then make sure the GPU is done with the one we're about to overwrite.
+		unsigned int filledSegment = (m_CurrentSegment + (unsigned int)m_SegmentFences.size() - 1) % m_SegmentFences.size();
+		m_SegmentFences[filledSegment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+		GLsync& segmentFence = m_SegmentFences[m_CurrentSegment];
+		if (segmentFence)
+		{
+			while (glClientWaitSync(segmentFence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+			{
+			}
+			glDeleteSync(segmentFence);
+			segmentFence = nullptr;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+
+namespace Crescent
+{
+	/*
+		GPU-resident copy of every render proxy's matrices, kept in a shader storage buffer indexed by transform slot (see Constants/Transforms.shader). Only
+		slots written since the last flush are uploaded: their entries are packed into a staging ring, split into fenced segments like our uniform ring, and
+		copied into place with one glCopyBufferSubData per run of neighbouring slots. A static scene thus uploads no matrices at all after its first frame.
+
+		Slots past the persistent ones are handed out per frame to commands that have no proxy, such as those pushed straight to the render queue.
+	*/
+
+	//Must match TransformEntry in Resources/Shaders/Constants/Transforms.shader, laid out as std430.
+	struct TransformStorageEntry
+	{
+		glm::mat4 m_Model;
+		glm::mat4 m_NormalMatrix; //Inverse transpose of the model matrix's upper 3x3, stored as a mat4 to keep entries 16 byte aligned.
+	};
+
+	static_assert(sizeof(TransformStorageEntry) == 128, "TransformStorageEntry no longer matches its std430 layout.");
+
+	class TransformBuffer
+	{
+	public:
+		TransformBuffer(size_t stagingSegmentSize, unsigned int segmentCount = 3);
+		~TransformBuffer();
+
+		//Makes room for the given number of persistent slots. Call before writing any slot in a frame, as growing moves the transient slots.
+		void ReserveSlots(uint32_t persistentSlotCount);
+		void WriteSlot(uint32_t transformSlot, const glm::mat4& modelMatrix);
+		//Returns a slot holding the matrix until the end of the frame.
+		uint32_t WriteTransientSlot(const glm::mat4& modelMatrix);
+
+		//Copies every slot written so far into the storage buffer and binds it for our shaders. Must precede any draw reading those slots.
+		void FlushUploads();
+		//Fences the staging memory written this frame and releases the transient slots. Called once per frame.
+		void EndFrame();
+
+		bool IsPersistentlyMapped() const { return m_MappedMemory != nullptr; }
+		uint32_t RetrieveUploadedSlotCount() const { return m_UploadedSlotCount; } //This frame.
+
+	private:
+		//Consecutive slots whose entries sit next to each other in the staging ring.
+		struct CopyRegion
+		{
+			size_t m_StagingOffset = 0;
+			uint32_t m_FirstSlot = 0;
+			uint32_t m_SlotCount = 0;
+		};
+
+		TransformStorageEntry* AllocateStagingEntry(uint32_t transformSlot);
+		void EnsureStorageCapacity(uint32_t slotCount);
+		void AdvanceSegment();
+
+	private:
+		unsigned int m_StorageBufferID = 0;
+		uint32_t m_StorageCapacity = 0; //In slots.
+		uint32_t m_PersistentSlotCount = 0; //Transient slots start here.
+		uint32_t m_TransientSlotCount = 0;
+
+		//Staging - Persistently mapped where ARB_buffer_storage is available. Otherwise, entries are staged in system memory and uploaded with glBufferSubData.
+		unsigned int m_StagingBufferID = 0;
+		uint8_t* m_MappedMemory = nullptr;
+		std::vector<uint8_t> m_SystemMemory;
+		size_t m_SegmentSize = 0;
+		size_t m_SegmentOffset = 0; //Write position within the current segment.
+		unsigned int m_CurrentSegment = 0;
+		std::vector<GLsync> m_SegmentFences;
+
+		std::vector<CopyRegion> m_CopyRegions;
+		uint32_t m_UploadedSlotCount = 0;
+	};
+}
\ No newline at end of file
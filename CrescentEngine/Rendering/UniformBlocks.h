@@ -0,0 +1,55 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+
+namespace Crescent
+{
+	/*
+		CPU mirrors of the uniform blocks declared in Resources/Shaders/Constants/Uniforms.shader. Both sides use the std140 layout, so members here
+		must stay in the same order and be padded to 16 bytes where std140 would.
+	*/
+
+	static constexpr unsigned int g_MaximumShadowCasters = 4;
+	static constexpr unsigned int g_MaximumShadowCascades = 4; //Per shadow caster. See ShadowCascades.
+
+	enum UniformBlockBinding
+	{
+		UniformBlock_Frame = 0,
+		UniformBlock_Draw = 1,
+		UniformBlock_Material = 2 //Declared per shader as MaterialUniforms, as its contents differ between shaders. Filled from each material's baked parameter block.
+	};
+
+	//Shader storage blocks have binding points of their own.
+	enum StorageBlockBinding
+	{
+		StorageBlock_Transforms = 0, //See TransformBuffer.
+		StorageBlock_PointLights = 1, //See PointLightBuffer.
+		StorageBlock_ClusterBounds = 2, //See LightClusters.
+		StorageBlock_ClusterLightCounts = 3,
+		StorageBlock_ClusterLightIndices = 4
+	};
+
+	//Updated whenever the camera used for rendering changes, and once shadow maps are rendered.
+	struct FrameUniformBlock
+	{
+		glm::mat4 m_Projection;
+		glm::mat4 m_View;
+		glm::mat4 m_ShadowCascadeViewProjections[g_MaximumShadowCascades]; //Of our first shadow casting light, whose cascades are bound for shadow receiving materials. Into its atlas tiles.
+		glm::vec4 m_ShadowCascadeSplits; //View depth at which each of those cascades ends.
+		glm::vec4 m_CameraPosition; //W is unused.
+		int32_t m_ShadowsEnabled;
+		int32_t m_ShadowCascadeCount;
+		int32_t m_Padding[2];
+	};
+
+	//Streamed per command through the renderer's uniform ring buffer.
+	struct DrawUniformBlock
+	{
+		glm::mat4 m_Model;
+		uint32_t m_TransformSlot; //Into our transform buffer, or g_NullTransformSlot for draws that only set their model matrix.
+		uint32_t m_Padding[3];
+	};
+
+	static_assert(sizeof(FrameUniformBlock) == 432, "FrameUniformBlock no longer matches its std140 layout.");
+	static_assert(sizeof(DrawUniformBlock) == 80, "DrawUniformBlock no longer matches its std140 layout.");
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "CrescentPCH.h"
+#include "UniformRingBuffer.h"
+#include <cstring>
+
+namespace Crescent
+{
+	UniformRingBuffer::UniformRingBuffer(size_t segmentSize, unsigned int segmentCount)
+	{
+		GLint offsetAlignment = 0;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+		if (offsetAlignment > 0)
+		{
+			m_OffsetAlignment = (size_t)offsetAlignment;
+		}
+
+		m_SegmentSize = (segmentSize + m_OffsetAlignment - 1) / m_OffsetAlignment * m_OffsetAlignment;
+		m_SegmentFences.resize(segmentCount, nullptr);
+
+		glGenBuffers(1, &m_BufferID);
+		glBindBuffer(GL_UNIFORM_BUFFER, m_BufferID);
+
+		//Our context is 4.3, so persistent mapping depends on the extension. Without it, we map each write unsynchronized and rely on our fences instead.
+		if (GLEW_ARB_buffer_storage)
+		{
+			GLbitfield storageFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glBufferStorage(GL_UNIFORM_BUFFER, m_SegmentSize * segmentCount, nullptr, storageFlags);
+			m_MappedMemory = (uint8_t*)glMapBufferRange(GL_UNIFORM_BUFFER, 0, m_SegmentSize * segmentCount, storageFlags);
+		}
+		else
+		{
+			glBufferData(GL_UNIFORM_BUFFER, m_SegmentSize * segmentCount, nullptr, GL_STREAM_DRAW);
+		}
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+
+	UniformRingBuffer::~UniformRingBuffer()
+	{
+		for (GLsync& segmentFence : m_SegmentFences)
+		{
+			if (segmentFence)
+			{
+				glDeleteSync(segmentFence);
+			}
+		}
+
+		if (m_MappedMemory)
+		{
+			glBindBuffer(GL_UNIFORM_BUFFER, m_BufferID);
+			glUnmapBuffer(GL_UNIFORM_BUFFER);
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		}
+		glDeleteBuffers(1, &m_BufferID);
+	}
+
+	void UniformRingBuffer::BindUniformData(unsigned int bindingPoint, const void* data, size_t dataSize)
+	{
+		size_t alignedSize = (dataSize + m_OffsetAlignment - 1) / m_OffsetAlignment * m_OffsetAlignment;
+		if (m_SegmentOffset + alignedSize > m_SegmentSize)
+		{
+			AdvanceSegment();
+		}
+
+		size_t bufferOffset = m_CurrentSegment * m_SegmentSize + m_SegmentOffset;
+		if (m_MappedMemory)
+		{
+			memcpy(m_MappedMemory + bufferOffset, data, dataSize);
+		}
+		else
+		{
+			glBindBuffer(GL_UNIFORM_BUFFER, m_BufferID);
+			void* mappedRange = glMapBufferRange(GL_UNIFORM_BUFFER, bufferOffset, dataSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+			memcpy(mappedRange, data, dataSize);
+			glUnmapBuffer(GL_UNIFORM_BUFFER);
+		}
+
+		glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, m_BufferID, bufferOffset, dataSize);
+		m_SegmentOffset += alignedSize;
+	}
+
+	void UniformRingBuffer::EndFrame()
+	{
+		if (m_SegmentOffset > 0)
+		{
+			AdvanceSegment();
+		}
+	}
+
+	void UniformRingBuffer::AdvanceSegment()
+	{
+		//Fence the segment we just filled, then make sure the GPU is done with the one we're about to overwrite.
+		m_SegmentFences[m_CurrentSegment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		m_CurrentSegment = (m_CurrentSegment + 1) % m_SegmentFences.size();
+		m_SegmentOffset = 0;
+
+		GLsync& segmentFence = m_SegmentFences[m_CurrentSegment];
+		if (segmentFence)
+		{
+			while (glClientWaitSync(segmentFence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED)
+			{
+			}
+			glDeleteSync(segmentFence);
+			segmentFence = nullptr;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+#include <GL/glew.h>
+#include <vector>
+#include <cstdint>
+
+namespace Crescent
+{
+	/*
+		Streams small per-draw uniform blocks to the GPU without any per-draw buffer allocation or driver synchronization. The buffer is split into segments
+		that are written front to back and bound with glBindBufferRange. Once a segment is full (or the frame ends), it is fenced and we move on to the next one,
+		only waiting if the GPU is still reading from it. Where ARB_buffer_storage is available, the buffer stays persistently mapped.
+	*/
+
+	class UniformRingBuffer
+	{
+	public:
+		UniformRingBuffer(size_t segmentSize, unsigned int segmentCount = 3);
+		~UniformRingBuffer();
+
+		//Copies the data into the ring and binds its range to the given uniform block binding point.
+		void BindUniformData(unsigned int bindingPoint, const void* data, size_t dataSize);
+
+		//Fences everything written so far. Called once per frame.
+		void EndFrame();
+
+		bool IsPersistentlyMapped() const { return m_MappedMemory != nullptr; }
+
+	private:
+		void AdvanceSegment();
+
+	private:
+		unsigned int m_BufferID = 0;
+		uint8_t* m_MappedMemory = nullptr;
+
+		size_t m_SegmentSize = 0;
+		size_t m_OffsetAlignment = 256; //Queried from GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT.
+		size_t m_SegmentOffset = 0; //Write position within the current segment.
+		unsigned int m_CurrentSegment = 0;
+		std::vector<GLsync> m_SegmentFences;
+	};
+}
\ No newline at end of file
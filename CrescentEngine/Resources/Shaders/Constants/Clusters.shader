@@ -0,0 +1,43 @@
+//Must match the cluster grid in Rendering/LightClusters.h. Requires #version 430.
+#define CLUSTER_COUNT_X 16u
+#define CLUSTER_COUNT_Y 9u
+#define CLUSTER_COUNT_Z 24u
+#define CLUSTER_COUNT (CLUSTER_COUNT_X * CLUSTER_COUNT_Y * CLUSTER_COUNT_Z)
+#define MAXIMUM_LIGHTS_PER_CLUSTER 256u
+
+//Shaders writing the light lists define this as writeonly before including us.
+#ifndef CLUSTER_LIST_QUALIFIER
+#define CLUSTER_LIST_QUALIFIER readonly
+#endif
+
+struct ClusterBounds
+{
+	vec4 minimum; //View space. W is unused.
+	vec4 maximum;
+};
+
+layout (std430, binding = 2) readonly buffer ClusterBoundsStorage
+{
+	ClusterBounds clusterBounds[];
+};
+
+layout (std430, binding = 3) CLUSTER_LIST_QUALIFIER buffer ClusterLightCountStorage
+{
+	uint clusterLightCounts[];
+};
+
+//MAXIMUM_LIGHTS_PER_CLUSTER indices into PointLightStorage per cluster, starting at the cluster's index times that.
+layout (std430, binding = 4) CLUSTER_LIST_QUALIFIER buffer ClusterLightIndexStorage
+{
+	uint clusterLightIndices[];
+};
+
+uniform vec2 clusterTileSize; //In pixels.
+uniform vec2 clusterDepthScaleBias; //Maps the log of a view depth onto our exponential depth slices.
+
+uint RetrieveClusterIndex(vec2 fragmentCoordinates, float viewDepth)
+{
+	uvec2 tile = min(uvec2(fragmentCoordinates / clusterTileSize), uvec2(CLUSTER_COUNT_X - 1u, CLUSTER_COUNT_Y - 1u));
+	uint slice = uint(clamp(log(max(viewDepth, 1e-4)) * clusterDepthScaleBias.x + clusterDepthScaleBias.y, 0.0, float(CLUSTER_COUNT_Z - 1u)));
+	return tile.x + tile.y * CLUSTER_COUNT_X + slice * CLUSTER_COUNT_X * CLUSTER_COUNT_Y;
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+//Must match PointLightStorageEntry in Rendering/PointLightBuffer.h. Requires #version 430.
+struct PointLightEntry
+{
+	vec4 positionRadius; //World space position, with the light's radius in w.
+	vec4 colorIntensity; //Normalized color, with the light's intensity in w.
+};
+
+layout (std430, binding = 1) readonly buffer PointLightStorage
+{
+	PointLightEntry pointLights[];
+};
\ No newline at end of file
@@ -0,0 +1,13 @@
+//Must match TransformStorageEntry in Rendering/TransformBuffer.h. Requires #version 430.
+#define NULL_TRANSFORM_SLOT 0xFFFFFFFFu
+
+struct TransformEntry
+{
+	mat4 model;
+	mat4 normalMatrix; //Inverse transpose of the model matrix's upper 3x3.
+};
+
+layout (std430, binding = 0) readonly buffer TransformStorage
+{
+	TransformEntry transforms[];
+};
\ No newline at end of file
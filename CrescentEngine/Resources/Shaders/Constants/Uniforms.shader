@@ -0,0 +1,17 @@
+//Must match the std140 blocks in Rendering/UniformBlocks.h.
+layout (std140, binding = 0) uniform FrameUniforms
+{
+	mat4 projection;
+	mat4 view;
+	mat4 shadowCascadeViewProjections[4];
+	vec4 shadowCascadeSplits;
+	vec4 cameraPosition;
+	bool ShadowsEnabled;
+	int shadowCascadeCount;
+};
+
+layout (std140, binding = 1) uniform DrawUniforms
+{
+	mat4 model;
+	uint transformSlot; //Slot of the command in Constants/Transforms.shader, or NULL_TRANSFORM_SLOT for draws that only set the model matrix.
+};
\ No newline at end of file
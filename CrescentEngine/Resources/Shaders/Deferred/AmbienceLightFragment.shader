@@ -6,6 +6,7 @@ in vec2 TexCoords;
 #include ../Constants/Constants.shader
 #include ../Constants/BRDF.shader
 #include ../Constants/Reflections.shader
+#include ../Constants/Uniforms.shader
 
 uniform samplerCube envIrradiance;
 uniform samplerCube envPrefilter;
@@ -17,7 +18,6 @@ uniform sampler2D gAlbedoAO;
 
 uniform int SSAO;
 uniform sampler2D TexSSAO;
-uniform vec3 camPos;
 
 void main()
 {
@@ -40,7 +40,7 @@ void main()
 
     // lighting data
     vec3 N = normalize(normal);
-    vec3 V = normalize(camPos.xyz - worldPos);
+    vec3 V = normalize(cameraPosition.xyz - worldPos);
     vec3 R = reflect(-V, N);
 
     // calculate color/reflectance at normal incidence
@@ -0,0 +1,55 @@
+#version 430 core
+#define CLUSTER_LIST_QUALIFIER writeonly
+#define BINNING_GROUP_SIZE 128u
+
+layout (local_size_x = 128) in;
+
+#include ../Constants/Lights.shader
+#include ../Constants/Clusters.shader
+
+uniform mat4 clusterView;
+uniform int lightCount; //Lights in PointLightStorage.
+
+//Each group stages lights in batches, transformed to view space once per batch rather than once per cluster.
+shared vec4 batchLights[BINNING_GROUP_SIZE];
+
+//One invocation per cluster. Lights are appended in index order, so the lists match the CPU reference in Rendering/LightClusters.cpp.
+void main()
+{
+    uint clusterIndex = gl_GlobalInvocationID.x;
+    bool validCluster = clusterIndex < CLUSTER_COUNT;
+    vec3 boundsMinimum = validCluster ? clusterBounds[clusterIndex].minimum.xyz : vec3(0.0);
+    vec3 boundsMaximum = validCluster ? clusterBounds[clusterIndex].maximum.xyz : vec3(0.0);
+    uint visibleCount = 0u;
+
+    //Every invocation runs every batch, as the barriers need uniform control flow.
+    for (uint batchStart = 0u; batchStart < uint(lightCount); batchStart += BINNING_GROUP_SIZE)
+    {
+        uint lightIndex = batchStart + gl_LocalInvocationIndex;
+        if (lightIndex < uint(lightCount))
+        {
+            vec4 positionRadius = pointLights[lightIndex].positionRadius;
+            batchLights[gl_LocalInvocationIndex] = vec4((clusterView * vec4(positionRadius.xyz, 1.0)).xyz, positionRadius.w);
+        }
+        barrier();
+
+        uint batchCount = min(BINNING_GROUP_SIZE, uint(lightCount) - batchStart);
+        for (uint i = 0u; i < batchCount && validCluster; i++)
+        {
+            //Sphere against box, through the box's closest point to the sphere's center.
+            vec4 batchLight = batchLights[i];
+            vec3 closestOffset = clamp(batchLight.xyz, boundsMinimum, boundsMaximum) - batchLight.xyz;
+            if (dot(closestOffset, closestOffset) <= batchLight.w * batchLight.w && visibleCount < MAXIMUM_LIGHTS_PER_CLUSTER)
+            {
+                clusterLightIndices[clusterIndex * MAXIMUM_LIGHTS_PER_CLUSTER + visibleCount] = batchStart + i;
+                visibleCount++;
+            }
+        }
+        barrier();
+    }
+
+    if (validCluster)
+    {
+        clusterLightCounts[clusterIndex] = visibleCount;
+    }
+}
\ No newline at end of file
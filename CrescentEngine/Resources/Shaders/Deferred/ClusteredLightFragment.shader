@@ -0,0 +1,77 @@
+#version 430 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+#include ../Constants/Constants.shader
+#include ../Constants/BRDF.shader
+#include ../Constants/Uniforms.shader
+#include ../Constants/Lights.shader
+#include ../Constants/Clusters.shader
+
+uniform sampler2D gPositionMetallic;
+uniform sampler2D gNormalRoughness;
+uniform sampler2D gAlbedoAO;
+
+//Shades every point light binned into the pixel's cluster, reading the G-buffer once for all of them.
+void main()
+{
+    vec4 albedoAO = texture(gAlbedoAO, TexCoords);
+    vec4 normalRoughness = texture(gNormalRoughness, TexCoords);
+    vec4 positionMetallic = texture(gPositionMetallic, TexCoords);
+
+    vec3 worldPosition = positionMetallic.xyz;
+    vec3 albedo = albedoAO.rgb;
+    vec3 normal = normalRoughness.rgb;
+    float roughness = normalRoughness.a;
+    float metallic = positionMetallic.a;
+
+    //Lighting Input - Everything but the light's direction is shared by every light.
+    vec3 N = normalize(normal);
+    vec3 V = normalize(cameraPosition.xyz - worldPosition);
+    float NdotV = max(dot(N, V), 0.0);
+
+    vec3 F0 = vec3(0.04f);
+    F0 = mix(F0, albedo, metallic);
+
+    float viewDepth = -(view * vec4(worldPosition, 1.0)).z;
+    uint clusterIndex = RetrieveClusterIndex(gl_FragCoord.xy, viewDepth);
+    uint clusterLightCount = clusterLightCounts[clusterIndex];
+    uint clusterLightStart = clusterIndex * MAXIMUM_LIGHTS_PER_CLUSTER;
+
+    vec3 Lo = vec3(0.0);
+    for (uint i = 0u; i < clusterLightCount; i++)
+    {
+        PointLightEntry pointLight = pointLights[clusterLightIndices[clusterLightStart + i]];
+        vec3 lightPosition = pointLight.positionRadius.xyz;
+        float lightRadius = pointLight.positionRadius.w;
+
+        vec3 L = normalize(lightPosition - worldPosition);
+        vec3 H = normalize(V + L);
+
+        //Calculate Light Radiance (Based on UE4's Light Attenuation Model)
+        float distance = length(worldPosition - lightPosition);
+        float attenuation = pow(clamp(1.0 - pow(distance / lightRadius, 1.0), 0.0, 1.0), 2.0) / (distance * distance + 1.0);
+        vec3 radiance = pointLight.colorIntensity.rgb * pointLight.colorIntensity.w * attenuation;
+
+        // cook-torrance brdf
+        float NdotL = max(dot(N, L), 0.0);
+        float NDF = DistributionGGX(N, H, roughness);
+        float G = GeometryGGX(NdotV, NdotL, roughness);
+        vec3 F = FresnelSchlick(max(dot(H, V), 0.0), F0);
+
+        vec3 kS = F;
+        vec3 kD = vec3(1.0) - kS;
+        kD *= 1.0 - metallic;
+
+        vec3 nominator = NDF * G * F;
+        float denominator = 4 * NdotV * NdotL + 0.001;
+        vec3 specular = nominator / denominator;
+
+        // add to outgoing radiance Lo
+        Lo += (kD * albedo / PI + specular) * radiance * NdotL;
+    }
+
+    FragColor.rgb = Lo;
+    FragColor.a = 1.0;
+}
\ No newline at end of file
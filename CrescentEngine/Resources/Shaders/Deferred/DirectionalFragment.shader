@@ -1,10 +1,11 @@
-#version 420 core
+#version 430 core
 out vec4 FragColor;
 
 in vec2 TexCoords;
 
 #include ../Constants/Constants.shader
 #include ../Constants/BRDF.shader
+#include ../Constants/Uniforms.shader
 
 uniform sampler2D gPositionMetallic;
 uniform sampler2D gNormalRoughness;
@@ -13,48 +14,78 @@ uniform sampler2D gAlbedoAO;
 uniform vec3 lightDirection;
 uniform vec3 lightColor;
 
-uniform vec3 cameraPosition;
-
+//Cascades of the light's shadow map, as fitted by Rendering/ShadowCascades.cpp. Zero cascades leaves the light unshadowed.
+//Each cascade is a tile of the shadow atlas. Its matrix maps straight into the atlas, and its bounds (minimum in xy, maximum in zw) keep filtering within the tile.
 uniform sampler2D lightShadowMap;
-uniform mat4 lightShadowViewProjection;
-uniform bool ShadowsEnabled;
-
-float ShadowFactor(sampler2D shadowMap, vec4 fragPosLightSpace, vec3 N, vec3 L)
+uniform mat4 lightCascadeViewProjections[4];
+uniform vec4 lightCascadeAtlasBounds[4];
+uniform vec4 lightCascadeSplits; //View depth at which each cascade ends.
+uniform vec4 lightCascadeBiases; //One texel's world size, in each cascade's depth range.
+uniform int lightCascadeCount;
+uniform float lightCascadeBlendFraction;
+
+float CascadeShadowFactor(int cascadeIndex, vec3 worldPos, vec3 N, vec3 L)
 {
-    if (ShadowsEnabled)
+    // perspective divide, to the [0,1] range
+    vec4 fragPosLightSpace = lightCascadeViewProjections[cascadeIndex] * vec4(worldPos, 1.0);
+    vec3 projCoords = (fragPosLightSpace.xyz / fragPosLightSpace.w) * 0.5 + 0.5;
+    // keep the shadow at 0.0 when outside the far_plane region of the cascade, or outside of its tile.
+    vec4 atlasBounds = lightCascadeAtlasBounds[cascadeIndex];
+    if (projCoords.z > 1.0 || any(lessThan(projCoords.xy, atlasBounds.xy)) || any(greaterThan(projCoords.xy, atlasBounds.zw)))
+        return 0.0;
+
+    // depth of current fragment from light's perspective
+    float currentDepth = projCoords.z;
+    // shadow bias, in texels of this cascade so that coarser cascades are biased further. Slopes are biased more, as our kernel spans several texels.
+    float bias = lightCascadeBiases[cascadeIndex] * (1.5 + 6.0 * (1.0 - max(dot(N, L), 0.0)));
+    // PCF
+    float shadow = 0.0;
+    vec2 texelSize = 1.0 / textureSize(lightShadowMap, 0);
+    vec2 sampleMinimum = atlasBounds.xy + texelSize * 0.5;
+    vec2 sampleMaximum = atlasBounds.zw - texelSize * 0.5;
+    for (int x = -2; x <= 2; ++x)
     {
-        // perspective divide
-        vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
-        // transform to [0,1] range
-        projCoords = projCoords * 0.5 + 0.5;
-        // closest depth value from light's perspective (using [0,1] range fragPosLight as coords)
-        float closestDepth = texture(shadowMap, projCoords.xy).r;
-        // depth of current fragment from light's perspective
-        float currentDepth = projCoords.z;
-        // shadow bias
-        float bias = max(0.05 * (1.0 - dot(N, L)), 0.005);
-        // PCF
-        float shadow = 0.0;
-        vec2 texelSize = 1.0 / textureSize(shadowMap, 0);
-        for (int x = -2; x <= 2; ++x)
+        for (int y = -2; y <= 2; ++y)
         {
-            for (int y = -2; y <= 2; ++y)
-            {
-                float pcfDepth = texture(shadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
-                shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
-            }
+            float pcfDepth = texture(lightShadowMap, clamp(projCoords.xy + vec2(x, y) * texelSize, sampleMinimum, sampleMaximum)).r;
+            shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
         }
-        shadow /= 25.0;
-        // keep the shadow at 0.0 when outside the far_plane region of the light's frustum.
-        if (projCoords.z > 1.0)
-            shadow = 0.0;
+    }
+    return shadow / 25.0;
+}
+
+float ShadowFactor(vec3 worldPos, vec3 N, vec3 L)
+{
+    if (!ShadowsEnabled || lightCascadeCount == 0)
+    {
+        return 0.0;
+    }
 
-        return shadow;
+    // pick the first cascade reaching past our depth
+    float viewDepth = -(view * vec4(worldPos, 1.0)).z;
+    int cascadeIndex = 0;
+    while (cascadeIndex < lightCascadeCount && viewDepth > lightCascadeSplits[cascadeIndex])
+    {
+        cascadeIndex++;
     }
-    else
+    if (cascadeIndex == lightCascadeCount)
     {
-        return 1.0;
+        return 0.0;
     }
+
+    float shadow = CascadeShadowFactor(cascadeIndex, worldPos, N, L);
+
+    // fade into the next cascade over the end of this one, hiding the seam between their resolutions. The last cascade fades out towards the shadow distance.
+    float cascadeStart = cascadeIndex == 0 ? 0.0 : lightCascadeSplits[cascadeIndex - 1];
+    float blendStart = mix(cascadeStart, lightCascadeSplits[cascadeIndex], 1.0 - lightCascadeBlendFraction);
+    if (viewDepth > blendStart)
+    {
+        float blend = (viewDepth - blendStart) / max(lightCascadeSplits[cascadeIndex] - blendStart, 0.0001);
+        float nextShadow = cascadeIndex + 1 < lightCascadeCount ? CascadeShadowFactor(cascadeIndex + 1, worldPos, N, L) : 0.0;
+        shadow = mix(shadow, nextShadow, blend);
+    }
+
+    return shadow;
 }
 
 void main()
@@ -82,8 +113,7 @@ void main()
     vec3 radiance = lightColor;
 
     // light shadow
-    vec4 fragPosLightSpace = lightShadowViewProjection * vec4(worldPos, 1.0);
-    float shadow = ShadowFactor(lightShadowMap, fragPosLightSpace, N, L);
+    float shadow = ShadowFactor(worldPos, N, L);
 
     // cook-torrance brdf
     float NDF = DistributionGGX(N, H, roughness);
@@ -0,0 +1,40 @@
+#version 430 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aUV;
+layout (location = 2) in vec3 aNormal;
+layout (location = 3) in vec3 aTangent;
+layout (location = 4) in vec3 aBitangent;
+layout (location = 5) in uint aTransformSlot; //Streamed per instance from the renderer's instance buffer.
+
+out vec2 UV;
+out vec3 FragPos;
+out mat3 TBN;
+
+#include ../Constants/Uniforms.shader
+#include ../Constants/Transforms.shader
+
+void main()
+{
+	mat4 modelMatrix = transforms[aTransformSlot].model;
+	mat3 normalMatrix = mat3(transforms[aTransformSlot].normalMatrix);
+
+	UV = aUV;
+	FragPos = vec3(modelMatrix * vec4(aPos, 1.0));
+
+	vec3 N = normalize(normalMatrix * aNormal);
+	vec3 T = normalize(mat3(modelMatrix) * aTangent);
+	T = normalize(T - dot(N, T) * N);
+
+	vec3 B = normalize(mat3(modelMatrix) * aBitangent);
+
+	//TBN must form a right handed coordinate system.
+	//Some models have symetric UVs. Check and fix.
+	if (dot(cross(N, T), B) < 0.0)
+	{
+		T = T * -1.0;
+	}
+
+	TBN = mat3(T, B, N);
+
+	gl_Position = projection * view * vec4(FragPos, 1.0);
+}
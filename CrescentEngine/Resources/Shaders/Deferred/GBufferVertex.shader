@@ -1,4 +1,4 @@
-#version 420 core
+#version 430 core
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aUV;
 layout (location = 2) in vec3 aNormal;
@@ -9,20 +9,28 @@ out vec2 UV;
 out vec3 FragPos;
 out mat3 TBN;
 
-uniform mat4 model;
-uniform mat4 projection;
-uniform mat4 view;
+#include ../Constants/Uniforms.shader
+#include ../Constants/Transforms.shader
 
 void main()
 {
+	//Queued commands are drawn from the transform buffer. Anything else only sets the model matrix.
+	mat4 modelMatrix = model;
+	mat3 normalMatrix = mat3(model);
+	if (transformSlot != NULL_TRANSFORM_SLOT)
+	{
+		modelMatrix = transforms[transformSlot].model;
+		normalMatrix = mat3(transforms[transformSlot].normalMatrix);
+	}
+
 	UV = aUV;
-	FragPos = vec3(model * vec4(aPos, 1.0));
+	FragPos = vec3(modelMatrix * vec4(aPos, 1.0));
 
-	vec3 N = normalize(mat3(model) * aNormal);
-	vec3 T = normalize(mat3(model) * aTangent);
+	vec3 N = normalize(normalMatrix * aNormal);
+	vec3 T = normalize(mat3(modelMatrix) * aTangent);
 	T = normalize(T - dot(N, T) * N);
 
-	vec3 B = normalize(mat3(model) * aBitangent);
+	vec3 B = normalize(mat3(modelMatrix) * aBitangent);
 
 	//TBN must form a right handed coordinate system.
 	//Some models have symetric UVs. Check and fix.
@@ -1,24 +1,25 @@
-#version 420 core
+#version 430 core
 out vec4 FragColor;
 
-in vec3 FragPos;
 in vec4 ScreenPos;
+flat in int LightIndex;
 
 #include ../Constants/Constants.shader
 #include ../Constants/BRDF.shader
+#include ../Constants/Uniforms.shader
+#include ../Constants/Lights.shader
 
 uniform sampler2D gPositionMetallic;
 uniform sampler2D gNormalRoughness;
 uniform sampler2D gAlbedoAO;
 
-uniform vec3 lightPosition;
-uniform vec3 lightColor;
-uniform float lightRadius;
-
-uniform vec3 cameraPosition;
-
 void main()
 {
+    PointLightEntry pointLight = pointLights[LightIndex];
+    vec3 lightPosition = pointLight.positionRadius.xyz;
+    float lightRadius = pointLight.positionRadius.w;
+    vec3 lightColor = pointLight.colorIntensity.rgb * pointLight.colorIntensity.w;
+
     vec2 UV = (ScreenPos.xy / ScreenPos.w) * 0.5 + 0.5;
 
     vec4 albedoAO = texture(gAlbedoAO, UV);
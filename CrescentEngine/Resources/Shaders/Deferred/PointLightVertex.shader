@@ -1,17 +1,19 @@
-#version 420 core
+#version 430 core
 layout (location = 0) in vec3 aPos;
 
-out vec3 FragPos;
 out vec4 ScreenPos;
+flat out int LightIndex;
 
-uniform mat4 projection;
-uniform mat4 view;
-uniform mat4 model;
+#include ../Constants/Uniforms.shader
+#include ../Constants/Lights.shader
 
+//One instance per light in PointLightStorage, scaling our unit sphere to the light's volume.
 void main()
 {
-	FragPos = vec3(model * vec4(aPos, 1.0f));
+	vec4 positionRadius = pointLights[gl_InstanceID].positionRadius;
+	vec3 FragPos = positionRadius.xyz + aPos * positionRadius.w;
 	ScreenPos = projection * view * vec4(FragPos, 1.0f);
+	LightIndex = gl_InstanceID;
 
 	gl_Position = ScreenPos;
 }
\ No newline at end of file
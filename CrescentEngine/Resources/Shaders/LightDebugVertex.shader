@@ -1,11 +1,20 @@
-#version 420 core
+#version 430 core
 layout (location = 0) in vec3 aPos;
 
-uniform mat4 projection;
-uniform mat4 model;
-uniform mat4 view;
+flat out vec3 LightColor;
 
+#include Constants/Uniforms.shader
+#include Constants/Lights.shader
+
+uniform float lightMeshScale; //Radius of every sphere. Zero scales each to its light's radius instead.
+uniform float lightIntensityScale; //Applied to each light's intensity. Zero leaves the color unscaled instead.
+
+//One instance per light in PointLightStorage.
 void main()
 {
-	gl_Position = projection * view * model * vec4(aPos, 1.0f);
+	PointLightEntry pointLight = pointLights[gl_InstanceID];
+	float meshScale = lightMeshScale > 0.0 ? lightMeshScale : pointLight.positionRadius.w;
+	LightColor = pointLight.colorIntensity.rgb * (lightIntensityScale > 0.0 ? pointLight.colorIntensity.w * lightIntensityScale : 1.0);
+
+	gl_Position = projection * view * vec4(pointLight.positionRadius.xyz + aPos * meshScale, 1.0f);
 }
\ No newline at end of file
@@ -1,11 +1,9 @@
-#version 330 core
+#version 420 core
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aTexCoords;
 layout (location = 2) in vec3 aNormal;
 
-uniform mat4 projection;
-uniform mat4 view;
-uniform mat4 model;
+#include ../Constants/Uniforms.shader
 
 out vec3 WorldPos;
 
@@ -1,4 +1,4 @@
-#version 330 core
+#version 420 core
 out vec4 FragColor;
 
 in vec3 WorldPos;
@@ -7,7 +7,11 @@ in vec3 WorldPos;
 #include ../Constants/Sampling.shader
 
 uniform samplerCube environment;
-uniform float roughness;
+
+layout (std140, binding = 2) uniform MaterialUniforms
+{
+	float roughness;
+};
 
 void main(void)
 {
@@ -0,0 +1,13 @@
+#version 430 core
+layout (location = 0) in vec3 aPos;
+layout (location = 5) in uint aTransformSlot;
+
+#include Constants/Transforms.shader
+
+uniform mat4 lightSpaceProjection;
+uniform mat4 lightSpaceView;
+
+void main()
+{
+	gl_Position = lightSpaceProjection * lightSpaceView * transforms[aTransformSlot].model * vec4(aPos, 1.0f);
+}
\ No newline at end of file
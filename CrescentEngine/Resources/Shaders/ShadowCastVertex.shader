@@ -1,11 +1,14 @@
-#version 330 core
+#version 430 core
 layout (location = 0) in vec3 aPos;
 
+#include Constants/Uniforms.shader
+#include Constants/Transforms.shader
+
 uniform mat4 lightSpaceProjection;
 uniform mat4 lightSpaceView;
-uniform mat4 model;
 
 void main()
 {
-	gl_Position = lightSpaceProjection * lightSpaceView * model * vec4(aPos, 1.0f);
+	mat4 modelMatrix = transformSlot != NULL_TRANSFORM_SLOT ? transforms[transformSlot].model : model;
+	gl_Position = lightSpaceProjection * lightSpaceView * modelMatrix * vec4(aPos, 1.0f);
 }
\ No newline at end of file
@@ -1,10 +1,14 @@
-#version 330 core
+#version 420 core
 out vec4 FragColor;
 
 in vec3 WorldPos;
 
 uniform samplerCube background;
-uniform float lodLevel;
+
+layout (std140, binding = 2) uniform MaterialUniforms
+{
+	float lodLevel;
+};
 
 void main()
 {
@@ -1,8 +1,7 @@
 #version 420 core
 layout (location = 0) in vec3 aPos;
 
-uniform mat4 projection;
-uniform mat4 view;
+#include Constants/Uniforms.shader
 
 out vec3 WorldPos;
 
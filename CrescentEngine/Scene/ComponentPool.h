@@ -0,0 +1,97 @@
+#pragma once
+#include "EntityHandle.h"
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+namespace Crescent
+{
+	/*
+		Sparse set storage for one component type, keyed by entity handle. Components are packed into a dense array (alongside the handle of the entity
+		owning each one) which systems iterate directly, while a sparse array indexed by the entity's slot maps back into it for O(1) lookups. Removal swaps
+		the last component into the hole, so the dense array never has gaps. Pointers into it are only valid until the next add or removal.
+	*/
+
+	template<typename Component>
+	class ComponentPool
+	{
+	public:
+		Component& AddComponent(EntityHandle entityHandle, const Component& component = Component())
+		{
+			const uint32_t slotIndex = entityHandle.RetrieveSlotIndex();
+			if (slotIndex >= m_SparseIndices.size())
+			{
+				m_SparseIndices.resize(slotIndex + 1, g_InvalidDenseIndex);
+			}
+
+			//Adding a component the entity already has overwrites it.
+			const uint32_t existingIndex = RetrieveDenseIndex(entityHandle);
+			if (existingIndex != g_InvalidDenseIndex)
+			{
+				m_DenseComponents[existingIndex] = component;
+				return m_DenseComponents[existingIndex];
+			}
+
+			m_SparseIndices[slotIndex] = (uint32_t)m_DenseComponents.size();
+			m_DenseEntities.push_back(entityHandle);
+			m_DenseComponents.push_back(component);
+			return m_DenseComponents.back();
+		}
+
+		void RemoveComponent(EntityHandle entityHandle)
+		{
+			const uint32_t denseIndex = RetrieveDenseIndex(entityHandle);
+			if (denseIndex == g_InvalidDenseIndex)
+			{
+				return;
+			}
+
+			//Move our last component into the hole to keep the dense array packed.
+			const uint32_t lastIndex = (uint32_t)m_DenseComponents.size() - 1;
+			if (denseIndex != lastIndex)
+			{
+				m_DenseComponents[denseIndex] = std::move(m_DenseComponents[lastIndex]);
+				m_DenseEntities[denseIndex] = m_DenseEntities[lastIndex];
+				m_SparseIndices[m_DenseEntities[denseIndex].RetrieveSlotIndex()] = denseIndex;
+			}
+
+			m_DenseComponents.pop_back();
+			m_DenseEntities.pop_back();
+			m_SparseIndices[entityHandle.RetrieveSlotIndex()] = g_InvalidDenseIndex;
+		}
+
+		//Returns nullptr if the entity has no such component.
+		Component* RetrieveComponent(EntityHandle entityHandle)
+		{
+			const uint32_t denseIndex = RetrieveDenseIndex(entityHandle);
+			return denseIndex == g_InvalidDenseIndex ? nullptr : &m_DenseComponents[denseIndex];
+		}
+
+		bool HasComponent(EntityHandle entityHandle) const { return RetrieveDenseIndex(entityHandle) != g_InvalidDenseIndex; }
+
+		//Dense iteration. The entity owning component i is at index i of RetrieveEntities.
+		uint32_t RetrieveComponentCount() const { return (uint32_t)m_DenseComponents.size(); }
+		std::vector<Component>& RetrieveComponents() { return m_DenseComponents; }
+		const std::vector<EntityHandle>& RetrieveEntities() const { return m_DenseEntities; }
+
+	private:
+		uint32_t RetrieveDenseIndex(EntityHandle entityHandle) const
+		{
+			const uint32_t slotIndex = entityHandle.RetrieveSlotIndex();
+			if (slotIndex >= m_SparseIndices.size())
+			{
+				return g_InvalidDenseIndex;
+			}
+
+			const uint32_t denseIndex = m_SparseIndices[slotIndex];
+			return denseIndex != g_InvalidDenseIndex && m_DenseEntities[denseIndex] == entityHandle ? denseIndex : g_InvalidDenseIndex;
+		}
+
+	private:
+		static constexpr uint32_t g_InvalidDenseIndex = ~0u;
+
+		std::vector<uint32_t> m_SparseIndices; //Indexed by entity slot.
+		std::vector<EntityHandle> m_DenseEntities;
+		std::vector<Component> m_DenseComponents;
+	};
+}
\ No newline at end of file
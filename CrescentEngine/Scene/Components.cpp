@@ -0,0 +1,87 @@
+#include "CrescentPCH.h"
+#include "Components.h"
+#include "SceneEntity.h"
+#include "TransformSystem.h"
+#include "Prefab.h"
+#include "../Models/Mesh.h"
+
+namespace Crescent
+{
+	ComponentPool<MeshRendererComponent> ComponentStorage::m_MeshRenderers;
+	ComponentPool<PrefabInstanceComponent> ComponentStorage::m_PrefabInstances;
+	ComponentPool<LightComponent> ComponentStorage::m_Lights;
+	ComponentPool<AnimatorComponent> ComponentStorage::m_Animators;
+	ComponentPool<BoundsComponent> ComponentStorage::m_Bounds;
+	std::vector<EntityHandle> ComponentStorage::m_ChangedRenderables;
+	std::vector<EntityHandle> ComponentStorage::m_MovedRenderables;
+
+	MeshRendererComponent& ComponentStorage::AttachMeshRenderer(SceneEntity* sceneEntity, Mesh* mesh, Material* material)
+	{
+		const EntityHandle entityHandle = sceneEntity->RetrieveEntityHandle();
+
+		AttachBounds(sceneEntity, mesh->m_BoundingBoxMinimum, mesh->m_BoundingBoxMaximum);
+
+		MeshRendererComponent meshRenderer;
+		meshRenderer.m_Mesh = mesh;
+		meshRenderer.m_Material = material;
+		MarkRenderableChanged(entityHandle);
+		return m_MeshRenderers.AddComponent(entityHandle, meshRenderer);
+	}
+
+	PrefabInstanceComponent& ComponentStorage::AttachPrefabInstance(SceneEntity* sceneEntity, const Prefab* prefab)
+	{
+		AttachBounds(sceneEntity, prefab->RetrieveBoundingBoxMinimum(), prefab->RetrieveBoundingBoxMaximum());
+
+		if (prefab->RetrieveAnimatedMesh())
+		{
+			m_Animators.AddComponent(sceneEntity->RetrieveEntityHandle());
+		}
+
+		PrefabInstanceComponent prefabInstance;
+		prefabInstance.m_Prefab = prefab;
+		MarkRenderableChanged(sceneEntity->RetrieveEntityHandle());
+		return m_PrefabInstances.AddComponent(sceneEntity->RetrieveEntityHandle(), prefabInstance);
+	}
+
+	bool ComponentStorage::IsRenderableEntity(EntityHandle entityHandle)
+	{
+		const MeshRendererComponent* meshRenderer = m_MeshRenderers.RetrieveComponent(entityHandle);
+		const PrefabInstanceComponent* prefabInstance = m_PrefabInstances.RetrieveComponent(entityHandle);
+		return (meshRenderer && meshRenderer->m_Enabled) || (prefabInstance && prefabInstance->m_Enabled);
+	}
+
+	void ComponentStorage::AttachBounds(SceneEntity* sceneEntity, const glm::vec3& localMinimum, const glm::vec3& localMaximum)
+	{
+		const EntityHandle entityHandle = sceneEntity->RetrieveEntityHandle();
+
+		BoundsComponent boundsComponent;
+		boundsComponent.m_LocalMinimum = localMinimum;
+		boundsComponent.m_LocalMaximum = localMaximum;
+		if (BoundsComponent* existingBounds = m_Bounds.RetrieveComponent(entityHandle))
+		{
+			boundsComponent.m_TreeProxy = existingBounds->m_TreeProxy; //Keeps its place in the spatial tree, which is refit along with the bounds.
+		}
+		m_Bounds.AddComponent(entityHandle, boundsComponent);
+		TransformSystem::MarkTransformDirty(sceneEntity->RetrieveTransformIndex()); //Lists the entity as changed, so its world bounds are fit.
+	}
+
+	void ComponentStorage::ClearRenderableChanges()
+	{
+		m_ChangedRenderables.clear();
+		m_MovedRenderables.clear();
+	}
+
+	void ComponentStorage::RemoveAllComponents(EntityHandle entityHandle)
+	{
+		if (m_MeshRenderers.HasComponent(entityHandle) || m_PrefabInstances.HasComponent(entityHandle))
+		{
+			MarkRenderableChanged(entityHandle); //Its render proxies go with it.
+		}
+
+		m_MeshRenderers.RemoveComponent(entityHandle);
+		m_PrefabInstances.RemoveComponent(entityHandle);
+		m_Lights.RemoveComponent(entityHandle);
+		m_Animators.RemoveComponent(entityHandle);
+		m_Bounds.RemoveComponent(entityHandle);
+	}
+}
\ No newline at end of file
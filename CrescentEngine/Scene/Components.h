@@ -0,0 +1,127 @@
+#pragma once
+#include "ComponentPool.h"
+#include "DynamicAABBTree.h"
+#include <glm/glm.hpp>
+
+namespace Crescent
+{
+	class Mesh;
+	class Material;
+	class PointLight;
+	class DirectionalLight;
+	class SceneEntity;
+	class Prefab;
+
+	//Draws a mesh with the given material at the entity's world transform.
+	struct MeshRendererComponent
+	{
+		Mesh* m_Mesh = nullptr;
+		Material* m_Material = nullptr;
+		bool m_Enabled = true; //Disabled renderers are skipped entirely, such as those of cached model hierarchies that are only ever cloned.
+	};
+
+	//Replaces the material of one of a prefab's nodes, for a single instance.
+	struct PrefabMaterialOverride
+	{
+		uint32_t m_NodeIndex = 0;
+		Material* m_Material = nullptr;
+	};
+
+	//Draws every renderable node of a shared prefab relative to the entity's world transform. Only the overrides are stored per instance.
+	struct PrefabInstanceComponent
+	{
+		const Prefab* m_Prefab = nullptr;
+		std::vector<PrefabMaterialOverride> m_MaterialOverrides;
+		bool m_Enabled = true;
+
+		Material* RetrieveNodeMaterial(uint32_t nodeIndex, Material* prefabMaterial) const
+		{
+			for (const PrefabMaterialOverride& materialOverride : m_MaterialOverrides)
+			{
+				if (materialOverride.m_NodeIndex == nodeIndex)
+				{
+					return materialOverride.m_Material;
+				}
+			}
+			return prefabMaterial;
+		}
+	};
+
+	//Places a light at the entity. Point lights follow the entity's world position. The light objects themselves are owned by whoever attached them.
+	struct LightComponent
+	{
+		PointLight* m_PointLight = nullptr;
+		DirectionalLight* m_DirectionalLight = nullptr;
+	};
+
+	//Playback state of one of the mesh renderer's skeletal animations. Advanced by the scene every frame.
+	struct AnimatorComponent
+	{
+		int m_AnimationIndex = 0;
+		float m_AnimationTime = 0.0f; //In seconds.
+		float m_PlaybackSpeed = 1.0f;
+		bool m_Looping = true;
+		bool m_Playing = true;
+	};
+
+	//World space bounds of the entity's mesh, refit whenever its transform changes. Enabled mesh renderers are also indexed in the scene's spatial tree.
+	struct BoundsComponent
+	{
+		glm::vec3 m_LocalMinimum = glm::vec3(0.0f);
+		glm::vec3 m_LocalMaximum = glm::vec3(0.0f);
+		glm::vec3 m_WorldCenter = glm::vec3(0.0f);
+		glm::vec3 m_WorldExtents = glm::vec3(0.0f);
+		uint32_t m_TreeProxy = g_NullTreeNode;
+	};
+
+	/*
+		Owns the component pools of every entity in the EntityPool. Each system iterates its pool's dense array rather than walking the entity hierarchy.
+	*/
+
+	class ComponentStorage
+	{
+	public:
+		static ComponentPool<MeshRendererComponent>& RetrieveMeshRenderers() { return m_MeshRenderers; }
+		static ComponentPool<PrefabInstanceComponent>& RetrievePrefabInstances() { return m_PrefabInstances; }
+		static ComponentPool<LightComponent>& RetrieveLights() { return m_Lights; }
+		static ComponentPool<AnimatorComponent>& RetrieveAnimators() { return m_Animators; }
+		static ComponentPool<BoundsComponent>& RetrieveBounds() { return m_Bounds; }
+
+		//Attaches a mesh renderer along with the bounds component culling and picking use for it. The bounds are fit on the next scene update.
+		static MeshRendererComponent& AttachMeshRenderer(SceneEntity* sceneEntity, Mesh* mesh, Material* material);
+		//Same as the above, with bounds enclosing every node of the prefab. Animated prefabs also get an animator.
+		static PrefabInstanceComponent& AttachPrefabInstance(SceneEntity* sceneEntity, const Prefab* prefab);
+
+		//Whether the entity has an enabled mesh renderer or prefab instance, which are the components we draw and index spatially.
+		static bool IsRenderableEntity(EntityHandle entityHandle);
+
+		//Renderables attached, removed or edited since the last ClearRenderableChanges. The renderer rebuilds its render proxies from these, so edits made to
+		//a mesh renderer or prefab instance in place (toggling it, swapping its material) must be followed by a MarkRenderableChanged. Entities may be listed more than once.
+		static void MarkRenderableChanged(EntityHandle entityHandle) { m_ChangedRenderables.push_back(entityHandle); }
+		static const std::vector<EntityHandle>& RetrieveChangedRenderables() { return m_ChangedRenderables; }
+		//Renderables whose world transform changed, listed by the scene as it refits their bounds. Their proxies only need moving.
+		static void MarkRenderableMoved(EntityHandle entityHandle) { m_MovedRenderables.push_back(entityHandle); }
+		static const std::vector<EntityHandle>& RetrieveMovedRenderables() { return m_MovedRenderables; }
+		static void ClearRenderableChanges();
+
+		//Called by the EntityPool as the entity is destroyed.
+		static void RemoveAllComponents(EntityHandle entityHandle);
+
+	private:
+		//Disallow creation of any ComponentStorage object. This is a static object.
+		ComponentStorage();
+
+		//Adds (or refits) the entity's bounds, and lists the entity as changed so they are fit into the world on the next scene update.
+		static void AttachBounds(SceneEntity* sceneEntity, const glm::vec3& localMinimum, const glm::vec3& localMaximum);
+
+	private:
+		static ComponentPool<MeshRendererComponent> m_MeshRenderers;
+		static ComponentPool<PrefabInstanceComponent> m_PrefabInstances;
+		static ComponentPool<LightComponent> m_Lights;
+		static ComponentPool<AnimatorComponent> m_Animators;
+		static ComponentPool<BoundsComponent> m_Bounds;
+
+		static std::vector<EntityHandle> m_ChangedRenderables;
+		static std::vector<EntityHandle> m_MovedRenderables;
+	};
+}
\ No newline at end of file
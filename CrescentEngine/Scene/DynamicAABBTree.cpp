@@ -0,0 +1,337 @@
+#include "CrescentPCH.h"
+#include "DynamicAABBTree.h"
+#include <algorithm>
+#include <cfloat>
+
+namespace Crescent
+{
+	//Proxies whose fat box has grown this many margins past their tight box are reinserted, so objects that shrink or stop moving don't keep oversized leaves.
+	static constexpr float g_OversizedMarginCount = 4.0f;
+
+	uint32_t DynamicAABBTree::CreateProxy(const AABB& box, uint32_t userData)
+	{
+		const uint32_t proxyIndex = AllocateNode();
+		m_Nodes[proxyIndex].m_Box = { box.m_Minimum - glm::vec3(g_FatBoxMargin), box.m_Maximum + glm::vec3(g_FatBoxMargin) };
+		m_Nodes[proxyIndex].m_UserData = userData;
+		m_Nodes[proxyIndex].m_Height = 0;
+
+		InsertLeaf(proxyIndex);
+		m_ProxyCount++;
+		return proxyIndex;
+	}
+
+	void DynamicAABBTree::DestroyProxy(uint32_t proxyIndex)
+	{
+		RemoveLeaf(proxyIndex);
+		FreeNode(proxyIndex);
+		m_ProxyCount--;
+	}
+
+	bool DynamicAABBTree::MoveProxy(uint32_t proxyIndex, const AABB& box)
+	{
+		const AABB& fatBox = m_Nodes[proxyIndex].m_Box;
+		const AABB oversizedBox = { box.m_Minimum - glm::vec3(g_FatBoxMargin * g_OversizedMarginCount), box.m_Maximum + glm::vec3(g_FatBoxMargin * g_OversizedMarginCount) };
+		if (fatBox.Contains(box) && oversizedBox.Contains(fatBox))
+		{
+			return false;
+		}
+
+		RemoveLeaf(proxyIndex);
+		m_Nodes[proxyIndex].m_Box = { box.m_Minimum - glm::vec3(g_FatBoxMargin), box.m_Maximum + glm::vec3(g_FatBoxMargin) };
+		InsertLeaf(proxyIndex);
+		return true;
+	}
+
+	bool DynamicAABBTree::OverlapsSphere(const glm::vec3& sphereCenter, float sphereRadius) const
+	{
+		bool overlapFound = false;
+		QueryNodes([&](const TreeNode& treeNode, uint32_t, bool&)
+		{
+			if (overlapFound)
+			{
+				return false; //Drains what's left of the stack without descending.
+			}
+
+			const glm::vec3 closestPoint = glm::clamp(sphereCenter, treeNode.m_Box.m_Minimum, treeNode.m_Box.m_Maximum);
+			const glm::vec3 offset = closestPoint - sphereCenter;
+			if (glm::dot(offset, offset) > sphereRadius * sphereRadius)
+			{
+				return false;
+			}
+
+			overlapFound = treeNode.IsLeaf();
+			return true;
+		});
+
+		return overlapFound;
+	}
+
+	bool DynamicAABBTree::IntersectRay(const AABB& box, const glm::vec3& rayOrigin, const glm::vec3& inverseDirection, float maximumDistance, float* hitDistance)
+	{
+		const glm::vec3 minimumDistances = (box.m_Minimum - rayOrigin) * inverseDirection;
+		const glm::vec3 maximumDistances = (box.m_Maximum - rayOrigin) * inverseDirection;
+		const glm::vec3 nearDistances = glm::min(minimumDistances, maximumDistances);
+		const glm::vec3 farDistances = glm::max(minimumDistances, maximumDistances);
+
+		const float entryDistance = std::max(std::max(nearDistances.x, nearDistances.y), std::max(nearDistances.z, 0.0f));
+		const float exitDistance = std::min(std::min(farDistances.x, farDistances.y), std::min(farDistances.z, maximumDistance));
+		if (entryDistance > exitDistance)
+		{
+			return false;
+		}
+
+		if (hitDistance)
+		{
+			*hitDistance = entryDistance;
+		}
+		return true;
+	}
+
+	DynamicAABBTree::FrustumOverlap DynamicAABBTree::ClassifyBox(const Frustum& frustum, const AABB& box)
+	{
+		const glm::vec3 boxCenter = box.RetrieveCenter();
+		const glm::vec3 boxExtents = box.RetrieveExtents();
+
+		FrustumOverlap overlap = FrustumOverlap_Inside;
+		for (int i = 0; i < FrustumPlane_Count; i++)
+		{
+			const glm::vec4& plane = frustum.m_Planes[i];
+			const float centerDistance = glm::dot(glm::vec3(plane), boxCenter) + plane.w;
+			const float projectedRadius = glm::dot(glm::abs(glm::vec3(plane)), boxExtents);
+			if (centerDistance < -projectedRadius)
+			{
+				return FrustumOverlap_Outside;
+			}
+			if (centerDistance < projectedRadius)
+			{
+				overlap = FrustumOverlap_Intersecting;
+			}
+		}
+		return overlap;
+	}
+
+	uint32_t DynamicAABBTree::AllocateNode()
+	{
+		if (m_FreeListIndex == g_NullTreeNode)
+		{
+			m_Nodes.emplace_back();
+			return (uint32_t)m_Nodes.size() - 1;
+		}
+
+		const uint32_t nodeIndex = m_FreeListIndex;
+		m_FreeListIndex = m_Nodes[nodeIndex].m_ParentIndex;
+		m_Nodes[nodeIndex] = TreeNode();
+		return nodeIndex;
+	}
+
+	void DynamicAABBTree::FreeNode(uint32_t nodeIndex)
+	{
+		m_Nodes[nodeIndex].m_ParentIndex = m_FreeListIndex;
+		m_FreeListIndex = nodeIndex;
+	}
+
+	void DynamicAABBTree::InsertLeaf(uint32_t leafIndex)
+	{
+		if (m_RootIndex == g_NullTreeNode)
+		{
+			m_RootIndex = leafIndex;
+			m_Nodes[leafIndex].m_ParentIndex = g_NullTreeNode;
+			return;
+		}
+
+		//The leaf and its sibling become the children of a new parent, which takes the sibling's place.
+		const uint32_t siblingIndex = FindBestSibling(m_Nodes[leafIndex].m_Box);
+		const uint32_t oldParentIndex = m_Nodes[siblingIndex].m_ParentIndex;
+		const uint32_t newParentIndex = AllocateNode(); //May grow our node array, so no references into it are held across this.
+
+		TreeNode& newParent = m_Nodes[newParentIndex];
+		newParent.m_ParentIndex = oldParentIndex;
+		newParent.m_Box = AABB::Union(m_Nodes[leafIndex].m_Box, m_Nodes[siblingIndex].m_Box);
+		newParent.m_ChildIndices[0] = siblingIndex;
+		newParent.m_ChildIndices[1] = leafIndex;
+		newParent.m_Height = m_Nodes[siblingIndex].m_Height + 1;
+		m_Nodes[siblingIndex].m_ParentIndex = newParentIndex;
+		m_Nodes[leafIndex].m_ParentIndex = newParentIndex;
+
+		if (oldParentIndex == g_NullTreeNode)
+		{
+			m_RootIndex = newParentIndex;
+		}
+		else
+		{
+			TreeNode& oldParent = m_Nodes[oldParentIndex];
+			oldParent.m_ChildIndices[oldParent.m_ChildIndices[0] == siblingIndex ? 0 : 1] = newParentIndex;
+		}
+
+		RefitAncestors(newParentIndex);
+	}
+
+	void DynamicAABBTree::RemoveLeaf(uint32_t leafIndex)
+	{
+		if (leafIndex == m_RootIndex)
+		{
+			m_RootIndex = g_NullTreeNode;
+			return;
+		}
+
+		//The leaf's sibling takes its parent's place.
+		const uint32_t parentIndex = m_Nodes[leafIndex].m_ParentIndex;
+		const TreeNode& parent = m_Nodes[parentIndex];
+		const uint32_t grandParentIndex = parent.m_ParentIndex;
+		const uint32_t siblingIndex = parent.m_ChildIndices[0] == leafIndex ? parent.m_ChildIndices[1] : parent.m_ChildIndices[0];
+
+		m_Nodes[siblingIndex].m_ParentIndex = grandParentIndex;
+		FreeNode(parentIndex);
+
+		if (grandParentIndex == g_NullTreeNode)
+		{
+			m_RootIndex = siblingIndex;
+		}
+		else
+		{
+			TreeNode& grandParent = m_Nodes[grandParentIndex];
+			grandParent.m_ChildIndices[grandParent.m_ChildIndices[0] == parentIndex ? 0 : 1] = siblingIndex;
+			RefitAncestors(grandParentIndex);
+		}
+	}
+
+	//Branch and bound search for the node whose replacement by a new parent of it and the leaf adds the least total surface area to the tree. Pairing the leaf with a node
+	//costs the area of their union, plus the area every ancestor grows by (the inherited cost). Inherited costs only increase further down, so the cheapest pairing
+	//anywhere below a node is bounded from below, and candidates are visited cheapest bound first from a priority queue. The search ends once no remaining bound can
+	//beat the best cost found, which is typically after a handful of nodes, but may explore several paths where a greedy descent would only follow one.
+	uint32_t DynamicAABBTree::FindBestSibling(const AABB& leafBox) const
+	{
+		const float leafArea = leafBox.RetrieveSurfaceArea();
+		auto isWorseCandidate = [](const SiblingCandidate& candidateA, const SiblingCandidate& candidateB) { return candidateA.m_LowerBound > candidateB.m_LowerBound; };
+
+		const float rootDirectCost = AABB::Union(m_Nodes[m_RootIndex].m_Box, leafBox).RetrieveSurfaceArea();
+		uint32_t bestSiblingIndex = m_RootIndex;
+		float bestCost = rootDirectCost;
+
+		m_SiblingQueue.clear();
+		m_SiblingQueue.push_back({ m_RootIndex, rootDirectCost, 0.0f, 0.0f });
+		while (!m_SiblingQueue.empty())
+		{
+			std::pop_heap(m_SiblingQueue.begin(), m_SiblingQueue.end(), isWorseCandidate);
+			const SiblingCandidate candidate = m_SiblingQueue.back();
+			m_SiblingQueue.pop_back();
+
+			//Every remaining candidate is bounded at least as high as this one.
+			if (candidate.m_LowerBound >= bestCost)
+			{
+				break;
+			}
+
+			const float cost = candidate.m_DirectCost + candidate.m_InheritedCost;
+			if (cost < bestCost)
+			{
+				bestSiblingIndex = candidate.m_NodeIndex;
+				bestCost = cost;
+			}
+
+			const TreeNode& treeNode = m_Nodes[candidate.m_NodeIndex];
+			if (treeNode.IsLeaf())
+			{
+				continue;
+			}
+
+			//This node grows by this much for anything inserted below it.
+			const float childInheritedCost = candidate.m_InheritedCost + candidate.m_DirectCost - treeNode.m_Box.RetrieveSurfaceArea();
+			for (int i = 0; i < 2; i++)
+			{
+				const TreeNode& childNode = m_Nodes[treeNode.m_ChildIndices[i]];
+				const float childDirectCost = AABB::Union(childNode.m_Box, leafBox).RetrieveSurfaceArea();
+
+				//Pairing with the child itself costs its direct cost. Anything below it costs at least the leaf's own area on top of the child growing to fit it.
+				float childLowerBound = childInheritedCost + childDirectCost;
+				if (!childNode.IsLeaf())
+				{
+					childLowerBound += std::min(leafArea - childNode.m_Box.RetrieveSurfaceArea(), 0.0f);
+				}
+
+				if (childLowerBound < bestCost)
+				{
+					m_SiblingQueue.push_back({ treeNode.m_ChildIndices[i], childDirectCost, childInheritedCost, childLowerBound });
+					std::push_heap(m_SiblingQueue.begin(), m_SiblingQueue.end(), isWorseCandidate);
+				}
+			}
+		}
+
+		return bestSiblingIndex;
+	}
+
+	void DynamicAABBTree::RefitAncestors(uint32_t nodeIndex)
+	{
+		while (nodeIndex != g_NullTreeNode)
+		{
+			TreeNode& treeNode = m_Nodes[nodeIndex];
+			const TreeNode& firstChild = m_Nodes[treeNode.m_ChildIndices[0]];
+			const TreeNode& secondChild = m_Nodes[treeNode.m_ChildIndices[1]];
+			treeNode.m_Box = AABB::Union(firstChild.m_Box, secondChild.m_Box);
+			treeNode.m_Height = std::max(firstChild.m_Height, secondChild.m_Height) + 1;
+
+			RotateNodes(nodeIndex);
+			nodeIndex = treeNode.m_ParentIndex;
+		}
+	}
+
+	//Considers swapping one of the node's children with a grandchild under its other child. Such a swap leaves the node's own box as is, while the box of the
+	//child the grandchild leaves shrinks or grows, so we apply the swap that shrinks it the most (if any).
+	void DynamicAABBTree::RotateNodes(uint32_t nodeIndex)
+	{
+		TreeNode& treeNode = m_Nodes[nodeIndex];
+		if (treeNode.m_Height < 2)
+		{
+			return;
+		}
+
+		float bestAreaChange = 0.0f;
+		int bestChildSlot = -1; //The child moving down.
+		int bestGrandChildSlot = -1; //The grandchild moving up, under our other child.
+
+		for (int childSlot = 0; childSlot < 2; childSlot++)
+		{
+			const TreeNode& swappedChild = m_Nodes[treeNode.m_ChildIndices[childSlot]];
+			const TreeNode& otherChild = m_Nodes[treeNode.m_ChildIndices[1 - childSlot]];
+			if (otherChild.IsLeaf())
+			{
+				continue;
+			}
+
+			const float otherChildArea = otherChild.m_Box.RetrieveSurfaceArea();
+			for (int grandChildSlot = 0; grandChildSlot < 2; grandChildSlot++)
+			{
+				//The other child would then bound the swapped child and the grandchild staying behind.
+				const TreeNode& remainingGrandChild = m_Nodes[otherChild.m_ChildIndices[1 - grandChildSlot]];
+				const float areaChange = AABB::Union(swappedChild.m_Box, remainingGrandChild.m_Box).RetrieveSurfaceArea() - otherChildArea;
+				if (areaChange < bestAreaChange)
+				{
+					bestAreaChange = areaChange;
+					bestChildSlot = childSlot;
+					bestGrandChildSlot = grandChildSlot;
+				}
+			}
+		}
+
+		if (bestChildSlot == -1)
+		{
+			return;
+		}
+
+		const uint32_t childIndex = treeNode.m_ChildIndices[bestChildSlot];
+		const uint32_t otherChildIndex = treeNode.m_ChildIndices[1 - bestChildSlot];
+		TreeNode& otherChild = m_Nodes[otherChildIndex];
+		const uint32_t grandChildIndex = otherChild.m_ChildIndices[bestGrandChildSlot];
+
+		treeNode.m_ChildIndices[bestChildSlot] = grandChildIndex;
+		otherChild.m_ChildIndices[bestGrandChildSlot] = childIndex;
+		m_Nodes[grandChildIndex].m_ParentIndex = nodeIndex;
+		m_Nodes[childIndex].m_ParentIndex = otherChildIndex;
+
+		const TreeNode& firstGrandChild = m_Nodes[otherChild.m_ChildIndices[0]];
+		const TreeNode& secondGrandChild = m_Nodes[otherChild.m_ChildIndices[1]];
+		otherChild.m_Box = AABB::Union(firstGrandChild.m_Box, secondGrandChild.m_Box);
+		otherChild.m_Height = std::max(firstGrandChild.m_Height, secondGrandChild.m_Height) + 1;
+		treeNode.m_Height = std::max(m_Nodes[treeNode.m_ChildIndices[0]].m_Height, m_Nodes[treeNode.m_ChildIndices[1]].m_Height) + 1;
+	}
+}
\ No newline at end of file
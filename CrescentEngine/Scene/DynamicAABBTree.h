@@ -0,0 +1,204 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include "../Rendering/Frustum.h"
+
+namespace Crescent
+{
+	static constexpr uint32_t g_NullTreeNode = ~0u;
+
+	struct AABB
+	{
+		glm::vec3 m_Minimum = glm::vec3(0.0f);
+		glm::vec3 m_Maximum = glm::vec3(0.0f);
+
+		glm::vec3 RetrieveCenter() const { return (m_Minimum + m_Maximum) * 0.5f; }
+		glm::vec3 RetrieveExtents() const { return (m_Maximum - m_Minimum) * 0.5f; }
+
+		float RetrieveSurfaceArea() const
+		{
+			const glm::vec3 size = m_Maximum - m_Minimum;
+			return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+		}
+
+		bool Contains(const AABB& otherBox) const { return glm::all(glm::lessThanEqual(m_Minimum, otherBox.m_Minimum)) && glm::all(glm::greaterThanEqual(m_Maximum, otherBox.m_Maximum)); }
+
+		static AABB Union(const AABB& boxA, const AABB& boxB) { return { glm::min(boxA.m_Minimum, boxB.m_Minimum), glm::max(boxA.m_Maximum, boxB.m_Maximum) }; }
+		static AABB FromCenterExtents(const glm::vec3& center, const glm::vec3& extents) { return { center - extents, center + extents }; }
+	};
+
+	/*
+		Dynamic bounding volume hierarchy over axis-aligned boxes, after the dynamic trees of Box2D and Bullet. Every proxy is a leaf holding a box fattened by a small
+		margin, so objects moving within it need no tree update at all. Leaves are inserted next to the sibling that minimizes the surface area heuristic, found through
+		a best first branch and bound search, and every ancestor refit on the way back up tries a tree rotation that lowers its area, keeping the tree from degrading as objects move.
+
+		Queries walk the tree with an explicit stack kept between calls, so they are main thread only and must not be nested from within their own callbacks.
+	*/
+
+	class DynamicAABBTree
+	{
+	public:
+		static constexpr float g_FatBoxMargin = 0.1f; //In world units.
+
+		uint32_t CreateProxy(const AABB& box, uint32_t userData);
+		void DestroyProxy(uint32_t proxyIndex);
+		//Returns whether the proxy had to be reinserted, which only happens once its box leaves the fattened one (or becomes much smaller than it).
+		bool MoveProxy(uint32_t proxyIndex, const AABB& box);
+
+		uint32_t RetrieveUserData(uint32_t proxyIndex) const { return m_Nodes[proxyIndex].m_UserData; }
+		const AABB& RetrieveFatBox(uint32_t proxyIndex) const { return m_Nodes[proxyIndex].m_Box; }
+		uint32_t RetrieveProxyCount() const { return m_ProxyCount; }
+		uint32_t RetrieveHeight() const { return m_RootIndex == g_NullTreeNode ? 0 : m_Nodes[m_RootIndex].m_Height; }
+
+		//Calls function(proxyIndex) for every proxy whose fat box intersects the frustum. Subtrees entirely inside it are reported without testing any further planes.
+		template<typename Function>
+		void QueryFrustum(const Frustum& frustum, Function function) const
+		{
+			QueryNodes([&](const TreeNode& treeNode, uint32_t nodeIndex, bool& fullyInside)
+			{
+				if (!fullyInside)
+				{
+					const FrustumOverlap overlap = ClassifyBox(frustum, treeNode.m_Box);
+					if (overlap == FrustumOverlap_Outside)
+					{
+						return false;
+					}
+					fullyInside = overlap == FrustumOverlap_Inside;
+				}
+
+				if (treeNode.IsLeaf())
+				{
+					function(nodeIndex);
+				}
+				return true;
+			});
+		}
+
+		//Calls function(proxyIndex) for every proxy whose fat box intersects the sphere.
+		template<typename Function>
+		void QuerySphere(const glm::vec3& sphereCenter, float sphereRadius, Function function) const
+		{
+			QueryNodes([&](const TreeNode& treeNode, uint32_t nodeIndex, bool&)
+			{
+				const glm::vec3 closestPoint = glm::clamp(sphereCenter, treeNode.m_Box.m_Minimum, treeNode.m_Box.m_Maximum);
+				const glm::vec3 offset = closestPoint - sphereCenter;
+				if (glm::dot(offset, offset) > sphereRadius * sphereRadius)
+				{
+					return false;
+				}
+
+				if (treeNode.IsLeaf())
+				{
+					function(nodeIndex);
+				}
+				return true;
+			});
+		}
+
+		bool OverlapsSphere(const glm::vec3& sphereCenter, float sphereRadius) const;
+
+		//Calls function(proxyIndex, maximumDistance) for every proxy whose fat box the ray hits within maximumDistance (rayDirection must be normalized).
+		//The function returns the new maximum distance: its own hit distance to only look for closer hits from then on, or the one passed in to ignore the proxy.
+		template<typename Function>
+		void RayCast(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, float maximumDistance, Function function) const
+		{
+			const glm::vec3 inverseDirection = 1.0f / rayDirection;
+			QueryNodes([&](const TreeNode& treeNode, uint32_t nodeIndex, bool&)
+			{
+				if (!IntersectRay(treeNode.m_Box, rayOrigin, inverseDirection, maximumDistance))
+				{
+					return false;
+				}
+
+				if (treeNode.IsLeaf())
+				{
+					maximumDistance = function(nodeIndex, maximumDistance);
+				}
+				return true;
+			});
+		}
+
+		//Slab test. Returns whether the ray enters the box before maximumDistance.
+		static bool IntersectRay(const AABB& box, const glm::vec3& rayOrigin, const glm::vec3& inverseDirection, float maximumDistance, float* hitDistance = nullptr);
+
+	private:
+		struct TreeNode
+		{
+			AABB m_Box;
+			uint32_t m_ParentIndex = g_NullTreeNode; //Next free node while on our free list.
+			uint32_t m_ChildIndices[2] = { g_NullTreeNode, g_NullTreeNode };
+			uint32_t m_UserData = 0;
+			uint32_t m_Height = 0; //Leaves are at height 0.
+
+			bool IsLeaf() const { return m_ChildIndices[0] == g_NullTreeNode; }
+		};
+
+		enum FrustumOverlap
+		{
+			FrustumOverlap_Outside,
+			FrustumOverlap_Intersecting,
+			FrustumOverlap_Inside
+		};
+
+		//Depth first walk. Visitor(node, index, fullyInside) returns whether to descend, and may set fullyInside, which is then inherited by the node's subtree.
+		template<typename Visitor>
+		void QueryNodes(Visitor visitor) const
+		{
+			if (m_RootIndex == g_NullTreeNode)
+			{
+				return;
+			}
+
+			m_QueryStack.clear();
+			m_QueryStack.push_back({ m_RootIndex, false });
+			while (!m_QueryStack.empty())
+			{
+				QueryEntry queryEntry = m_QueryStack.back();
+				m_QueryStack.pop_back();
+
+				const TreeNode& treeNode = m_Nodes[queryEntry.m_NodeIndex];
+				if (visitor(treeNode, queryEntry.m_NodeIndex, queryEntry.m_FullyInside) && !treeNode.IsLeaf())
+				{
+					m_QueryStack.push_back({ treeNode.m_ChildIndices[0], queryEntry.m_FullyInside });
+					m_QueryStack.push_back({ treeNode.m_ChildIndices[1], queryEntry.m_FullyInside });
+				}
+			}
+		}
+
+		static FrustumOverlap ClassifyBox(const Frustum& frustum, const AABB& box);
+
+		uint32_t AllocateNode();
+		void FreeNode(uint32_t nodeIndex);
+
+		void InsertLeaf(uint32_t leafIndex);
+		void RemoveLeaf(uint32_t leafIndex);
+		uint32_t FindBestSibling(const AABB& leafBox) const;
+		//Refits every node from nodeIndex up to the root, rotating each where that lowers its area.
+		void RefitAncestors(uint32_t nodeIndex);
+		void RotateNodes(uint32_t nodeIndex);
+
+	private:
+		struct QueryEntry
+		{
+			uint32_t m_NodeIndex;
+			bool m_FullyInside;
+		};
+
+		struct SiblingCandidate
+		{
+			uint32_t m_NodeIndex;
+			float m_DirectCost; //Area of the node's union with the leaf.
+			float m_InheritedCost; //Growth of the node's ancestors.
+			float m_LowerBound; //Least that pairing the leaf with the node or anything below it can cost.
+		};
+
+		std::vector<TreeNode> m_Nodes;
+		uint32_t m_RootIndex = g_NullTreeNode;
+		uint32_t m_FreeListIndex = g_NullTreeNode;
+		uint32_t m_ProxyCount = 0;
+
+		mutable std::vector<QueryEntry> m_QueryStack;
+		mutable std::vector<SiblingCandidate> m_SiblingQueue; //Min-heap on lower bound, for FindBestSibling.
+	};
+}
\ No newline at end of file
@@ -1,13 +1,12 @@
 #include "CrescentPCH.h"
 #include "Skybox.h"
-#include "../Scene.h"
 #include "../Models/DefaultPrimitives.h"
 #include "../Shading/Material.h"
 #include "../Rendering/Resources.h"
 
 namespace Crescent
 {
-	Skybox::Skybox() : SceneEntity("Skybox", Scene::m_SceneEntityCounterID++)
+	Skybox::Skybox() : SceneEntity("Skybox", g_InvalidEntityHandle.m_Value)
 	{
 		m_CubeMapShader = Resources::LoadShader("Background", "Resources/Shaders/SkyboxVertex.shader", "Resources/Shaders/SkyboxFragment.shader");
 		m_Material = new Material(m_CubeMapShader);
@@ -8,6 +8,7 @@ namespace Crescent
 	class Shader;
 	class Renderer;
 	class Cube;
+	class Mesh;
 
 	/*
 		A SkyBox represented as a scene entity for easy scene management. This is set up in a way that when passed to the renderer, it will automatically
@@ -22,6 +23,11 @@ namespace Crescent
 
 		void SetCubeMap(TextureCube* cubeMap);
 
+	public:
+		//Our skybox lives outside the entity pool, so it owns its mesh and material directly rather than through a mesh renderer component.
+		Mesh* m_Mesh = nullptr;
+		Material* m_Material = nullptr;
+
 	private:
 		TextureCube* m_CubeMap = nullptr;
 		Shader* m_CubeMapShader = nullptr;
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+
+namespace Crescent
+{
+	/*
+		32-bit reference to a pooled scene entity: the low bits index its slot in the EntityPool, while the high bits hold the slot's generation at the time
+		the entity was constructed. Destroying an entity bumps its slot's generation, so stale handles fail validation instead of reaching whatever reuses the slot.
+
+		20 index bits allow a million live entities, leaving 12 bits (4096 generations) per slot. As the pool reuses the lowest free slot first, a slot can cycle
+		through its generations quickly, and wrapping would let a stale handle alias a live entity. The pool instead retires a slot once its generation saturates.
+	*/
+
+	static constexpr uint32_t g_EntityIndexBits = 20;
+	static constexpr uint32_t g_EntityIndexMask = (1u << g_EntityIndexBits) - 1;
+	static constexpr uint32_t g_EntityGenerationMask = (1u << (32 - g_EntityIndexBits)) - 1;
+
+	struct EntityHandle
+	{
+		EntityHandle() = default;
+		explicit EntityHandle(uint32_t handleValue) : m_Value(handleValue) { }
+		EntityHandle(uint32_t slotIndex, uint32_t generation) : m_Value(((generation & g_EntityGenerationMask) << g_EntityIndexBits) | (slotIndex & g_EntityIndexMask)) { }
+
+		uint32_t RetrieveSlotIndex() const { return m_Value & g_EntityIndexMask; }
+		uint32_t RetrieveGeneration() const { return m_Value >> g_EntityIndexBits; }
+		bool IsValid() const { return m_Value != ~0u; }
+
+		bool operator==(const EntityHandle& otherHandle) const { return m_Value == otherHandle.m_Value; }
+		bool operator!=(const EntityHandle& otherHandle) const { return m_Value != otherHandle.m_Value; }
+
+		uint32_t m_Value = ~0u; //All bits set is never handed out, as the slot index it encodes is reserved.
+	};
+
+	static const EntityHandle g_InvalidEntityHandle = EntityHandle();
+}
\ No newline at end of file
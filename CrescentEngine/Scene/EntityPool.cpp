@@ -0,0 +1,97 @@
+#include "CrescentPCH.h"
+#include "EntityPool.h"
+#include "Components.h"
+#include <algorithm>
+#include <functional>
+
+namespace Crescent
+{
+	std::vector<std::unique_ptr<EntityPool::EntitySlot[]>> EntityPool::m_Slabs;
+	std::vector<uint16_t> EntityPool::m_Generations;
+	std::vector<uint8_t> EntityPool::m_LiveFlags;
+	std::vector<uint32_t> EntityPool::m_FreeIndices;
+	uint32_t EntityPool::m_SlotCount = 0;
+	uint32_t EntityPool::m_LiveEntityCount = 0;
+	uint32_t EntityPool::m_RetiredSlotCount = 0;
+
+	SceneEntity* EntityPool::ConstructEntity(const std::string& entityName)
+	{
+		uint32_t slotIndex;
+		if (!m_FreeIndices.empty())
+		{
+			std::pop_heap(m_FreeIndices.begin(), m_FreeIndices.end(), std::greater<uint32_t>());
+			slotIndex = m_FreeIndices.back();
+			m_FreeIndices.pop_back();
+		}
+		else
+		{
+			//The highest index is reserved, as it forms our invalid handle.
+			if (m_SlotCount == g_EntityIndexMask)
+			{
+				CrescentError("Entity pool exhausted. Increase g_EntityIndexBits to allow more entities.");
+			}
+
+			slotIndex = m_SlotCount++;
+			if (slotIndex / g_EntitySlabSize == m_Slabs.size())
+			{
+				m_Slabs.emplace_back(new EntitySlot[g_EntitySlabSize]);
+			}
+			m_Generations.push_back(0);
+			m_LiveFlags.push_back(0);
+		}
+
+		m_LiveFlags[slotIndex] = 1;
+		m_LiveEntityCount++;
+		return new (RetrieveSlotEntity(slotIndex)) SceneEntity(entityName, EntityHandle(slotIndex, m_Generations[slotIndex]).m_Value);
+	}
+
+	void EntityPool::DestroyEntity(SceneEntity* sceneEntity)
+	{
+		const EntityHandle entityHandle = sceneEntity->RetrieveEntityHandle();
+		const uint32_t slotIndex = entityHandle.RetrieveSlotIndex();
+		ComponentStorage::RemoveAllComponents(entityHandle);
+		sceneEntity->~SceneEntity();
+
+		m_LiveFlags[slotIndex] = 0;
+		m_LiveEntityCount--;
+
+		//A slot in its last generation can't be reused without wrapping back to a generation that stale handles may still hold, so it is retired instead.
+		//Its generation stays as is, which no live entity will ever have, as the slot is never live again.
+		if (m_Generations[slotIndex] == g_EntityGenerationMask)
+		{
+			m_RetiredSlotCount++;
+			return;
+		}
+
+		//Invalidates every outstanding handle to this slot.
+		m_Generations[slotIndex]++;
+		m_FreeIndices.push_back(slotIndex);
+		std::push_heap(m_FreeIndices.begin(), m_FreeIndices.end(), std::greater<uint32_t>());
+	}
+
+	void EntityPool::DestroyEntityHierarchy(SceneEntity* sceneEntity)
+	{
+		//Gather the subtree parents first, then destroy it in reverse so every entity is gone before its parent.
+		std::vector<SceneEntity*> subtreeEntities = { sceneEntity };
+		for (size_t i = 0; i < subtreeEntities.size(); i++)
+		{
+			subtreeEntities.insert(subtreeEntities.end(), subtreeEntities[i]->m_ChildEntities.begin(), subtreeEntities[i]->m_ChildEntities.end());
+		}
+
+		for (auto iterator = subtreeEntities.rbegin(); iterator != subtreeEntities.rend(); iterator++)
+		{
+			DestroyEntity(*iterator);
+		}
+	}
+
+	SceneEntity* EntityPool::RetrieveEntity(EntityHandle entityHandle)
+	{
+		const uint32_t slotIndex = entityHandle.RetrieveSlotIndex();
+		if (slotIndex >= m_SlotCount || !m_LiveFlags[slotIndex] || m_Generations[slotIndex] != entityHandle.RetrieveGeneration())
+		{
+			return nullptr;
+		}
+
+		return RetrieveSlotEntity(slotIndex);
+	}
+}
\ No newline at end of file
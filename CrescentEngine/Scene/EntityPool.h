@@ -0,0 +1,69 @@
+#pragma once
+#include "SceneEntity.h"
+#include "EntityHandle.h"
+#include <memory>
+#include <vector>
+#include <string>
+
+namespace Crescent
+{
+	/*
+		Slab storage for scene entities. Entities are constructed in place within fixed size slabs that are never moved or freed, so entity pointers stay stable
+		and neighbouring entities share cache lines instead of being scattered across the heap. Every slot carries a generation, which together with the slot's
+		index forms the entity's handle (and ID), letting lookups validate in O(1). Freed slots are reused lowest index first, keeping live entities packed
+		at the front of the pool for iteration. A slot destroyed in its last generation is never reused, so generations never wrap (see EntityHandle.h).
+	*/
+
+	class EntityPool
+	{
+	public:
+		static constexpr uint32_t g_EntitySlabSize = 256;
+
+		static SceneEntity* ConstructEntity(const std::string& entityName);
+		static void DestroyEntity(SceneEntity* sceneEntity);
+		//Destroys the entity along with all of its descendants, which must be pooled as well.
+		static void DestroyEntityHierarchy(SceneEntity* sceneEntity);
+
+		//Returns nullptr if the handle is invalid or its entity has since been destroyed.
+		static SceneEntity* RetrieveEntity(EntityHandle entityHandle);
+		//Whether the entity lives in our slabs, as opposed to being allocated by its owner (such as our skybox).
+		static bool IsPooledEntity(const SceneEntity* sceneEntity) { return RetrieveEntity(sceneEntity->RetrieveEntityHandle()) == sceneEntity; }
+
+		static uint32_t RetrieveLiveEntityCount() { return m_LiveEntityCount; }
+		//Slots taken out of use after exhausting their generations.
+		static uint32_t RetrieveRetiredSlotCount() { return m_RetiredSlotCount; }
+
+		//Visits every live entity in slot order.
+		template<typename Function>
+		static void ForEachEntity(Function function)
+		{
+			for (uint32_t slotIndex = 0; slotIndex < m_SlotCount; slotIndex++)
+			{
+				if (m_LiveFlags[slotIndex])
+				{
+					function(RetrieveSlotEntity(slotIndex));
+				}
+			}
+		}
+
+	private:
+		//Disallow creation of any EntityPool object. This is a static object.
+		EntityPool();
+
+		struct EntitySlot
+		{
+			alignas(SceneEntity) unsigned char m_Storage[sizeof(SceneEntity)];
+		};
+
+		static SceneEntity* RetrieveSlotEntity(uint32_t slotIndex) { return reinterpret_cast<SceneEntity*>(m_Slabs[slotIndex / g_EntitySlabSize][slotIndex % g_EntitySlabSize].m_Storage); }
+
+	private:
+		static std::vector<std::unique_ptr<EntitySlot[]>> m_Slabs;
+		static std::vector<uint16_t> m_Generations;
+		static std::vector<uint8_t> m_LiveFlags;
+		static std::vector<uint32_t> m_FreeIndices; //Min-heap, so the lowest free slot is reused first.
+		static uint32_t m_SlotCount;
+		static uint32_t m_LiveEntityCount;
+		static uint32_t m_RetiredSlotCount;
+	};
+}
\ No newline at end of file
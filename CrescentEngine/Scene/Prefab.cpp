@@ -0,0 +1,101 @@
+#include "CrescentPCH.h"
+#include "Prefab.h"
+#include "SceneEntity.h"
+#include "Components.h"
+#include "../Models/Mesh.h"
+#include "../Shading/Material.h"
+#include <unordered_set>
+#include <cfloat>
+
+namespace Crescent
+{
+	Prefab::Prefab(const std::string& prefabName, SceneEntity* rootEntity, const std::string& sourcePath, uint64_t contentHash, bool pooledGeometry)
+		: m_PrefabName(prefabName), m_SourcePath(sourcePath), m_ContentHash(contentHash), m_PooledGeometry(pooledGeometry)
+	{
+		//Node transforms are taken relative to the root, so the hierarchy may be placed anywhere.
+		const glm::mat4 inverseRootMatrix = glm::inverse(rootEntity->RetrieveEntityTransform());
+		ComponentPool<MeshRendererComponent>& meshRendererPool = ComponentStorage::RetrieveMeshRenderers();
+
+		m_BoundingBoxMinimum = glm::vec3(FLT_MAX);
+		m_BoundingBoxMaximum = glm::vec3(-FLT_MAX);
+
+		std::unordered_set<const Texture*> sampledTextures;
+
+		std::vector<std::pair<SceneEntity*, uint32_t>> nodeStack = { { rootEntity, g_NullPrefabNode } };
+		while (!nodeStack.empty())
+		{
+			SceneEntity* sceneEntity = nodeStack.back().first;
+			const uint32_t parentIndex = nodeStack.back().second;
+			nodeStack.pop_back();
+
+			PrefabNode prefabNode;
+			prefabNode.m_NodeName = sceneEntity->RetrieveEntityName();
+			prefabNode.m_ParentIndex = parentIndex;
+			prefabNode.m_PrefabTransform = inverseRootMatrix * sceneEntity->RetrieveEntityTransform();
+			prefabNode.m_LocalTransform = parentIndex == g_NullPrefabNode ? glm::mat4(1.0f) : glm::inverse(m_Nodes[parentIndex].m_PrefabTransform) * prefabNode.m_PrefabTransform;
+
+			if (const MeshRendererComponent* meshRenderer = meshRendererPool.RetrieveComponent(sceneEntity->RetrieveEntityHandle()))
+			{
+				prefabNode.m_Mesh = meshRenderer->m_Mesh;
+				prefabNode.m_Material = meshRenderer->m_Material;
+			}
+
+			const uint32_t nodeIndex = (uint32_t)m_Nodes.size();
+			m_Nodes.push_back(prefabNode);
+
+			if (prefabNode.m_Mesh)
+			{
+				m_RenderableNodes.push_back(nodeIndex);
+				if (!m_AnimatedMesh && !prefabNode.m_Mesh->m_Animations.empty())
+				{
+					m_AnimatedMesh = prefabNode.m_Mesh;
+				}
+
+				//Same projection of the mesh's box onto each axis our bounds components use.
+				const glm::mat4& prefabTransform = prefabNode.m_PrefabTransform;
+				const glm::vec3 localCenter = (prefabNode.m_Mesh->m_BoundingBoxMinimum + prefabNode.m_Mesh->m_BoundingBoxMaximum) * 0.5f;
+				const glm::vec3 localExtents = (prefabNode.m_Mesh->m_BoundingBoxMaximum - prefabNode.m_Mesh->m_BoundingBoxMinimum) * 0.5f;
+				const glm::mat3 absoluteMatrix = glm::mat3(glm::abs(glm::vec3(prefabTransform[0])), glm::abs(glm::vec3(prefabTransform[1])), glm::abs(glm::vec3(prefabTransform[2])));
+				const glm::vec3 nodeCenter = glm::vec3(prefabTransform * glm::vec4(localCenter, 1.0f));
+				const glm::vec3 nodeExtents = absoluteMatrix * localExtents;
+
+				m_BoundingBoxMinimum = glm::min(m_BoundingBoxMinimum, nodeCenter - nodeExtents);
+				m_BoundingBoxMaximum = glm::max(m_BoundingBoxMaximum, nodeCenter + nodeExtents);
+
+				const Mesh* mesh = prefabNode.m_Mesh;
+				const size_t geometrySize = mesh->m_Positions.size() * sizeof(glm::vec3) + mesh->m_UV.size() * sizeof(glm::vec2) + mesh->m_Normals.size() * sizeof(glm::vec3) +
+					mesh->m_Tangents.size() * sizeof(glm::vec3) + mesh->m_Bitangents.size() * sizeof(glm::vec3) + mesh->m_Indices.size() * sizeof(unsigned int);
+				m_MemoryFootprint += geometrySize * 2;
+
+				if (prefabNode.m_Material)
+				{
+					for (const auto& samplerUniform : *prefabNode.m_Material->GetSamplerUniforms())
+					{
+						if (samplerUniform.second.m_UniformType != Shader_Type_SamplerCube && samplerUniform.second.m_Texture)
+						{
+							sampledTextures.insert(samplerUniform.second.m_Texture);
+						}
+					}
+				}
+			}
+
+			//Pushed in reverse, so children are flattened in their original order.
+			for (unsigned int i = sceneEntity->RetrieveChildCount(); i > 0; i--)
+			{
+				nodeStack.push_back({ sceneEntity->RetrieveChildByIndex(i - 1), nodeIndex });
+			}
+		}
+
+		//Assumes 4 bytes per texel, plus a third for mipmaps.
+		for (const Texture* texture : sampledTextures)
+		{
+			m_MemoryFootprint += (size_t)texture->m_TextureWidth * std::max(texture->m_TextureHeight, 1u) * 4 * 4 / 3;
+		}
+
+		if (m_RenderableNodes.empty())
+		{
+			m_BoundingBoxMinimum = glm::vec3(0.0f);
+			m_BoundingBoxMaximum = glm::vec3(0.0f);
+		}
+	}
+}
\ No newline at end of file
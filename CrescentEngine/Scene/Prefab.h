@@ -0,0 +1,70 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace Crescent
+{
+	class SceneEntity;
+	class Mesh;
+	class Material;
+
+	static constexpr uint32_t g_NullPrefabNode = ~0u;
+
+	//One node of a flattened prefab hierarchy. Parents always precede their children.
+	struct PrefabNode
+	{
+		std::string m_NodeName;
+		uint32_t m_ParentIndex = g_NullPrefabNode;
+		glm::mat4 m_LocalTransform = glm::mat4(1.0f); //Relative to the parent node.
+		glm::mat4 m_PrefabTransform = glm::mat4(1.0f); //Relative to the prefab's root, resolved once as the prefab is built.
+		Mesh* m_Mesh = nullptr;
+		Material* m_Material = nullptr;
+	};
+
+	/*
+		Immutable, flattened copy of a loaded model hierarchy, shared by every instance of it. An instance is a single entity holding a PrefabInstanceComponent,
+		so placing a model costs one entity and one transform no matter how many nodes it has, and its nodes are drawn straight from our array relative to the
+		instance's world transform.
+	*/
+
+	class Prefab
+	{
+	public:
+		//Flattens the entity hierarchy depth first. The hierarchy itself is left untouched, and can be destroyed once we're built.
+		//The source file and its content hash are what scene files reference us by.
+		Prefab(const std::string& prefabName, SceneEntity* rootEntity, const std::string& sourcePath, uint64_t contentHash, bool pooledGeometry);
+
+		const std::string& RetrievePrefabName() const { return m_PrefabName; }
+		const std::string& RetrieveSourcePath() const { return m_SourcePath; }
+		uint64_t RetrieveContentHash() const { return m_ContentHash; }
+		bool IsGeometryPooled() const { return m_PooledGeometry; }
+		const std::vector<PrefabNode>& RetrieveNodes() const { return m_Nodes; }
+		const std::vector<uint32_t>& RetrieveRenderableNodes() const { return m_RenderableNodes; } //Indices of the nodes with a mesh, in node order.
+
+		//Bounds of every renderable node, relative to the prefab's root.
+		const glm::vec3& RetrieveBoundingBoxMinimum() const { return m_BoundingBoxMinimum; }
+		const glm::vec3& RetrieveBoundingBoxMaximum() const { return m_BoundingBoxMaximum; }
+
+		//The first mesh with skeletal animations, which instance animators play back. nullptr if there is none.
+		Mesh* RetrieveAnimatedMesh() const { return m_AnimatedMesh; }
+
+		//Estimated bytes held by our geometry (both its CPU and GPU copies) and the textures our materials sample. Used to budget streamed worlds.
+		size_t RetrieveMemoryFootprint() const { return m_MemoryFootprint; }
+
+	private:
+		std::string m_PrefabName;
+		std::string m_SourcePath;
+		uint64_t m_ContentHash = 0;
+		bool m_PooledGeometry = false;
+
+		std::vector<PrefabNode> m_Nodes;
+		std::vector<uint32_t> m_RenderableNodes;
+
+		glm::vec3 m_BoundingBoxMinimum = glm::vec3(0.0f);
+		glm::vec3 m_BoundingBoxMaximum = glm::vec3(0.0f);
+		Mesh* m_AnimatedMesh = nullptr;
+		size_t m_MemoryFootprint = 0;
+	};
+}
\ No newline at end of file
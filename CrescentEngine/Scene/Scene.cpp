@@ -1,13 +1,18 @@
 #include "CrescentPCH.h"
 #include "Scene.h"
 #include "SceneEntity.h"
+#include "EntityPool.h"
+#include "Components.h"
+#include "TransformSystem.h"
+#include "Prefab.h"
+#include "../Models/Mesh.h"
+#include "../Lighting/PointLight.h"
 #include "Entities/Skybox.h"
 #include <stack>
+#include <cfloat>
 
 namespace Crescent
 {
-	unsigned int Scene::m_SceneEntityCounterID = 0;
-
 	Scene::Scene(bool isEmptyScene)
 	{
 		ConstructDefaultScene();
@@ -15,15 +20,18 @@ namespace Crescent
 
 	void Scene::ClearScene()
 	{
-		for (int i = 0; i < m_SceneEntities.size(); i++)
+		while (!m_SceneEntities.empty())
 		{
-			DeleteSceneEntity(m_SceneEntities[i]);
+			DeleteSceneEntity(m_SceneEntities.back());
 		}
+
+		m_OwnedPointLights.clear();
+		m_OwnedDirectionalLights.clear();
 	}
 
 	SceneEntity* Scene::ConstructNewEntity()
 	{
-		SceneEntity* newEntity = new SceneEntity("Empty Entity", Scene::m_SceneEntityCounterID++);
+		SceneEntity* newEntity = EntityPool::ConstructEntity("Empty Entity");
 		m_SceneEntities.push_back(newEntity);
 
 		return newEntity;
@@ -31,63 +39,226 @@ namespace Crescent
 
 	SceneEntity* Scene::ConstructNewEntity(Mesh* mesh, Material* material)
 	{
-		SceneEntity* newEntity = new SceneEntity("Model", Scene::m_SceneEntityCounterID++);
-		
-		newEntity->m_Mesh = mesh;
-		newEntity->m_Material = material;
+		SceneEntity* newEntity = EntityPool::ConstructEntity("Model");
+		ComponentStorage::AttachMeshRenderer(newEntity, mesh, material);
 
 		m_SceneEntities.push_back(newEntity);
 		
 		return newEntity;
 	}
 
-	SceneEntity* Scene::ConstructNewEntity(SceneEntity* sceneEntity)
+	SceneEntity* Scene::ConstructNewEntity(PointLight* pointLight)
 	{
-		SceneEntity* newEntity = new SceneEntity(sceneEntity->RetrieveEntityName(), Scene::m_SceneEntityCounterID++);
+		SceneEntity* newEntity = EntityPool::ConstructEntity("Point Light");
+		newEntity->SetEntityPosition(pointLight->m_LightPosition);
 
-		newEntity->m_Mesh = sceneEntity->m_Mesh;
-		newEntity->m_Material = sceneEntity->m_Material;
+		LightComponent lightComponent;
+		lightComponent.m_PointLight = pointLight;
+		ComponentStorage::RetrieveLights().AddComponent(newEntity->RetrieveEntityHandle(), lightComponent);
 
-		//Traverse through the list of children and add them accordingly.
-		std::stack<SceneEntity*> nodeStack;
-		for (unsigned int i = 0; i < sceneEntity->RetrieveChildCount(); i++)
+		m_SceneEntities.push_back(newEntity);
+		return newEntity;
+	}
+
+	SceneEntity* Scene::ConstructNewEntity(DirectionalLight* directionalLight)
+	{
+		SceneEntity* newEntity = EntityPool::ConstructEntity("Directional Light");
+
+		LightComponent lightComponent;
+		lightComponent.m_DirectionalLight = directionalLight;
+		ComponentStorage::RetrieveLights().AddComponent(newEntity->RetrieveEntityHandle(), lightComponent);
+
+		m_SceneEntities.push_back(newEntity);
+		return newEntity;
+	}
+
+	SceneEntity* Scene::ConstructNewEntity(const Prefab* prefab)
+	{
+		SceneEntity* newEntity = EntityPool::ConstructEntity(prefab->RetrievePrefabName());
+		ComponentStorage::AttachPrefabInstance(newEntity, prefab);
+
+		m_SceneEntities.push_back(newEntity);
+		return newEntity;
+	}
+
+	void Scene::ConstructSkyboxEntity(Skybox* skyBox)
+	{
+		m_SceneEntities.push_back(skyBox);
+	}
+
+	void Scene::DeleteSceneEntity(SceneEntity* sceneEntity)
+	{
+		m_SceneEntities.erase(std::remove(m_SceneEntities.begin(), m_SceneEntities.end(), sceneEntity), m_SceneEntities.end());
+
+		//Entities we didn't construct (such as our skybox) are owned by whoever allocated them.
+		if (EntityPool::IsPooledEntity(sceneEntity))
 		{
-			nodeStack.push(sceneEntity->RetrieveChildByIndex(i));
+			DestroyEntityProxies(sceneEntity);
+			EntityPool::DestroyEntityHierarchy(sceneEntity);
 		}
+		else
+		{
+			delete sceneEntity;
+		}
+	}
+
+	void Scene::UpdateScene(float deltaTime)
+	{
+		TransformSystem::UpdateTransforms();
+		UpdateEntityBounds();
+		UpdateLights();
+		UpdateAnimators(deltaTime);
+	}
+
+	void Scene::UpdateEntityBounds()
+	{
+		//Only entities whose world matrix changed need refitting, which for a static scene is none of them.
+		ComponentPool<BoundsComponent>& boundsPool = ComponentStorage::RetrieveBounds();
+		for (SceneEntity* changedEntity : TransformSystem::RetrieveChangedEntities())
+		{
+			BoundsComponent* entityBounds = boundsPool.RetrieveComponent(changedEntity->RetrieveEntityHandle());
+			if (!entityBounds)
+			{
+				continue;
+			}
+
+			//Transforms the box's center, and projects its extents onto each world axis through the absolute values of the matrix.
+			const glm::mat4& worldMatrix = TransformSystem::RetrieveWorldMatrix(changedEntity->RetrieveTransformIndex());
+			const glm::vec3 localCenter = (entityBounds->m_LocalMinimum + entityBounds->m_LocalMaximum) * 0.5f;
+			const glm::vec3 localExtents = (entityBounds->m_LocalMaximum - entityBounds->m_LocalMinimum) * 0.5f;
+			const glm::mat3 absoluteMatrix = glm::mat3(glm::abs(glm::vec3(worldMatrix[0])), glm::abs(glm::vec3(worldMatrix[1])), glm::abs(glm::vec3(worldMatrix[2])));
+
+			entityBounds->m_WorldCenter = glm::vec3(worldMatrix * glm::vec4(localCenter, 1.0f));
+			entityBounds->m_WorldExtents = absoluteMatrix * localExtents;
+
+			//Only entities that can actually be drawn are indexed. Small moves stay within the proxy's fattened box and leave the tree untouched.
+			const AABB worldBox = AABB::FromCenterExtents(entityBounds->m_WorldCenter, entityBounds->m_WorldExtents);
+			if (ComponentStorage::IsRenderableEntity(changedEntity->RetrieveEntityHandle()))
+			{
+				if (entityBounds->m_TreeProxy == g_NullTreeNode)
+				{
+					entityBounds->m_TreeProxy = m_SpatialTree.CreateProxy(worldBox, changedEntity->RetrieveEntityHandle().m_Value);
+				}
+				else
+				{
+					m_SpatialTree.MoveProxy(entityBounds->m_TreeProxy, worldBox);
+				}
+				ComponentStorage::MarkRenderableMoved(changedEntity->RetrieveEntityHandle());
+			}
+			else if (entityBounds->m_TreeProxy != g_NullTreeNode)
+			{
+				m_SpatialTree.DestroyProxy(entityBounds->m_TreeProxy);
+				entityBounds->m_TreeProxy = g_NullTreeNode;
+			}
+		}
+		TransformSystem::ClearChangedEntities();
+	}
+
+	void Scene::DestroyEntityProxies(SceneEntity* sceneEntity)
+	{
+		ComponentPool<BoundsComponent>& boundsPool = ComponentStorage::RetrieveBounds();
+		std::stack<SceneEntity*> nodeStack;
+		nodeStack.push(sceneEntity);
 		while (!nodeStack.empty())
 		{
-			SceneEntity* child = nodeStack.top();
+			SceneEntity* entity = nodeStack.top();
 			nodeStack.pop();
 
-			//Similarly, create SceneNode for each child and push to scene node memory list.
-			SceneEntity* newChild = new SceneEntity(sceneEntity->RetrieveEntityName(), Scene::m_SceneEntityCounterID++);
-			newChild->m_Mesh = child->m_Mesh;
-			newChild->m_Material = child->m_Material;
-			newEntity->AddChildEntity(newChild);
+			BoundsComponent* entityBounds = boundsPool.RetrieveComponent(entity->RetrieveEntityHandle());
+			if (entityBounds && entityBounds->m_TreeProxy != g_NullTreeNode)
+			{
+				m_SpatialTree.DestroyProxy(entityBounds->m_TreeProxy);
+				entityBounds->m_TreeProxy = g_NullTreeNode;
+			}
 
-			for (unsigned int i = 0; i < child->RetrieveChildCount(); i++)
+			for (unsigned int i = 0; i < entity->RetrieveChildCount(); i++)
 			{
-				nodeStack.push(child->RetrieveChildByIndex(i));
+				nodeStack.push(entity->RetrieveChildByIndex(i));
 			}
 		}
-
-		m_SceneEntities.push_back(newEntity);
-		return newEntity;
 	}
 
-	void Scene::ConstructSkyboxEntity(Skybox* skyBox)
+	SceneEntity* Scene::PickEntity(const glm::vec3& rayOrigin, const glm::vec3& rayDirection) const
 	{
-		m_SceneEntities.push_back(skyBox);
+		//The tree only knows fattened boxes, so each candidate is confirmed against its tight world bounds, which also gives us its hit distance.
+		ComponentPool<BoundsComponent>& boundsPool = ComponentStorage::RetrieveBounds();
+		const glm::vec3 inverseDirection = 1.0f / rayDirection;
+		SceneEntity* closestEntity = nullptr;
+
+		m_SpatialTree.RayCast(rayOrigin, rayDirection, FLT_MAX, [&](uint32_t proxyIndex, float maximumDistance)
+		{
+			SceneEntity* candidateEntity = EntityPool::RetrieveEntity(EntityHandle(m_SpatialTree.RetrieveUserData(proxyIndex)));
+			const BoundsComponent* entityBounds = candidateEntity ? boundsPool.RetrieveComponent(candidateEntity->RetrieveEntityHandle()) : nullptr;
+
+			float hitDistance = 0.0f;
+			if (!entityBounds || !DynamicAABBTree::IntersectRay(AABB::FromCenterExtents(entityBounds->m_WorldCenter, entityBounds->m_WorldExtents), rayOrigin, inverseDirection, maximumDistance, &hitDistance))
+			{
+				return maximumDistance;
+			}
+
+			closestEntity = candidateEntity;
+			return hitDistance;
+		});
+
+		return closestEntity;
 	}
 
-	void Scene::DeleteSceneEntity(SceneEntity* sceneEntity)
+	void Scene::UpdateLights()
 	{
-		delete sceneEntity;
+		ComponentPool<LightComponent>& lightPool = ComponentStorage::RetrieveLights();
+		const std::vector<EntityHandle>& lightEntities = lightPool.RetrieveEntities();
+		std::vector<LightComponent>& lightComponents = lightPool.RetrieveComponents();
+		for (uint32_t i = 0; i < lightPool.RetrieveComponentCount(); i++)
+		{
+			if (lightComponents[i].m_PointLight)
+			{
+				const glm::mat4& worldMatrix = EntityPool::RetrieveEntity(lightEntities[i])->RetrieveEntityTransform();
+				lightComponents[i].m_PointLight->m_LightPosition = glm::vec3(worldMatrix[3]);
+			}
+		}
 	}
 
-	std::vector<SceneEntity*> Scene::RetrieveSceneEntities()
+	void Scene::UpdateAnimators(float deltaTime)
 	{
-		return m_SceneEntities;
+		ComponentPool<AnimatorComponent>& animatorPool = ComponentStorage::RetrieveAnimators();
+		ComponentPool<MeshRendererComponent>& meshRendererPool = ComponentStorage::RetrieveMeshRenderers();
+		ComponentPool<PrefabInstanceComponent>& prefabInstancePool = ComponentStorage::RetrievePrefabInstances();
+		const std::vector<EntityHandle>& animatorEntities = animatorPool.RetrieveEntities();
+		std::vector<AnimatorComponent>& animatorComponents = animatorPool.RetrieveComponents();
+		for (uint32_t i = 0; i < animatorPool.RetrieveComponentCount(); i++)
+		{
+			//Animators play back their entity's own mesh, or the animated mesh of the prefab it instances.
+			Mesh* animatedMesh = nullptr;
+			if (MeshRendererComponent* meshRenderer = meshRendererPool.RetrieveComponent(animatorEntities[i]))
+			{
+				animatedMesh = meshRenderer->m_Mesh;
+			}
+			else if (PrefabInstanceComponent* prefabInstance = prefabInstancePool.RetrieveComponent(animatorEntities[i]))
+			{
+				animatedMesh = prefabInstance->m_Prefab->RetrieveAnimatedMesh();
+			}
+
+			AnimatorComponent& animator = animatorComponents[i];
+			if (!animator.m_Playing || !animatedMesh || animator.m_AnimationIndex >= (int)animatedMesh->m_Animations.size())
+			{
+				continue;
+			}
+
+			const float animationDuration = animatedMesh->m_Animations[animator.m_AnimationIndex]->m_AnimationTimeInSeconds;
+			animator.m_AnimationTime += deltaTime * animator.m_PlaybackSpeed;
+			if (animator.m_AnimationTime >= animationDuration)
+			{
+				if (animator.m_Looping && animationDuration > 0.0f)
+				{
+					animator.m_AnimationTime = std::fmod(animator.m_AnimationTime, animationDuration);
+				}
+				else
+				{
+					animator.m_AnimationTime = animationDuration;
+					animator.m_Playing = false;
+				}
+			}
+		}
 	}
 
 	void Scene::ConstructDefaultScene()
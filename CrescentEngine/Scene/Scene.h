@@ -1,5 +1,9 @@
 #pragma once
 #include <vector>
+#include <deque>
+#include "DynamicAABBTree.h"
+#include "../Lighting/PointLight.h"
+#include "../Lighting/DirectionalLight.h"
 
 /*
 	- This is our global scene object. There will always one global scene object which can be cleared and configured at will.
@@ -11,18 +15,22 @@ namespace Crescent
 	class Model;
 	class Mesh;
 	class Material;
-	class PointLight;
-	class DirectionalLight;
 	class Skybox;
+	class Prefab;
 
 	class Scene
 	{
+		friend class SceneSerializer;
+
 	public:
 		Scene(bool isEmptyScene = true);
 
 		//Clears all scene entities currently part of the open scene.
 		void ClearScene();
 
+		//Runs our per-frame systems: propagates transforms, refits the bounds of moved entities, moves lights with their entities and advances animations.
+		void UpdateScene(float deltaTime);
+
 		//Constructs an empty scene entity. 
 		SceneEntity* ConstructNewEntity();
 		//Directly constructs a node with an attached Mesh and Material.
@@ -31,23 +39,39 @@ namespace Crescent
 		SceneEntity* ConstructNewEntity(PointLight* pointLight); ///Take lighting positions from the scene entity.
 		SceneEntity* ConstructNewEntity(DirectionalLight* directionalLight); ///Take lighting rotations from the scene entity.
 
-		SceneEntity* ConstructNewEntity(SceneEntity* sceneEntity);
+		//Constructs a single entity drawing every node of the prefab. Nodes aren't entities themselves, so the instance costs the same regardless of the model's size.
+		SceneEntity* ConstructNewEntity(const Prefab* prefab);
 
 		void ConstructSkyboxEntity(Skybox* skyBox);
 
 		//Deletes a scene node from the global scene hierarchy together with its children.
 		void DeleteSceneEntity(SceneEntity* sceneEntity);
 
-		std::vector<SceneEntity*> RetrieveSceneEntities();
+		//The root entities of the scene. Children are reached through their parents.
+		const std::vector<SceneEntity*>& RetrieveSceneEntities() const { return m_SceneEntities; }
+
+		//Bounding volume hierarchy over the world bounds of every enabled mesh renderer, keyed by entity handle. Kept up to date by UpdateScene.
+		const DynamicAABBTree& RetrieveSpatialTree() const { return m_SpatialTree; }
+
+		//Returns the closest entity whose world bounds the ray hits (rayDirection must be normalized), or nullptr.
+		SceneEntity* PickEntity(const glm::vec3& rayOrigin, const glm::vec3& rayDirection) const;
 
-	public:
-		static unsigned int m_SceneEntityCounterID;
-	
 	private:
 		void ConstructDefaultScene();
 
+		void UpdateEntityBounds();
+		void DestroyEntityProxies(SceneEntity* sceneEntity); //Removes the entity and its children from our spatial tree.
+		void UpdateLights();
+		void UpdateAnimators(float deltaTime);
+
 	private:
-		//Cache all scene entities part of the current scene.
+		//Cache all root scene entities part of the current scene. Entities themselves live in the EntityPool.
 		std::vector<SceneEntity*> m_SceneEntities;
+
+		DynamicAABBTree m_SpatialTree;
+
+		//Lights read from scene files. Our light components point into these, so they're only freed by ClearScene.
+		std::deque<PointLight> m_OwnedPointLights;
+		std::deque<DirectionalLight> m_OwnedDirectionalLights;
 	};
 }
\ No newline at end of file
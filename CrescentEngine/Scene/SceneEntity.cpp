@@ -1,14 +1,30 @@
 #include "CrescentPCH.h"
 #include "SceneEntity.h"
-#include "glm/gtc/matrix_transform.hpp"
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/quaternion.hpp>
+#include "TransformSystem.h"
+#include "EntityPool.h"
 
 namespace Crescent
 {
 	SceneEntity::SceneEntity(const std::string& entityName, const unsigned int& entityID) : m_EntityName(entityName), m_EntityID(entityID)
 	{
+		m_TransformIndex = TransformSystem::AllocateTransform(this);
+	}
+
+	SceneEntity::~SceneEntity()
+	{
+		//Our children outlive us as roots, so they mustn't keep resolving against our released transform.
+		for (SceneEntity* childEntity : m_ChildEntities)
+		{
+			childEntity->m_ParentEntity = nullptr;
+			TransformSystem::SetParent(childEntity->m_TransformIndex, g_InvalidTransformIndex);
+		}
 
+		if (m_ParentEntity)
+		{
+			std::vector<SceneEntity*>& siblingEntities = m_ParentEntity->m_ChildEntities;
+			siblingEntities.erase(std::remove(siblingEntities.begin(), siblingEntities.end(), this), siblingEntities.end());
+		}
+		TransformSystem::ReleaseTransform(m_TransformIndex);
 	}
 
 	void SceneEntity::AddChildEntity(SceneEntity* childEntity)
@@ -16,69 +32,44 @@ namespace Crescent
 		//Check if this child already has a parent. If so, first remove this scene node from its current parent. Scene nodes cannot exist under multiple parents.
 		if (childEntity->m_ParentEntity != nullptr)
 		{
-			childEntity->m_ParentEntity->RemoveChildEntity(childEntity->m_EntityID);
+			std::vector<SceneEntity*>& siblingEntities = childEntity->m_ParentEntity->m_ChildEntities;
+			siblingEntities.erase(std::remove(siblingEntities.begin(), siblingEntities.end(), childEntity), siblingEntities.end());
 		}
 
 		childEntity->m_ParentEntity = this;
 		m_ChildEntities.push_back(childEntity);
+		TransformSystem::SetParent(childEntity->m_TransformIndex, m_TransformIndex);
 	}
 
-	void SceneEntity::RemoveChildEntity(unsigned int entityID)
+	void SceneEntity::RemoveChildEntity(EntityHandle entityHandle)
 	{
-		auto iterator = std::find(m_ChildEntities.begin(), m_ChildEntities.end(), RetrieveChildEntity(entityID));
-		if (iterator != m_ChildEntities.end())
+		SceneEntity* childEntity = RetrieveChildEntity(entityHandle);
+		if (childEntity)
 		{
-			m_ChildEntities.erase(iterator);
+			m_ChildEntities.erase(std::find(m_ChildEntities.begin(), m_ChildEntities.end(), childEntity));
+			childEntity->m_ParentEntity = nullptr;
+			TransformSystem::SetParent(childEntity->m_TransformIndex, g_InvalidTransformIndex);
 		}
 	}
 
-	void SceneEntity::UpdateEntityTransform(bool updatePreviousTransform)
-	{
-		if (m_IsTransformDirty)
-		{
-			glm::mat4 rotation = glm::toMat4(glm::quat(m_EntityRotation));
-			m_EntityTransform = glm::translate(glm::mat4(1.0f), m_EntityPosition) * rotation * glm::scale(glm::mat4(1.0f), m_EntityScale);
-
-			if (m_ParentEntity != nullptr)
-			{
-				m_EntityTransform = m_ParentEntity->m_EntityTransform * m_EntityTransform;
-			}
-		}
-
-		for (int i = 0; i < m_ChildEntities.size(); i++)
-		{
-			if (m_IsTransformDirty)
-			{
-				m_ChildEntities[i]->m_IsTransformDirty = true;
-			}
-			m_ChildEntities[i]->UpdateEntityTransform(updatePreviousTransform);
-		}
-
-		m_IsTransformDirty = false;
-	}
-
 	void SceneEntity::SetEntityPosition(glm::vec3 newPosition)
 	{
-		m_EntityPosition = newPosition;
-		m_IsTransformDirty = true;
+		TransformSystem::SetLocalPosition(m_TransformIndex, newPosition);
 	}
 
 	void SceneEntity::SetEntityScale(glm::vec3 newScale)
 	{
-		m_EntityScale = newScale;
-		m_IsTransformDirty = true;
+		TransformSystem::SetLocalScale(m_TransformIndex, newScale);
 	}
 
 	void SceneEntity::SetEntityScale(float newScalar)
 	{
-		m_EntityScale = glm::vec3(newScalar, newScalar, newScalar);
-		m_IsTransformDirty = true;
+		TransformSystem::SetLocalScale(m_TransformIndex, glm::vec3(newScalar, newScalar, newScalar));
 	}
 
 	void SceneEntity::SetEntityRotation(glm::vec3 newRotation)
 	{
-		m_EntityRotation = newRotation;
-		m_IsTransformDirty = true;
+		TransformSystem::SetLocalRotation(m_TransformIndex, newRotation);
 	}
 
 	void SceneEntity::SetEntityName(const std::string& newName)
@@ -86,41 +77,35 @@ namespace Crescent
 		m_EntityName = newName;
 	}
 
-	glm::mat4& SceneEntity::RetrieveEntityTransform()
+	const glm::mat4& SceneEntity::RetrieveEntityTransform()
 	{
-		if (m_IsTransformDirty)
+		if (TransformSystem::HasDirtyTransforms())
 		{
-			UpdateEntityTransform(true);
+			TransformSystem::UpdateTransforms();
 		}
 
-		return m_EntityTransform;
+		return TransformSystem::RetrieveWorldMatrix(m_TransformIndex);
 	}
 
 	glm::vec3& SceneEntity::RetrieveEntityPosition()
 	{
-		return m_EntityPosition;
+		return TransformSystem::RetrieveLocalPosition(m_TransformIndex);
 	}
 
 	glm::vec3& SceneEntity::RetrieveEntityScale()
 	{
-		return m_EntityScale;
+		return TransformSystem::RetrieveLocalScale(m_TransformIndex);
 	}
 
 	glm::vec3& SceneEntity::RetrieveEntityRotation()
 	{
-		return m_EntityRotation;
+		return TransformSystem::RetrieveLocalRotation(m_TransformIndex);
 	}
 
-	SceneEntity* SceneEntity::RetrieveChildEntity(unsigned int entityID)
+	SceneEntity* SceneEntity::RetrieveChildEntity(EntityHandle entityHandle)
 	{
-		for (unsigned int i = 0; i < m_ChildEntities.size(); i++)
-		{
-			if (m_ChildEntities[i]->m_EntityID == entityID)
-			{
-				return m_ChildEntities[i];
-			}
-		}
-		return nullptr;
+		SceneEntity* childEntity = EntityPool::RetrieveEntity(entityHandle);
+		return childEntity && childEntity->m_ParentEntity == this ? childEntity : nullptr;
 	}
 
 	SceneEntity* SceneEntity::RetrieveChildByIndex(unsigned int entityIndex)
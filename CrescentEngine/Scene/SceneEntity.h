@@ -1,25 +1,28 @@
 #pragma once
 #include <glm/glm.hpp>
 #include <vector>
+#include <cstdint>
+#include "EntityHandle.h"
 
 /*
 	- Symbolizes a scene entity with a respective UI component. A scene entity contains several default parameters such as a name and transforms.
 	- Each entity can have any number of child entities, but there can only ever be one parent. 
+	- Renderable, light and animation data is attached as components in the ComponentStorage, keyed by the entity's handle.
 */
 
 namespace Crescent
 {
-	class Mesh;
-	class Material;
-
 	class SceneEntity
 	{
 	public:
 		SceneEntity(const std::string& entityName, const unsigned int& entityID);
+		virtual ~SceneEntity();
 
-		//Transforms
-		void UpdateEntityTransform(bool updatePreviousTransform = false);
+		//Entities own a slot in the transform system, so they can't be copied.
+		SceneEntity(const SceneEntity&) = delete;
+		SceneEntity& operator=(const SceneEntity&) = delete;
 
+		//Transforms - Stored in the TransformSystem, and brought up to date by the scene's next update.
 		void SetEntityPosition(glm::vec3 newPosition);
 		void SetEntityScale(glm::vec3 newScale);
 		void SetEntityScale(float newScalar);
@@ -27,19 +30,24 @@ namespace Crescent
 		void SetEntityName(const std::string& newName);
 
 		void AddChildEntity(SceneEntity* childEntity);
-		void RemoveChildEntity(unsigned int entityID);
+		void RemoveChildEntity(EntityHandle entityHandle);
 
-		glm::mat4& RetrieveEntityTransform();
+		const glm::mat4& RetrieveEntityTransform();
+		//Writing through these requires a TransformSystem::MarkTransformDirty afterwards.
 		glm::vec3& RetrieveEntityPosition();
 		glm::vec3& RetrieveEntityScale();
 		glm::vec3& RetrieveEntityRotation();
-		SceneEntity* RetrieveChildEntity(unsigned int entityID);
+		//Validated O(1) lookup through the EntityPool. Returns nullptr if the handle is stale or doesn't belong to one of our children.
+		SceneEntity* RetrieveChildEntity(EntityHandle entityHandle);
 		unsigned int RetrieveChildCount() const { return m_ChildEntities.size(); }
 		SceneEntity* RetrieveChildByIndex(unsigned int entityIndex);
 
 		std::string RetrieveEntityName() const;
 
 		unsigned int RetrieveEntityID() const;
+		EntityHandle RetrieveEntityHandle() const { return EntityHandle(m_EntityID); }
+		SceneEntity* RetrieveParentEntity() const { return m_ParentEntity; }
+		uint32_t RetrieveTransformIndex() const { return m_TransformIndex; }
 
 		operator uint32_t() const
 		{
@@ -47,22 +55,18 @@ namespace Crescent
 		}
 
 	public:
-		Mesh* m_Mesh = nullptr;
-		Material* m_Material = nullptr;
 		std::vector<SceneEntity*> m_ChildEntities;
 
 	private:
+		friend class TransformSystem; //Patches our transform index when it re-sorts its arrays.
+
 		//Scene Information
 		std::string m_EntityName = "Entity";
-		SceneEntity* m_ParentEntity;
+		SceneEntity* m_ParentEntity = nullptr;
 
-		glm::mat4 m_EntityTransform = glm::mat4(1.0f);
-		glm::vec3 m_EntityPosition = glm::vec3(0.0f);
-		glm::vec3 m_EntityScale = glm::vec3(1.0f);
-		glm::vec3 m_EntityRotation = glm::vec3(0.0f);
+		uint32_t m_TransformIndex;
 
-		//Each entity is uniquely identified by a 32-bit incrementing unsigned integer.
-		bool m_IsTransformDirty = true;
+		//Pooled entities are uniquely identified by their 32-bit generational handle. Entities allocated outside the pool (such as our skybox) use g_InvalidEntityHandle.
 		unsigned int m_EntityID;
 	};
 }
\ No newline at end of file
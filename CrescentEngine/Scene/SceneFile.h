@@ -0,0 +1,121 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+
+namespace Crescent
+{
+	/*
+		On-disk layout of our binary scene files. A fixed header locates a handful of flat tables, each aligned to 16 bytes, so that a mapped file is used in place:
+		loading only turns the header's offsets into typed pointers after checking they lie within the file. Entities are stored parents first, referencing their
+		parent, prefab and lights by table index, with their local transforms in parallel arrays matching the TransformSystem's layout. Strings share a single
+		table of null terminated entries.
+
+		Bump g_SceneFileVersion whenever any of these structures change. Files of another version are rejected rather than converted.
+	*/
+
+	static constexpr uint32_t g_SceneFileMagic = 0x4E435343; //"CSCN", read as a little endian integer.
+	static constexpr uint32_t g_SceneFileVersion = 1;
+	static constexpr uint32_t g_SceneFileNullIndex = ~0u;
+	static constexpr uint32_t g_SceneFileTableAlignment = 16;
+
+	enum SceneFileTable
+	{
+		SceneFileTable_Entities = 0,
+		SceneFileTable_Positions,
+		SceneFileTable_Rotations,
+		SceneFileTable_Scales,
+		SceneFileTable_Assets,
+		SceneFileTable_PointLights,
+		SceneFileTable_DirectionalLights,
+		SceneFileTable_Strings,
+		SceneFileTable_Count
+	};
+
+	struct SceneFileTableEntry
+	{
+		uint32_t m_Offset; //From the start of the file.
+		uint32_t m_Count; //In elements. In bytes for the string table.
+	};
+
+	struct SceneFileHeader
+	{
+		uint32_t m_Magic;
+		uint32_t m_Version;
+		uint64_t m_FileSize; //Catches truncated files.
+		SceneFileTableEntry m_Tables[SceneFileTable_Count];
+	};
+
+	struct SceneFileEntity
+	{
+		uint32_t m_NameOffset; //Into the string table.
+		uint32_t m_ParentIndex; //Always lower than the entity's own index. g_SceneFileNullIndex for root entities.
+		uint32_t m_AssetIndex; //The prefab the entity instances, if any.
+		uint32_t m_PointLightIndex;
+		uint32_t m_DirectionalLightIndex;
+	};
+
+	//A model file, referenced by the hash of its contents. Its name and path are only used to load it should no resident prefab match the hash.
+	struct SceneFileAsset
+	{
+		uint64_t m_ContentHash;
+		uint32_t m_NameOffset;
+		uint32_t m_PathOffset;
+		uint32_t m_PooledGeometry;
+		uint32_t m_Padding;
+	};
+
+	//Point lights take their position from their entity.
+	struct SceneFilePointLight
+	{
+		glm::vec3 m_LightColor;
+		float m_LightIntensity;
+		float m_LightRadius;
+		uint32_t m_LightVisible;
+		uint32_t m_RenderMesh;
+	};
+
+	struct SceneFileDirectionalLight
+	{
+		glm::vec3 m_LightDirection;
+		glm::vec3 m_LightColor;
+		float m_LightIntensity;
+		uint32_t m_ShadowCastingEnabled;
+	};
+
+	static_assert(sizeof(SceneFileHeader) == 16 + 8 * SceneFileTable_Count, "Scene file header layout changed. Bump g_SceneFileVersion.");
+	static_assert(sizeof(SceneFileEntity) == 20 && sizeof(SceneFileAsset) == 24, "Scene file entity or asset layout changed. Bump g_SceneFileVersion.");
+	static_assert(sizeof(SceneFilePointLight) == 28 && sizeof(SceneFileDirectionalLight) == 32, "Scene file light layout changed. Bump g_SceneFileVersion.");
+
+	/*
+		World manifests (.cworld) list the square cells a world was split into on the XZ plane (see WorldPartition). Every cell is a scene file of its own, saved next to
+		the manifest, whose asset table doubles as the cell's asset manifest. Cells also record an estimate of the memory their assets take up, so that streaming can
+		budget for a cell before loading it. Strings share a table of null terminated entries, as in scene files.
+	*/
+
+	static constexpr uint32_t g_WorldFileMagic = 0x444C5743; //"CWLD", read as a little endian integer.
+	static constexpr uint32_t g_WorldFileVersion = 1;
+
+	struct WorldFileHeader
+	{
+		uint32_t m_Magic;
+		uint32_t m_Version;
+		uint64_t m_FileSize;
+		float m_CellSize;
+		uint32_t m_CellCount;
+		uint32_t m_CellTableOffset;
+		uint32_t m_StringTableOffset;
+		uint32_t m_StringTableSize; //In bytes.
+		uint32_t m_Padding;
+	};
+
+	struct WorldFileCell
+	{
+		int32_t m_CellX; //In cells, from the origin.
+		int32_t m_CellZ;
+		uint32_t m_PathOffset; //Into the string table. Relative to the manifest's directory.
+		uint32_t m_EntityCount;
+		uint64_t m_MemoryEstimate; //In bytes. Sum of the footprints of the prefabs the cell instances.
+	};
+
+	static_assert(sizeof(WorldFileHeader) == 40 && sizeof(WorldFileCell) == 24, "World file layout changed. Bump g_WorldFileVersion.");
+}
\ No newline at end of file
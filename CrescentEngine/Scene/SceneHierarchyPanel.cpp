@@ -3,6 +3,8 @@
 #include "Scene.h"
 #include "../Core/Window.h"
 #include "SceneEntity.h"
+#include "TransformSystem.h"
+#include "Components.h"
 #include <imgui/imgui.h>
 #include <imgui/imgui_internal.h>
 #include "../Shading/Texture.h"
@@ -73,11 +75,17 @@ namespace Crescent
 
 	static MeshAnimation* currentSelectedAnimation = nullptr;
 
+	static MeshRendererComponent* RetrieveMeshRenderer(SceneEntity* sceneEntity)
+	{
+		return ComponentStorage::RetrieveMeshRenderers().RetrieveComponent(sceneEntity->RetrieveEntityHandle());
+	}
+
 	void SceneHierarchyPanel::DrawSelectedEntityAnimationSettings(SceneEntity* selectedEntity)
 	{
-		if (selectedEntity->m_Mesh != nullptr)
+		MeshRendererComponent* meshRenderer = RetrieveMeshRenderer(selectedEntity);
+		if (meshRenderer != nullptr && meshRenderer->m_Mesh != nullptr)
 		{
-			if (!selectedEntity->m_Mesh->m_Animations.empty())
+			if (!meshRenderer->m_Mesh->m_Animations.empty())
 			{
 				bool replayAnimation = true;
 				ImGui::Button("Play");
@@ -86,7 +94,7 @@ namespace Crescent
 				ImGui::SameLine();
 				ImGui::Checkbox("Loop", &replayAnimation);
 
-				std::vector<MeshAnimation*> meshAnimations = selectedEntity->m_Mesh->m_Animations;
+				std::vector<MeshAnimation*> meshAnimations = meshRenderer->m_Mesh->m_Animations;
 				if (currentSelectedAnimation == nullptr)
 				{
 					currentSelectedAnimation = meshAnimations[0];
@@ -118,7 +126,8 @@ namespace Crescent
 
 	void SceneHierarchyPanel::DrawSelectedEntityMaterialSettings(SceneEntity* selectedEntity)
 	{
-		if (selectedEntity->m_Material != nullptr)
+		MeshRendererComponent* meshRenderer = RetrieveMeshRenderer(selectedEntity);
+		if (meshRenderer != nullptr && meshRenderer->m_Material != nullptr)
 		{
 			DrawSelectedEntityMaterialTextureComponent(selectedEntity, "Albedo", "TexAlbedo", 3);
 			DrawSelectedEntityMaterialTextureComponent(selectedEntity, "Normal", "TexNormal", 4);
@@ -152,12 +161,13 @@ namespace Crescent
 
 	void SceneHierarchyPanel::DrawSelectedEntityMaterialTextureComponent(SceneEntity* selectedEntity, const std::string& nodeName, const std::string& uniformTextureName, int uniformTextureUnit)
 	{
-		if (selectedEntity->m_Material->m_SamplerUniforms[uniformTextureName].m_Texture != nullptr)
+		Material* material = RetrieveMeshRenderer(selectedEntity)->m_Material;
+		if (material->m_SamplerUniforms[uniformTextureName].m_Texture != nullptr)
 		{
 			if (ImGui::CollapsingHeader(nodeName.c_str()))
 			{
 				ImGui::Spacing();
-				ImGui::Image((void*)selectedEntity->m_Material->m_SamplerUniforms[uniformTextureName].m_Texture->RetrieveTextureID(), { 100.0f, 100.0f }, ImVec2{ 0, 1 }, ImVec2{ 1, 0 });
+				ImGui::Image((void*)material->m_SamplerUniforms[uniformTextureName].m_Texture->RetrieveTextureID(), { 100.0f, 100.0f }, ImVec2{ 0, 1 }, ImVec2{ 1, 0 });
 				ImGui::SameLine();
 				if (ImGui::Button("Load New Texture"))
 				{
@@ -168,7 +178,7 @@ namespace Crescent
 						std::string filePath = path.substr(0, path.find_last_of("/"));
 
 						Texture* loadedTexture = Resources::LoadTexture(filePath, filePath, GL_TEXTURE_2D, GL_RGB, true);
-						selectedEntity->m_Material->SetShaderTexture(uniformTextureName, loadedTexture, uniformTextureUnit);
+						material->SetShaderTexture(uniformTextureName, loadedTexture, uniformTextureUnit);
 					}
 				}
 
@@ -194,7 +204,8 @@ namespace Crescent
 			for (int i = 0; i < sceneEntity->m_ChildEntities.size(); i++)
 			{
 				SceneEntity* childEntity = sceneEntity->m_ChildEntities[i];
-				if (childEntity->m_Material != nullptr)
+				MeshRendererComponent* childRenderer = RetrieveMeshRenderer(childEntity);
+				if (childRenderer != nullptr && childRenderer->m_Material != nullptr)
 				{
 					DrawEntityUI(childEntity);
 				}
@@ -216,10 +227,15 @@ namespace Crescent
 
 		DrawVector3Controls("Translation", selectedEntity->RetrieveEntityPosition(), selectedEntity);
 
-		//Converts our radians to degrees for display in the hierarchy, and translates its new values back to radians.
-		glm::vec3 rotation = (glm::vec3)glm::degrees(selectedEntity->RetrieveEntityRotation());
+		//Converts our radians to degrees for display in the hierarchy, and translates its new values back to radians. Only written back when edited, as the round trip
+		//isn't exact and would otherwise dirty the entity's transform every frame.
+		const glm::vec3 displayedRotation = (glm::vec3)glm::degrees(selectedEntity->RetrieveEntityRotation());
+		glm::vec3 rotation = displayedRotation;
 		DrawVector3Controls("Rotation", rotation, selectedEntity);
-		selectedEntity->SetEntityRotation(glm::radians(rotation));
+		if (rotation != displayedRotation)
+		{
+			selectedEntity->SetEntityRotation(glm::radians(rotation));
+		}
 
 		DrawVector3Controls("Scale", selectedEntity->RetrieveEntityScale(), selectedEntity);
 	}
@@ -249,7 +265,7 @@ namespace Crescent
 		if (ImGui::Button("X", buttonSize))
 		{
 			values.x = resetValue;
-			selectedEntity->UpdateEntityTransform(true);
+			TransformSystem::MarkTransformDirty(selectedEntity->RetrieveTransformIndex());
 		}
 
 		ImGui::PopFont();
@@ -258,7 +274,7 @@ namespace Crescent
 		ImGui::SameLine();
 		if (ImGui::DragFloat("##X", &values.x, 0.1f, 0.0f, 0.0f, "%.2f"))
 		{
-			selectedEntity->UpdateEntityTransform(true);
+			TransformSystem::MarkTransformDirty(selectedEntity->RetrieveTransformIndex());
 		}
 		ImGui::PopItemWidth();
 		ImGui::SameLine();
@@ -271,7 +287,7 @@ namespace Crescent
 		if (ImGui::Button("Y", buttonSize))
 		{
 			values.y = resetValue;
-			selectedEntity->UpdateEntityTransform(true);
+			TransformSystem::MarkTransformDirty(selectedEntity->RetrieveTransformIndex());
 		}
 
 		ImGui::PopFont();
@@ -280,7 +296,7 @@ namespace Crescent
 		ImGui::SameLine();
 		if (ImGui::DragFloat("##Y", &values.y, 0.1f, 0.0f, 0.0f, "%.2f"))
 		{
-			selectedEntity->UpdateEntityTransform(true);
+			TransformSystem::MarkTransformDirty(selectedEntity->RetrieveTransformIndex());
 		}
 		ImGui::PopItemWidth();
 		ImGui::SameLine();
@@ -293,7 +309,7 @@ namespace Crescent
 		if (ImGui::Button("Z", buttonSize))
 		{
 			values.z = resetValue;
-			selectedEntity->UpdateEntityTransform(true);
+			TransformSystem::MarkTransformDirty(selectedEntity->RetrieveTransformIndex());
 		}
 
 		ImGui::PopFont();
@@ -302,7 +318,7 @@ namespace Crescent
 		ImGui::SameLine();
 		if (ImGui::DragFloat("##Z", &values.z, 0.1f, 0.0f, 0.0f, "%.2f"))
 		{
-			selectedEntity->UpdateEntityTransform(true);
+			TransformSystem::MarkTransformDirty(selectedEntity->RetrieveTransformIndex());
 		}
 		ImGui::PopItemWidth();
 
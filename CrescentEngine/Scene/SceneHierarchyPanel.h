@@ -21,6 +21,9 @@ namespace Crescent
 		//Renders all invidual entities of the scene with UI.
 		void RenderSceneEditorUI();
 
+		//Such as from picking in our viewport. Pass nullptr to clear the selection.
+		void SetSelectedEntity(SceneEntity* sceneEntity) { m_CurrentlySelectedEntity = sceneEntity; }
+
 	private:
 		void DrawEntityUI(SceneEntity* sceneEntity);
 		void DrawSelectedEntityComponents(SceneEntity* selectedEntity);
@@ -0,0 +1,357 @@
+#include "CrescentPCH.h"
+#include "SceneSerializer.h"
+#include "SceneFile.h"
+#include "Scene.h"
+#include "SceneEntity.h"
+#include "EntityPool.h"
+#include "Components.h"
+#include "TransformSystem.h"
+#include "Prefab.h"
+#include "../Memory/MappedFile.h"
+#include "../Rendering/Resources.h"
+#include <unordered_map>
+#include <fstream>
+#include <cstring>
+
+namespace Crescent
+{
+	//Pads the buffer to our table alignment, appends the table and returns its offset.
+	static uint32_t AppendSceneFileTable(std::vector<uint8_t>& fileBuffer, const void* tableData, size_t tableSize)
+	{
+		fileBuffer.resize((fileBuffer.size() + g_SceneFileTableAlignment - 1) & ~(size_t)(g_SceneFileTableAlignment - 1), 0);
+		const uint32_t tableOffset = (uint32_t)fileBuffer.size();
+		if (tableSize > 0)
+		{
+			fileBuffer.insert(fileBuffer.end(), static_cast<const uint8_t*>(tableData), static_cast<const uint8_t*>(tableData) + tableSize);
+		}
+		return tableOffset;
+	}
+
+	static uint32_t AppendSceneFileString(std::vector<char>& stringTable, const std::string& string)
+	{
+		const uint32_t stringOffset = (uint32_t)stringTable.size();
+		stringTable.insert(stringTable.end(), string.begin(), string.end());
+		stringTable.push_back('\0');
+		return stringOffset;
+	}
+
+	bool SceneSerializer::SaveScene(Scene* scene, const std::string& filePath)
+	{
+		//Entities we didn't construct (such as our skybox) are set up by their owners.
+		std::vector<SceneEntity*> rootEntities;
+		for (SceneEntity* sceneEntity : scene->m_SceneEntities)
+		{
+			if (EntityPool::IsPooledEntity(sceneEntity))
+			{
+				rootEntities.push_back(sceneEntity);
+			}
+		}
+		return SaveEntities(rootEntities, filePath);
+	}
+
+	bool SceneSerializer::SaveEntities(const std::vector<SceneEntity*>& rootEntities, const std::string& filePath)
+	{
+		std::vector<SceneFileEntity> fileEntities;
+		std::vector<glm::vec3> positions, rotations, scales;
+		std::vector<SceneFileAsset> fileAssets;
+		std::vector<SceneFilePointLight> filePointLights;
+		std::vector<SceneFileDirectionalLight> fileDirectionalLights;
+		std::vector<char> stringTable;
+		std::unordered_map<const Prefab*, uint32_t> assetIndices;
+		unsigned int skippedMeshRendererCount = 0;
+
+		ComponentPool<PrefabInstanceComponent>& prefabInstancePool = ComponentStorage::RetrievePrefabInstances();
+		ComponentPool<LightComponent>& lightPool = ComponentStorage::RetrieveLights();
+		ComponentPool<MeshRendererComponent>& meshRendererPool = ComponentStorage::RetrieveMeshRenderers();
+
+		//Depth first from every root, so parents are always written before their children.
+		std::vector<std::pair<SceneEntity*, uint32_t>> entityStack;
+		for (auto iterator = rootEntities.rbegin(); iterator != rootEntities.rend(); iterator++)
+		{
+			entityStack.push_back({ *iterator, g_SceneFileNullIndex });
+		}
+
+		while (!entityStack.empty())
+		{
+			SceneEntity* sceneEntity = entityStack.back().first;
+			const uint32_t parentIndex = entityStack.back().second;
+			entityStack.pop_back();
+
+			const EntityHandle entityHandle = sceneEntity->RetrieveEntityHandle();
+			const uint32_t transformIndex = sceneEntity->RetrieveTransformIndex();
+
+			SceneFileEntity fileEntity;
+			fileEntity.m_NameOffset = AppendSceneFileString(stringTable, sceneEntity->RetrieveEntityName());
+			fileEntity.m_ParentIndex = parentIndex;
+			fileEntity.m_AssetIndex = g_SceneFileNullIndex;
+			fileEntity.m_PointLightIndex = g_SceneFileNullIndex;
+			fileEntity.m_DirectionalLightIndex = g_SceneFileNullIndex;
+
+			if (const PrefabInstanceComponent* prefabInstance = prefabInstancePool.RetrieveComponent(entityHandle))
+			{
+				auto assetIterator = assetIndices.find(prefabInstance->m_Prefab);
+				if (assetIterator == assetIndices.end())
+				{
+					SceneFileAsset fileAsset = {};
+					fileAsset.m_ContentHash = prefabInstance->m_Prefab->RetrieveContentHash();
+					fileAsset.m_NameOffset = AppendSceneFileString(stringTable, prefabInstance->m_Prefab->RetrievePrefabName());
+					fileAsset.m_PathOffset = AppendSceneFileString(stringTable, prefabInstance->m_Prefab->RetrieveSourcePath());
+					fileAsset.m_PooledGeometry = prefabInstance->m_Prefab->IsGeometryPooled() ? 1 : 0;
+
+					assetIterator = assetIndices.insert({ prefabInstance->m_Prefab, (uint32_t)fileAssets.size() }).first;
+					fileAssets.push_back(fileAsset);
+				}
+				fileEntity.m_AssetIndex = assetIterator->second;
+			}
+			else if (meshRendererPool.HasComponent(entityHandle))
+			{
+				skippedMeshRendererCount++;
+			}
+
+			if (const LightComponent* lightComponent = lightPool.RetrieveComponent(entityHandle))
+			{
+				if (const PointLight* pointLight = lightComponent->m_PointLight)
+				{
+					fileEntity.m_PointLightIndex = (uint32_t)filePointLights.size();
+					filePointLights.push_back({ pointLight->m_LightColor, pointLight->m_LightIntensity, pointLight->m_LightRadius, pointLight->m_IsLightVisible ? 1u : 0u, pointLight->m_RenderMesh ? 1u : 0u });
+				}
+				if (const DirectionalLight* directionalLight = lightComponent->m_DirectionalLight)
+				{
+					fileEntity.m_DirectionalLightIndex = (uint32_t)fileDirectionalLights.size();
+					fileDirectionalLights.push_back({ directionalLight->m_LightDirection, directionalLight->m_LightColor, directionalLight->m_LightIntensity, directionalLight->m_ShadowCastingEnabled ? 1u : 0u });
+				}
+			}
+
+			const uint32_t entityIndex = (uint32_t)fileEntities.size();
+			fileEntities.push_back(fileEntity);
+			positions.push_back(TransformSystem::RetrieveLocalPosition(transformIndex));
+			rotations.push_back(TransformSystem::RetrieveLocalRotation(transformIndex));
+			scales.push_back(TransformSystem::RetrieveLocalScale(transformIndex));
+
+			//Pushed in reverse, so children keep their order.
+			for (unsigned int i = sceneEntity->RetrieveChildCount(); i > 0; i--)
+			{
+				entityStack.push_back({ sceneEntity->RetrieveChildByIndex(i - 1), entityIndex });
+			}
+		}
+
+		//The header is patched in once every table's offset is known.
+		SceneFileHeader fileHeader = {};
+		std::vector<uint8_t> fileBuffer(sizeof(SceneFileHeader), 0);
+		auto appendTable = [&](SceneFileTable table, const void* tableData, size_t elementCount, size_t elementSize)
+		{
+			fileHeader.m_Tables[table].m_Offset = AppendSceneFileTable(fileBuffer, tableData, elementCount * elementSize);
+			fileHeader.m_Tables[table].m_Count = (uint32_t)elementCount;
+		};
+		appendTable(SceneFileTable_Entities, fileEntities.data(), fileEntities.size(), sizeof(SceneFileEntity));
+		appendTable(SceneFileTable_Positions, positions.data(), positions.size(), sizeof(glm::vec3));
+		appendTable(SceneFileTable_Rotations, rotations.data(), rotations.size(), sizeof(glm::vec3));
+		appendTable(SceneFileTable_Scales, scales.data(), scales.size(), sizeof(glm::vec3));
+		appendTable(SceneFileTable_Assets, fileAssets.data(), fileAssets.size(), sizeof(SceneFileAsset));
+		appendTable(SceneFileTable_PointLights, filePointLights.data(), filePointLights.size(), sizeof(SceneFilePointLight));
+		appendTable(SceneFileTable_DirectionalLights, fileDirectionalLights.data(), fileDirectionalLights.size(), sizeof(SceneFileDirectionalLight));
+		appendTable(SceneFileTable_Strings, stringTable.data(), stringTable.size(), 1);
+
+		fileHeader.m_Magic = g_SceneFileMagic;
+		fileHeader.m_Version = g_SceneFileVersion;
+		fileHeader.m_FileSize = fileBuffer.size();
+		std::memcpy(fileBuffer.data(), &fileHeader, sizeof(SceneFileHeader));
+
+		std::ofstream fileStream(filePath, std::ios::binary | std::ios::trunc);
+		if (!fileStream.write(reinterpret_cast<const char*>(fileBuffer.data()), fileBuffer.size()))
+		{
+			CrescentInfo("Failed to write scene file: " + filePath + ".");
+			return false;
+		}
+
+		if (skippedMeshRendererCount > 0)
+		{
+			CrescentInfo(std::to_string(skippedMeshRendererCount) + " mesh renderers outside of prefabs were not saved to: " + filePath + ".");
+		}
+		CrescentInfo("Saved " + std::to_string(fileEntities.size()) + " entities to: " + filePath + ".");
+		return true;
+	}
+
+	bool SceneSerializer::LoadScene(Scene* scene, Renderer* rendererContext, const std::string& filePath, std::vector<SceneEntity*>* rootEntities)
+	{
+		SceneFileContents fileContents;
+		std::string failureMessage;
+		if (!OpenSceneFile(filePath, fileContents, &failureMessage))
+		{
+			CrescentInfo(failureMessage);
+			return false;
+		}
+
+		InstantiateScene(scene, rendererContext, fileContents, rootEntities);
+		CrescentInfo("Loaded " + std::to_string(fileContents.m_EntityCount) + " entities from: " + filePath + ".");
+		return true;
+	}
+
+	bool SceneSerializer::OpenSceneFile(const std::string& filePath, SceneFileContents& fileContents, std::string* failureMessage)
+	{
+		//We may be on a worker thread, so failures are handed back rather than logged.
+		auto fail = [&](const std::string& message)
+		{
+			if (failureMessage)
+			{
+				*failureMessage = message + filePath + ".";
+			}
+			fileContents.m_File.CloseFile();
+			return false;
+		};
+
+		MappedFile& sceneFile = fileContents.m_File;
+		if (!sceneFile.OpenFile(filePath) || sceneFile.RetrieveSize() < sizeof(SceneFileHeader))
+		{
+			return fail("Failed to open scene file: ");
+		}
+
+		const uint8_t* fileData = sceneFile.RetrieveData();
+		const SceneFileHeader* fileHeader = reinterpret_cast<const SceneFileHeader*>(fileData);
+		if (fileHeader->m_Magic != g_SceneFileMagic || fileHeader->m_Version != g_SceneFileVersion || fileHeader->m_FileSize != sceneFile.RetrieveSize())
+		{
+			return fail("Scene file is not of version " + std::to_string(g_SceneFileVersion) + " or is truncated: ");
+		}
+
+		//Fix-ups - Each table's offset becomes a typed pointer into the mapping, once we know the table lies within the file.
+		bool tablesValid = true;
+		auto retrieveTable = [&](SceneFileTable table, size_t elementSize) -> const void*
+		{
+			const SceneFileTableEntry& tableEntry = fileHeader->m_Tables[table];
+			const uint64_t tableEnd = (uint64_t)tableEntry.m_Offset + (uint64_t)tableEntry.m_Count * elementSize;
+			if (tableEntry.m_Offset % g_SceneFileTableAlignment != 0 || tableEntry.m_Offset < sizeof(SceneFileHeader) || tableEnd > sceneFile.RetrieveSize())
+			{
+				tablesValid = false;
+				return nullptr;
+			}
+			return fileData + tableEntry.m_Offset;
+		};
+
+		fileContents.m_Entities = static_cast<const SceneFileEntity*>(retrieveTable(SceneFileTable_Entities, sizeof(SceneFileEntity)));
+		fileContents.m_Positions = static_cast<const glm::vec3*>(retrieveTable(SceneFileTable_Positions, sizeof(glm::vec3)));
+		fileContents.m_Rotations = static_cast<const glm::vec3*>(retrieveTable(SceneFileTable_Rotations, sizeof(glm::vec3)));
+		fileContents.m_Scales = static_cast<const glm::vec3*>(retrieveTable(SceneFileTable_Scales, sizeof(glm::vec3)));
+		fileContents.m_Assets = static_cast<const SceneFileAsset*>(retrieveTable(SceneFileTable_Assets, sizeof(SceneFileAsset)));
+		fileContents.m_PointLights = static_cast<const SceneFilePointLight*>(retrieveTable(SceneFileTable_PointLights, sizeof(SceneFilePointLight)));
+		fileContents.m_DirectionalLights = static_cast<const SceneFileDirectionalLight*>(retrieveTable(SceneFileTable_DirectionalLights, sizeof(SceneFileDirectionalLight)));
+		fileContents.m_StringTable = static_cast<const char*>(retrieveTable(SceneFileTable_Strings, 1));
+
+		const uint32_t entityCount = fileContents.m_EntityCount = fileHeader->m_Tables[SceneFileTable_Entities].m_Count;
+		const uint32_t assetCount = fileContents.m_AssetCount = fileHeader->m_Tables[SceneFileTable_Assets].m_Count;
+		const uint32_t pointLightCount = fileContents.m_PointLightCount = fileHeader->m_Tables[SceneFileTable_PointLights].m_Count;
+		const uint32_t directionalLightCount = fileContents.m_DirectionalLightCount = fileHeader->m_Tables[SceneFileTable_DirectionalLights].m_Count;
+		const uint32_t stringTableSize = fileHeader->m_Tables[SceneFileTable_Strings].m_Count;
+
+		tablesValid = tablesValid && fileHeader->m_Tables[SceneFileTable_Positions].m_Count == entityCount && fileHeader->m_Tables[SceneFileTable_Rotations].m_Count == entityCount &&
+			fileHeader->m_Tables[SceneFileTable_Scales].m_Count == entityCount && (stringTableSize == 0 || fileContents.m_StringTable[stringTableSize - 1] == '\0');
+
+		//Every index is checked before anything is constructed, so a malformed file can't leave a half loaded scene behind.
+		auto isValidString = [&](uint32_t stringOffset) { return stringOffset < stringTableSize; };
+		auto isValidIndex = [](uint32_t index, uint32_t count) { return index == g_SceneFileNullIndex || index < count; };
+		for (uint32_t i = 0; i < assetCount && tablesValid; i++)
+		{
+			tablesValid = isValidString(fileContents.m_Assets[i].m_NameOffset) && isValidString(fileContents.m_Assets[i].m_PathOffset);
+		}
+		for (uint32_t i = 0; i < entityCount && tablesValid; i++)
+		{
+			const SceneFileEntity& fileEntity = fileContents.m_Entities[i];
+			tablesValid = isValidString(fileEntity.m_NameOffset) && (fileEntity.m_ParentIndex == g_SceneFileNullIndex || fileEntity.m_ParentIndex < i) &&
+				isValidIndex(fileEntity.m_AssetIndex, assetCount) && isValidIndex(fileEntity.m_PointLightIndex, pointLightCount) && isValidIndex(fileEntity.m_DirectionalLightIndex, directionalLightCount);
+		}
+
+		if (!tablesValid)
+		{
+			return fail("Scene file is malformed: ");
+		}
+		return true;
+	}
+
+	void SceneSerializer::InstantiateScene(Scene* scene, Renderer* rendererContext, const SceneFileContents& fileContents, std::vector<SceneEntity*>* rootEntities)
+	{
+		const SceneFileEntity* fileEntities = fileContents.m_Entities;
+		const SceneFileAsset* fileAssets = fileContents.m_Assets;
+		const SceneFilePointLight* filePointLights = fileContents.m_PointLights;
+		const SceneFileDirectionalLight* fileDirectionalLights = fileContents.m_DirectionalLights;
+		const char* stringTable = fileContents.m_StringTable;
+
+		//Assets - Matched against our resident prefabs by content, and only loaded from their recorded path otherwise.
+		std::vector<const Prefab*> prefabs(fileContents.m_AssetCount, nullptr);
+		for (uint32_t i = 0; i < fileContents.m_AssetCount; i++)
+		{
+			prefabs[i] = Resources::RetrievePrefabByContentHash(fileAssets[i].m_ContentHash);
+			if (!prefabs[i])
+			{
+				prefabs[i] = Resources::LoadPrefab(rendererContext, stringTable + fileAssets[i].m_NameOffset, stringTable + fileAssets[i].m_PathOffset, fileAssets[i].m_PooledGeometry != 0);
+				if (prefabs[i] && prefabs[i]->RetrieveContentHash() != fileAssets[i].m_ContentHash)
+				{
+					CrescentInfo("Model file has changed since the scene was saved: " + prefabs[i]->RetrieveSourcePath() + ".");
+				}
+			}
+		}
+
+		//Lights - Owned by the scene from here on.
+		std::vector<PointLight*> pointLights(fileContents.m_PointLightCount);
+		for (uint32_t i = 0; i < fileContents.m_PointLightCount; i++)
+		{
+			PointLight& pointLight = scene->m_OwnedPointLights.emplace_back();
+			pointLight.m_LightColor = filePointLights[i].m_LightColor;
+			pointLight.m_LightIntensity = filePointLights[i].m_LightIntensity;
+			pointLight.m_LightRadius = filePointLights[i].m_LightRadius;
+			pointLight.m_IsLightVisible = filePointLights[i].m_LightVisible != 0;
+			pointLight.m_RenderMesh = filePointLights[i].m_RenderMesh != 0;
+			pointLights[i] = &pointLight;
+		}
+
+		std::vector<DirectionalLight*> directionalLights(fileContents.m_DirectionalLightCount);
+		for (uint32_t i = 0; i < fileContents.m_DirectionalLightCount; i++)
+		{
+			DirectionalLight& directionalLight = scene->m_OwnedDirectionalLights.emplace_back();
+			directionalLight.m_LightDirection = fileDirectionalLights[i].m_LightDirection;
+			directionalLight.m_LightColor = fileDirectionalLights[i].m_LightColor;
+			directionalLight.m_LightIntensity = fileDirectionalLights[i].m_LightIntensity;
+			directionalLight.m_ShadowCastingEnabled = fileDirectionalLights[i].m_ShadowCastingEnabled != 0;
+			directionalLights[i] = &directionalLight;
+		}
+
+		//Entities - Parents precede their children, so every parent already exists and the transform arrays stay sorted as we append to them.
+		std::vector<SceneEntity*> sceneEntities(fileContents.m_EntityCount);
+		for (uint32_t i = 0; i < fileContents.m_EntityCount; i++)
+		{
+			const SceneFileEntity& fileEntity = fileEntities[i];
+			SceneEntity* sceneEntity = EntityPool::ConstructEntity(stringTable + fileEntity.m_NameOffset);
+			sceneEntities[i] = sceneEntity;
+
+			const uint32_t transformIndex = sceneEntity->RetrieveTransformIndex();
+			TransformSystem::RetrieveLocalPosition(transformIndex) = fileContents.m_Positions[i];
+			TransformSystem::RetrieveLocalRotation(transformIndex) = fileContents.m_Rotations[i];
+			TransformSystem::RetrieveLocalScale(transformIndex) = fileContents.m_Scales[i];
+			TransformSystem::MarkTransformDirty(transformIndex);
+
+			if (fileEntity.m_ParentIndex == g_SceneFileNullIndex)
+			{
+				scene->m_SceneEntities.push_back(sceneEntity);
+				if (rootEntities)
+				{
+					rootEntities->push_back(sceneEntity);
+				}
+			}
+			else
+			{
+				sceneEntities[fileEntity.m_ParentIndex]->AddChildEntity(sceneEntity);
+			}
+
+			if (fileEntity.m_AssetIndex != g_SceneFileNullIndex && prefabs[fileEntity.m_AssetIndex])
+			{
+				ComponentStorage::AttachPrefabInstance(sceneEntity, prefabs[fileEntity.m_AssetIndex]);
+			}
+
+			if (fileEntity.m_PointLightIndex != g_SceneFileNullIndex || fileEntity.m_DirectionalLightIndex != g_SceneFileNullIndex)
+			{
+				LightComponent lightComponent;
+				lightComponent.m_PointLight = fileEntity.m_PointLightIndex != g_SceneFileNullIndex ? pointLights[fileEntity.m_PointLightIndex] : nullptr;
+				lightComponent.m_DirectionalLight = fileEntity.m_DirectionalLightIndex != g_SceneFileNullIndex ? directionalLights[fileEntity.m_DirectionalLightIndex] : nullptr;
+				ComponentStorage::RetrieveLights().AddComponent(sceneEntity->RetrieveEntityHandle(), lightComponent);
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+#include "SceneFile.h"
+#include "../Memory/MappedFile.h"
+#include <string>
+#include <vector>
+
+namespace Crescent
+{
+	class Scene;
+	class SceneEntity;
+	class Renderer;
+
+	//A mapped and validated scene file, its tables resolved into the mapping. Opening one touches nothing but the file, so it is safe on any thread.
+	struct SceneFileContents
+	{
+		MappedFile m_File;
+		const SceneFileEntity* m_Entities = nullptr;
+		const glm::vec3* m_Positions = nullptr;
+		const glm::vec3* m_Rotations = nullptr;
+		const glm::vec3* m_Scales = nullptr;
+		const SceneFileAsset* m_Assets = nullptr;
+		const SceneFilePointLight* m_PointLights = nullptr;
+		const SceneFileDirectionalLight* m_DirectionalLights = nullptr;
+		const char* m_StringTable = nullptr;
+
+		uint32_t m_EntityCount = 0;
+		uint32_t m_AssetCount = 0;
+		uint32_t m_PointLightCount = 0;
+		uint32_t m_DirectionalLightCount = 0;
+	};
+
+	/*
+		Saves and loads scenes in our binary scene format (see SceneFile.h). Saving snapshots the scene's pooled entities along with their hierarchy, local transforms,
+		prefab instances and lights. Loading maps the file and constructs entities straight from its tables, with no parsing step in between.
+	*/
+
+	class SceneSerializer
+	{
+	public:
+		//Entities holding a mesh renderer outside of a prefab are saved without it, as such meshes aren't backed by any file we could reference.
+		static bool SaveScene(Scene* scene, const std::string& filePath);
+		//As above, for the given pooled root entities and their descendants only.
+		static bool SaveEntities(const std::vector<SceneEntity*>& rootEntities, const std::string& filePath);
+		//Adds the file's entities to those already in the scene, appending the root entities it constructs to rootEntities if given. Prefabs that aren't loaded yet are
+		//loaded from their recorded paths. Returns false if the file is missing, malformed or of another version, in which case the scene is left untouched.
+		static bool LoadScene(Scene* scene, Renderer* rendererContext, const std::string& filePath, std::vector<SceneEntity*>* rootEntities = nullptr);
+
+		//The two halves of the above, so that files can be opened off the main thread. On failure, the reason is written to failureMessage if given.
+		static bool OpenSceneFile(const std::string& filePath, SceneFileContents& fileContents, std::string* failureMessage = nullptr);
+		static void InstantiateScene(Scene* scene, Renderer* rendererContext, const SceneFileContents& fileContents, std::vector<SceneEntity*>* rootEntities = nullptr);
+
+	private:
+		//Disallow creation of any SceneSerializer object. This is a static object.
+		SceneSerializer();
+	};
+}
\ No newline at end of file
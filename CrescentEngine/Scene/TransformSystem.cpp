@@ -0,0 +1,348 @@
+#include "CrescentPCH.h"
+#include "TransformSystem.h"
+#include "SceneEntity.h"
+#include <glm/gtc/quaternion.hpp>
+#include <xmmintrin.h>
+#include <algorithm>
+
+namespace Crescent
+{
+	std::vector<glm::vec3> TransformSystem::m_LocalPositions;
+	std::vector<glm::vec3> TransformSystem::m_LocalRotations;
+	std::vector<glm::vec3> TransformSystem::m_LocalScales;
+	std::vector<glm::mat4> TransformSystem::m_WorldMatrices;
+	std::vector<uint32_t> TransformSystem::m_ParentIndices;
+	std::vector<uint32_t> TransformSystem::m_FirstChildIndices;
+	std::vector<uint32_t> TransformSystem::m_NextSiblingIndices;
+	std::vector<uint8_t> TransformSystem::m_DirtyFlags;
+	std::vector<uint8_t> TransformSystem::m_ChangedFlags;
+	std::vector<SceneEntity*> TransformSystem::m_Owners;
+	std::vector<uint32_t> TransformSystem::m_FreeIndices;
+	std::vector<uint32_t> TransformSystem::m_DirtyIndices;
+	std::vector<uint32_t> TransformSystem::m_PropagationStack;
+	std::vector<SceneEntity*> TransformSystem::m_ChangedEntities;
+	bool TransformSystem::m_OrderInvalidated = false;
+
+	uint32_t TransformSystem::AllocateTransform(SceneEntity* owner)
+	{
+		//A new transform has no parent, so any free slot keeps the ordering intact.
+		uint32_t transformIndex;
+		if (!m_FreeIndices.empty())
+		{
+			transformIndex = m_FreeIndices.back();
+			m_FreeIndices.pop_back();
+		}
+		else
+		{
+			transformIndex = (uint32_t)m_ParentIndices.size();
+			m_LocalPositions.emplace_back();
+			m_LocalRotations.emplace_back();
+			m_LocalScales.emplace_back();
+			m_WorldMatrices.emplace_back();
+			m_ParentIndices.emplace_back();
+			m_FirstChildIndices.emplace_back();
+			m_NextSiblingIndices.emplace_back();
+			m_DirtyFlags.emplace_back();
+			m_ChangedFlags.emplace_back();
+			m_Owners.emplace_back();
+		}
+
+		m_LocalPositions[transformIndex] = glm::vec3(0.0f);
+		m_LocalRotations[transformIndex] = glm::vec3(0.0f);
+		m_LocalScales[transformIndex] = glm::vec3(1.0f);
+		m_WorldMatrices[transformIndex] = glm::mat4(1.0f);
+		m_ParentIndices[transformIndex] = g_InvalidTransformIndex;
+		m_FirstChildIndices[transformIndex] = g_InvalidTransformIndex;
+		m_NextSiblingIndices[transformIndex] = g_InvalidTransformIndex;
+		m_Owners[transformIndex] = owner;
+		MarkTransformDirty(transformIndex);
+
+		return transformIndex;
+	}
+
+	void TransformSystem::ReleaseTransform(uint32_t transformIndex)
+	{
+		//Our owner detaches its children before releasing us, so only our own link needs undoing. A stale entry left in the dirty list is skipped by its cleared flag.
+		UnlinkChild(transformIndex);
+		if (m_ChangedFlags[transformIndex])
+		{
+			m_ChangedEntities.erase(std::find(m_ChangedEntities.begin(), m_ChangedEntities.end(), m_Owners[transformIndex]));
+			m_ChangedFlags[transformIndex] = 0;
+		}
+
+		m_Owners[transformIndex] = nullptr;
+		m_ParentIndices[transformIndex] = g_InvalidTransformIndex;
+		m_DirtyFlags[transformIndex] = 0;
+		m_FreeIndices.push_back(transformIndex);
+	}
+
+	void TransformSystem::SetParent(uint32_t transformIndex, uint32_t parentIndex)
+	{
+		UnlinkChild(transformIndex);
+		LinkChild(transformIndex, parentIndex);
+		if (parentIndex != g_InvalidTransformIndex && parentIndex > transformIndex)
+		{
+			m_OrderInvalidated = true;
+		}
+		MarkTransformDirty(transformIndex);
+	}
+
+	//Writing an unchanged value (as the editor does every frame for the selected entity) doesn't dirty the transform.
+	void TransformSystem::SetLocalPosition(uint32_t transformIndex, const glm::vec3& position)
+	{
+		if (m_LocalPositions[transformIndex] != position)
+		{
+			m_LocalPositions[transformIndex] = position;
+			MarkTransformDirty(transformIndex);
+		}
+	}
+
+	void TransformSystem::SetLocalRotation(uint32_t transformIndex, const glm::vec3& rotation)
+	{
+		if (m_LocalRotations[transformIndex] != rotation)
+		{
+			m_LocalRotations[transformIndex] = rotation;
+			MarkTransformDirty(transformIndex);
+		}
+	}
+
+	void TransformSystem::SetLocalScale(uint32_t transformIndex, const glm::vec3& scale)
+	{
+		if (m_LocalScales[transformIndex] != scale)
+		{
+			m_LocalScales[transformIndex] = scale;
+			MarkTransformDirty(transformIndex);
+		}
+	}
+
+	void TransformSystem::MarkTransformDirty(uint32_t transformIndex)
+	{
+		if (!m_DirtyFlags[transformIndex])
+		{
+			m_DirtyFlags[transformIndex] = 1;
+			m_DirtyIndices.push_back(transformIndex);
+		}
+	}
+
+	void TransformSystem::ClearChangedEntities()
+	{
+		for (SceneEntity* changedEntity : m_ChangedEntities)
+		{
+			m_ChangedFlags[changedEntity->m_TransformIndex] = 0;
+		}
+		m_ChangedEntities.clear();
+	}
+
+	void TransformSystem::LinkChild(uint32_t transformIndex, uint32_t parentIndex)
+	{
+		m_ParentIndices[transformIndex] = parentIndex;
+		if (parentIndex != g_InvalidTransformIndex)
+		{
+			m_NextSiblingIndices[transformIndex] = m_FirstChildIndices[parentIndex];
+			m_FirstChildIndices[parentIndex] = transformIndex;
+		}
+	}
+
+	void TransformSystem::UnlinkChild(uint32_t transformIndex)
+	{
+		const uint32_t parentIndex = m_ParentIndices[transformIndex];
+		if (parentIndex != g_InvalidTransformIndex)
+		{
+			//Reparenting is rare next to updates, so a singly linked walk over the siblings is fine here.
+			uint32_t* link = &m_FirstChildIndices[parentIndex];
+			while (*link != transformIndex)
+			{
+				link = &m_NextSiblingIndices[*link];
+			}
+			*link = m_NextSiblingIndices[transformIndex];
+		}
+
+		m_ParentIndices[transformIndex] = g_InvalidTransformIndex;
+		m_NextSiblingIndices[transformIndex] = g_InvalidTransformIndex;
+	}
+
+	void TransformSystem::UpdateTransforms()
+	{
+		if (m_OrderInvalidated)
+		{
+			SortTransforms();
+		}
+
+		if (m_DirtyIndices.empty())
+		{
+			return;
+		}
+
+		//Parents always sit at lower indices than their children, so in index order every dirty ancestor is walked before its dirty descendants,
+		//and a descendant that was already resolved as part of an ancestor's subtree is recognized by its cleared flag.
+		std::sort(m_DirtyIndices.begin(), m_DirtyIndices.end());
+		for (uint32_t dirtyIndex : m_DirtyIndices)
+		{
+			if (!m_DirtyFlags[dirtyIndex])
+			{
+				continue;
+			}
+
+			//Depth first, resolving each transform before pushing its children so they always see an up-to-date parent.
+			m_PropagationStack.push_back(dirtyIndex);
+			while (!m_PropagationStack.empty())
+			{
+				const uint32_t transformIndex = m_PropagationStack.back();
+				m_PropagationStack.pop_back();
+
+				ResolveWorldMatrix(transformIndex);
+				m_DirtyFlags[transformIndex] = 0;
+				if (!m_ChangedFlags[transformIndex])
+				{
+					m_ChangedFlags[transformIndex] = 1;
+					m_ChangedEntities.push_back(m_Owners[transformIndex]);
+				}
+
+				for (uint32_t childIndex = m_FirstChildIndices[transformIndex]; childIndex != g_InvalidTransformIndex; childIndex = m_NextSiblingIndices[childIndex])
+				{
+					m_PropagationStack.push_back(childIndex);
+				}
+			}
+		}
+		m_DirtyIndices.clear();
+	}
+
+	void TransformSystem::ResolveWorldMatrix(uint32_t transformIndex)
+	{
+		//Local TRS, built straight into columns: the rotation's axes scaled, followed by the translation.
+		const glm::mat3 rotation = glm::mat3_cast(glm::quat(m_LocalRotations[transformIndex]));
+		const glm::vec3& scale = m_LocalScales[transformIndex];
+		const glm::vec3& position = m_LocalPositions[transformIndex];
+		const __m128 localColumns[4] =
+		{
+			_mm_setr_ps(rotation[0].x * scale.x, rotation[0].y * scale.x, rotation[0].z * scale.x, 0.0f),
+			_mm_setr_ps(rotation[1].x * scale.y, rotation[1].y * scale.y, rotation[1].z * scale.y, 0.0f),
+			_mm_setr_ps(rotation[2].x * scale.z, rotation[2].y * scale.z, rotation[2].z * scale.z, 0.0f),
+			_mm_setr_ps(position.x, position.y, position.z, 1.0f)
+		};
+
+		float* worldMatrix = &m_WorldMatrices[transformIndex][0][0];
+		const uint32_t parentIndex = m_ParentIndices[transformIndex];
+		if (parentIndex == g_InvalidTransformIndex)
+		{
+			for (int column = 0; column < 4; column++)
+			{
+				_mm_storeu_ps(worldMatrix + column * 4, localColumns[column]);
+			}
+			return;
+		}
+
+		//World = Parent * Local. Each world column is the parent's columns weighted by the matching local column's components.
+		const float* parentMatrix = &m_WorldMatrices[parentIndex][0][0];
+		const __m128 parentColumn0 = _mm_loadu_ps(parentMatrix);
+		const __m128 parentColumn1 = _mm_loadu_ps(parentMatrix + 4);
+		const __m128 parentColumn2 = _mm_loadu_ps(parentMatrix + 8);
+		const __m128 parentColumn3 = _mm_loadu_ps(parentMatrix + 12);
+		for (int column = 0; column < 4; column++)
+		{
+			const __m128 localColumn = localColumns[column];
+			__m128 worldColumn = _mm_mul_ps(parentColumn0, _mm_shuffle_ps(localColumn, localColumn, _MM_SHUFFLE(0, 0, 0, 0)));
+			worldColumn = _mm_add_ps(worldColumn, _mm_mul_ps(parentColumn1, _mm_shuffle_ps(localColumn, localColumn, _MM_SHUFFLE(1, 1, 1, 1))));
+			worldColumn = _mm_add_ps(worldColumn, _mm_mul_ps(parentColumn2, _mm_shuffle_ps(localColumn, localColumn, _MM_SHUFFLE(2, 2, 2, 2))));
+			worldColumn = _mm_add_ps(worldColumn, _mm_mul_ps(parentColumn3, _mm_shuffle_ps(localColumn, localColumn, _MM_SHUFFLE(3, 3, 3, 3))));
+			_mm_storeu_ps(worldMatrix + column * 4, worldColumn);
+		}
+	}
+
+	void TransformSystem::SortTransforms()
+	{
+		m_OrderInvalidated = false;
+		const uint32_t transformCount = (uint32_t)m_ParentIndices.size();
+
+		//Depth of every transform. Walks up until it meets a transform whose depth is already known.
+		std::vector<uint32_t> depths(transformCount, g_InvalidTransformIndex);
+		std::vector<uint32_t> ancestorChain;
+		uint32_t maximumDepth = 0;
+		for (uint32_t i = 0; i < transformCount; i++)
+		{
+			uint32_t current = i;
+			while (current != g_InvalidTransformIndex && depths[current] == g_InvalidTransformIndex)
+			{
+				ancestorChain.push_back(current);
+				current = m_ParentIndices[current];
+			}
+
+			uint32_t depth = current == g_InvalidTransformIndex ? 0 : depths[current] + 1;
+			while (!ancestorChain.empty())
+			{
+				depths[ancestorChain.back()] = depth++;
+				ancestorChain.pop_back();
+			}
+			maximumDepth = std::max(maximumDepth, depths[i]);
+		}
+
+		//Stable counting sort by depth. Within a depth, transforms keep their current relative order.
+		std::vector<uint32_t> depthOffsets(maximumDepth + 2, 0);
+		for (uint32_t i = 0; i < transformCount; i++)
+		{
+			depthOffsets[depths[i] + 1]++;
+		}
+		for (uint32_t depth = 1; depth < depthOffsets.size(); depth++)
+		{
+			depthOffsets[depth] += depthOffsets[depth - 1];
+		}
+
+		std::vector<uint32_t> newIndices(transformCount);
+		for (uint32_t i = 0; i < transformCount; i++)
+		{
+			newIndices[i] = depthOffsets[depths[i]]++;
+		}
+
+		//Scatter every array into its sorted order.
+		std::vector<glm::vec3> localPositions(transformCount), localRotations(transformCount), localScales(transformCount);
+		std::vector<glm::mat4> worldMatrices(transformCount);
+		std::vector<uint32_t> parentIndices(transformCount), firstChildIndices(transformCount), nextSiblingIndices(transformCount);
+		std::vector<uint8_t> dirtyFlags(transformCount), changedFlags(transformCount);
+		std::vector<SceneEntity*> owners(transformCount);
+		for (uint32_t i = 0; i < transformCount; i++)
+		{
+			const uint32_t newIndex = newIndices[i];
+			localPositions[newIndex] = m_LocalPositions[i];
+			localRotations[newIndex] = m_LocalRotations[i];
+			localScales[newIndex] = m_LocalScales[i];
+			worldMatrices[newIndex] = m_WorldMatrices[i];
+			parentIndices[newIndex] = m_ParentIndices[i] == g_InvalidTransformIndex ? g_InvalidTransformIndex : newIndices[m_ParentIndices[i]];
+			firstChildIndices[newIndex] = m_FirstChildIndices[i] == g_InvalidTransformIndex ? g_InvalidTransformIndex : newIndices[m_FirstChildIndices[i]];
+			nextSiblingIndices[newIndex] = m_NextSiblingIndices[i] == g_InvalidTransformIndex ? g_InvalidTransformIndex : newIndices[m_NextSiblingIndices[i]];
+			dirtyFlags[newIndex] = m_DirtyFlags[i];
+			changedFlags[newIndex] = m_ChangedFlags[i];
+			owners[newIndex] = m_Owners[i];
+		}
+
+		m_LocalPositions.swap(localPositions);
+		m_LocalRotations.swap(localRotations);
+		m_LocalScales.swap(localScales);
+		m_WorldMatrices.swap(worldMatrices);
+		m_ParentIndices.swap(parentIndices);
+		m_FirstChildIndices.swap(firstChildIndices);
+		m_NextSiblingIndices.swap(nextSiblingIndices);
+		m_DirtyFlags.swap(dirtyFlags);
+		m_ChangedFlags.swap(changedFlags);
+		m_Owners.swap(owners);
+
+		//Hand every entity its new index, and rebuild our free and dirty lists to match.
+		m_FreeIndices.clear();
+		m_DirtyIndices.clear();
+		for (uint32_t i = 0; i < transformCount; i++)
+		{
+			if (m_Owners[i])
+			{
+				m_Owners[i]->m_TransformIndex = i;
+			}
+			else
+			{
+				m_FreeIndices.push_back(i);
+			}
+
+			if (m_DirtyFlags[i])
+			{
+				m_DirtyIndices.push_back(i);
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+
+namespace Crescent
+{
+	class SceneEntity;
+
+	static constexpr uint32_t g_InvalidTransformIndex = ~0u;
+
+	/*
+		Owns the transforms of every scene entity in flat structure-of-arrays storage, with each entity only holding its index. Arrays are kept sorted
+		so that parents always come before their children. Modified transforms are collected in a dirty list, and UpdateTransforms only walks the subtrees
+		below them (in index order, so a dirty ancestor covers its dirty descendants in the same walk). With nothing modified, an update costs nothing.
+		Reparenting that breaks the ordering re-sorts the arrays (by depth) before the next update, patching the owning entities' indices as it goes.
+
+		Every entity whose world matrix changed is also recorded, so spatial structures can refit just those entities' bounds.
+	*/
+
+	class TransformSystem
+	{
+	public:
+		static uint32_t AllocateTransform(SceneEntity* owner);
+		static void ReleaseTransform(uint32_t transformIndex);
+		static void SetParent(uint32_t transformIndex, uint32_t parentIndex); //g_InvalidTransformIndex detaches the transform.
+
+		static void SetLocalPosition(uint32_t transformIndex, const glm::vec3& position);
+		static void SetLocalRotation(uint32_t transformIndex, const glm::vec3& rotation); //Euler angles, in radians.
+		static void SetLocalScale(uint32_t transformIndex, const glm::vec3& scale);
+		//Writing through these requires a MarkTransformDirty afterwards. Only valid until the next transform is allocated or the arrays are re-sorted.
+		static glm::vec3& RetrieveLocalPosition(uint32_t transformIndex) { return m_LocalPositions[transformIndex]; }
+		static glm::vec3& RetrieveLocalRotation(uint32_t transformIndex) { return m_LocalRotations[transformIndex]; }
+		static glm::vec3& RetrieveLocalScale(uint32_t transformIndex) { return m_LocalScales[transformIndex]; }
+		static void MarkTransformDirty(uint32_t transformIndex);
+
+		//World matrices are only current as of the last UpdateTransforms.
+		static const glm::mat4& RetrieveWorldMatrix(uint32_t transformIndex) { return m_WorldMatrices[transformIndex]; }
+		static bool HasDirtyTransforms() { return !m_DirtyIndices.empty() || m_OrderInvalidated; }
+
+		//Recomputes the world matrix of every dirty transform and its descendants. Main thread only.
+		static void UpdateTransforms();
+
+		//Entities whose world matrix changed since the last ClearChangedEntities, each listed once.
+		static const std::vector<SceneEntity*>& RetrieveChangedEntities() { return m_ChangedEntities; }
+		static void ClearChangedEntities();
+
+		static uint32_t RetrieveTransformCount() { return (uint32_t)m_ParentIndices.size(); }
+
+	private:
+		//Disallow creation of any TransformSystem object. This is a static object.
+		TransformSystem();
+
+		//Restores parent-before-child order after a reparent broke it.
+		static void SortTransforms();
+		static void LinkChild(uint32_t transformIndex, uint32_t parentIndex);
+		static void UnlinkChild(uint32_t transformIndex);
+		//Recomputes a single world matrix from its local TRS and its (already resolved) parent's world matrix.
+		static void ResolveWorldMatrix(uint32_t transformIndex);
+
+	private:
+		static std::vector<glm::vec3> m_LocalPositions;
+		static std::vector<glm::vec3> m_LocalRotations;
+		static std::vector<glm::vec3> m_LocalScales;
+		static std::vector<glm::mat4> m_WorldMatrices;
+		static std::vector<uint32_t> m_ParentIndices;
+		static std::vector<uint32_t> m_FirstChildIndices; //Children form a singly linked list through m_NextSiblingIndices.
+		static std::vector<uint32_t> m_NextSiblingIndices;
+		static std::vector<uint8_t> m_DirtyFlags;
+		static std::vector<uint8_t> m_ChangedFlags; //Set while the transform's entity is in m_ChangedEntities.
+		static std::vector<SceneEntity*> m_Owners; //nullptr for released transforms.
+
+		static std::vector<uint32_t> m_FreeIndices;
+		static std::vector<uint32_t> m_DirtyIndices; //Transforms modified since the last update. A transform's dirty flag keeps it from being listed twice.
+		static std::vector<uint32_t> m_PropagationStack; //Scratch memory for walking dirty subtrees.
+		static std::vector<SceneEntity*> m_ChangedEntities;
+		static bool m_OrderInvalidated;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,535 @@
+#include "CrescentPCH.h"
+#include "WorldPartition.h"
+#include "SceneFile.h"
+#include "SceneSerializer.h"
+#include "Scene.h"
+#include "SceneEntity.h"
+#include "EntityPool.h"
+#include "Components.h"
+#include "Prefab.h"
+#include "../Core/JobSystem.h"
+#include "../Memory/MappedFile.h"
+#include "../Memory/MeshLoader.h"
+#include "../Rendering/Resources.h"
+#include "../Utilities/StringID.h"
+#include <assimp/Importer.hpp>
+#include <unordered_set>
+#include <algorithm>
+#include <fstream>
+#include <cmath>
+#include <map>
+
+namespace Crescent
+{
+	//A model the cell's scene file references that wasn't resident when the cell was opened, imported by a job of its own.
+	struct ImportedAsset
+	{
+		uint32_t m_AssetIndex = 0;
+		std::string m_AssetName;
+		std::string m_FilePath;
+		std::unique_ptr<Assimp::Importer> m_Importer; //Owns the imported scene.
+		const aiScene* m_ImportedScene = nullptr;
+		uint64_t m_ContentHash = 0; //Of the file as it is now, which may differ from the one recorded in the scene file.
+	};
+
+	//Everything written by a cell's jobs. Only read on the main thread once the counter reaches zero.
+	struct WorldPartition::CellLoad
+	{
+		SceneFileContents m_FileContents;
+		bool m_FileOpened = false;
+		std::string m_FailureMessage;
+		std::vector<ImportedAsset> m_ImportedAssets;
+		JobCounter m_JobCounter;
+	};
+
+	//Distance from the point to the box on the XZ plane. Zero within it.
+	static float CellDistance(const glm::vec2& boundsMinimum, const glm::vec2& boundsMaximum, const glm::vec3& position)
+	{
+		const glm::vec2 planarPosition = glm::vec2(position.x, position.z);
+		return glm::length(glm::max(glm::max(boundsMinimum - planarPosition, planarPosition - boundsMaximum), glm::vec2(0.0f)));
+	}
+
+	WorldPartition::WorldPartition(Scene* scene, Renderer* rendererContext) : m_Scene(scene), m_RendererContext(rendererContext)
+	{
+	}
+
+	WorldPartition::~WorldPartition()
+	{
+		ClosePartition();
+		UnloadPendingPrefabs(true);
+	}
+
+	bool WorldPartition::BuildPartition(Scene* scene, const std::string& manifestPath, float cellSize)
+	{
+		if (cellSize <= 0.0f)
+		{
+			CrescentInfo("World partition cell size must be positive.");
+			return false;
+		}
+
+		//Ordered by cell, so the same scene always builds the same files.
+		std::map<std::pair<int32_t, int32_t>, std::vector<SceneEntity*>> cellEntities;
+		for (SceneEntity* sceneEntity : scene->RetrieveSceneEntities())
+		{
+			if (EntityPool::IsPooledEntity(sceneEntity))
+			{
+				const glm::vec3& entityPosition = sceneEntity->RetrieveEntityPosition();
+				cellEntities[{ (int32_t)std::floor(entityPosition.x / cellSize), (int32_t)std::floor(entityPosition.z / cellSize) }].push_back(sceneEntity);
+			}
+		}
+
+		const size_t directoryEnd = manifestPath.find_last_of("/\\");
+		const std::string manifestDirectory = directoryEnd == std::string::npos ? "" : manifestPath.substr(0, directoryEnd + 1);
+		const size_t extensionStart = manifestPath.find_last_of('.');
+		const std::string manifestName = manifestPath.substr(manifestDirectory.size(), extensionStart == std::string::npos || extensionStart < manifestDirectory.size() ? std::string::npos : extensionStart - manifestDirectory.size());
+
+		ComponentPool<PrefabInstanceComponent>& prefabInstancePool = ComponentStorage::RetrievePrefabInstances();
+		std::vector<WorldFileCell> fileCells;
+		std::vector<char> stringTable;
+		for (const auto& cellEntry : cellEntities)
+		{
+			const std::string cellFileName = manifestName + "_" + std::to_string(cellEntry.first.first) + "_" + std::to_string(cellEntry.first.second) + ".cscene";
+			if (!SceneSerializer::SaveEntities(cellEntry.second, manifestDirectory + cellFileName))
+			{
+				return false;
+			}
+
+			WorldFileCell fileCell = {};
+			fileCell.m_CellX = cellEntry.first.first;
+			fileCell.m_CellZ = cellEntry.first.second;
+			fileCell.m_PathOffset = (uint32_t)stringTable.size();
+			stringTable.insert(stringTable.end(), cellFileName.begin(), cellFileName.end());
+			stringTable.push_back('\0');
+
+			//Every model the cell instances counts once, however many instances of it there are.
+			std::unordered_set<const Prefab*> cellPrefabs;
+			std::vector<SceneEntity*> entityStack = cellEntry.second;
+			while (!entityStack.empty())
+			{
+				SceneEntity* sceneEntity = entityStack.back();
+				entityStack.pop_back();
+				fileCell.m_EntityCount++;
+
+				if (const PrefabInstanceComponent* prefabInstance = prefabInstancePool.RetrieveComponent(sceneEntity->RetrieveEntityHandle()))
+				{
+					if (cellPrefabs.insert(prefabInstance->m_Prefab).second)
+					{
+						fileCell.m_MemoryEstimate += prefabInstance->m_Prefab->RetrieveMemoryFootprint();
+					}
+				}
+				entityStack.insert(entityStack.end(), sceneEntity->m_ChildEntities.begin(), sceneEntity->m_ChildEntities.end());
+			}
+			fileCells.push_back(fileCell);
+		}
+
+		WorldFileHeader fileHeader = {};
+		fileHeader.m_Magic = g_WorldFileMagic;
+		fileHeader.m_Version = g_WorldFileVersion;
+		fileHeader.m_CellSize = cellSize;
+		fileHeader.m_CellCount = (uint32_t)fileCells.size();
+		fileHeader.m_CellTableOffset = sizeof(WorldFileHeader);
+		fileHeader.m_StringTableOffset = fileHeader.m_CellTableOffset + (uint32_t)(fileCells.size() * sizeof(WorldFileCell));
+		fileHeader.m_StringTableSize = (uint32_t)stringTable.size();
+		fileHeader.m_FileSize = fileHeader.m_StringTableOffset + fileHeader.m_StringTableSize;
+
+		std::ofstream fileStream(manifestPath, std::ios::binary | std::ios::trunc);
+		fileStream.write(reinterpret_cast<const char*>(&fileHeader), sizeof(WorldFileHeader));
+		fileStream.write(reinterpret_cast<const char*>(fileCells.data()), fileCells.size() * sizeof(WorldFileCell));
+		fileStream.write(stringTable.data(), stringTable.size());
+		if (!fileStream)
+		{
+			CrescentInfo("Failed to write world manifest: " + manifestPath + ".");
+			return false;
+		}
+
+		CrescentInfo("Partitioned the scene into " + std::to_string(fileCells.size()) + " cells at: " + manifestPath + ".");
+		return true;
+	}
+
+	bool WorldPartition::OpenPartition(const std::string& manifestPath)
+	{
+		ClosePartition();
+
+		MappedFile manifestFile;
+		if (!manifestFile.OpenFile(manifestPath) || manifestFile.RetrieveSize() < sizeof(WorldFileHeader))
+		{
+			CrescentInfo("Failed to open world manifest: " + manifestPath + ".");
+			return false;
+		}
+
+		const uint8_t* fileData = manifestFile.RetrieveData();
+		const WorldFileHeader* fileHeader = reinterpret_cast<const WorldFileHeader*>(fileData);
+		const uint64_t cellTableEnd = (uint64_t)fileHeader->m_CellTableOffset + (uint64_t)fileHeader->m_CellCount * sizeof(WorldFileCell);
+		const uint64_t stringTableEnd = (uint64_t)fileHeader->m_StringTableOffset + fileHeader->m_StringTableSize;
+		const char* stringTable = reinterpret_cast<const char*>(fileData + fileHeader->m_StringTableOffset);
+
+		bool manifestValid = fileHeader->m_Magic == g_WorldFileMagic && fileHeader->m_Version == g_WorldFileVersion && fileHeader->m_FileSize == manifestFile.RetrieveSize() &&
+			fileHeader->m_CellSize > 0.0f && fileHeader->m_CellTableOffset >= sizeof(WorldFileHeader) && fileHeader->m_CellTableOffset % alignof(WorldFileCell) == 0 &&
+			cellTableEnd <= manifestFile.RetrieveSize() && stringTableEnd <= manifestFile.RetrieveSize() && (fileHeader->m_StringTableSize == 0 ? fileHeader->m_CellCount == 0 : stringTable[fileHeader->m_StringTableSize - 1] == '\0');
+
+		const WorldFileCell* fileCells = reinterpret_cast<const WorldFileCell*>(fileData + fileHeader->m_CellTableOffset);
+		for (uint32_t i = 0; i < fileHeader->m_CellCount && manifestValid; i++)
+		{
+			manifestValid = fileCells[i].m_PathOffset < fileHeader->m_StringTableSize;
+		}
+
+		if (!manifestValid)
+		{
+			CrescentInfo("World manifest is malformed or not of version " + std::to_string(g_WorldFileVersion) + ": " + manifestPath + ".");
+			return false;
+		}
+
+		//The manifest is small enough to copy out, so it needn't stay mapped.
+		const size_t directoryEnd = manifestPath.find_last_of("/\\");
+		const std::string manifestDirectory = directoryEnd == std::string::npos ? "" : manifestPath.substr(0, directoryEnd + 1);
+		const float cellSize = fileHeader->m_CellSize;
+
+		m_Cells.resize(fileHeader->m_CellCount);
+		for (uint32_t i = 0; i < fileHeader->m_CellCount; i++)
+		{
+			WorldCell& worldCell = m_Cells[i];
+			worldCell.m_FilePath = manifestDirectory + (stringTable + fileCells[i].m_PathOffset);
+			worldCell.m_BoundsMinimum = glm::vec2((float)fileCells[i].m_CellX, (float)fileCells[i].m_CellZ) * cellSize;
+			worldCell.m_BoundsMaximum = worldCell.m_BoundsMinimum + glm::vec2(cellSize);
+			worldCell.m_MemoryEstimate = (size_t)fileCells[i].m_MemoryEstimate;
+		}
+
+		CrescentInfo("Opened world manifest with " + std::to_string(m_Cells.size()) + " cells: " + manifestPath + ".");
+		return true;
+	}
+
+	void WorldPartition::ClosePartition()
+	{
+		for (WorldCell& worldCell : m_Cells)
+		{
+			if (worldCell.m_Load)
+			{
+				JobSystem::Wait(&worldCell.m_Load->m_JobCounter);
+				worldCell.m_Load.reset(); //Drops any imports we haven't used.
+			}
+
+			if (worldCell.m_State == CellState_Resident)
+			{
+				EvictCell(worldCell);
+			}
+			else
+			{
+				for (const Prefab* prefab : worldCell.m_Prefabs)
+				{
+					ReleasePrefab(prefab);
+				}
+			}
+		}
+
+		m_Cells.clear();
+		m_ResidentCellCount = 0;
+		m_LoadingCellCount = 0;
+		m_LoadingMemory = 0;
+	}
+
+	void WorldPartition::SetStreamingRadii(float loadRadius, float unloadRadius)
+	{
+		m_LoadRadius = std::max(loadRadius, 0.0f);
+		m_UnloadRadius = std::max(unloadRadius, m_LoadRadius);
+	}
+
+	void WorldPartition::UpdateStreaming(const glm::vec3& cameraPosition)
+	{
+		m_FrameIndex++;
+		m_CameraPosition = cameraPosition;
+		UnloadPendingPrefabs(false);
+
+		//In-flight loads - Opened files move on to importing right away, but only one cell is placed into the scene per frame.
+		bool cellFinished = false;
+		for (WorldCell& worldCell : m_Cells)
+		{
+			if (!worldCell.m_Load || !worldCell.m_Load->m_JobCounter.IsComplete())
+			{
+				continue;
+			}
+
+			if (worldCell.m_State == CellState_Opening)
+			{
+				if (worldCell.m_Load->m_FileOpened)
+				{
+					BeginImport(worldCell);
+				}
+				else
+				{
+					FailLoad(worldCell, worldCell.m_Load->m_FailureMessage);
+				}
+			}
+			else if (worldCell.m_State == CellState_Importing && !cellFinished)
+			{
+				FinishLoad(worldCell);
+				cellFinished = true;
+			}
+		}
+
+		//Wanted cells, nearest first.
+		std::vector<std::pair<float, uint32_t>> loadCandidates;
+		for (uint32_t i = 0; i < m_Cells.size(); i++)
+		{
+			WorldCell& worldCell = m_Cells[i];
+			const float cellDistance = CellDistance(worldCell.m_BoundsMinimum, worldCell.m_BoundsMaximum, m_CameraPosition);
+			if (cellDistance <= m_LoadRadius)
+			{
+				worldCell.m_LastWantedFrame = m_FrameIndex;
+				if (worldCell.m_State == CellState_Unloaded && !worldCell.m_LoadFailed)
+				{
+					loadCandidates.push_back({ cellDistance, i });
+				}
+			}
+		}
+		std::sort(loadCandidates.begin(), loadCandidates.end());
+
+		//Keeps us within budget should it have been lowered.
+		ReserveMemory(0);
+
+		for (const std::pair<float, uint32_t>& loadCandidate : loadCandidates)
+		{
+			if (m_LoadingCellCount >= g_MaximumConcurrentCellLoads)
+			{
+				break;
+			}
+
+			WorldCell& worldCell = m_Cells[loadCandidate.second];
+			if (worldCell.m_MemoryEstimate > m_MemoryBudget)
+			{
+				worldCell.m_LoadFailed = true;
+				CrescentInfo("World cell exceeds the streaming memory budget on its own: " + worldCell.m_FilePath + ".");
+				continue;
+			}
+			if (!ReserveMemory(worldCell.m_MemoryEstimate))
+			{
+				break;
+			}
+
+			worldCell.m_State = CellState_Opening;
+			worldCell.m_Load = std::make_unique<CellLoad>();
+			m_LoadingCellCount++;
+			m_LoadingMemory += worldCell.m_MemoryEstimate;
+
+			CellLoad* cellLoad = worldCell.m_Load.get();
+			const std::string filePath = worldCell.m_FilePath;
+			JobSystem::RunInBackground([cellLoad, filePath]()
+			{
+				cellLoad->m_FileOpened = SceneSerializer::OpenSceneFile(filePath, cellLoad->m_FileContents, &cellLoad->m_FailureMessage);
+			}, &cellLoad->m_JobCounter);
+		}
+	}
+
+	void WorldPartition::BeginImport(WorldCell& worldCell)
+	{
+		CellLoad* cellLoad = worldCell.m_Load.get();
+		const SceneFileContents& fileContents = cellLoad->m_FileContents;
+
+		//Resident models are claimed now, so that they can't be unloaded from under us while we import the rest.
+		cellLoad->m_ImportedAssets.reserve(fileContents.m_AssetCount);
+		for (uint32_t i = 0; i < fileContents.m_AssetCount; i++)
+		{
+			const SceneFileAsset& fileAsset = fileContents.m_Assets[i];
+			if (const Prefab* prefab = Resources::RetrievePrefabByContentHash(fileAsset.m_ContentHash))
+			{
+				AcquirePrefab(worldCell, prefab);
+				continue;
+			}
+
+			ImportedAsset& importedAsset = cellLoad->m_ImportedAssets.emplace_back();
+			importedAsset.m_AssetIndex = i;
+			importedAsset.m_AssetName = fileContents.m_StringTable + fileAsset.m_NameOffset;
+			importedAsset.m_FilePath = fileContents.m_StringTable + fileAsset.m_PathOffset;
+			importedAsset.m_Importer = std::make_unique<Assimp::Importer>();
+		}
+
+		//Our reserve keeps these addresses stable while the jobs run.
+		for (ImportedAsset& importedAsset : cellLoad->m_ImportedAssets)
+		{
+			ImportedAsset* asset = &importedAsset;
+			JobSystem::RunInBackground([asset]()
+			{
+				MappedFile sourceFile;
+				if (sourceFile.OpenFile(asset->m_FilePath))
+				{
+					asset->m_ContentHash = Hash_FNV1a64(sourceFile.RetrieveData(), sourceFile.RetrieveSize());
+					sourceFile.CloseFile();
+					asset->m_ImportedScene = MeshLoader::ImportMesh(*asset->m_Importer, asset->m_FilePath);
+				}
+			}, &cellLoad->m_JobCounter);
+		}
+
+		worldCell.m_State = CellState_Importing;
+	}
+
+	void WorldPartition::FinishLoad(WorldCell& worldCell)
+	{
+		CellLoad* cellLoad = worldCell.m_Load.get();
+		const SceneFileContents& fileContents = cellLoad->m_FileContents;
+
+		//Imported models become prefabs of ours, unless another cell finished the same model first. Streamed geometry is never pooled, as pool allocations aren't freed.
+		for (ImportedAsset& importedAsset : cellLoad->m_ImportedAssets)
+		{
+			if (!importedAsset.m_ImportedScene)
+			{
+				CrescentInfo("Failed to import model for world cell: " + importedAsset.m_FilePath + ".");
+				continue;
+			}
+			if (Resources::RetrievePrefabByContentHash(importedAsset.m_ContentHash) || Resources::RetrievePrefab(importedAsset.m_AssetName))
+			{
+				continue;
+			}
+
+			if (const Prefab* prefab = Resources::LoadPrefab(m_RendererContext, importedAsset.m_AssetName, importedAsset.m_FilePath, importedAsset.m_ContentHash, importedAsset.m_ImportedScene, false))
+			{
+				m_PrefabReferences.insert({ prefab, 0 });
+			}
+		}
+		cellLoad->m_ImportedAssets.clear(); //Frees the imported scenes.
+
+		for (uint32_t i = 0; i < fileContents.m_AssetCount; i++)
+		{
+			const SceneFileAsset& fileAsset = fileContents.m_Assets[i];
+			const Prefab* prefab = Resources::RetrievePrefabByContentHash(fileAsset.m_ContentHash);
+			if (const Prefab* loadedPrefab = prefab ? prefab : Resources::RetrievePrefab(fileContents.m_StringTable + fileAsset.m_NameOffset))
+			{
+				AcquirePrefab(worldCell, loadedPrefab);
+			}
+		}
+
+		std::vector<SceneEntity*> rootEntities;
+		SceneSerializer::InstantiateScene(m_Scene, m_RendererContext, fileContents, &rootEntities);
+		for (SceneEntity* rootEntity : rootEntities)
+		{
+			worldCell.m_RootEntities.push_back(rootEntity->RetrieveEntityHandle());
+		}
+
+		CrescentInfo("Streamed in " + std::to_string(fileContents.m_EntityCount) + " entities from world cell: " + worldCell.m_FilePath + ".");
+
+		m_LoadingCellCount--;
+		m_LoadingMemory -= worldCell.m_MemoryEstimate;
+		m_ResidentCellCount++;
+		worldCell.m_State = CellState_Resident;
+		worldCell.m_Load.reset(); //Unmaps the scene file.
+	}
+
+	void WorldPartition::FailLoad(WorldCell& worldCell, const std::string& failureMessage)
+	{
+		CrescentInfo(failureMessage);
+
+		for (const Prefab* prefab : worldCell.m_Prefabs)
+		{
+			ReleasePrefab(prefab);
+		}
+		worldCell.m_Prefabs.clear();
+
+		m_LoadingCellCount--;
+		m_LoadingMemory -= worldCell.m_MemoryEstimate;
+		worldCell.m_State = CellState_Unloaded;
+		worldCell.m_LoadFailed = true;
+		worldCell.m_Load.reset();
+	}
+
+	void WorldPartition::EvictCell(WorldCell& worldCell)
+	{
+		//Entities deleted from the scene in the meantime are simply skipped. The lights a cell loaded stay with the scene until it is cleared.
+		for (EntityHandle entityHandle : worldCell.m_RootEntities)
+		{
+			if (SceneEntity* rootEntity = EntityPool::RetrieveEntity(entityHandle))
+			{
+				m_Scene->DeleteSceneEntity(rootEntity);
+			}
+		}
+		worldCell.m_RootEntities.clear();
+
+		for (const Prefab* prefab : worldCell.m_Prefabs)
+		{
+			ReleasePrefab(prefab);
+		}
+		worldCell.m_Prefabs.clear();
+
+		m_ResidentCellCount--;
+		worldCell.m_State = CellState_Unloaded;
+	}
+
+	bool WorldPartition::ReserveMemory(size_t requiredMemory)
+	{
+		while (m_ResidentMemory + m_LoadingMemory + requiredMemory > m_MemoryBudget)
+		{
+			WorldCell* evictedCell = nullptr;
+			for (WorldCell& worldCell : m_Cells)
+			{
+				if (worldCell.m_State == CellState_Resident && CellDistance(worldCell.m_BoundsMinimum, worldCell.m_BoundsMaximum, m_CameraPosition) > m_UnloadRadius &&
+					(!evictedCell || worldCell.m_LastWantedFrame < evictedCell->m_LastWantedFrame))
+				{
+					evictedCell = &worldCell;
+				}
+			}
+
+			if (!evictedCell)
+			{
+				return false;
+			}
+			EvictCell(*evictedCell);
+		}
+		return true;
+	}
+
+	void WorldPartition::AcquirePrefab(WorldCell& worldCell, const Prefab* prefab)
+	{
+		auto referenceIterator = m_PrefabReferences.find(prefab);
+		if (referenceIterator == m_PrefabReferences.end() || std::find(worldCell.m_Prefabs.begin(), worldCell.m_Prefabs.end(), prefab) != worldCell.m_Prefabs.end())
+		{
+			return;
+		}
+
+		if (referenceIterator->second++ == 0)
+		{
+			m_PendingPrefabUnloads.erase(std::remove_if(m_PendingPrefabUnloads.begin(), m_PendingPrefabUnloads.end(),
+				[prefab](const std::pair<const Prefab*, uint32_t>& pendingUnload) { return pendingUnload.first == prefab; }), m_PendingPrefabUnloads.end());
+			m_ResidentMemory += prefab->RetrieveMemoryFootprint();
+		}
+		worldCell.m_Prefabs.push_back(prefab);
+	}
+
+	void WorldPartition::ReleasePrefab(const Prefab* prefab)
+	{
+		auto referenceIterator = m_PrefabReferences.find(prefab);
+		if (referenceIterator != m_PrefabReferences.end() && --referenceIterator->second == 0)
+		{
+			m_ResidentMemory -= prefab->RetrieveMemoryFootprint();
+			m_PendingPrefabUnloads.push_back({ prefab, m_FrameIndex });
+		}
+	}
+
+	void WorldPartition::UnloadPendingPrefabs(bool immediately)
+	{
+		if (m_PendingPrefabUnloads.empty())
+		{
+			return;
+		}
+
+		//Models may have been instanced outside of our cells since, such as through the editor. Those are left to their new owners.
+		std::unordered_set<const Prefab*> instancedPrefabs;
+		for (const PrefabInstanceComponent& prefabInstance : ComponentStorage::RetrievePrefabInstances().RetrieveComponents())
+		{
+			instancedPrefabs.insert(prefabInstance.m_Prefab);
+		}
+
+		//Released during a frame's UpdateStreaming, a model's proxies are gone once that frame has rendered. Released after it, they only go the frame after.
+		auto unloadIterator = std::remove_if(m_PendingPrefabUnloads.begin(), m_PendingPrefabUnloads.end(), [&](const std::pair<const Prefab*, uint32_t>& pendingUnload)
+		{
+			if (!immediately && m_FrameIndex < pendingUnload.second + 2)
+			{
+				return false;
+			}
+
+			m_PrefabReferences.erase(pendingUnload.first);
+			if (instancedPrefabs.count(pendingUnload.first) == 0)
+			{
+				Resources::UnloadPrefab(m_RendererContext, pendingUnload.first);
+			}
+			return true;
+		});
+		m_PendingPrefabUnloads.erase(unloadIterator, m_PendingPrefabUnloads.end());
+	}
+}
\ No newline at end of file
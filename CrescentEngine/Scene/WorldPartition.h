@@ -0,0 +1,120 @@
+#pragma once
+#include "EntityHandle.h"
+#include <glm/glm.hpp>
+#include <unordered_map>
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace Crescent
+{
+	class Scene;
+	class Renderer;
+	class Prefab;
+
+	/*
+		Streams a world that was split into square cells on the XZ plane (see WorldFileHeader) in and out of a scene around the camera. Every cell is a scene file
+		of its own, listing the models it instances. Cells within the load radius are opened and have their missing models imported on worker threads, and are
+		then placed into the scene on the main thread, at most one per frame, so a load costs a bounded hitch rather than a stall.
+
+		Resident cells are only evicted once they lie beyond the unload radius, leaving a band between the two radii where cells keep whatever state they are in,
+		so that moving back and forth across a cell border doesn't thrash. Eviction is driven by our memory budget: whenever the models of resident and loading
+		cells would exceed it, the cells outside the band that were least recently within the load radius are evicted first. Models are reference counted
+		across cells and unloaded (see Resources::UnloadPrefab) once no resident cell instances them. Models we didn't load ourselves are never unloaded.
+	*/
+
+	class WorldPartition
+	{
+	public:
+		static constexpr uint32_t g_MaximumConcurrentCellLoads = 2;
+
+		WorldPartition(Scene* scene, Renderer* rendererContext);
+		~WorldPartition(); //Unloads everything we loaded, so must run before the renderer is destroyed.
+
+		WorldPartition(const WorldPartition&) = delete;
+		WorldPartition& operator=(const WorldPartition&) = delete;
+
+		//Bins the scene's pooled root entities into cells by their position, and saves every occupied cell next to the manifest as <manifest name>_<x>_<z>.cscene.
+		static bool BuildPartition(Scene* scene, const std::string& manifestPath, float cellSize);
+
+		//Closes any open partition first. Returns false if the manifest is missing or malformed.
+		bool OpenPartition(const std::string& manifestPath);
+		//Waits for in-flight loads, then evicts every cell. Models are unloaded by the next UpdateStreaming, once the renderer has dropped their instances.
+		void ClosePartition();
+		bool IsPartitionOpen() const { return !m_Cells.empty(); }
+
+		//Call once per frame, before the scene is updated.
+		void UpdateStreaming(const glm::vec3& cameraPosition);
+
+		//Distances from the camera to a cell's bounds on the XZ plane. The unload radius is kept at or beyond the load radius.
+		void SetStreamingRadii(float loadRadius, float unloadRadius);
+		void SetMemoryBudget(size_t memoryBudget) { m_MemoryBudget = memoryBudget; } //In bytes.
+
+		uint32_t RetrieveCellCount() const { return (uint32_t)m_Cells.size(); }
+		uint32_t RetrieveResidentCellCount() const { return m_ResidentCellCount; }
+		uint32_t RetrieveLoadingCellCount() const { return m_LoadingCellCount; }
+		size_t RetrieveResidentMemory() const { return m_ResidentMemory; } //Footprint of the models instanced by resident cells.
+		size_t RetrieveMemoryBudget() const { return m_MemoryBudget; }
+
+	private:
+		enum CellState
+		{
+			CellState_Unloaded,
+			CellState_Opening, //Scene file being mapped and validated.
+			CellState_Importing, //Missing models being imported.
+			CellState_Resident
+		};
+
+		struct CellLoad;
+
+		struct WorldCell
+		{
+			std::string m_FilePath;
+			glm::vec2 m_BoundsMinimum = glm::vec2(0.0f); //On the XZ plane.
+			glm::vec2 m_BoundsMaximum = glm::vec2(0.0f);
+			size_t m_MemoryEstimate = 0;
+
+			CellState m_State = CellState_Unloaded;
+			uint32_t m_LastWantedFrame = 0; //Last frame the cell was within the load radius.
+			bool m_LoadFailed = false; //Not retried until the partition is reopened.
+			std::unique_ptr<CellLoad> m_Load; //While opening or importing.
+
+			std::vector<EntityHandle> m_RootEntities; //Handles, as the entities may have been deleted from the scene since.
+			std::vector<const Prefab*> m_Prefabs; //Models we hold a reference to on the cell's behalf.
+		};
+
+		void BeginImport(WorldCell& worldCell);
+		void FinishLoad(WorldCell& worldCell);
+		void FailLoad(WorldCell& worldCell, const std::string& failureMessage);
+		void EvictCell(WorldCell& worldCell);
+		//Evicts cells beyond the unload radius, least recently wanted first, until the requested bytes fit within our budget. Returns false if they can't.
+		bool ReserveMemory(size_t requiredMemory);
+
+		void AcquirePrefab(WorldCell& worldCell, const Prefab* prefab);
+		void ReleasePrefab(const Prefab* prefab);
+		//Models are only unloaded a frame after they were released, once the renderer has dropped their proxies, unless immediately is set.
+		void UnloadPendingPrefabs(bool immediately);
+
+	private:
+		Scene* m_Scene = nullptr;
+		Renderer* m_RendererContext = nullptr;
+
+		std::vector<WorldCell> m_Cells;
+		glm::vec3 m_CameraPosition = glm::vec3(0.0f);
+		float m_LoadRadius = 64.0f;
+		float m_UnloadRadius = 96.0f;
+		uint32_t m_FrameIndex = 0;
+		uint32_t m_ResidentCellCount = 0;
+		uint32_t m_LoadingCellCount = 0;
+
+		//Memory
+		size_t m_MemoryBudget = (size_t)1024 * 1024 * 1024;
+		size_t m_ResidentMemory = 0;
+		size_t m_LoadingMemory = 0; //Estimates of the cells being loaded.
+
+		//Reference counts of the models we loaded. Models reaching zero wait in the pending list for a frame, and are kept should a cell claim them in the meantime.
+		std::unordered_map<const Prefab*, uint32_t> m_PrefabReferences;
+		std::vector<std::pair<const Prefab*, uint32_t>> m_PendingPrefabUnloads; //With the frame each was released on.
+	};
+}
\ No newline at end of file
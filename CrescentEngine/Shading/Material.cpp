@@ -1,21 +1,27 @@
 #include "CrescentPCH.h"
 #include "Material.h"
+#include "TextureCube.h"
+#include <cstring>
 
 namespace Crescent
 {
+	unsigned int Material::m_MaterialCounterID = 0;
+
 	Material::Material()
 	{
-
+		m_MaterialID = Material::m_MaterialCounterID++;
 	}
 
 	Material::Material(Shader* shader)
 	{
 		m_Shader = shader;
+		m_MaterialID = Material::m_MaterialCounterID++;
 	}
 
 	Material Material::CopyMaterial()
 	{
 		Material copy(m_Shader);
+		copy.m_InstancedShader = m_InstancedShader;
 
 		copy.m_MaterialType = m_MaterialType;
 		copy.m_Color = m_Color;
@@ -51,24 +57,28 @@ namespace Crescent
 
 	void Material::SetShaderBool(const std::string& uniformName, const bool& value)
 	{
+		MarkParametersDirty();
 		m_Uniforms[uniformName].m_UniformType = Shader_Type_Boolean;
 		m_Uniforms[uniformName].m_BoolValue = value;
 	}
 
 	void Material::SetShaderInt(const std::string& uniformName, const int& value)
 	{
+		MarkParametersDirty();
 		m_Uniforms[uniformName].m_UniformType = Shader_Type_Integer;
 		m_Uniforms[uniformName].m_IntValue = value;
 	}
 
 	void Material::SetShaderFloat(const std::string& uniformName, const float& value)
 	{
+		MarkParametersDirty();
 		m_Uniforms[uniformName].m_UniformType = Shader_Type_Float;
 		m_Uniforms[uniformName].m_FloatValue = value;
 	}
 
 	void Material::SetShaderTexture(const std::string& uniformName, Texture* value, unsigned int textureUnit)
 	{
+		MarkParametersDirty();
 		m_SamplerUniforms[uniformName].m_TextureUnit = textureUnit; 
 		m_SamplerUniforms[uniformName].m_Texture = value;
 		
@@ -96,10 +106,17 @@ namespace Crescent
 			m_Shader->UseShader();
 			m_Shader->SetUniformInteger(uniformName, textureUnit);
 		}
+
+		if (m_InstancedShader)
+		{
+			m_InstancedShader->UseShader();
+			m_InstancedShader->SetUniformInteger(uniformName, textureUnit);
+		}
 	}
 
 	void Material::SetShaderTextureCube(const std::string& uniformName, TextureCube* value, unsigned int textureUnit)
 	{
+		MarkParametersDirty();
 		m_SamplerUniforms[uniformName].m_TextureUnit = textureUnit;
 		m_SamplerUniforms[uniformName].m_UniformType = Shader_Type_SamplerCube;
 		m_SamplerUniforms[uniformName].m_TextureCube = value;
@@ -109,41 +126,159 @@ namespace Crescent
 			m_Shader->UseShader();
 			m_Shader->SetUniformInteger(uniformName, textureUnit);
 		}
+
+		if (m_InstancedShader)
+		{
+			m_InstancedShader->UseShader();
+			m_InstancedShader->SetUniformInteger(uniformName, textureUnit);
+		}
 	}
 
 	void Material::SetShaderVector2(const std::string& uniformName, const glm::vec2& value)
 	{
+		MarkParametersDirty();
 		m_Uniforms[uniformName].m_UniformType = Shader_Type_Vector2;
 		m_Uniforms[uniformName].m_Vector2Value = value;
 	}
 
 	void Material::SetShaderVector3(const std::string& uniformName, const glm::vec3& value)
 	{
+		MarkParametersDirty();
 		m_Uniforms[uniformName].m_UniformType = Shader_Type_Vector3;
 		m_Uniforms[uniformName].m_Vector3Value = value;
 	}
 
 	void Material::SetShaderVector3(const std::string& uniformName, const glm::vec4& value)
 	{
+		MarkParametersDirty();
 		m_Uniforms[uniformName].m_UniformType = Shader_Type_Vector4;
 		m_Uniforms[uniformName].m_Vector4Value = value;
 	}
 
 	void Material::SetShaderMat2(const std::string& uniformName, const glm::mat2& value)
 	{
+		MarkParametersDirty();
 		m_Uniforms[uniformName].m_UniformType = Shader_Type_Matrix2;
 		m_Uniforms[uniformName].m_Mat2Value = value;
 	}
 
 	void Material::SetShaderMat3(const std::string& uniformName, const glm::mat3& value)
 	{
+		MarkParametersDirty();
 		m_Uniforms[uniformName].m_UniformType = Shader_Type_Matrix3;
 		m_Uniforms[uniformName].m_Mat3Value = value;
 	}
 
 	void Material::SetShaderMat4(const std::string& uniformName, const glm::mat4& value)
 	{
+		MarkParametersDirty();
 		m_Uniforms[uniformName].m_UniformType = Shader_Type_Matrix4;
 		m_Uniforms[uniformName].m_Mat4Value = value;
 	}
+
+	void Material::MarkParametersDirty()
+	{
+		m_MaterialVersion++;
+		m_ParameterBlockDirty = true;
+	}
+
+	void Material::BakeParameterBlock()
+	{
+		m_ParameterBlockDirty = false;
+		m_ParameterBlock.assign(m_Shader ? m_Shader->RetrieveMaterialBlockSize() : 0, 0);
+		m_TextureBindings.clear();
+		m_LooseUniforms.clear();
+
+		//std140 layouts are fully defined by the block's declaration, so our instanced variant shares the same offsets.
+		for (auto iterator = m_Uniforms.begin(); iterator != m_Uniforms.end(); iterator++)
+		{
+			UniformHandle uniform(iterator->first);
+			const MaterialBlockMember* blockMember = m_Shader ? m_Shader->RetrieveMaterialBlockMember(uniform) : nullptr;
+			if (blockMember)
+			{
+				WriteBlockMember(*blockMember, iterator->second);
+			}
+			else if ((m_Shader && m_Shader->HasUniform(uniform)) || (m_InstancedShader && m_InstancedShader->HasUniform(uniform)))
+			{
+				m_LooseUniforms.emplace_back(uniform, iterator->second);
+			}
+		}
+
+		for (auto iterator = m_SamplerUniforms.begin(); iterator != m_SamplerUniforms.end(); iterator++)
+		{
+			MaterialTextureBinding textureBinding;
+			textureBinding.m_TextureUnit = iterator->second.m_TextureUnit;
+			if (iterator->second.m_UniformType == Shader_Type_SamplerCube)
+			{
+				textureBinding.m_TextureTarget = GL_TEXTURE_CUBE_MAP;
+				textureBinding.m_TextureID = iterator->second.m_TextureCube->m_TextureCubeID;
+			}
+			else
+			{
+				textureBinding.m_TextureTarget = iterator->second.m_Texture->m_TextureTarget;
+				textureBinding.m_TextureID = iterator->second.m_Texture->RetrieveTextureID();
+			}
+			m_TextureBindings.push_back(textureBinding);
+		}
+	}
+
+	void Material::WriteBlockMember(const MaterialBlockMember& blockMember, const UniformValue& uniformValue)
+	{
+		uint8_t* destination = m_ParameterBlock.data() + blockMember.m_BlockOffset;
+		switch (uniformValue.m_UniformType)
+		{
+			case Shader_Type_Boolean:
+			{
+				int32_t boolValue = uniformValue.m_BoolValue ? 1 : 0; //std140 booleans are 4 bytes.
+				memcpy(destination, &boolValue, sizeof(int32_t));
+				break;
+			}
+
+			case Shader_Type_Integer:
+				memcpy(destination, &uniformValue.m_IntValue, sizeof(int));
+				break;
+
+			case Shader_Type_Float:
+				memcpy(destination, &uniformValue.m_FloatValue, sizeof(float));
+				break;
+
+			case Shader_Type_Vector2:
+				memcpy(destination, &uniformValue.m_Vector2Value, sizeof(glm::vec2));
+				break;
+
+			case Shader_Type_Vector3:
+				memcpy(destination, &uniformValue.m_Vector3Value, sizeof(glm::vec3));
+				break;
+
+			case Shader_Type_Vector4:
+				memcpy(destination, &uniformValue.m_Vector4Value, sizeof(glm::vec4));
+				break;
+
+			//Matrix columns are padded out to the block's matrix stride.
+			case Shader_Type_Matrix2:
+				for (int i = 0; i < 2; i++)
+				{
+					memcpy(destination + i * blockMember.m_MatrixStride, &uniformValue.m_Mat2Value[i], sizeof(glm::vec2));
+				}
+				break;
+
+			case Shader_Type_Matrix3:
+				for (int i = 0; i < 3; i++)
+				{
+					memcpy(destination + i * blockMember.m_MatrixStride, &uniformValue.m_Mat3Value[i], sizeof(glm::vec3));
+				}
+				break;
+
+			case Shader_Type_Matrix4:
+				for (int i = 0; i < 4; i++)
+				{
+					memcpy(destination + i * blockMember.m_MatrixStride, &uniformValue.m_Mat4Value[i], sizeof(glm::vec4));
+				}
+				break;
+
+			default:
+				CrescentError("You tried to bake an unidentified uniform data type into a material block. Please check.");
+				break;
+		}
+	}
 }
\ No newline at end of file
@@ -22,6 +22,23 @@ namespace Crescent
 		Material_PostProcess
 	};
 
+	//One entry of a material's baked texture table.
+	struct MaterialTextureBinding
+	{
+		unsigned int m_TextureUnit;
+		GLenum m_TextureTarget;
+		unsigned int m_TextureID;
+	};
+
+	//A uniform the shader's MaterialUniforms block doesn't hold, which we still set on the shader directly.
+	struct MaterialLooseUniform
+	{
+		MaterialLooseUniform(UniformHandle uniform, const UniformValue& value) : m_Uniform(uniform), m_Value(value) { }
+
+		UniformHandle m_Uniform;
+		UniformValue m_Value;
+	};
+
 	class Material
 	{
 	public:
@@ -30,7 +47,10 @@ namespace Crescent
 
 		//Shaders
 		Shader* RetrieveMaterialShader() const { return m_Shader; }
-		void SetMaterialShader(Shader* shader) { m_Shader = shader; }
+		void SetMaterialShader(Shader* shader) { m_Shader = shader; MarkParametersDirty(); }
+		//Optional variant of our shader that reads its model matrix per instance, allowing the renderer to draw repeated commands of this material in one call.
+		Shader* RetrieveInstancedShader() const { return m_InstancedShader; }
+		void SetInstancedShader(Shader* shader) { m_InstancedShader = shader; MarkParametersDirty(); }
 
 		//Due to the states of our materials, we have to manually copy certain things.
 		Material CopyMaterial();
@@ -51,6 +71,24 @@ namespace Crescent
 		void SetShaderMat3(const std::string& uniformName, const glm::mat3& value);
 		void SetShaderMat4(const std::string& uniformName, const glm::mat4& value);
 
+		//Parameter Block - Our uniforms packed to the shader's std140 MaterialUniforms layout, alongside a flat table of textures to bind. Rebuilt once a setter marks us dirty.
+		bool IsParameterBlockDirty() const { return m_ParameterBlockDirty; }
+		void BakeParameterBlock();
+		const std::vector<uint8_t>& RetrieveParameterBlock() const { return m_ParameterBlock; }
+		const std::vector<MaterialTextureBinding>& RetrieveTextureBindings() const { return m_TextureBindings; }
+		const std::vector<MaterialLooseUniform>& RetrieveLooseUniforms() const { return m_LooseUniforms; }
+		//Slot in the renderer's material uniform buffer holding our parameter block. -1 until first uploaded.
+		int RetrieveParameterBlockSlot() const { return m_ParameterBlockSlot; }
+		void SetParameterBlockSlot(int parameterBlockSlot) { m_ParameterBlockSlot = parameterBlockSlot; }
+
+		//Identification
+		unsigned int RetrieveMaterialID() const { return m_MaterialID; }
+		//Incremented whenever a uniform or sampler changes, so the renderer knows when it can skip re-applying this material between draws.
+		unsigned int RetrieveMaterialVersion() const { return m_MaterialVersion; }
+
+	public:
+		static unsigned int m_MaterialCounterID;
+
 	public:
 		MaterialType m_MaterialType = Material_Custom;
 		glm::vec4 m_Color = glm::vec4(1.0f);
@@ -78,7 +116,22 @@ namespace Crescent
 		std::map<std::string, UniformSamplerValue> m_SamplerUniforms;
 
 	private:
-		Shader* m_Shader;
+		void MarkParametersDirty();
+		void WriteBlockMember(const MaterialBlockMember& blockMember, const UniformValue& uniformValue);
+
+	private:
+		Shader* m_Shader = nullptr;
+		Shader* m_InstancedShader = nullptr;
 		std::map<std::string, UniformValue> m_Uniforms;
+
+		unsigned int m_MaterialID = 0;
+		unsigned int m_MaterialVersion = 0;
+
+		//Baked Parameters
+		bool m_ParameterBlockDirty = true;
+		int m_ParameterBlockSlot = -1;
+		std::vector<uint8_t> m_ParameterBlock;
+		std::vector<MaterialTextureBinding> m_TextureBindings;
+		std::vector<MaterialLooseUniform> m_LooseUniforms;
 	};
 }
\ No newline at end of file
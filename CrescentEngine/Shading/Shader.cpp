@@ -2,9 +2,12 @@
 #include "Shader.h"
 #include "GL/glew.h"
 #include <glm/gtc/type_ptr.hpp>
+#include <cstring>
 
 namespace Crescent
 {
+	unsigned int Shader::m_BoundShaderID = 0;
+
 	Shader::Shader()
 	{
 
@@ -65,6 +68,47 @@ namespace Crescent
 		glDeleteShader(vertexShader);
 		glDeleteShader(fragmentShader);
 
+		QueryProgramInterface();
+	}
+
+	void Shader::LoadComputeShader(const std::string& shaderName, std::string computeShaderCode)
+	{
+		m_ShaderName = shaderName;
+		unsigned int computeShader = glCreateShader(GL_COMPUTE_SHADER);
+		m_ShaderID = glCreateProgram();
+
+		const char* computeShaderSourceCode = computeShaderCode.c_str();
+		glShaderSource(computeShader, 1, &computeShaderSourceCode, nullptr);
+		glCompileShader(computeShader);
+
+		int status;
+		char log[1024];
+		glGetShaderiv(computeShader, GL_COMPILE_STATUS, &status);
+		if (!status)
+		{
+			glGetShaderInfoLog(computeShader, 1024, NULL, log);
+			CrescentInfo("Compute shader compilation error at: " + shaderName + "!\n" + std::string(log));
+		}
+
+		glAttachShader(m_ShaderID, computeShader);
+		glLinkProgram(m_ShaderID);
+
+		glGetProgramiv(m_ShaderID, GL_LINK_STATUS, &status);
+		if (!status)
+		{
+			glGetProgramInfoLog(m_ShaderID, 1024, NULL, log);
+			CrescentInfo("Shader program linking error: \n" + std::string(log));
+
+			throw std::runtime_error("Shader linker error.");
+		}
+
+		glDeleteShader(computeShader);
+
+		QueryProgramInterface();
+	}
+
+	void Shader::QueryProgramInterface()
+	{
 		//Query the number of active uniforms and attributes.
 		int numberOfAttributes, numberOfUniforms;
 		glGetProgramiv(m_ShaderID, GL_ACTIVE_ATTRIBUTES, &numberOfAttributes);
@@ -94,110 +138,263 @@ namespace Crescent
 
 			m_Uniforms[i].m_UniformLocation = glGetUniformLocation(m_ShaderID, buffer);
 		}
+
+		BuildUniformTable();
+		QueryMaterialBlockLayout();
 	}
 
 	void Shader::UseShader()
 	{
-		glUseProgram(m_ShaderID);
+		if (m_BoundShaderID != m_ShaderID)
+		{
+			m_BoundShaderID = m_ShaderID;
+			glUseProgram(m_ShaderID);
+		}
+	}
+
+	bool Shader::HasUniform(UniformHandle uniform) const
+	{
+		return RetrieveUniformSlot(uniform) != nullptr;
+	}
+
+	void Shader::BuildUniformTable()
+	{
+		//Keep the load factor at or below 50% so probe sequences stay short.
+		uint32_t tableSize = 8;
+		while (tableSize < m_Uniforms.size() * 4)
+		{
+			tableSize *= 2;
+		}
+		m_UniformTable.assign(tableSize, UniformSlot());
+		m_UniformTableMask = tableSize - 1;
+		m_CachedValues.clear();
+
+		for (const Uniform& uniform : m_Uniforms)
+		{
+			//Uniform block members have no location of their own.
+			if ((int)uniform.m_UniformLocation < 0)
+			{
+				continue;
+			}
+
+			const uint32_t cachedValueIndex = (uint32_t)m_CachedValues.size();
+			m_CachedValues.emplace_back();
+			InsertUniformSlot(UniformHandle(uniform.m_UniformName).m_UniformHash, uniform.m_UniformLocation, cachedValueIndex);
+
+			//Arrays are reported as "name[0]". Also make them reachable through their plain name, sharing the same cached value.
+			const std::string arraySuffix = "[0]";
+			if (uniform.m_UniformName.size() > arraySuffix.size() && uniform.m_UniformName.compare(uniform.m_UniformName.size() - arraySuffix.size(), arraySuffix.size(), arraySuffix) == 0)
+			{
+				InsertUniformSlot(UniformHandle(uniform.m_UniformName.substr(0, uniform.m_UniformName.size() - arraySuffix.size())).m_UniformHash, uniform.m_UniformLocation, cachedValueIndex);
+			}
+		}
+	}
+
+	void Shader::InsertUniformSlot(uint32_t uniformHash, int uniformLocation, uint32_t cachedValueIndex)
+	{
+		uint32_t slotIndex = uniformHash & m_UniformTableMask;
+		while (m_UniformTable[slotIndex].m_UniformLocation >= 0)
+		{
+			if (m_UniformTable[slotIndex].m_UniformHash == uniformHash)
+			{
+				CrescentInfo("Uniform name hash collision in shader: " + m_ShaderName + ". Only the first uniform will be settable.");
+				return;
+			}
+			slotIndex = (slotIndex + 1) & m_UniformTableMask;
+		}
+
+		m_UniformTable[slotIndex].m_UniformHash = uniformHash;
+		m_UniformTable[slotIndex].m_UniformLocation = uniformLocation;
+		m_UniformTable[slotIndex].m_CachedValueIndex = cachedValueIndex;
+	}
+
+	const Shader::UniformSlot* Shader::RetrieveUniformSlot(UniformHandle uniform) const
+	{
+		if (m_UniformTable.empty())
+		{
+			return nullptr;
+		}
+
+		uint32_t slotIndex = uniform.m_UniformHash & m_UniformTableMask;
+		while (m_UniformTable[slotIndex].m_UniformLocation >= 0)
+		{
+			if (m_UniformTable[slotIndex].m_UniformHash == uniform.m_UniformHash)
+			{
+				return &m_UniformTable[slotIndex];
+			}
+			slotIndex = (slotIndex + 1) & m_UniformTableMask;
+		}
+		return nullptr;
 	}
 
-	bool Shader::HasUniform(const std::string& uniformName)
+	Shader::UniformSlot* Shader::RetrieveUniformSlot(UniformHandle uniform)
 	{
+		return const_cast<UniformSlot*>(static_cast<const Shader*>(this)->RetrieveUniformSlot(uniform));
+	}
+
+	void Shader::QueryMaterialBlockLayout()
+	{
+		unsigned int materialBlockIndex = glGetUniformBlockIndex(m_ShaderID, "MaterialUniforms");
+		if (materialBlockIndex == GL_INVALID_INDEX)
+		{
+			return;
+		}
+		glGetActiveUniformBlockiv(m_ShaderID, materialBlockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &m_MaterialBlockSize);
+
 		for (unsigned int i = 0; i < m_Uniforms.size(); i++)
 		{
-			if (m_Uniforms[i].m_UniformName == uniformName)
+			int blockIndex = -1;
+			glGetActiveUniformsiv(m_ShaderID, 1, &i, GL_UNIFORM_BLOCK_INDEX, &blockIndex);
+			if (blockIndex != (int)materialBlockIndex)
 			{
-				return true;
+				continue;
 			}
+
+			MaterialBlockMember blockMember;
+			blockMember.m_UniformHash = UniformHandle(m_Uniforms[i].m_UniformName).m_UniformHash;
+			glGetActiveUniformsiv(m_ShaderID, 1, &i, GL_UNIFORM_OFFSET, &blockMember.m_BlockOffset);
+			glGetActiveUniformsiv(m_ShaderID, 1, &i, GL_UNIFORM_MATRIX_STRIDE, &blockMember.m_MatrixStride);
+			m_MaterialBlockMembers.push_back(blockMember);
 		}
-		return false;
 	}
 
-	void Shader::SetUniformFloat(std::string name, float value) 
+	//Only used while baking materials, and blocks are small, so a linear search will do.
+	const MaterialBlockMember* Shader::RetrieveMaterialBlockMember(UniformHandle uniform) const
 	{
-		int location = RetrieveUniformLocation(name);
-		if (location >= 0)
+		for (const MaterialBlockMember& blockMember : m_MaterialBlockMembers)
 		{
-			glUniform1f(location, value);
+			if (blockMember.m_UniformHash == uniform.m_UniformHash)
+			{
+				return &blockMember;
+			}
 		}
+		return nullptr;
 	}
 
-	void Shader::SetUniformInteger(std::string name, int value) 
+	template<typename T>
+	bool Shader::UpdateCachedValue(const UniformSlot* uniformSlot, const T& value)
 	{
-		int location = RetrieveUniformLocation(name);
-		if (location >= 0)
+		static_assert(sizeof(T) <= sizeof(CachedUniformValue::m_Value), "Uniform value too large to cache.");
+		CachedUniformValue& cachedValue = m_CachedValues[uniformSlot->m_CachedValueIndex];
+		if (cachedValue.m_HasValue && memcmp(cachedValue.m_Value, &value, sizeof(T)) == 0)
 		{
-			glUniform1i(location, value);
+			return false;
 		}
+
+		memcpy(cachedValue.m_Value, &value, sizeof(T));
+		cachedValue.m_HasValue = true;
+		return true;
 	}
 
-	void Shader::SetUniformBool(std::string name, bool value) 
+	void Shader::SetUniformFloat(UniformHandle uniform, float value) 
 	{
-		int location = RetrieveUniformLocation(name);
-		if (location >= 0)
+		UniformSlot* uniformSlot = RetrieveUniformSlot(uniform);
+		if (uniformSlot && UpdateCachedValue(uniformSlot, value))
 		{
-			glUniform1i(location, (int)value);
+			glProgramUniform1f(m_ShaderID, uniformSlot->m_UniformLocation, value);
 		}
 	}
 
-	void Shader::SetUniformVector2(std::string name, glm::vec2 value)
+	void Shader::SetUniformInteger(UniformHandle uniform, int value) 
 	{
-		int location = RetrieveUniformLocation(name);
-		if (location >= 0)
+		UniformSlot* uniformSlot = RetrieveUniformSlot(uniform);
+		if (uniformSlot && UpdateCachedValue(uniformSlot, value))
 		{
-			glUniform2fv(location, 1, &value[0]);
+			glProgramUniform1i(m_ShaderID, uniformSlot->m_UniformLocation, value);
 		}
 	}
 
-	void Shader::SetUniformVector3(std::string name, glm::vec3 value)
+	void Shader::SetUniformBool(UniformHandle uniform, bool value) 
+	{
+		//Booleans are integers as far as OpenGL is concerned, so they share their cache representation with SetUniformInteger.
+		SetUniformInteger(uniform, (int)value);
+	}
+
+	void Shader::SetUniformVector2(UniformHandle uniform, const glm::vec2& value)
 	{
-		int location = RetrieveUniformLocation(name);
-		if (location >= 0)
+		UniformSlot* uniformSlot = RetrieveUniformSlot(uniform);
+		if (uniformSlot && UpdateCachedValue(uniformSlot, value))
 		{
-			glUniform3fv(location, 1, &value[0]);
+			glProgramUniform2fv(m_ShaderID, uniformSlot->m_UniformLocation, 1, &value[0]);
 		}
 	}
 
-	void Shader::SetUniformMat4(std::string name, glm::mat4 value)
+	void Shader::SetUniformVector3(UniformHandle uniform, const glm::vec3& value)
 	{
-		int location = RetrieveUniformLocation(name);
-		if (location >= 0)
+		UniformSlot* uniformSlot = RetrieveUniformSlot(uniform);
+		if (uniformSlot && UpdateCachedValue(uniformSlot, value))
 		{
-			glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]);
+			glProgramUniform3fv(m_ShaderID, uniformSlot->m_UniformLocation, 1, &value[0]);
 		}
 	}
 
-	void Shader::SetUniformVectorArray(std::string name, int size, const std::vector<glm::vec3>& values)
+	void Shader::SetUniformVector4(UniformHandle uniform, const glm::vec4& value)
 	{
-		unsigned int location = glGetUniformLocation(m_ShaderID, name.c_str());
-		if (location >= 0)
+		UniformSlot* uniformSlot = RetrieveUniformSlot(uniform);
+		if (uniformSlot && UpdateCachedValue(uniformSlot, value))
 		{
-			glUniform3fv(location, size, (float*)(&values[0].x));
+			glProgramUniform4fv(m_ShaderID, uniformSlot->m_UniformLocation, 1, &value[0]);
 		}
 	}
 
-	int Shader::RetrieveUniformLocation(const std::string& uniformName)
+	void Shader::SetUniformMat4(UniformHandle uniform, const glm::mat4& value)
 	{
-		for (unsigned int i = 0; i < m_Uniforms.size(); i++)
+		UniformSlot* uniformSlot = RetrieveUniformSlot(uniform);
+		if (uniformSlot && UpdateCachedValue(uniformSlot, value))
 		{
-			if (m_Uniforms[i].m_UniformName == uniformName)
-			{
-				return m_Uniforms[i].m_UniformLocation;
-			}
+			glProgramUniformMatrix4fv(m_ShaderID, uniformSlot->m_UniformLocation, 1, GL_FALSE, &value[0][0]);
 		}
-		return -1;
 	}
 
-	//====================================================================================================
-	void Shader::DeleteShader()
+	//Arrays aren't cached. We only drop the cached value of their first element, which shares its location, whichever name it was set through.
+	void Shader::SetUniformMat4Array(UniformHandle uniform, const glm::mat4* values, int count)
 	{
-		glDeleteProgram(m_ShaderID);
+		UniformSlot* uniformSlot = RetrieveUniformSlot(uniform);
+		if (uniformSlot && count > 0)
+		{
+			InvalidateCachedValue(uniformSlot);
+			glProgramUniformMatrix4fv(m_ShaderID, uniformSlot->m_UniformLocation, count, GL_FALSE, glm::value_ptr(values[0]));
+		}
 	}
 
-	void Shader::SetUniformVectorMat4(std::string identifier, std::vector<glm::mat4> value)
+	void Shader::SetUniformVector4Array(UniformHandle uniform, const glm::vec4* values, int count)
 	{
-		auto location = glGetUniformLocation(m_ShaderID, identifier.c_str());
-		glUniformMatrix4fv(location, value.size(), GL_FALSE, value_ptr(value[0]));
+		UniformSlot* uniformSlot = RetrieveUniformSlot(uniform);
+		if (uniformSlot && count > 0)
+		{
+			InvalidateCachedValue(uniformSlot);
+			glProgramUniform4fv(m_ShaderID, uniformSlot->m_UniformLocation, count, glm::value_ptr(values[0]));
+		}
+	}
+
+	void Shader::SetUniformVectorArray(UniformHandle uniform, int size, const std::vector<glm::vec3>& values)
+	{
+		UniformSlot* uniformSlot = RetrieveUniformSlot(uniform);
+		if (uniformSlot && !values.empty())
+		{
+			InvalidateCachedValue(uniformSlot);
+			glProgramUniform3fv(m_ShaderID, uniformSlot->m_UniformLocation, size, (float*)(&values[0].x));
+		}
+	}
+
+	void Shader::SetUniformVectorMat4(UniformHandle uniform, const std::vector<glm::mat4>& values)
+	{
+		UniformSlot* uniformSlot = RetrieveUniformSlot(uniform);
+		if (uniformSlot && !values.empty())
+		{
+			InvalidateCachedValue(uniformSlot);
+			glProgramUniformMatrix4fv(m_ShaderID, uniformSlot->m_UniformLocation, (GLsizei)values.size(), GL_FALSE, glm::value_ptr(values[0]));
+		}
+	}
+
+	//====================================================================================================
+	void Shader::DeleteShader()
+	{
+		if (m_BoundShaderID == m_ShaderID)
+		{
+			m_BoundShaderID = 0;
+		}
+		glDeleteProgram(m_ShaderID);
 	}
 
 	void Shader::CheckCompileErrors(unsigned int shader, std::string type)
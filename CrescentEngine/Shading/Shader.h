@@ -16,22 +16,31 @@ namespace Crescent
 		Shader(const std::string& shaderName, std::string vertexShaderCode, std::string fragmentShaderCode);
 
 		void LoadShader(const std::string& shaderName, std::string vertexShaderCode, std::string fragmentShaderCode);
-		void UseShader();
-		bool HasUniform(const std::string& uniformName);
+		void LoadComputeShader(const std::string& shaderName, std::string computeShaderCode); //Dispatched with glDispatchCompute once bound through UseShader.
+		void UseShader(); //Only calls into OpenGL if this program isn't already the one bound.
+		bool HasUniform(UniformHandle uniform) const;
 
 		void DeleteShader();
 
-		void SetUniformFloat(const std::string name, float value);
-		void SetUniformInteger(std::string name, int value);
-		void SetUniformBool(std::string name, bool value);
-		void SetUniformVector2(std::string name, glm::vec2 value);
-		void SetUniformVector3(std::string name, glm::vec3 value);
-		void SetUniformMat4(std::string name, glm::mat4 value);
-		void SetUniformVectorArray(std::string name, int size, const std::vector<glm::vec3>& values);
-		void SetUniformVectorMat4(std::string identifier, std::vector<glm::mat4> value);
+		//Setters write straight to this program (it needn't be bound) and skip the upload if the uniform already holds the value.
+		void SetUniformFloat(UniformHandle uniform, float value);
+		void SetUniformInteger(UniformHandle uniform, int value);
+		void SetUniformBool(UniformHandle uniform, bool value);
+		void SetUniformVector2(UniformHandle uniform, const glm::vec2& value);
+		void SetUniformVector3(UniformHandle uniform, const glm::vec3& value);
+		void SetUniformVector4(UniformHandle uniform, const glm::vec4& value);
+		void SetUniformMat4(UniformHandle uniform, const glm::mat4& value);
+		void SetUniformMat4Array(UniformHandle uniform, const glm::mat4* values, int count); //Arrays are uploaded every call, uncached.
+		void SetUniformVector4Array(UniformHandle uniform, const glm::vec4* values, int count);
+		void SetUniformVectorArray(UniformHandle uniform, int size, const std::vector<glm::vec3>& values);
+		void SetUniformVectorMat4(UniformHandle uniform, const std::vector<glm::mat4>& values);
 
 		inline unsigned int GetShaderID() const { return m_ShaderID; }
 
+		//Layout of the shader's MaterialUniforms block, if it declares one. Materials bake their parameters against this.
+		int RetrieveMaterialBlockSize() const { return m_MaterialBlockSize; }
+		const MaterialBlockMember* RetrieveMaterialBlockMember(UniformHandle uniform) const;
+
 	public:
 		//Defunct
 		Shader(const std::string& vertexShaderPath, const std::string& fragmentShaderPath);
@@ -39,14 +48,47 @@ namespace Crescent
 
 	private:
 		void CheckCompileErrors(unsigned int shader, std::string type);
+		//Reflects the linked program's attributes, uniforms and material block.
+		void QueryProgramInterface();
 		
-		//Retrieves uniform location from pre-stored uniform locations and reports an error if a non-uniform is set.
-		int RetrieveUniformLocation(const std::string& uniformName);
+		//Uniform locations, indexed by name hash in a flat open-addressed table (linear probing) built once the program is linked.
+		//An array is reachable through both "name[0]" and "name", so the last uploaded values are kept per location rather than per slot.
+		struct UniformSlot
+		{
+			uint32_t m_UniformHash = 0;
+			int m_UniformLocation = -1; //-1 marks an empty slot.
+			uint32_t m_CachedValueIndex = 0; //Into m_CachedValues, shared by every name of the same location.
+		};
+
+		struct CachedUniformValue
+		{
+			bool m_HasValue = false;
+			alignas(16) unsigned char m_Value[sizeof(glm::mat4)]; //Last value uploaded, large enough for our biggest non-array type.
+		};
+
+		void BuildUniformTable();
+		void QueryMaterialBlockLayout();
+		void InsertUniformSlot(uint32_t uniformHash, int uniformLocation, uint32_t cachedValueIndex);
+		const UniformSlot* RetrieveUniformSlot(UniformHandle uniform) const;
+		UniformSlot* RetrieveUniformSlot(UniformHandle uniform);
+		//Returns false if the location already holds this value, otherwise caches it.
+		template<typename T> bool UpdateCachedValue(const UniformSlot* uniformSlot, const T& value);
+		//Array uploads aren't cached, but overwrite their first element's value.
+		void InvalidateCachedValue(const UniformSlot* uniformSlot) { m_CachedValues[uniformSlot->m_CachedValueIndex].m_HasValue = false; }
+
 		unsigned int m_ShaderID;
 
 	private:
+		//The program currently bound to the context. All program binds go through UseShader, so this always mirrors OpenGL's state.
+		static unsigned int m_BoundShaderID;
+
 		std::string m_ShaderName;
 		std::vector<Uniform> m_Uniforms;
 		std::vector<VertexAttribute> m_Attributes;
+		std::vector<UniformSlot> m_UniformTable;
+		uint32_t m_UniformTableMask = 0; //Table size is a power of 2, so this replaces a modulo.
+		std::vector<CachedUniformValue> m_CachedValues;
+		std::vector<MaterialBlockMember> m_MaterialBlockMembers;
+		int m_MaterialBlockSize = 0; //0 if the shader has no MaterialUniforms block.
 	};
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include <glm/glm.hpp>
+#include "../Utilities/StringID.h"
 
 namespace Crescent
 {
@@ -23,6 +24,15 @@ namespace Crescent
 		Shader_Type_Matrix4
 	};
 
+	//A uniform name reduced to its hash. Declare hot ones as static constexpr so they are hashed at compile time, e.g. static constexpr UniformHandle g_ModelUniform("model").
+	struct UniformHandle
+	{
+		constexpr UniformHandle(const char* uniformName) : m_UniformHash(Hash_FNV1a(uniformName)) { }
+		UniformHandle(const std::string& uniformName) : m_UniformHash(Hash_FNV1a(uniformName.c_str(), uniformName.size())) { }
+
+		uint32_t m_UniformHash;
+	};
+
 	struct Uniform
 	{
 		Shader_Type m_UniformType;
@@ -31,6 +41,14 @@ namespace Crescent
 		unsigned int m_UniformLocation;
 	};
 
+	//Where a uniform lives within a shader's std140 MaterialUniforms block, as reported by the driver.
+	struct MaterialBlockMember
+	{
+		uint32_t m_UniformHash;
+		int m_BlockOffset; //In bytes.
+		int m_MatrixStride; //In bytes. 0 for non-matrices.
+	};
+
 	struct VertexAttribute
 	{
 		Shader_Type m_AttributeType;
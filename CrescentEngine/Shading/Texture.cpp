@@ -168,6 +168,15 @@ namespace Crescent
 		glTexParameteri(m_TextureTarget, GL_TEXTURE_MAG_FILTER, magnificationFilter);
 	}
 
+	void Texture::DeleteTexture()
+	{
+		if (m_TextureID)
+		{
+			glDeleteTextures(1, &m_TextureID);
+			m_TextureID = 0;
+		}
+	}
+
 	unsigned int Texture::RetrieveTextureID() const
 	{
 		return m_TextureID;
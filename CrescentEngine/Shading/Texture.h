@@ -17,6 +17,8 @@ namespace Crescent
 		void GenerateTexture(unsigned int textureWidth, unsigned int textureHeight, unsigned int textureDepth, GLenum textureInternalFormat, GLenum textureFormat, GLenum textureDataType, void* textureData);
 		//Resizes the textures, adding new (empty) texture memory in the process.
 		void ResizeTexture(unsigned int textureWidth, unsigned int textureHeight = 0, unsigned int textureDepth = 0);
+		//Frees the texture's GPU memory. Textures are copied around by value, so this is never done on destruction.
+		void DeleteTexture();
 
 		//Update Relevant Texture State
 		void SetWrappingMode(GLenum wrappingMode, bool binding = false);
@@ -1,4 +1,6 @@
 #pragma once
+#include <string>
+#include <cstdint>
 
 #define SID(string) Custom_Simple_Hash(string)
 
@@ -11,5 +13,38 @@ inline unsigned int Custom_Simple_Hash(const std::string& string)
 		hash = 37 * hash + 17 * static_cast<char>(iterator);
 	}
 
+	return hash;
+}
+
+//32-bit FNV-1a. Spreads similar names (such as "lightColor" and "lightColors") far better than the above, and being constexpr, hashes literals at compile time.
+constexpr uint32_t Hash_FNV1a(const char* string, size_t length)
+{
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < length; i++)
+	{
+		hash = (hash ^ static_cast<uint8_t>(string[i])) * 16777619u;
+	}
+	return hash;
+}
+
+constexpr uint32_t Hash_FNV1a(const char* string)
+{
+	size_t length = 0;
+	while (string[length] != '\0')
+	{
+		length++;
+	}
+	return Hash_FNV1a(string, length);
+}
+
+//64-bit FNV-1a over raw bytes. Used for content hashes of whole asset files, where 32 bits would make collisions a real possibility.
+inline uint64_t Hash_FNV1a64(const void* data, size_t length)
+{
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < length; i++)
+	{
+		hash = (hash ^ bytes[i]) * 1099511628211ull;
+	}
 	return hash;
 }
\ No newline at end of file
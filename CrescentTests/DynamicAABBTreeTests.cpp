@@ -0,0 +1,162 @@
+#include "TestFramework.h"
+#include "Core/CrescentPCH.h"
+#include "Scene/DynamicAABBTree.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cfloat>
+
+namespace Crescent
+{
+	//Boxes of 0.5 to 2.5 units scattered through a cube of the given size, reproducibly.
+	static std::vector<AABB> GenerateBoxes(uint32_t boxCount, float worldSize, uint32_t randomSeed)
+	{
+		std::vector<AABB> boxes(boxCount);
+		uint32_t randomState = randomSeed;
+		auto RandomFloat = [&randomState]()
+		{
+			randomState = randomState * 1664525u + 1013904223u;
+			return (float)(randomState >> 8) / (float)(1u << 24);
+		};
+
+		for (AABB& box : boxes)
+		{
+			const glm::vec3 boxCenter = (glm::vec3(RandomFloat(), RandomFloat(), RandomFloat()) - 0.5f) * worldSize;
+			const glm::vec3 boxExtents = glm::vec3(0.25f) + glm::vec3(RandomFloat(), RandomFloat(), RandomFloat());
+			box = AABB::FromCenterExtents(boxCenter, boxExtents);
+		}
+		return boxes;
+	}
+
+	static Frustum ConstructTestFrustum()
+	{
+		const glm::mat4 projectionMatrix = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 300.0f);
+		const glm::mat4 viewMatrix = glm::lookAt(glm::vec3(0.0f, 10.0f, 0.0f), glm::vec3(1.0f, 9.5f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		return Frustum(projectionMatrix * viewMatrix);
+	}
+
+	//Worlds grow with their box count, keeping density (and so how much a frustum sees of it) comparable.
+	static float RetrieveWorldSize(uint32_t boxCount)
+	{
+		return 10.0f * std::cbrt((float)boxCount);
+	}
+
+	CRESCENT_TEST(DynamicAABBTree_QueriesMatchBruteForce)
+	{
+		const std::vector<AABB> boxes = GenerateBoxes(20000, RetrieveWorldSize(20000), 7);
+		DynamicAABBTree spatialTree;
+		std::vector<uint32_t> proxyIndices;
+		for (uint32_t i = 0; i < boxes.size(); i++)
+		{
+			proxyIndices.push_back(spatialTree.CreateProxy(boxes[i], i));
+		}
+
+		//Move a third of them, some far enough to be reinserted, and remove another third.
+		for (uint32_t i = 0; i < boxes.size(); i += 3)
+		{
+			const glm::vec3 offset = glm::vec3((float)(i % 7), 0.0f, -(float)(i % 5)) * 0.2f;
+			spatialTree.MoveProxy(proxyIndices[i], { boxes[i].m_Minimum + offset, boxes[i].m_Maximum + offset });
+		}
+		std::vector<bool> liveProxies(boxes.size(), true);
+		for (uint32_t i = 1; i < boxes.size(); i += 3)
+		{
+			spatialTree.DestroyProxy(proxyIndices[i]);
+			liveProxies[i] = false;
+		}
+
+		//A balanced tree of n leaves is log2(n) high. Ours needn't be balanced, but shouldn't be far off.
+		CrescentCheck(spatialTree.RetrieveProxyCount() == boxes.size() - (boxes.size() + 1) / 3);
+		CrescentCheck(spatialTree.RetrieveHeight() < 40);
+
+		const Frustum frustum = ConstructTestFrustum();
+		std::vector<uint32_t> treeResults;
+		spatialTree.QueryFrustum(frustum, [&](uint32_t proxyIndex) { treeResults.push_back(spatialTree.RetrieveUserData(proxyIndex)); });
+
+		std::vector<uint32_t> bruteForceResults;
+		for (uint32_t i = 0; i < boxes.size(); i++)
+		{
+			const AABB& fatBox = spatialTree.RetrieveFatBox(proxyIndices[i]);
+			if (liveProxies[i] && frustum.IsBoxVisible(fatBox.RetrieveCenter(), fatBox.RetrieveExtents()))
+			{
+				bruteForceResults.push_back(i);
+			}
+		}
+
+		std::sort(treeResults.begin(), treeResults.end());
+		CrescentCheck(!treeResults.empty());
+		CrescentCheck(treeResults == bruteForceResults);
+
+		//Nearest ray hit.
+		const glm::vec3 rayOrigin = glm::vec3(0.0f, 10.0f, 0.0f);
+		const glm::vec3 rayDirection = glm::normalize(glm::vec3(1.0f, -0.5f, -1.0f));
+		uint32_t treeHit = g_NullTreeNode;
+		spatialTree.RayCast(rayOrigin, rayDirection, FLT_MAX, [&](uint32_t proxyIndex, float maximumDistance)
+		{
+			float hitDistance = 0.0f;
+			DynamicAABBTree::IntersectRay(spatialTree.RetrieveFatBox(proxyIndex), rayOrigin, 1.0f / rayDirection, maximumDistance, &hitDistance);
+			treeHit = spatialTree.RetrieveUserData(proxyIndex);
+			return hitDistance;
+		});
+
+		uint32_t bruteForceHit = g_NullTreeNode;
+		float nearestDistance = FLT_MAX;
+		for (uint32_t i = 0; i < boxes.size(); i++)
+		{
+			float hitDistance = 0.0f;
+			if (liveProxies[i] && DynamicAABBTree::IntersectRay(spatialTree.RetrieveFatBox(proxyIndices[i]), rayOrigin, 1.0f / rayDirection, nearestDistance, &hitDistance))
+			{
+				bruteForceHit = i;
+				nearestDistance = hitDistance;
+			}
+		}
+		CrescentCheck(treeHit == bruteForceHit);
+	}
+
+	CRESCENT_BENCHMARK(DynamicAABBTree_AgainstBruteForce)
+	{
+		const Frustum frustum = ConstructTestFrustum();
+		for (uint32_t boxCount : { 10000u, 100000u, 1000000u })
+		{
+			const float worldSize = RetrieveWorldSize(boxCount);
+			const std::vector<AABB> boxes = GenerateBoxes(boxCount, worldSize, 11);
+			const std::string label = std::to_string(boxCount) + " entities, ";
+
+			uint32_t visibleCount = 0;
+			const double bruteForceTime = MeasureMilliseconds([&]()
+			{
+				visibleCount = 0;
+				for (const AABB& box : boxes)
+				{
+					visibleCount += frustum.IsBoxVisible(box.RetrieveCenter(), box.RetrieveExtents()) ? 1 : 0;
+				}
+			}, 10);
+			ReportBenchmark(label + "brute force frustum test (" + std::to_string(visibleCount) + " visible)", bruteForceTime);
+
+			DynamicAABBTree spatialTree;
+			std::vector<uint32_t> proxyIndices(boxCount);
+			ReportBenchmark(label + "tree build", MeasureMilliseconds([&]()
+			{
+				for (uint32_t i = 0; i < boxCount; i++)
+				{
+					proxyIndices[i] = spatialTree.CreateProxy(boxes[i], i);
+				}
+			}));
+
+			const double treeTime = MeasureMilliseconds([&]()
+			{
+				visibleCount = 0;
+				spatialTree.QueryFrustum(frustum, [&](uint32_t) { visibleCount++; });
+			}, 10);
+			ReportBenchmark(label + "tree frustum query (" + std::to_string(visibleCount) + " visible, height " + std::to_string(spatialTree.RetrieveHeight()) + ")", treeTime);
+
+			//A frame in which 1% of entities move, enough for most to leave their fat boxes.
+			ReportBenchmark(label + "tree update of 1% moved", MeasureMilliseconds([&]()
+			{
+				for (uint32_t i = 0; i < boxCount; i += 100)
+				{
+					const glm::vec3 offset = glm::vec3(0.5f, 0.0f, 0.25f);
+					spatialTree.MoveProxy(proxyIndices[i], { boxes[i].m_Minimum + offset, boxes[i].m_Maximum + offset });
+				}
+			}));
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#include "TestFramework.h"
+#include "Core/CrescentPCH.h"
+#include "Scene/EntityPool.h"
+#include "Scene/SceneEntity.h"
+
+namespace Crescent
+{
+	CRESCENT_TEST(EntityPool_StaleHandlesNeverReachReusedSlots)
+	{
+		//The lowest free slot is always reused first, so destroying and constructing one entity over and over cycles a single slot through every generation.
+		SceneEntity* sceneEntity = EntityPool::ConstructEntity("Recycled");
+		const EntityHandle firstHandle = sceneEntity->RetrieveEntityHandle();
+		const uint32_t slotIndex = firstHandle.RetrieveSlotIndex();
+		const uint32_t retiredSlotCount = EntityPool::RetrieveRetiredSlotCount();
+
+		uint32_t reuseCount = 0;
+		uint32_t aliasedHandleCount = 0;
+		while (sceneEntity->RetrieveEntityHandle().RetrieveSlotIndex() == slotIndex && reuseCount <= g_EntityGenerationMask + 1)
+		{
+			const EntityHandle previousHandle = sceneEntity->RetrieveEntityHandle();
+			EntityPool::DestroyEntity(sceneEntity);
+			sceneEntity = EntityPool::ConstructEntity("Recycled");
+			aliasedHandleCount += EntityPool::RetrieveEntity(previousHandle) || EntityPool::RetrieveEntity(firstHandle) ? 1 : 0;
+			reuseCount++;
+		}
+
+		//The slot gets one entity per remaining generation, after which it is retired rather than wrapping back to the first handle's generation.
+		CrescentCheck(reuseCount == g_EntityGenerationMask + 1 - firstHandle.RetrieveGeneration());
+		CrescentCheck(aliasedHandleCount == 0);
+		CrescentCheck(EntityPool::RetrieveRetiredSlotCount() == retiredSlotCount + 1);
+
+		uint32_t reachableGenerationCount = 0;
+		for (uint32_t generation = 0; generation <= g_EntityGenerationMask; generation++)
+		{
+			reachableGenerationCount += EntityPool::RetrieveEntity(EntityHandle(slotIndex, generation)) ? 1 : 0;
+		}
+		CrescentCheck(reachableGenerationCount == 0);
+		CrescentCheck(EntityPool::RetrieveEntity(sceneEntity->RetrieveEntityHandle()) == sceneEntity);
+		EntityPool::DestroyEntity(sceneEntity);
+	}
+}
\ No newline at end of file
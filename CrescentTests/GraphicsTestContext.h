@@ -0,0 +1,46 @@
+#pragma once
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+
+namespace Crescent
+{
+	//Tests that need OpenGL run against a hidden window's context. Where none can be created, such as on a headless build machine, they say so and pass.
+	inline GLFWwindow* CreateHiddenContext()
+	{
+		if (!glfwInit())
+		{
+			std::cout << "    Skipped, as GLFW failed to initialize.\n";
+			return nullptr;
+		}
+
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		GLFWwindow* hiddenWindow = glfwCreateWindow(64, 64, "CrescentTests", nullptr, nullptr);
+		if (!hiddenWindow)
+		{
+			std::cout << "    Skipped, as no OpenGL context could be created.\n";
+			glfwTerminate();
+			return nullptr;
+		}
+
+		glfwMakeContextCurrent(hiddenWindow);
+		glewExperimental = GL_TRUE;
+		if (glewInit() != GLEW_OK)
+		{
+			std::cout << "    Skipped, as GLEW failed to initialize.\n";
+			glfwDestroyWindow(hiddenWindow);
+			glfwTerminate();
+			return nullptr;
+		}
+		return hiddenWindow;
+	}
+
+	inline void DestroyHiddenContext(GLFWwindow* hiddenWindow)
+	{
+		glfwDestroyWindow(hiddenWindow);
+		glfwTerminate();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,319 @@
+#include "TestFramework.h"
+#include "Core/CrescentPCH.h"
+#include "Core/JobSystem.h"
+#include "Core/WorkStealingDeque.h"
+#include <atomic>
+#include <thread>
+#include <cmath>
+#include <algorithm>
+
+namespace Crescent
+{
+	static constexpr unsigned int g_TestWorkerCount = 4;
+
+	CRESCENT_TEST(WorkStealingDeque_EveryJobTakenOnce)
+	{
+		//The owner pushes and pops at the bottom while thieves steal from the top. Every job must come out exactly once, whoever wins the races.
+		static constexpr int g_JobCount = 200000;
+		static constexpr int g_ThiefCount = 3;
+
+		std::vector<Job> jobs(g_JobCount);
+		std::vector<std::atomic<int>> takenCounts(g_JobCount);
+		for (std::atomic<int>& takenCount : takenCounts)
+		{
+			takenCount = 0;
+		}
+
+		WorkStealingDeque deque;
+		std::atomic<bool> ownerFinished = { false };
+		std::atomic<int> takenTotal = { 0 };
+
+		auto TakeJob = [&](Job* job)
+		{
+			takenCounts[job - jobs.data()].fetch_add(1, std::memory_order_relaxed);
+			takenTotal.fetch_add(1, std::memory_order_relaxed);
+		};
+
+		std::vector<std::thread> thieves;
+		for (int i = 0; i < g_ThiefCount; i++)
+		{
+			thieves.emplace_back([&]()
+			{
+				while (!ownerFinished.load(std::memory_order_acquire) || takenTotal.load(std::memory_order_relaxed) < g_JobCount)
+				{
+					if (Job* job = deque.Steal())
+					{
+						TakeJob(job);
+					}
+				}
+			});
+		}
+
+		for (int i = 0; i < g_JobCount; i++)
+		{
+			while (!deque.Push(&jobs[i]))
+			{
+				if (Job* job = deque.Pop())
+				{
+					TakeJob(job);
+				}
+			}
+
+			//Pop every so often, so that the owner also races thieves for the last job.
+			if (i % 3 == 0)
+			{
+				if (Job* job = deque.Pop())
+				{
+					TakeJob(job);
+				}
+			}
+		}
+		while (Job* job = deque.Pop())
+		{
+			TakeJob(job);
+		}
+		ownerFinished = true;
+
+		for (std::thread& thief : thieves)
+		{
+			thief.join();
+		}
+
+		CrescentCheck(takenTotal == g_JobCount);
+		CrescentCheck(std::all_of(takenCounts.begin(), takenCounts.end(), [](const std::atomic<int>& takenCount) { return takenCount == 1; }));
+	}
+
+	CRESCENT_TEST(WorkStealingDeque_ReportsFullAndEmpty)
+	{
+		WorkStealingDeque deque;
+		std::vector<Job> jobs(WorkStealingDeque::g_DequeCapacity + 1);
+
+		CrescentCheck(deque.Pop() == nullptr);
+		CrescentCheck(deque.Steal() == nullptr);
+
+		for (int64_t i = 0; i < WorkStealingDeque::g_DequeCapacity; i++)
+		{
+			CrescentCheck(deque.Push(&jobs[i]));
+		}
+		CrescentCheck(!deque.Push(&jobs.back()));
+
+		//Owner takes the newest, thieves the oldest.
+		CrescentCheck(deque.Pop() == &jobs[WorkStealingDeque::g_DequeCapacity - 1]);
+		CrescentCheck(deque.Steal() == &jobs[0]);
+	}
+
+	CRESCENT_TEST(JobSystem_ParallelForVisitsEveryIndexOnce)
+	{
+		JobSystem::Initialize(g_TestWorkerCount);
+
+		//Many small ParallelFors, each with a counter on the stack that is gone the moment it returns.
+		std::vector<std::atomic<int>> visitCounts(10000);
+		for (int iteration = 0; iteration < 500; iteration++)
+		{
+			for (std::atomic<int>& visitCount : visitCounts)
+			{
+				visitCount.store(0, std::memory_order_relaxed);
+			}
+
+			const uint32_t count = 1 + (iteration * 37) % (uint32_t)visitCounts.size();
+			JobSystem::ParallelFor(count, 16, [&](uint32_t begin, uint32_t end)
+			{
+				for (uint32_t i = begin; i < end; i++)
+				{
+					visitCounts[i].fetch_add(1, std::memory_order_relaxed);
+				}
+			});
+
+			for (uint32_t i = 0; i < visitCounts.size(); i++)
+			{
+				CrescentCheck(visitCounts[i].load(std::memory_order_relaxed) == (i < count ? 1 : 0));
+			}
+		}
+
+		JobSystem::Shutdown();
+	}
+
+	CRESCENT_TEST(JobSystem_ContinuationsRunAfterDependency)
+	{
+		JobSystem::Initialize(g_TestWorkerCount);
+
+		for (int iteration = 0; iteration < 2000; iteration++)
+		{
+			static constexpr int g_StageJobCount = 8;
+			std::atomic<int> firstStageCount = { 0 };
+			std::atomic<int> secondStageCount = { 0 };
+			std::atomic<int> orderingFailures = { 0 };
+
+			JobCounter firstStage;
+			JobCounter secondStage;
+			for (int i = 0; i < g_StageJobCount; i++)
+			{
+				JobSystem::Run([&]() { firstStageCount.fetch_add(1, std::memory_order_relaxed); }, &firstStage);
+			}
+			for (int i = 0; i < g_StageJobCount; i++)
+			{
+				JobSystem::Run([&]()
+				{
+					if (firstStageCount.load(std::memory_order_relaxed) != g_StageJobCount)
+					{
+						orderingFailures.fetch_add(1, std::memory_order_relaxed);
+					}
+					secondStageCount.fetch_add(1, std::memory_order_relaxed);
+				}, &secondStage, &firstStage);
+			}
+
+			JobSystem::Wait(&secondStage);
+			CrescentCheck(firstStage.IsComplete());
+			CrescentCheck(secondStageCount == g_StageJobCount);
+			CrescentCheck(orderingFailures == 0);
+		}
+
+		JobSystem::Shutdown();
+	}
+
+	CRESCENT_TEST(JobSystem_PendingJobsOutliveTheirPoolSlot)
+	{
+		JobSystem::Initialize(g_TestWorkerCount);
+
+		//More continuations than the pool holds wait on a job that doesn't finish until they have all been allocated, so the ring has wrapped around
+		//onto slots whose jobs haven't run yet.
+		std::atomic<bool> dependencyReleased = { false };
+		std::atomic<int> continuationCount = { 0 };
+		JobCounter dependency;
+		JobCounter continuations;
+
+		JobSystem::Run([&]()
+		{
+			while (!dependencyReleased.load(std::memory_order_acquire))
+			{
+				std::this_thread::yield();
+			}
+		}, &dependency);
+
+		const int pendingJobCount = (int)JobSystem::g_JobPoolCapacity + 1000;
+		for (int i = 0; i < pendingJobCount; i++)
+		{
+			JobSystem::Run([&]() { continuationCount.fetch_add(1, std::memory_order_relaxed); }, &continuations, &dependency);
+		}
+
+		dependencyReleased = true;
+		JobSystem::Wait(&continuations);
+		CrescentCheck(continuationCount == pendingJobCount);
+
+		JobSystem::Shutdown();
+	}
+
+	CRESCENT_TEST(JobSystem_MainThreadJobsRunOnMainThread)
+	{
+		JobSystem::Initialize(g_TestWorkerCount);
+
+		std::atomic<int> mainThreadRuns = { 0 };
+		std::atomic<int> wrongThreadRuns = { 0 };
+		JobCounter jobCounter;
+		for (int i = 0; i < 64; i++)
+		{
+			JobSystem::Run([&]()
+			{
+				JobSystem::RunOnMainThread([&]()
+				{
+					(JobSystem::IsMainThread() ? mainThreadRuns : wrongThreadRuns).fetch_add(1, std::memory_order_relaxed);
+				}, &jobCounter);
+			}, &jobCounter);
+		}
+
+		JobSystem::Wait(&jobCounter);
+		CrescentCheck(mainThreadRuns == 64);
+		CrescentCheck(wrongThreadRuns == 0);
+
+		JobSystem::Shutdown();
+	}
+
+	CRESCENT_TEST(JobSystem_BackgroundJobsAvoidMainThread)
+	{
+		JobSystem::Initialize(g_TestWorkerCount);
+
+		//The main thread keeps helping out with ParallelFors while the background jobs are queued, and must never pick one of them up.
+		std::atomic<int> backgroundRuns = { 0 };
+		std::atomic<int> mainThreadRuns = { 0 };
+		JobCounter backgroundCounter;
+		for (int i = 0; i < 256; i++)
+		{
+			JobSystem::RunInBackground([&]()
+			{
+				(JobSystem::IsMainThread() ? mainThreadRuns : backgroundRuns).fetch_add(1, std::memory_order_relaxed);
+			}, &backgroundCounter);
+		}
+
+		while (!backgroundCounter.IsComplete())
+		{
+			JobSystem::ParallelFor(256, 1, [](uint32_t, uint32_t) { });
+		}
+		JobSystem::Wait(&backgroundCounter);
+		CrescentCheck(backgroundRuns == 256);
+		CrescentCheck(mainThreadRuns == 0);
+
+		JobSystem::Shutdown();
+	}
+
+	CRESCENT_TEST(JobSystem_ShutdownRunsEverythingLeftQueued)
+	{
+		//With a single worker, queued jobs only run once someone waits on them. Shutting down without waiting must still run every one of them.
+		JobSystem::Initialize(1);
+
+		std::atomic<int> runCount = { 0 };
+		auto CountRun = [&runCount]() { runCount.fetch_add(1, std::memory_order_relaxed); };
+		JobCounter dependency;
+		JobCounter continuations;
+		JobCounter jobCounter;
+		JobSystem::Run(CountRun, &dependency);
+
+		//Continuations hold on to their pool slots until their dependency is done, so the jobs queued after them are allocated on the heap.
+		for (uint32_t i = 0; i < JobSystem::g_JobPoolCapacity; i++)
+		{
+			JobSystem::Run(CountRun, &continuations, &dependency);
+		}
+		for (int i = 0; i < 64; i++)
+		{
+			JobSystem::Run(CountRun, &jobCounter);
+		}
+		JobSystem::RunOnMainThread(CountRun, &jobCounter);
+		CrescentCheck(runCount == 0);
+
+		JobSystem::Shutdown();
+		CrescentCheck(runCount == (int)JobSystem::g_JobPoolCapacity + 66);
+		CrescentCheck(dependency.IsComplete() && continuations.IsComplete() && jobCounter.IsComplete());
+	}
+
+	CRESCENT_BENCHMARK(JobSystem_ParallelForScaling)
+	{
+		static constexpr uint32_t g_ElementCount = 1 << 22;
+		std::vector<float> elements(g_ElementCount);
+
+		auto TransformElements = [&]()
+		{
+			JobSystem::ParallelFor(g_ElementCount, 4096, [&](uint32_t begin, uint32_t end)
+			{
+				for (uint32_t i = begin; i < end; i++)
+				{
+					elements[i] = std::sqrt((float)i) * std::sin((float)i);
+				}
+			});
+		};
+
+		const unsigned int maximumWorkerCount = std::max(std::thread::hardware_concurrency(), 1u);
+		double singleWorkerTime = 0.0;
+		for (unsigned int workerCount = 1; workerCount <= maximumWorkerCount; workerCount++)
+		{
+			JobSystem::Initialize(workerCount);
+			TransformElements(); //Warm up.
+			const double elapsedTime = MeasureMilliseconds(TransformElements, 10);
+			JobSystem::Shutdown();
+
+			if (workerCount == 1)
+			{
+				singleWorkerTime = elapsedTime;
+			}
+			ReportBenchmark(std::to_string(workerCount) + " workers (" + std::to_string(singleWorkerTime / elapsedTime) + "x)", elapsedTime);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "TestFramework.h"
+#include "Core/CrescentPCH.h"
+#include "Rendering/LightClusters.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <cstdint>
+
+namespace Crescent
+{
+	//A fixed, reproducible light set in view space. Centers spread over and around the frustum, with the last few left over from batches of 4.
+	static std::vector<glm::vec4> GenerateViewSpaceLights(uint32_t lightCount)
+	{
+		std::vector<glm::vec4> viewSpaceLights(lightCount);
+		uint32_t randomState = 12345;
+		auto RandomFloat = [&randomState]()
+		{
+			randomState = randomState * 1664525u + 1013904223u;
+			return (float)(randomState >> 8) / (float)(1u << 24);
+		};
+
+		for (glm::vec4& viewSpaceLight : viewSpaceLights)
+		{
+			const float lightDepth = 0.1f + RandomFloat() * 120.0f;
+			viewSpaceLight = glm::vec4((RandomFloat() * 2.0f - 1.0f) * lightDepth, (RandomFloat() * 2.0f - 1.0f) * lightDepth * 0.6f, -lightDepth, 0.25f + RandomFloat() * 6.0f);
+		}
+		return viewSpaceLights;
+	}
+
+	//Scalar sphere against box test, one light at a time, as the compute shader does it.
+	static void BinLightsReference(const ClusterBounds* clusterBounds, const std::vector<glm::vec4>& viewSpaceLights, std::vector<uint32_t>& clusterLightCounts, std::vector<uint32_t>& clusterLightIndices)
+	{
+		for (uint32_t clusterIndex = 0; clusterIndex < g_ClusterCount; clusterIndex++)
+		{
+			const glm::vec3 boundsMinimum = glm::vec3(clusterBounds[clusterIndex].m_Minimum);
+			const glm::vec3 boundsMaximum = glm::vec3(clusterBounds[clusterIndex].m_Maximum);
+			uint32_t visibleCount = 0;
+			for (uint32_t lightIndex = 0; lightIndex < viewSpaceLights.size() && visibleCount < g_MaximumLightsPerCluster; lightIndex++)
+			{
+				const glm::vec3 lightCenter = glm::vec3(viewSpaceLights[lightIndex]);
+				const glm::vec3 offset = glm::max(glm::max(boundsMinimum - lightCenter, lightCenter - boundsMaximum), glm::vec3(0.0f));
+				if (offset.x * offset.x + offset.y * offset.y + offset.z * offset.z <= viewSpaceLights[lightIndex].w * viewSpaceLights[lightIndex].w)
+				{
+					clusterLightIndices[(size_t)clusterIndex * g_MaximumLightsPerCluster + visibleCount++] = lightIndex;
+				}
+			}
+			clusterLightCounts[clusterIndex] = visibleCount;
+		}
+	}
+
+	static bool ClusterListsMatch(const std::vector<uint32_t>& lightCounts, const std::vector<uint32_t>& lightIndices, const std::vector<uint32_t>& otherLightCounts, const std::vector<uint32_t>& otherLightIndices)
+	{
+		for (uint32_t clusterIndex = 0; clusterIndex < g_ClusterCount; clusterIndex++)
+		{
+			if (lightCounts[clusterIndex] != otherLightCounts[clusterIndex])
+			{
+				return false;
+			}
+
+			const size_t listOffset = (size_t)clusterIndex * g_MaximumLightsPerCluster;
+			if (!std::equal(lightIndices.begin() + listOffset, lightIndices.begin() + listOffset + lightCounts[clusterIndex], otherLightIndices.begin() + listOffset))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	CRESCENT_TEST(LightClusters_BinLightsMatchesScalarReference)
+	{
+		const glm::mat4 projectionMatrix = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+		std::vector<ClusterBounds> clusterBounds(g_ClusterCount);
+		LightClusters::BuildClusterBounds(projectionMatrix, clusterBounds.data());
+
+		const std::vector<glm::vec4> viewSpaceLights = GenerateViewSpaceLights(1003);
+		std::vector<uint32_t> lightCounts(g_ClusterCount);
+		std::vector<uint32_t> lightIndices((size_t)g_ClusterCount * g_MaximumLightsPerCluster);
+		std::vector<uint32_t> referenceLightCounts(g_ClusterCount);
+		std::vector<uint32_t> referenceLightIndices((size_t)g_ClusterCount * g_MaximumLightsPerCluster);
+
+		//Binned in two uneven ranges, as ParallelFor would split it.
+		LightClusters::BinLights(clusterBounds.data(), 0, 1000, viewSpaceLights.data(), (uint32_t)viewSpaceLights.size(), lightCounts.data(), lightIndices.data());
+		LightClusters::BinLights(clusterBounds.data(), 1000, g_ClusterCount, viewSpaceLights.data(), (uint32_t)viewSpaceLights.size(), lightCounts.data(), lightIndices.data());
+		BinLightsReference(clusterBounds.data(), viewSpaceLights, referenceLightCounts, referenceLightIndices);
+
+		CrescentCheck(ClusterListsMatch(lightCounts, lightIndices, referenceLightCounts, referenceLightIndices));
+
+		//The set should actually exercise the lists, rather than match by leaving them all empty.
+		uint32_t occupiedClusterCount = 0;
+		for (uint32_t lightCount : lightCounts)
+		{
+			occupiedClusterCount += lightCount != 0 ? 1 : 0;
+		}
+		CrescentCheck(occupiedClusterCount > g_ClusterCount / 4);
+	}
+
+	CRESCENT_TEST(LightClusters_BinLightsDropsLightsPastClusterCapacity)
+	{
+		const glm::mat4 projectionMatrix = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+		std::vector<ClusterBounds> clusterBounds(g_ClusterCount);
+		LightClusters::BuildClusterBounds(projectionMatrix, clusterBounds.data());
+
+		//More lights than a cluster holds, all in the middle of the first one. It keeps the lowest indices.
+		const uint32_t clusterIndex = 0;
+		const glm::vec3 clusterCenter = glm::vec3(clusterBounds[clusterIndex].m_Minimum + clusterBounds[clusterIndex].m_Maximum) * 0.5f;
+		const std::vector<glm::vec4> viewSpaceLights(g_MaximumLightsPerCluster + 37, glm::vec4(clusterCenter, 0.01f));
+
+		std::vector<uint32_t> lightCounts(g_ClusterCount);
+		std::vector<uint32_t> lightIndices((size_t)g_ClusterCount * g_MaximumLightsPerCluster);
+		LightClusters::BinLights(clusterBounds.data(), clusterIndex, clusterIndex + 1, viewSpaceLights.data(), (uint32_t)viewSpaceLights.size(), lightCounts.data(), lightIndices.data());
+
+		CrescentCheck(lightCounts[clusterIndex] == g_MaximumLightsPerCluster);
+		bool lowestIndicesKept = true;
+		for (uint32_t i = 0; i < g_MaximumLightsPerCluster; i++)
+		{
+			lowestIndicesKept &= lightIndices[i] == i;
+		}
+		CrescentCheck(lowestIndicesKept);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#include "TestFramework.h"
+#include "Core/CrescentPCH.h"
+#include "Memory/LinearAllocator.h"
+
+namespace Crescent
+{
+	CRESCENT_TEST(LinearAllocator_SteadyStateMakesNoHeapAllocations)
+	{
+		LinearAllocator frameAllocator(1024);
+		CrescentCheck(frameAllocator.RetrieveHeapAllocationCount() == 0);
+
+		//The first frame outgrows the initial block and chains on more.
+		auto AllocateFrame = [&frameAllocator]()
+		{
+			for (int i = 0; i < 64; i++)
+			{
+				frameAllocator.AllocateArray<uint64_t>(16 + i);
+			}
+		};
+		AllocateFrame();
+		CrescentCheck(frameAllocator.RetrieveHeapAllocationCount() > 0);
+
+		//Resetting coalesces those blocks into one, which is last frame's allocation, not the next one's. From then on, the same frame fits without the heap.
+		frameAllocator.Reset();
+		CrescentCheck(frameAllocator.RetrieveHeapAllocationCount() == 0);
+		CrescentCheck(frameAllocator.RetrieveUsedMemory() == 0);
+		for (int frame = 0; frame < 3; frame++)
+		{
+			AllocateFrame();
+			CrescentCheck(frameAllocator.RetrieveHeapAllocationCount() == 0);
+			frameAllocator.Reset();
+			CrescentCheck(frameAllocator.RetrieveHeapAllocationCount() == 0);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#include "TestFramework.h"
+#include "Core/CrescentPCH.h"
+#include "GraphicsTestContext.h"
+#include "Rendering/MaterialParameterBuffer.h"
+#include <algorithm>
+
+namespace Crescent
+{
+	CRESCENT_TEST(MaterialParameterBuffer_ReleasedSlotsAreReused)
+	{
+		GLFWwindow* hiddenWindow = CreateHiddenContext();
+		if (!hiddenWindow)
+		{
+			return;
+		}
+
+		//A streamed cell's materials are destroyed and recreated every time it reloads. However often that happens, it must keep to the same slots.
+		{
+			MaterialParameterBuffer parameterBuffer(4);
+			std::vector<int> cellSlots;
+			for (int reloadIndex = 0; reloadIndex < 100; reloadIndex++)
+			{
+				for (int materialIndex = 0; materialIndex < 3; materialIndex++)
+				{
+					cellSlots.push_back(parameterBuffer.AllocateSlot());
+				}
+				CrescentCheck(parameterBuffer.RetrieveAllocatedSlotCount() == 3);
+
+				for (int cellSlot : cellSlots)
+				{
+					parameterBuffer.ReleaseSlot(cellSlot);
+				}
+				cellSlots.clear();
+				CrescentCheck(parameterBuffer.RetrieveAllocatedSlotCount() == 0);
+			}
+
+			//Live slots are never handed out twice, whether fresh or reused.
+			std::vector<int> liveSlots;
+			for (int i = 0; i < 10; i++)
+			{
+				liveSlots.push_back(parameterBuffer.AllocateSlot());
+			}
+			std::sort(liveSlots.begin(), liveSlots.end());
+			CrescentCheck(std::adjacent_find(liveSlots.begin(), liveSlots.end()) == liveSlots.end());
+			CrescentCheck(liveSlots.back() == 9);
+		}
+
+		DestroyHiddenContext(hiddenWindow);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include "TestFramework.h"
+#include "Core/CrescentPCH.h"
+#include "Core/JobSystem.h"
+#include "Rendering/RenderQueue.h"
+#include "Models/Mesh.h"
+#include "Shading/Material.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <thread>
+#include <algorithm>
+
+namespace Crescent
+{
+	static constexpr uint32_t g_SceneMeshCount = 16;
+	static constexpr uint32_t g_SceneMaterialCount = 8;
+
+	//Stand-ins for a scene's meshes and materials. Neither touches GL until it is drawn, and we never draw them.
+	struct GeneratedRenderScene
+	{
+		GeneratedRenderScene(uint32_t entityCount)
+		{
+			for (uint32_t i = 0; i < g_SceneMeshCount; i++)
+			{
+				m_Meshes[i].m_BoundingBoxMinimum = glm::vec3(-0.5f - 0.1f * i);
+				m_Meshes[i].m_BoundingBoxMaximum = glm::vec3(0.5f + 0.1f * i);
+			}
+			for (Material& material : m_Materials)
+			{
+				material.m_MaterialType = Material_Default;
+			}
+
+			//Entities scattered through a 400 unit cube, of which the camera below sees a small part.
+			m_Transforms.resize(entityCount);
+			uint32_t randomState = 20211017;
+			auto RandomFloat = [&randomState]()
+			{
+				randomState = randomState * 1664525u + 1013904223u;
+				return (randomState >> 8) * (1.0f / 16777216.0f);
+			};
+			for (glm::mat4& transform : m_Transforms)
+			{
+				glm::vec3 position = glm::vec3(RandomFloat(), RandomFloat(), RandomFloat()) * 400.0f - 200.0f;
+				transform = glm::rotate(glm::translate(glm::mat4(1.0f), position), RandomFloat() * 6.28f, glm::vec3(0.0f, 1.0f, 0.0f));
+			}
+		}
+
+		Mesh* RetrieveEntityMesh(uint32_t entityIndex) { return &m_Meshes[entityIndex % g_SceneMeshCount]; }
+		Material* RetrieveEntityMaterial(uint32_t entityIndex) { return &m_Materials[(entityIndex / 3) % g_SceneMaterialCount]; }
+
+		Mesh m_Meshes[g_SceneMeshCount];
+		Material m_Materials[g_SceneMaterialCount];
+		std::vector<glm::mat4> m_Transforms;
+	};
+
+	static Frustum RetrieveTestFrustum()
+	{
+		const glm::mat4 projectionMatrix = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 150.0f);
+		const glm::mat4 viewMatrix = glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, -0.2f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		return Frustum(projectionMatrix * viewMatrix);
+	}
+
+	//Submits one command per entity. Only culling is spread across workers by the queue, so there's nothing to parallelize here.
+	static void SubmitRenderCommands(RenderQueue& renderQueue, GeneratedRenderScene& scene)
+	{
+		for (uint32_t i = 0; i < scene.m_Transforms.size(); i++)
+		{
+			renderQueue.SubmitRenderCommand(renderQueue.BuildRenderCommand(scene.RetrieveEntityMesh(i), scene.RetrieveEntityMaterial(i), scene.m_Transforms[i], true, false));
+		}
+	}
+
+	//Sorts commands carrying the given keys through the queue, then counts the positions at which they differ from a stable sort of the same keys.
+	static uint32_t CountMisorderedCommands(RenderQueue& renderQueue, GeneratedRenderScene& scene, const std::vector<uint64_t>& sortKeys)
+	{
+		//The transform slot is never read before drawing, so it carries each command's submission index through the sort.
+		for (uint32_t i = 0; i < sortKeys.size(); i++)
+		{
+			RenderCommand renderCommand = renderQueue.BuildRenderCommand(scene.RetrieveEntityMesh(i), scene.RetrieveEntityMaterial(i), scene.m_Transforms[i], true, false);
+			renderCommand.m_SortKey = sortKeys[i];
+			renderCommand.m_TransformSlot = i;
+			renderQueue.SubmitRenderCommand(renderCommand);
+		}
+		renderQueue.SortRenderCommands();
+
+		std::vector<uint32_t> expectedOrder(sortKeys.size());
+		for (uint32_t i = 0; i < expectedOrder.size(); i++)
+		{
+			expectedOrder[i] = i;
+		}
+		std::stable_sort(expectedOrder.begin(), expectedOrder.end(), [&sortKeys](uint32_t left, uint32_t right) { return sortKeys[left] < sortKeys[right]; });
+
+		const RenderCommandList sortedCommands = renderQueue.RetrieveDeferredRenderingCommands();
+		uint32_t mismatchCount = sortedCommands.size() == sortKeys.size() ? 0 : 1;
+		for (uint32_t i = 0; i < std::min(sortedCommands.size(), (uint32_t)expectedOrder.size()); i++)
+		{
+			mismatchCount += sortedCommands[i].m_TransformSlot != expectedOrder[i] || sortedCommands[i].m_SortKey != sortKeys[expectedOrder[i]] ? 1 : 0;
+		}
+		renderQueue.ClearQueuedCommands();
+		return mismatchCount;
+	}
+
+	CRESCENT_TEST(RenderQueue_RadixSortMatchesStableSort)
+	{
+		static constexpr uint32_t g_CommandCount = 5000;
+		GeneratedRenderScene scene(g_CommandCount);
+		RenderQueue renderQueue(nullptr);
+
+		uint64_t randomState = 20211017;
+		auto RandomKey = [&randomState]()
+		{
+			randomState = randomState * 6364136223846793005ull + 1442695040888963407ull;
+			return randomState ^ (randomState >> 29);
+		};
+
+		//Keys spread over every digit, then keys drawn from a few values so that many are equal and their submission order has to survive.
+		std::vector<uint64_t> sortKeys(g_CommandCount);
+		std::generate(sortKeys.begin(), sortKeys.end(), RandomKey);
+		CrescentCheck(CountMisorderedCommands(renderQueue, scene, sortKeys) == 0);
+
+		std::generate(sortKeys.begin(), sortKeys.end(), [&]() { return RandomKey() % 7 * 0x0101010101010101ull; });
+		CrescentCheck(CountMisorderedCommands(renderQueue, scene, sortKeys) == 0);
+
+		//Every digit pass is skipped when all keys are equal, and all but the last when keys differ only in their top byte.
+		std::fill(sortKeys.begin(), sortKeys.end(), 0x123456789ABCDEF0ull);
+		CrescentCheck(CountMisorderedCommands(renderQueue, scene, sortKeys) == 0);
+
+		std::generate(sortKeys.begin(), sortKeys.end(), [&]() { return (RandomKey() >> 56) << 56 | 0x0000ABCD00001234ull; });
+		CrescentCheck(CountMisorderedCommands(renderQueue, scene, sortKeys) == 0);
+
+		//Skipped passes between ones that run, as with our keys' sparse middle bits.
+		std::generate(sortKeys.begin(), sortKeys.end(), [&]() { const uint64_t randomKey = RandomKey(); return (randomKey & 0xFF00000000000000ull) | (randomKey & 0xFF); });
+		CrescentCheck(CountMisorderedCommands(renderQueue, scene, sortKeys) == 0);
+
+		//Fewer than two commands are left as they are.
+		sortKeys.assign(1, RandomKey());
+		CrescentCheck(CountMisorderedCommands(renderQueue, scene, sortKeys) == 0);
+	}
+
+	CRESCENT_TEST(RenderQueue_ParallelCullingMatchesSerialCulling)
+	{
+		//Enough commands for the queue to split culling across many chunks. The result must be exactly what one pass over the list keeps, in the same order.
+		GeneratedRenderScene scene(50000);
+		RenderQueue renderQueue(nullptr);
+		SubmitRenderCommands(renderQueue, scene);
+		renderQueue.SortRenderCommands();
+
+		JobSystem::Initialize(4);
+
+		const Frustum frustum = RetrieveTestFrustum();
+		RenderCommandList deferredCommands = renderQueue.RetrieveDeferredRenderingCommands();
+		RenderCommandList visibleCommands = renderQueue.CullRenderCommands(deferredCommands, frustum);
+		JobSystem::Shutdown();
+
+		std::vector<RenderCommand*> expectedCommands(deferredCommands.size());
+		const uint32_t expectedCount = frustum.CullRenderCommands(deferredCommands, expectedCommands.data());
+
+		CrescentCheck(deferredCommands.size() == 50000);
+		CrescentCheck(expectedCount > 0 && expectedCount < deferredCommands.size());
+		CrescentCheck(visibleCommands.size() == expectedCount);
+		uint32_t mismatchCount = 0;
+		for (uint32_t i = 0; i < std::min(visibleCommands.size(), expectedCount); i++)
+		{
+			mismatchCount += &visibleCommands[i] != expectedCommands[i] ? 1 : 0;
+		}
+		CrescentCheck(mismatchCount == 0);
+	}
+
+	CRESCENT_BENCHMARK(RenderQueue_CullingScaling)
+	{
+		//Culling 100k entities' commands against the camera, which the queue splits into chunks across 1 to N workers.
+		static constexpr uint32_t g_EntityCount = 100000;
+		GeneratedRenderScene scene(g_EntityCount);
+		RenderQueue renderQueue(nullptr);
+		SubmitRenderCommands(renderQueue, scene);
+		renderQueue.SortRenderCommands();
+		const RenderCommandList deferredCommands = renderQueue.RetrieveDeferredRenderingCommands();
+		const Frustum frustum = RetrieveTestFrustum();
+		uint32_t visibleCount = 0;
+
+		auto CullCommands = [&]()
+		{
+			visibleCount = renderQueue.CullRenderCommands(deferredCommands, frustum).size();
+		};
+
+		const unsigned int maximumWorkerCount = std::max(std::thread::hardware_concurrency(), 1u);
+		double singleWorkerTime = 0.0;
+		for (unsigned int workerCount = 1; workerCount <= maximumWorkerCount; workerCount++)
+		{
+			JobSystem::Initialize(workerCount);
+			CullCommands(); //Warm up.
+			const double elapsedTime = MeasureMilliseconds(CullCommands, 10);
+			JobSystem::Shutdown();
+
+			if (workerCount == 1)
+			{
+				singleWorkerTime = elapsedTime;
+			}
+			ReportBenchmark(std::to_string(workerCount) + " workers, " + std::to_string(visibleCount) + " visible (" + std::to_string(singleWorkerTime / elapsedTime) + "x)", elapsedTime);
+		}
+		renderQueue.ClearQueuedCommands();
+	}
+}
\ No newline at end of file
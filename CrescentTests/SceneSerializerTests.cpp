@@ -0,0 +1,216 @@
+#include "TestFramework.h"
+#include "Core/CrescentPCH.h"
+#include "Scene/SceneSerializer.h"
+#include "Scene/Scene.h"
+#include "Scene/Components.h"
+#include "SceneTestHelpers.h"
+#include <filesystem>
+#include <deque>
+
+namespace Crescent
+{
+	//Lights attached to the generated entities. Light components only point at them, so they must outlive the scene they're saved from.
+	struct GeneratedLights
+	{
+		std::deque<PointLight> m_PointLights;
+		std::deque<DirectionalLight> m_DirectionalLights;
+	};
+
+	static std::string RetrieveTemporaryScenePath(const std::string& fileName)
+	{
+		return (std::filesystem::temp_directory_path() / fileName).string();
+	}
+
+	static void AttachGeneratedTransform(SceneEntity* sceneEntity, uint32_t entityIndex)
+	{
+		const float offset = (float)entityIndex;
+		const uint32_t transformIndex = sceneEntity->RetrieveTransformIndex();
+		TransformSystem::SetLocalPosition(transformIndex, glm::vec3(offset * 0.5f, -offset * 0.25f, offset * 0.125f + 1.0f));
+		TransformSystem::SetLocalRotation(transformIndex, glm::vec3(offset * 0.01f, offset * 0.02f, -offset * 0.03f));
+		TransformSystem::SetLocalScale(transformIndex, glm::vec3(1.0f + offset * 0.001f, 2.0f, 0.5f));
+	}
+
+	static void AttachGeneratedLights(SceneEntity* sceneEntity, uint32_t entityIndex, GeneratedLights& generatedLights)
+	{
+		LightComponent lightComponent;
+		if (entityIndex % 5 == 0)
+		{
+			PointLight& pointLight = generatedLights.m_PointLights.emplace_back();
+			pointLight.m_LightColor = glm::vec3(0.1f, 0.2f, (float)(entityIndex % 7) / 7.0f);
+			pointLight.m_LightIntensity = 1.0f + (float)entityIndex;
+			pointLight.m_LightRadius = 2.0f + (float)(entityIndex % 11);
+			pointLight.m_IsLightVisible = entityIndex % 2 == 0;
+			pointLight.m_RenderMesh = entityIndex % 3 == 0;
+			lightComponent.m_PointLight = &pointLight;
+		}
+		if (entityIndex % 17 == 0)
+		{
+			DirectionalLight& directionalLight = generatedLights.m_DirectionalLights.emplace_back();
+			directionalLight.m_LightDirection = glm::normalize(glm::vec3(1.0f, -2.0f, (float)entityIndex));
+			directionalLight.m_LightColor = glm::vec3(0.9f, 0.8f, 0.7f);
+			directionalLight.m_LightIntensity = 3.0f;
+			directionalLight.m_ShadowCastingEnabled = entityIndex % 2 == 1;
+			lightComponent.m_DirectionalLight = &directionalLight;
+		}
+
+		if (lightComponent.m_PointLight || lightComponent.m_DirectionalLight)
+		{
+			ComponentStorage::RetrieveLights().AddComponent(sceneEntity->RetrieveEntityHandle(), lightComponent);
+		}
+	}
+
+	static std::vector<SceneEntity*> GenerateLitHierarchy(uint32_t rootCount, uint32_t childCount, GeneratedLights& generatedLights)
+	{
+		return GenerateHierarchy(rootCount, childCount, [&generatedLights](SceneEntity* sceneEntity, uint32_t entityIndex)
+		{
+			AttachGeneratedTransform(sceneEntity, entityIndex);
+			AttachGeneratedLights(sceneEntity, entityIndex, generatedLights);
+		});
+	}
+
+	static bool LightsMatch(const SceneEntity* savedEntity, const SceneEntity* loadedEntity)
+	{
+		const LightComponent* savedLight = ComponentStorage::RetrieveLights().RetrieveComponent(savedEntity->RetrieveEntityHandle());
+		const LightComponent* loadedLight = ComponentStorage::RetrieveLights().RetrieveComponent(loadedEntity->RetrieveEntityHandle());
+		if (!savedLight || !loadedLight)
+		{
+			return !savedLight && !loadedLight;
+		}
+
+		if ((savedLight->m_PointLight != nullptr) != (loadedLight->m_PointLight != nullptr) || (savedLight->m_DirectionalLight != nullptr) != (loadedLight->m_DirectionalLight != nullptr))
+		{
+			return false;
+		}
+
+		if (const PointLight* savedPointLight = savedLight->m_PointLight)
+		{
+			const PointLight* loadedPointLight = loadedLight->m_PointLight;
+			if (savedPointLight->m_LightColor != loadedPointLight->m_LightColor || savedPointLight->m_LightIntensity != loadedPointLight->m_LightIntensity ||
+				savedPointLight->m_LightRadius != loadedPointLight->m_LightRadius || savedPointLight->m_IsLightVisible != loadedPointLight->m_IsLightVisible ||
+				savedPointLight->m_RenderMesh != loadedPointLight->m_RenderMesh)
+			{
+				return false;
+			}
+		}
+
+		if (const DirectionalLight* savedDirectionalLight = savedLight->m_DirectionalLight)
+		{
+			const DirectionalLight* loadedDirectionalLight = loadedLight->m_DirectionalLight;
+			if (savedDirectionalLight->m_LightDirection != loadedDirectionalLight->m_LightDirection || savedDirectionalLight->m_LightColor != loadedDirectionalLight->m_LightColor ||
+				savedDirectionalLight->m_LightIntensity != loadedDirectionalLight->m_LightIntensity || savedDirectionalLight->m_ShadowCastingEnabled != loadedDirectionalLight->m_ShadowCastingEnabled)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//Walks both hierarchies in step. Counts mismatching entities rather than stopping at the first, so a failure shows how widespread it is.
+	static uint32_t CountMismatchingEntities(SceneEntity* savedEntity, SceneEntity* loadedEntity)
+	{
+		const uint32_t savedTransformIndex = savedEntity->RetrieveTransformIndex();
+		const uint32_t loadedTransformIndex = loadedEntity->RetrieveTransformIndex();
+		const bool entityMatches = savedEntity->RetrieveEntityName() == loadedEntity->RetrieveEntityName() &&
+			(savedEntity->RetrieveParentEntity() == nullptr) == (loadedEntity->RetrieveParentEntity() == nullptr) &&
+			(!savedEntity->RetrieveParentEntity() || savedEntity->RetrieveParentEntity()->RetrieveEntityName() == loadedEntity->RetrieveParentEntity()->RetrieveEntityName()) &&
+			TransformSystem::RetrieveLocalPosition(savedTransformIndex) == TransformSystem::RetrieveLocalPosition(loadedTransformIndex) &&
+			TransformSystem::RetrieveLocalRotation(savedTransformIndex) == TransformSystem::RetrieveLocalRotation(loadedTransformIndex) &&
+			TransformSystem::RetrieveLocalScale(savedTransformIndex) == TransformSystem::RetrieveLocalScale(loadedTransformIndex) &&
+			LightsMatch(savedEntity, loadedEntity);
+
+		uint32_t mismatchCount = entityMatches ? 0 : 1;
+		if (savedEntity->RetrieveChildCount() != loadedEntity->RetrieveChildCount())
+		{
+			return mismatchCount + 1;
+		}
+		for (unsigned int i = 0; i < savedEntity->RetrieveChildCount(); i++)
+		{
+			mismatchCount += CountMismatchingEntities(savedEntity->RetrieveChildByIndex(i), loadedEntity->RetrieveChildByIndex(i));
+		}
+		return mismatchCount;
+	}
+
+	CRESCENT_TEST(SceneSerializer_RoundTripsHierarchyAndLights)
+	{
+		const std::string filePath = RetrieveTemporaryScenePath("CrescentTests_RoundTrip.cscene");
+		GeneratedLights generatedLights;
+		const std::vector<SceneEntity*> savedEntities = GenerateLitHierarchy(20, 4, generatedLights);
+		const std::vector<SceneEntity*> savedRoots = RetrieveRootEntities(savedEntities);
+		CrescentCheck(SceneSerializer::SaveEntities(savedRoots, filePath));
+
+		Scene loadedScene;
+		std::vector<SceneEntity*> loadedRoots;
+		{
+			SceneFileContents fileContents;
+			std::string failureMessage;
+			const bool fileOpened = SceneSerializer::OpenSceneFile(filePath, fileContents, &failureMessage);
+			CrescentCheck(fileOpened);
+			if (fileOpened)
+			{
+				CrescentCheck(fileContents.m_EntityCount == 20 * (1 + 4 + 4 * 4));
+				CrescentCheck(fileContents.m_PointLightCount == generatedLights.m_PointLights.size());
+				CrescentCheck(fileContents.m_DirectionalLightCount == generatedLights.m_DirectionalLights.size());
+				SceneSerializer::InstantiateScene(&loadedScene, nullptr, fileContents, &loadedRoots);
+			}
+		}
+
+		CrescentCheck(loadedRoots.size() == savedRoots.size());
+		CrescentCheck(loadedScene.RetrieveSceneEntities() == loadedRoots);
+		for (size_t i = 0; i < std::min(savedRoots.size(), loadedRoots.size()); i++)
+		{
+			CrescentCheck(CountMismatchingEntities(savedRoots[i], loadedRoots[i]) == 0);
+		}
+
+		loadedScene.ClearScene();
+		DestroyHierarchy(savedEntities);
+		std::filesystem::remove(filePath);
+	}
+
+	CRESCENT_TEST(SceneSerializer_RejectsTruncatedFiles)
+	{
+		const std::string filePath = RetrieveTemporaryScenePath("CrescentTests_Truncated.cscene");
+		GeneratedLights generatedLights;
+		const std::vector<SceneEntity*> savedEntities = GenerateLitHierarchy(2, 2, generatedLights);
+		CrescentCheck(SceneSerializer::SaveEntities(RetrieveRootEntities(savedEntities), filePath));
+		DestroyHierarchy(savedEntities);
+
+		std::filesystem::resize_file(filePath, std::filesystem::file_size(filePath) - 4);
+		SceneFileContents fileContents;
+		CrescentCheck(!SceneSerializer::OpenSceneFile(filePath, fileContents));
+		std::filesystem::remove(filePath);
+	}
+
+	CRESCENT_BENCHMARK(SceneSerializer_Load100kEntities)
+	{
+		//4,000 roots of 1 + 4 + 16 entities, 84,000 all told, plus another 16,000 loose roots.
+		const std::string filePath = RetrieveTemporaryScenePath("CrescentTests_Load100k.cscene");
+		GeneratedLights generatedLights;
+		std::vector<SceneEntity*> savedEntities = GenerateLitHierarchy(4000, 4, generatedLights);
+		const std::vector<SceneEntity*> looseRoots = GenerateLitHierarchy(16000, 0, generatedLights);
+		savedEntities.insert(savedEntities.end(), looseRoots.begin(), looseRoots.end());
+		const std::vector<SceneEntity*> savedRoots = RetrieveRootEntities(savedEntities);
+
+		ReportBenchmark("Save 100,000 entities", MeasureMilliseconds([&]() { SceneSerializer::SaveEntities(savedRoots, filePath); }));
+		DestroyHierarchy(savedEntities);
+
+		for (int iteration = 0; iteration < 3; iteration++)
+		{
+			Scene loadedScene;
+			SceneFileContents fileContents;
+			bool fileOpened = false;
+			const double openTime = MeasureMilliseconds([&]() { fileOpened = SceneSerializer::OpenSceneFile(filePath, fileContents); });
+			CrescentCheck(fileOpened);
+			if (!fileOpened)
+			{
+				break;
+			}
+
+			const double instantiateTime = MeasureMilliseconds([&]() { SceneSerializer::InstantiateScene(&loadedScene, nullptr, fileContents); });
+			ReportBenchmark("Open 100,000 entities", openTime);
+			ReportBenchmark("Instantiate 100,000 entities", instantiateTime);
+			CrescentCheck(EntityPool::RetrieveLiveEntityCount() >= 100000);
+			loadedScene.ClearScene();
+		}
+		std::filesystem::remove(filePath);
+	}
+}
\ No newline at end of file
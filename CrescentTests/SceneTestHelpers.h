@@ -0,0 +1,67 @@
+#pragma once
+#include "Scene/SceneEntity.h"
+#include "Scene/EntityPool.h"
+#include "Scene/TransformSystem.h"
+#include <vector>
+#include <string>
+
+namespace Crescent
+{
+	//Roots with childCount children each, every child with childCount children of its own. Each entity is handed to attachComponents(sceneEntity, entityIndex)
+	//once it is parented, numbered in construction order. Returns every entity, parents before their children.
+	template<typename AttachFunction>
+	inline std::vector<SceneEntity*> GenerateHierarchy(uint32_t rootCount, uint32_t childCount, AttachFunction attachComponents)
+	{
+		std::vector<SceneEntity*> sceneEntities;
+		sceneEntities.reserve(rootCount * (1 + childCount + childCount * childCount));
+		auto ConstructGeneratedEntity = [&](SceneEntity* parentEntity)
+		{
+			const uint32_t entityIndex = (uint32_t)sceneEntities.size();
+			SceneEntity* sceneEntity = EntityPool::ConstructEntity("Entity " + std::to_string(entityIndex));
+			if (parentEntity)
+			{
+				parentEntity->AddChildEntity(sceneEntity);
+			}
+			attachComponents(sceneEntity, entityIndex);
+			sceneEntities.push_back(sceneEntity);
+			return sceneEntity;
+		};
+
+		for (uint32_t rootIndex = 0; rootIndex < rootCount; rootIndex++)
+		{
+			SceneEntity* rootEntity = ConstructGeneratedEntity(nullptr);
+			for (uint32_t childIndex = 0; childIndex < childCount; childIndex++)
+			{
+				SceneEntity* childEntity = ConstructGeneratedEntity(rootEntity);
+				for (uint32_t grandchildIndex = 0; grandchildIndex < childCount; grandchildIndex++)
+				{
+					ConstructGeneratedEntity(childEntity);
+				}
+			}
+		}
+		return sceneEntities;
+	}
+
+	inline std::vector<SceneEntity*> RetrieveRootEntities(const std::vector<SceneEntity*>& sceneEntities)
+	{
+		std::vector<SceneEntity*> rootEntities;
+		for (SceneEntity* sceneEntity : sceneEntities)
+		{
+			if (!sceneEntity->RetrieveParentEntity())
+			{
+				rootEntities.push_back(sceneEntity);
+			}
+		}
+		return rootEntities;
+	}
+
+	//Takes every entity GenerateHierarchy returned. Children go before their parents, so nothing is ever re-rooted on the way out.
+	inline void DestroyHierarchy(const std::vector<SceneEntity*>& sceneEntities)
+	{
+		TransformSystem::ClearChangedEntities();
+		for (auto iterator = sceneEntities.rbegin(); iterator != sceneEntities.rend(); iterator++)
+		{
+			EntityPool::DestroyEntity(*iterator);
+		}
+	}
+}
\ No newline at end of file
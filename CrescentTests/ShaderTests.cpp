@@ -0,0 +1,142 @@
+#include "TestFramework.h"
+#include "Core/CrescentPCH.h"
+#include "GraphicsTestContext.h"
+#include "Shading/Shader.h"
+#include <glm/gtc/type_ptr.hpp>
+#include <cstring>
+
+namespace Crescent
+{
+	static const char* g_UniformTestVertexShader = R"(
+		#version 330 core
+		layout (location = 0) in vec3 a_Position;
+		uniform mat4 u_BoneMatrices[2];
+		void main()
+		{
+			gl_Position = u_BoneMatrices[0] * u_BoneMatrices[1] * vec4(a_Position, 1.0);
+		})";
+
+	static const char* g_UniformTestFragmentShader = R"(
+		#version 330 core
+		out vec4 o_Color;
+		uniform vec4 u_Colors[4];
+		uniform vec4 u_Tint;
+		void main()
+		{
+			o_Color = u_Tint * (u_Colors[0] + u_Colors[1] + u_Colors[2] + u_Colors[3]);
+		})";
+
+	//What the program actually holds at a location, read back from OpenGL rather than through our cache.
+	template<typename T>
+	static T RetrieveProgramUniform(const Shader& shader, const char* uniformName)
+	{
+		T value;
+		glGetUniformfv(shader.GetShaderID(), glGetUniformLocation(shader.GetShaderID(), uniformName), (float*)&value);
+		return value;
+	}
+
+	CRESCENT_TEST(Shader_ArrayNamesShareCachedValues)
+	{
+		GLFWwindow* hiddenWindow = CreateHiddenContext();
+		if (!hiddenWindow)
+		{
+			return;
+		}
+
+		Shader shader("Uniform Test", g_UniformTestVertexShader, g_UniformTestFragmentShader);
+		CrescentCheck(shader.HasUniform("u_Colors") && shader.HasUniform("u_Colors[0]"));
+
+		//An array's first element is settable through either name. Uploading the array through one must drop the value cached through the other,
+		//or setting that value again is skipped while the program holds the array's.
+		const glm::vec4 singleColor = glm::vec4(1.0f, 2.0f, 3.0f, 4.0f);
+		const glm::vec4 arrayColors[4] = { glm::vec4(5.0f), glm::vec4(6.0f), glm::vec4(7.0f), glm::vec4(8.0f) };
+		shader.SetUniformVector4("u_Colors", singleColor);
+		shader.SetUniformVector4Array("u_Colors[0]", arrayColors, 4);
+		CrescentCheck(RetrieveProgramUniform<glm::vec4>(shader, "u_Colors[0]") == arrayColors[0]);
+		shader.SetUniformVector4("u_Colors", singleColor);
+		CrescentCheck(RetrieveProgramUniform<glm::vec4>(shader, "u_Colors[0]") == singleColor);
+
+		shader.SetUniformVector4("u_Colors[0]", singleColor);
+		shader.SetUniformVector4Array("u_Colors", arrayColors, 4);
+		shader.SetUniformVector4("u_Colors[0]", singleColor);
+		CrescentCheck(RetrieveProgramUniform<glm::vec4>(shader, "u_Colors[0]") == singleColor);
+		CrescentCheck(RetrieveProgramUniform<glm::vec4>(shader, "u_Colors[1]") == arrayColors[1]);
+
+		const glm::mat4 singleMatrix = glm::mat4(2.0f);
+		const glm::mat4 arrayMatrices[2] = { glm::mat4(3.0f), glm::mat4(4.0f) };
+		shader.SetUniformMat4("u_BoneMatrices[0]", singleMatrix);
+		shader.SetUniformMat4Array("u_BoneMatrices", arrayMatrices, 2);
+		shader.SetUniformMat4("u_BoneMatrices[0]", singleMatrix);
+		CrescentCheck(RetrieveProgramUniform<glm::mat4>(shader, "u_BoneMatrices[0]") == singleMatrix);
+
+		//Setting the value a location already holds, through either name, is skipped but must leave it intact.
+		shader.SetUniformMat4("u_BoneMatrices", singleMatrix);
+		CrescentCheck(RetrieveProgramUniform<glm::mat4>(shader, "u_BoneMatrices[0]") == singleMatrix);
+
+		shader.DeleteShader();
+		DestroyHiddenContext(hiddenWindow);
+	}
+
+	CRESCENT_BENCHMARK(Shader_UniformSetters)
+	{
+		GLFWwindow* hiddenWindow = CreateHiddenContext();
+		if (!hiddenWindow)
+		{
+			return;
+		}
+
+		static constexpr int g_SetCount = 100000;
+		Shader shader("Uniform Test", g_UniformTestVertexShader, g_UniformTestFragmentShader);
+		shader.UseShader();
+		const glm::vec4 tintValues[2] = { glm::vec4(1.0f), glm::vec4(0.5f) };
+
+		//How setters worked before uniform handles: a search by name over the program's uniforms, and an upload to the bound program on every call.
+		std::vector<std::pair<std::string, int>> programUniforms;
+		int uniformCount = 0;
+		glGetProgramiv(shader.GetShaderID(), GL_ACTIVE_UNIFORMS, &uniformCount);
+		for (int i = 0; i < uniformCount; i++)
+		{
+			char uniformName[128];
+			int uniformSize;
+			GLenum uniformType;
+			glGetActiveUniform(shader.GetShaderID(), i, sizeof(uniformName), nullptr, &uniformSize, &uniformType, uniformName);
+			programUniforms.emplace_back(uniformName, glGetUniformLocation(shader.GetShaderID(), uniformName));
+		}
+		auto SetTintByName = [&programUniforms](const std::string& uniformName, const glm::vec4& value)
+		{
+			for (const std::pair<std::string, int>& programUniform : programUniforms)
+			{
+				if (programUniform.first == uniformName)
+				{
+					glUniform4fv(programUniform.second, 1, &value[0]);
+					return;
+				}
+			}
+		};
+
+		ReportBenchmark("100,000 sets, searched by name and uploaded every call", MeasureMilliseconds([&]()
+		{
+			for (int i = 0; i < g_SetCount; i++)
+			{
+				SetTintByName("u_Tint", tintValues[i & 1]);
+			}
+		}, 10));
+		ReportBenchmark("100,000 sets, hashed handle with the value changing every call", MeasureMilliseconds([&]()
+		{
+			for (int i = 0; i < g_SetCount; i++)
+			{
+				shader.SetUniformVector4("u_Tint", tintValues[i & 1]);
+			}
+		}, 10));
+		ReportBenchmark("100,000 sets, hashed handle with the value unchanged", MeasureMilliseconds([&]()
+		{
+			for (int i = 0; i < g_SetCount; i++)
+			{
+				shader.SetUniformVector4("u_Tint", tintValues[0]);
+			}
+		}, 10));
+
+		shader.DeleteShader();
+		DestroyHiddenContext(hiddenWindow);
+	}
+}
\ No newline at end of file
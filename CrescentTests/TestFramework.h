@@ -0,0 +1,82 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <iostream>
+
+namespace Crescent
+{
+	/*
+		Just enough of a test runner for the engine's CPU side systems. Tests and benchmarks register themselves through the macros below at static
+		initialization, and TestMain runs every test, followed by the benchmarks when asked to. A failed check reports itself and fails its test, but the
+		test carries on so that one run shows everything that is wrong.
+	*/
+
+	struct TestCase
+	{
+		const char* m_Name = nullptr;
+		void (*m_Function)() = nullptr;
+		bool m_Benchmark = false;
+	};
+
+	class TestRegistry
+	{
+	public:
+		static std::vector<TestCase>& RetrieveTestCases()
+		{
+			static std::vector<TestCase> testCases;
+			return testCases;
+		}
+
+		static int& RetrieveFailureCount()
+		{
+			static int failureCount = 0;
+			return failureCount;
+		}
+
+		static bool RegisterTestCase(const char* name, void (*function)(), bool benchmark)
+		{
+			RetrieveTestCases().push_back({ name, function, benchmark });
+			return true;
+		}
+
+		static void ReportFailure(const char* expression, const char* filePath, int lineNumber)
+		{
+			RetrieveFailureCount()++;
+			std::cout << "[FAILED] " << filePath << "(" << lineNumber << "): " << expression << "\n";
+		}
+	};
+
+	//Times the function over the given iterations, returning the average in milliseconds.
+	inline double MeasureMilliseconds(const std::function<void()>& function, int iterationCount = 1)
+	{
+		const std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < iterationCount; i++)
+		{
+			function();
+		}
+		const std::chrono::duration<double, std::milli> elapsedTime = std::chrono::high_resolution_clock::now() - startTime;
+		return elapsedTime.count() / iterationCount;
+	}
+
+	inline void ReportBenchmark(const std::string& label, double milliseconds)
+	{
+		std::cout << "    " << label << ": " << milliseconds << " ms\n";
+	}
+}
+
+#define CrescentTestConcatenate(a, b) a##b
+#define CrescentTestName(a, b) CrescentTestConcatenate(a, b)
+
+#define CRESCENT_TEST(name) \
+	static void name(); \
+	static const bool CrescentTestName(g_Registered, name) = Crescent::TestRegistry::RegisterTestCase(#name, &name, false); \
+	static void name()
+
+#define CRESCENT_BENCHMARK(name) \
+	static void name(); \
+	static const bool CrescentTestName(g_Registered, name) = Crescent::TestRegistry::RegisterTestCase(#name, &name, true); \
+	static void name()
+
+#define CrescentCheck(expression) do { if (!(expression)) { Crescent::TestRegistry::ReportFailure(#expression, __FILE__, __LINE__); } } while (false)
\ No newline at end of file
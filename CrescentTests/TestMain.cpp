@@ -0,0 +1,42 @@
+#include "TestFramework.h"
+#include <cstring>
+
+//Usage: CrescentTests [--benchmarks] [name filter]. Returns non-zero if any check failed.
+int main(int argumentCount, char** arguments)
+{
+	bool runBenchmarks = false;
+	const char* nameFilter = nullptr;
+	for (int i = 1; i < argumentCount; i++)
+	{
+		if (std::strcmp(arguments[i], "--benchmarks") == 0)
+		{
+			runBenchmarks = true;
+		}
+		else
+		{
+			nameFilter = arguments[i];
+		}
+	}
+
+	int testCount = 0;
+	for (const Crescent::TestCase& testCase : Crescent::TestRegistry::RetrieveTestCases())
+	{
+		if ((testCase.m_Benchmark && !runBenchmarks) || (nameFilter && !std::strstr(testCase.m_Name, nameFilter)))
+		{
+			continue;
+		}
+
+		const int previousFailureCount = Crescent::TestRegistry::RetrieveFailureCount();
+		std::cout << (testCase.m_Benchmark ? "[BENCHMARK] " : "[TEST] ") << testCase.m_Name << "\n";
+		testCase.m_Function();
+		if (Crescent::TestRegistry::RetrieveFailureCount() != previousFailureCount)
+		{
+			std::cout << "[FAILED] " << testCase.m_Name << "\n";
+		}
+		testCount++;
+	}
+
+	const int failureCount = Crescent::TestRegistry::RetrieveFailureCount();
+	std::cout << testCount << " run, " << failureCount << " failed checks.\n";
+	return failureCount == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "TestFramework.h"
+#include "Core/CrescentPCH.h"
+#include "SceneTestHelpers.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace Crescent
+{
+	//A generated hierarchy with varied local transforms, whose world matrices are already up to date.
+	static std::vector<SceneEntity*> GenerateTransformHierarchy(uint32_t rootCount, uint32_t childCount)
+	{
+		const std::vector<SceneEntity*> sceneEntities = GenerateHierarchy(rootCount, childCount, [](SceneEntity* sceneEntity, uint32_t entityIndex)
+		{
+			const float offset = (float)(entityIndex % 97);
+			const uint32_t transformIndex = sceneEntity->RetrieveTransformIndex();
+			TransformSystem::SetLocalPosition(transformIndex, glm::vec3(offset, 1.0f, -offset * 0.5f));
+			TransformSystem::SetLocalRotation(transformIndex, glm::vec3(offset * 0.01f, offset * 0.02f, 0.0f));
+			TransformSystem::SetLocalScale(transformIndex, glm::vec3(1.0f, 1.0f + offset * 0.001f, 1.0f));
+		});
+
+		TransformSystem::UpdateTransforms();
+		TransformSystem::ClearChangedEntities();
+		return sceneEntities;
+	}
+
+	//The world matrix as glm would build it, walking up through the parents.
+	static glm::mat4 ComputeReferenceWorldMatrix(const SceneEntity* sceneEntity)
+	{
+		const uint32_t transformIndex = sceneEntity->RetrieveTransformIndex();
+		const glm::mat4 localMatrix = glm::translate(glm::mat4(1.0f), TransformSystem::RetrieveLocalPosition(transformIndex)) *
+			glm::mat4_cast(glm::quat(TransformSystem::RetrieveLocalRotation(transformIndex))) * glm::scale(glm::mat4(1.0f), TransformSystem::RetrieveLocalScale(transformIndex));
+		return sceneEntity->RetrieveParentEntity() ? ComputeReferenceWorldMatrix(sceneEntity->RetrieveParentEntity()) * localMatrix : localMatrix;
+	}
+
+	static uint32_t CountMismatchingWorldMatrices(const std::vector<SceneEntity*>& sceneEntities)
+	{
+		uint32_t mismatchCount = 0;
+		for (const SceneEntity* sceneEntity : sceneEntities)
+		{
+			const glm::mat4& worldMatrix = TransformSystem::RetrieveWorldMatrix(sceneEntity->RetrieveTransformIndex());
+			const glm::mat4 referenceMatrix = ComputeReferenceWorldMatrix(sceneEntity);
+			bool matrixMatches = true;
+			for (int column = 0; column < 4; column++)
+			{
+				const glm::vec4 difference = glm::abs(worldMatrix[column] - referenceMatrix[column]);
+				matrixMatches &= glm::max(glm::max(difference.x, difference.y), glm::max(difference.z, difference.w)) < 1e-3f;
+			}
+			mismatchCount += matrixMatches ? 0 : 1;
+		}
+		return mismatchCount;
+	}
+
+	CRESCENT_TEST(TransformSystem_UpdatesMatchReferenceMatrices)
+	{
+		std::vector<SceneEntity*> sceneEntities = GenerateTransformHierarchy(20, 4);
+		CrescentCheck(CountMismatchingWorldMatrices(sceneEntities) == 0);
+
+		//Moving a root must carry its whole subtree along, and report each of its 21 entities as changed exactly once.
+		TransformSystem::SetLocalPosition(sceneEntities[0]->RetrieveTransformIndex(), glm::vec3(5.0f, -3.0f, 2.0f));
+		TransformSystem::SetLocalRotation(sceneEntities[1]->RetrieveTransformIndex(), glm::vec3(0.3f, 0.0f, 0.0f));
+		TransformSystem::UpdateTransforms();
+		CrescentCheck(TransformSystem::RetrieveChangedEntities().size() == 21);
+		CrescentCheck(CountMismatchingWorldMatrices(sceneEntities) == 0);
+		TransformSystem::ClearChangedEntities();
+
+		//Parenting a root under an entity created after it breaks the parent-before-child order, which the next update has to restore.
+		sceneEntities.back()->AddChildEntity(sceneEntities[0]);
+		TransformSystem::UpdateTransforms();
+		CrescentCheck(CountMismatchingWorldMatrices(sceneEntities) == 0);
+
+		//With nothing modified, nothing changes.
+		TransformSystem::ClearChangedEntities();
+		TransformSystem::UpdateTransforms();
+		CrescentCheck(TransformSystem::RetrieveChangedEntities().empty());
+
+		sceneEntities.back()->RemoveChildEntity(sceneEntities[0]->RetrieveEntityHandle());
+		DestroyHierarchy(sceneEntities);
+	}
+
+	CRESCENT_BENCHMARK(TransformSystem_UpdateLargeHierarchies)
+	{
+		//Roots of 1 + 10 + 100 entities, about 100k and 1M entities all told. Each frame modifies some transforms, then brings the world matrices up to date.
+		for (uint32_t rootCount : { 901u, 9009u })
+		{
+			const std::vector<SceneEntity*> sceneEntities = GenerateTransformHierarchy(rootCount, 10);
+			const std::string entityCount = std::to_string(sceneEntities.size());
+
+			auto UpdateFrame = [&](uint32_t modifiedStride, uint32_t modifiedOffset)
+			{
+				for (uint32_t i = modifiedOffset; i < sceneEntities.size(); i += modifiedStride)
+				{
+					TransformSystem::RetrieveLocalRotation(sceneEntities[i]->RetrieveTransformIndex()).y += 0.01f;
+					TransformSystem::MarkTransformDirty(sceneEntities[i]->RetrieveTransformIndex());
+				}
+				TransformSystem::UpdateTransforms();
+				TransformSystem::ClearChangedEntities();
+			};
+
+			//Every root moving updates every entity, while every 10th entity moving mostly touches leaves. An idle frame should cost nothing.
+			ReportBenchmark(entityCount + " entities, every entity updated", MeasureMilliseconds([&]() { UpdateFrame(111, 0); }, 10));
+			ReportBenchmark(entityCount + " entities, every 10th entity modified", MeasureMilliseconds([&]() { UpdateFrame(10, 5); }, 10));
+			ReportBenchmark(entityCount + " entities, nothing modified", MeasureMilliseconds([&]() { UpdateFrame(1, (uint32_t)sceneEntities.size()); }, 10));
+			DestroyHierarchy(sceneEntities);
+		}
+	}
+}
\ No newline at end of file